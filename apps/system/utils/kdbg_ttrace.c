@@ -18,6 +18,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include <errno.h>
 #include <getopt.h>
 #include <string.h>
@@ -31,6 +32,9 @@
 
 int param = 0;
 int selected_tags = 0;
+#ifdef CONFIG_TTRACE_RING
+static char *save_path;
+#endif
 
 static void show_help(void);
 static void wait_ttrace_dump(void);
@@ -85,6 +89,79 @@ static int print_packet(struct trace_packet *packet)
 	}
 }
 
+#ifdef CONFIG_TTRACE_RING
+static void print_record(struct ttrace_record_s *rec, struct ttrace_ringhdr_s *hdr)
+{
+	uint32_t usec = rec->ticks * hdr->usec_per_tick;
+	uint32_t lost;
+
+	printf("[%06d:%06d] %010u %03d: %c|", usec / 1000000, usec % 1000000, rec->cycles, rec->pid, rec->event_type);
+
+	if (rec->event_type == TTRACE_EVENT_TYPE_SCHED) {
+		printf("prev_comm=%.12s prev_pid=%u prev_prio=%u prev_state=%u ==> next_comm=%.12s next_pid=%u next_prio=%u\r\n",
+			   rec->msg.sched_msg.prev_comm,
+			   rec->msg.sched_msg.prev_pid,
+			   rec->msg.sched_msg.prev_prio,
+			   rec->msg.sched_msg.prev_state,
+			   rec->msg.sched_msg.next_comm,
+			   rec->msg.sched_msg.next_pid,
+			   rec->msg.sched_msg.next_prio);
+	} else if (rec->event_type == TTRACE_EVENT_TYPE_LOST) {
+		memcpy(&lost, rec->msg.message, sizeof(uint32_t));
+		printf("%u records lost\r\n", lost);
+	} else if (rec->codelen & TTRACE_CODE_UNIQUE) {
+		printf("%u\r\n", rec->codelen & ~TTRACE_CODE_UNIQUE);
+	} else {
+		printf("%.32s\r\n", rec->msg.message);
+	}
+}
+
+/* Drain the trace ring, printing the records or saving them to a file */
+static int read_tracering(FILE *file, char *path)
+{
+	struct ttrace_ringhdr_s hdr;
+	struct ttrace_record_s rec;
+	FILE *out = NULL;
+	int ret = TTRACE_VALID;
+	int count = 0;
+
+	if (read(file->fs_fd, &hdr, sizeof(hdr)) != sizeof(hdr) || hdr.magic != TTRACE_RING_MAGIC) {
+		printf("Failed to read the trace ring header\r\n");
+		return TTRACE_INVALID;
+	}
+
+	if (path != NULL) {
+		out = fopen(path, "w");
+		if (out == NULL || fwrite(&hdr, sizeof(hdr), 1, out) != 1) {
+			printf("Failed to write : %s\r\n", path);
+			ret = TTRACE_INVALID;
+			goto errout;
+		}
+	}
+
+	while (read(file->fs_fd, &rec, sizeof(rec)) == sizeof(rec)) {
+		if (out == NULL) {
+			print_record(&rec, &hdr);
+		} else if (fwrite(&rec, sizeof(rec), 1, out) != 1) {
+			printf("Failed to write : %s\r\n", path);
+			ret = TTRACE_INVALID;
+			break;
+		}
+		count++;
+	}
+
+	if (out != NULL) {
+		printf("%d records saved to %s, convert with os/tools/ttrace2json.py\r\n", count, path);
+	}
+
+errout:
+	if (out != NULL) {
+		fclose(out);
+	}
+	return ret;
+}
+#endif
+
 static void show_help()
 {
 	printf("usage: ttrace [opions] [tags...]\r\n");
@@ -94,6 +171,9 @@ static void show_help()
 	printf("    -i     Show information(state, available/selected/TP used tags, bufsize)\r\n");
 	printf("    -d     Dump trace buffer, It should be run after finish\r\n");
 	printf("    -p     Print trace buffer, It should be run after finish)\r\n");
+#ifdef CONFIG_TTRACE_RING
+	printf("    -o     Save trace buffer to the file given as argument\r\n");
+#endif
 }
 
 static int assign_tag(char *name)
@@ -123,10 +203,11 @@ static int parse_args(int argc, char **args)
 	 * -g : TTRACE_FUNC_TAG, TP's tag(hidden to user)
 	 * -d : TTRACE_DUMP, dump mode(hang), It should be run after finish.
 	 * -p : TTRACE_PRINT, print traces, It should be run after finish.
+	 * -o : TTRACE_SAVE, save traces to a file (trace ring only).
 	 */
 	while (1) {
 		optarg = NULL;
-		ret = getopt(argc, args, "sfidpb:");
+		ret = getopt(argc, args, "sfidpb:o:");
 		if (ret == '?') {
 			show_help();
 			return TTRACE_INVALID;
@@ -142,6 +223,11 @@ static int parse_args(int argc, char **args)
 		if (optarg != NULL) {
 			param = atoi(optarg);
 		}
+#ifdef CONFIG_TTRACE_RING
+		if (cmd == TTRACE_SAVE) {
+			save_path = optarg;
+		}
+#endif
 	}
 	for (i = optind ; i < argc ; i++) {
 		printf("args[%d], %s\r\n", i, args[i]);
@@ -252,10 +338,19 @@ static int send_cmds(FILE *file, int cmd)
 	} else if (cmd == TTRACE_FINISH) {
 		bufsize = run_cmd(file, TTRACE_USED_BUFSIZE, param);
 	} else if (cmd == TTRACE_PRINT) {
+#ifdef CONFIG_TTRACE_RING
+		return read_tracering(file, NULL);
+#else
 		bufsize = run_cmd(file, TTRACE_USED_BUFSIZE, param);
 		ret = read_tracebuffer(file, bufsize);
 		return ret;
+#endif
+	}
+#ifdef CONFIG_TTRACE_RING
+	else if (cmd == TTRACE_SAVE) {
+		return read_tracering(file, save_path);
 	}
+#endif
 
 	if (run_cmd(file, cmd, param) == TTRACE_INVALID) {
 		return TTRACE_INVALID;
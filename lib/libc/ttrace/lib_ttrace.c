@@ -87,6 +87,33 @@ int send_packet_sched(struct trace_packet *packet)
 	return ret;
 }
 
+static void create_sched_message(struct sched_message *msg, struct tcb_s *prev, struct tcb_s *next)
+{
+	msg->pad = -1;
+
+	if (prev != NULL) {
+		memcpy(msg->prev_comm, prev->name, TTRACE_COMM_BYTES);
+		msg->prev_pid = prev->pid;
+		msg->prev_prio = prev->sched_priority;
+		msg->prev_state = prev->task_state;
+	} else {
+		memcpy(msg->prev_comm, "Idle Task", TTRACE_COMM_BYTES);
+		msg->prev_pid = 0;
+		msg->prev_prio = 0;
+		msg->prev_state = 3;
+	}
+
+	if (next != NULL) {
+		memcpy(msg->next_comm, next->name, TTRACE_COMM_BYTES);
+		msg->next_pid = next->pid;
+		msg->next_prio = next->sched_priority;
+	} else {
+		memcpy(msg->next_comm, "Idle Task", TTRACE_COMM_BYTES);
+		msg->next_pid = 0;
+		msg->next_prio = 0;
+	}
+}
+
 int create_packet_sched(struct trace_packet *packet, struct tcb_s *prev, struct tcb_s *next)
 {
 	int ret = TTRACE_VALID;
@@ -98,29 +125,7 @@ int create_packet_sched(struct trace_packet *packet, struct tcb_s *prev, struct
 	packet->codelen = TTRACE_CODE_VARIABLE | msg_len;
 	packet->pad = -1;
 
-	packet->msg.sched_msg.pad = -1;
-
-	if (prev != NULL) {
-		memcpy(packet->msg.sched_msg.prev_comm, prev->name, TTRACE_COMM_BYTES);
-		packet->msg.sched_msg.prev_pid = prev->pid;
-		packet->msg.sched_msg.prev_prio = prev->sched_priority;
-		packet->msg.sched_msg.prev_state = prev->task_state;
-	} else {
-		memcpy(packet->msg.sched_msg.prev_comm, "Idle Task", TTRACE_COMM_BYTES);
-		packet->msg.sched_msg.prev_pid = 0;
-		packet->msg.sched_msg.prev_prio = 0;
-		packet->msg.sched_msg.prev_state = 3;
-	}
-
-	if (next != NULL) {
-		memcpy(packet->msg.sched_msg.next_comm, next->name, TTRACE_COMM_BYTES);
-		packet->msg.sched_msg.next_pid = next->pid;
-		packet->msg.sched_msg.next_prio = next->sched_priority;
-	} else {
-		memcpy(packet->msg.sched_msg.next_comm, "Idle Task", TTRACE_COMM_BYTES);
-		packet->msg.sched_msg.next_pid = 0;
-		packet->msg.sched_msg.next_prio = 0;
-	}
+	create_sched_message(&packet->msg.sched_msg, prev, next);
 
 	return ret;
 }
@@ -171,6 +176,40 @@ int create_packet_u(struct trace_packet *packet, char type, int8_t uid)
 	return ret;
 }
 
+#ifdef CONFIG_TTRACE_RING
+/* Records for the trace ring.  The message is only formatted if it has
+ * conversions, and the time is stamped by the driver.  The whole message
+ * is cleared first, as all of it is copied to the ring and read out.
+ */
+
+static void create_record(struct ttrace_record_s *rec, char type, char *str, va_list valist)
+{
+	int msg_len;
+
+	memset(&rec->msg, 0, sizeof(rec->msg));
+	rec->event_type = type;
+	rec->pid = getpid();
+
+	if (strchr(str, '%') != NULL) {
+		vsnprintf(rec->msg.message, TTRACE_MSG_BYTES, str, valist);
+	} else {
+		strncpy(rec->msg.message, str, TTRACE_MSG_BYTES - 1);
+		rec->msg.message[TTRACE_MSG_BYTES - 1] = '\0';
+	}
+
+	msg_len = strlen(rec->msg.message) + 1;
+	rec->codelen = TTRACE_CODE_VARIABLE | msg_len;
+}
+
+static void create_record_u(struct ttrace_record_s *rec, char type, int8_t uid)
+{
+	memset(&rec->msg, 0, sizeof(rec->msg));
+	rec->event_type = type;
+	rec->pid = getpid();
+	rec->codelen = TTRACE_CODE_UNIQUE | uid;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -181,6 +220,22 @@ int trace_sched(struct tcb_s *prev_tcb, struct tcb_s *next_tcb)
 	int tag = TTRACE_TAG_TASK;
 	struct trace_packet packet;
 
+#ifdef CONFIG_TTRACE_RING
+	struct ttrace_record_s rec;
+
+	/* Called on every context switch, so return early if not tracing */
+	if (!ttrace_ring_enabled(tag)) {
+		return TTRACE_INVALID;
+	}
+
+	rec.event_type = TTRACE_EVENT_TYPE_SCHED;
+	rec.pid = next_tcb != NULL ? next_tcb->pid : 0;
+	rec.codelen = TTRACE_CODE_VARIABLE | sizeof(struct sched_message);
+	create_sched_message(&rec.msg.sched_msg, prev_tcb, next_tcb);
+	ttrace_ring_put(&rec);
+	return ret;
+#endif
+
 	if (is_fd_available() < 0) {
 		return TTRACE_INVALID;
 	}
@@ -215,6 +270,20 @@ int trace_begin(int tag, char *str, ...)
 	struct trace_packet packet;
 	va_list ap;
 
+#ifdef CONFIG_TTRACE_RING
+	struct ttrace_record_s rec;
+
+	if (!ttrace_ring_enabled(tag)) {
+		return TTRACE_INVALID;
+	}
+
+	va_start(ap, str);
+	create_record(&rec, TTRACE_EVENT_TYPE_BEGIN, str, ap);
+	va_end(ap);
+	ttrace_ring_put(&rec);
+	return ret;
+#endif
+
 	if (is_fd_available() < 0) {
 		return TTRACE_INVALID;
 	}
@@ -241,6 +310,18 @@ int trace_begin_u(int tag, int8_t uid)
 	int ret = TTRACE_VALID;
 	struct trace_packet packet;
 
+#ifdef CONFIG_TTRACE_RING
+	struct ttrace_record_s rec;
+
+	if (!ttrace_ring_enabled(tag)) {
+		return TTRACE_INVALID;
+	}
+
+	create_record_u(&rec, TTRACE_EVENT_TYPE_BEGIN, uid);
+	ttrace_ring_put(&rec);
+	return ret;
+#endif
+
 	if (is_fd_available() < 0) {
 		return TTRACE_INVALID;
 	}
@@ -275,6 +356,18 @@ int trace_end(int tag)
 	int ret = TTRACE_VALID;
 	struct trace_packet packet;
 
+#ifdef CONFIG_TTRACE_RING
+	struct ttrace_record_s rec;
+
+	if (!ttrace_ring_enabled(tag)) {
+		return TTRACE_INVALID;
+	}
+
+	create_record_u(&rec, TTRACE_EVENT_TYPE_END, 0);
+	ttrace_ring_put(&rec);
+	return ret;
+#endif
+
 	if (is_fd_available() < 0) {
 		return TTRACE_INVALID;
 	}
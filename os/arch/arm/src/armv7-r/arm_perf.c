@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/arm/src/armv7-r/arm_perf.c
+ *
+ * Cycle counter for timing short code paths, based on the PMCCNTR register
+ * of the Performance Monitors extension.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+
+#include <tinyara/arch.h>
+
+#include "sctlr.h"
+
+#ifdef CONFIG_ARCH_HAVE_PERF_EVENTS
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The counting rate is measured over this many milliseconds of the
+ * calibrated delay loop.
+ */
+
+#define PERF_CALIBRATE_MSEC  10
+
+/* PMCNTENSET bit enabling the cycle counter */
+
+#define PMCNTENSET_C         (1 << 31)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint32_t g_perf_freq;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_perf_init
+ *
+ * Description:
+ *   Reset and start the cycle counter, counting every CPU clock, and
+ *   measure its rate against up_mdelay().  The rate is therefore only as
+ *   accurate as CONFIG_BOARD_LOOPSPERMSEC.
+ *
+ ****************************************************************************/
+
+void up_perf_init(void)
+{
+	uint32_t start;
+
+	cp15_wrpmcr((cp15_rdpmcr() & ~PCMR_D) | PCMR_E | PCMR_C);
+	cp15_wrpmcntenset(PMCNTENSET_C);
+
+	start = cp15_rdpmccntr();
+	up_mdelay(PERF_CALIBRATE_MSEC);
+	g_perf_freq = (cp15_rdpmccntr() - start) * (1000 / PERF_CALIBRATE_MSEC);
+}
+
+/****************************************************************************
+ * Name: up_perf_gettime
+ *
+ * Description:
+ *   Return the current count of the cycle counter.
+ *
+ ****************************************************************************/
+
+uint32_t up_perf_gettime(void)
+{
+	return cp15_rdpmccntr();
+}
+
+/****************************************************************************
+ * Name: up_perf_getfreq
+ *
+ * Description:
+ *   Return the rate of the cycle counter in Hz.
+ *
+ ****************************************************************************/
+
+uint32_t up_perf_getfreq(void)
+{
+	return g_perf_freq;
+}
+
+#endif /* CONFIG_ARCH_HAVE_PERF_EVENTS */
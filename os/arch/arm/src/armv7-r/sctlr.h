@@ -530,6 +530,35 @@ static inline void cp15_wrpmcr(unsigned int pmcr)
 	);
 }
 
+/* Write the Performance Monitors Count Enable Set Register (PMCNTENSET) */
+
+static inline void cp15_wrpmcntenset(unsigned int pmcntenset)
+{
+	__asm__ __volatile__
+	(
+		"\tmcr p15, 0, %0, c9, c12, 1\n"
+		:
+		: "r"(pmcntenset)
+		: "memory"
+	);
+}
+
+/* Read the Performance Monitors Cycle Count Register (PMCCNTR) */
+
+static inline unsigned int cp15_rdpmccntr(void)
+{
+	unsigned int pmccntr;
+	__asm__ __volatile__
+	(
+		"\tmrc p15, 0, %0, c9, c13, 0\n"
+		: "=r"(pmccntr)
+		:
+		: "memory"
+	);
+
+	return pmccntr;
+}
+
 #endif							/* __ASSEMBLY__ */
 
 /****************************************************************************
@@ -162,6 +162,12 @@ void up_initialize(void)
 
 	up_calibratedelay();
 
+#ifdef CONFIG_ARCH_HAVE_PERF_EVENTS
+	/* Start the cycle counter used to time short code paths */
+
+	up_perf_init();
+#endif
+
 	/* Colorize the interrupt stack */
 
 	up_color_intstack();
@@ -385,6 +385,20 @@
 
 /* Add next LCD display */
 
+/* Default the size of the bounce buffer */
+
+#ifndef CONFIG_LCD_ILI9341_BOUNCEBUF
+#define CONFIG_LCD_ILI9341_BOUNCEBUF 0
+#endif
+
+/* Number of pixels sent per transfer when filling a run with one color */
+
+#if CONFIG_LCD_ILI9341_BOUNCEBUF > 0
+#define ILI9341_FILLBLOCK         CONFIG_LCD_ILI9341_BOUNCEBUF
+#else
+#define ILI9341_FILLBLOCK         32
+#endif
+
 /* Debug option */
 
 #ifdef CONFIG_DEBUG_LCD
@@ -423,10 +437,33 @@ struct ili9341_dev_s {
 
 	int (*getrun)(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer, size_t npixels);
 #endif
+	/* Driver specific fillrun function */
+
+	int (*fillrun)(fb_coord_t row, fb_coord_t col, uint32_t color, size_t npixels);
+
 	/* Run buffer for the device */
 
 	uint16_t *runbuffer;
 
+#if CONFIG_LCD_ILI9341_BOUNCEBUF > 0
+	/* Buffer that all pixel transfers of the device go through */
+
+	uint16_t *bounce;
+#endif
+
+	/* The address window left open by the last write.  Its columns are those
+	 * of the run and its pages run to the bottom of the display, so the next
+	 * row of a rectangle is written with ILI9341_WRITE_MEMORY_CONTINUE.
+	 */
+
+	fb_coord_t wincol;			/* First column of the window */
+	fb_coord_t winncols;		/* Columns of the window, 0: no window open */
+	fb_coord_t winrow;			/* Row that the next pixel goes to */
+
+	/* Bus transfer counters */
+
+	struct ili9341_stats_s stats;
+
 	/* Display orientation, e.g. Landscape, Portrait */
 
 	uint8_t orient;
@@ -459,6 +496,7 @@ static int ili9341_putrun(int devno, fb_coord_t row, fb_coord_t col, FAR const u
 #ifndef CONFIG_LCD_NOGETRUN
 static int ili9341_getrun(int devno, fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer, size_t npixels);
 #endif
+static int ili9341_fillrun(int devno, fb_coord_t row, fb_coord_t col, uint32_t color, size_t npixels);
 /*
  * Definition of the public visible getrun / putrun methods
  * each for a single LCD driver
@@ -480,6 +518,13 @@ static int ili9341_getrun1(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer,
 #endif
 #endif
 
+#ifdef CONFIG_LCD_ILI9341_IFACE0
+static int ili9341_fillrun0(fb_coord_t row, fb_coord_t col, uint32_t color, size_t npixels);
+#endif
+#ifdef CONFIG_LCD_ILI9341_IFACE1
+static int ili9341_fillrun1(fb_coord_t row, fb_coord_t col, uint32_t color, size_t npixels);
+#endif
+
 /* lcd configuration */
 
 static int ili9341_getvideoinfo(FAR struct lcd_dev_s *dev, FAR struct fb_videoinfo_s *vinfo);
@@ -491,6 +536,7 @@ static int ili9341_getpower(struct lcd_dev_s *dev);
 static int ili9341_setpower(struct lcd_dev_s *dev, int power);
 static int ili9341_getcontrast(struct lcd_dev_s *dev);
 static int ili9341_setcontrast(struct lcd_dev_s *dev, unsigned int contrast);
+static int ili9341_ioctl(FAR struct lcd_dev_s *dev, int cmd, unsigned long arg);
 
 /******************************************************************************
  * Private Data
@@ -500,9 +546,15 @@ static int ili9341_setcontrast(struct lcd_dev_s *dev, unsigned int contrast);
 
 #ifdef CONFIG_LCD_ILI9341_IFACE0
 static uint16_t g_runbuffer0[ILI9341_IFACE0_BUFFER];
+#if CONFIG_LCD_ILI9341_BOUNCEBUF > 0
+static uint32_t g_bounce0[(CONFIG_LCD_ILI9341_BOUNCEBUF + 1) / 2];
+#endif
 #endif
 #ifdef CONFIG_LCD_ILI9341_IFACE1
 static uint16_t g_runbuffer1[ILI9341_IFACE1_BUFFER];
+#if CONFIG_LCD_ILI9341_BOUNCEBUF > 0
+static uint32_t g_bounce1[(CONFIG_LCD_ILI9341_BOUNCEBUF + 1) / 2];
+#endif
 #endif
 
 static struct ili9341_dev_s g_lcddev[CONFIG_LCD_ILI9341_NINTERFACES] = {
@@ -513,7 +565,11 @@ static struct ili9341_dev_s g_lcddev[CONFIG_LCD_ILI9341_NINTERFACES] = {
 #ifndef CONFIG_LCD_NOGETRUN
 		.getrun = ili9341_getrun0,
 #endif
+		.fillrun = ili9341_fillrun0,
 		.runbuffer = g_runbuffer0,
+#if CONFIG_LCD_ILI9341_BOUNCEBUF > 0
+		.bounce = (uint16_t *)g_bounce0,
+#endif
 		.orient = ILI9341_IFACE0_ORIENT,
 		.pxfmt = ILI9341_IFACE0_PXFMT,
 		.bpp = ILI9341_IFACE0_BPP,
@@ -527,7 +583,11 @@ static struct ili9341_dev_s g_lcddev[CONFIG_LCD_ILI9341_NINTERFACES] = {
 #ifndef CONFIG_LCD_NOGETRUN
 		.getrun = ili9341_getrun1,
 #endif
+		.fillrun = ili9341_fillrun1,
 		.runbuffer = g_runbuffer1,
+#if CONFIG_LCD_ILI9341_BOUNCEBUF > 0
+		.bounce = (uint16_t *)g_bounce1,
+#endif
 		.orient = ILI9341_IFACE1_ORIENT,
 		.pxfmt = ILI9341_IFACE1_PXFMT,
 		.bpp = ILI9341_IFACE1_BPP,
@@ -624,6 +684,132 @@ static void ili9341_selectarea(FAR struct ili9341_lcd_s *lcd, uint16_t x0, uint1
 	lcd->sendparam(lcd, (y1 & 0xff));
 }
 
+/*******************************************************************************
+ * Name:  ili9341_openwindow
+ *
+ * Description:
+ *   Prepare the controller to receive a run of pixels.  If the run continues
+ *   the rectangle being written, the open address window is reused with a
+ *   single memory write continue command.  Otherwise a new window is set
+ *   that has the columns of the run and reaches the bottom of the display.
+ *
+ * Parameter:
+ *   dev     - Reference to private driver structure
+ *   row     - Row of the run
+ *   col     - First column of the run
+ *   npixels - Number of pixels of the run
+ *
+ ******************************************************************************/
+
+static void ili9341_openwindow(FAR struct ili9341_dev_s *dev, fb_coord_t row, fb_coord_t col, size_t npixels)
+{
+	FAR struct ili9341_lcd_s *lcd = dev->lcd;
+
+	if (dev->winncols == npixels && dev->wincol == col && dev->winrow == row) {
+		/* Continue where the previous run ended */
+
+		lcd->sendcmd(lcd, ILI9341_WRITE_MEMORY_CONTINUE);
+		dev->stats.streamed++;
+		dev->stats.cmdbytes += 1;
+	} else {
+		ili9341_selectarea(lcd, col, row, col + npixels - 1, ili9341_getyres(dev) - 1);
+		lcd->sendcmd(lcd, ILI9341_MEMORY_WRITE);
+		dev->wincol = col;
+		dev->winncols = npixels;
+		dev->stats.windows++;
+		dev->stats.cmdbytes += 11;
+	}
+
+	/* After the run the controller points to the start of the next row */
+
+	dev->winrow = row + 1;
+	if (dev->winrow >= ili9341_getyres(dev)) {
+		dev->winncols = 0;
+	}
+}
+
+/*******************************************************************************
+ * Name:  ili9341_closewindow
+ *
+ * Description:
+ *   Forget the open address window.  Must be called whenever a command other
+ *   than a memory write is sent to the controller.
+ *
+ ******************************************************************************/
+
+static inline void ili9341_closewindow(FAR struct ili9341_dev_s *dev)
+{
+	dev->winncols = 0;
+}
+
+/*******************************************************************************
+ * Name:  ili9341_sendpixels
+ *
+ * Description:
+ *   Send pixels to the gram, through the bounce buffer if there is one.
+ *
+ ******************************************************************************/
+
+static void ili9341_sendpixels(FAR struct ili9341_dev_s *dev, FAR const uint16_t *src, size_t npixels)
+{
+	FAR struct ili9341_lcd_s *lcd = dev->lcd;
+#if CONFIG_LCD_ILI9341_BOUNCEBUF > 0
+	size_t nblock;
+#endif
+
+	dev->stats.txbytes += npixels * sizeof(uint16_t);
+
+#if CONFIG_LCD_ILI9341_BOUNCEBUF > 0
+	while (npixels > 0) {
+		nblock = npixels < CONFIG_LCD_ILI9341_BOUNCEBUF ? npixels : CONFIG_LCD_ILI9341_BOUNCEBUF;
+		memcpy(dev->bounce, src, nblock * sizeof(uint16_t));
+		lcd->sendgram(lcd, dev->bounce, nblock);
+		dev->stats.transfers++;
+		src += nblock;
+		npixels -= nblock;
+	}
+#else
+	lcd->sendgram(lcd, src, npixels);
+	dev->stats.transfers++;
+#endif
+}
+
+/*******************************************************************************
+ * Name:  ili9341_fillpixels
+ *
+ * Description:
+ *   Send one color to the gram npixels times, repeating a block of pixels.
+ *
+ ******************************************************************************/
+
+static void ili9341_fillpixels(FAR struct ili9341_dev_s *dev, uint16_t color, size_t npixels)
+{
+	FAR struct ili9341_lcd_s *lcd = dev->lcd;
+#if CONFIG_LCD_ILI9341_BOUNCEBUF > 0
+	FAR uint16_t *block = dev->bounce;
+#else
+	uint16_t block[ILI9341_FILLBLOCK];
+#endif
+	size_t nblock;
+	size_t i;
+
+	dev->stats.txbytes += npixels * sizeof(uint16_t);
+
+	nblock = npixels < ILI9341_FILLBLOCK ? npixels : ILI9341_FILLBLOCK;
+	for (i = 0; i < nblock; i++) {
+		block[i] = color;
+	}
+
+	/* Send the block of pixels until the run is full */
+
+	while (npixels > 0) {
+		nblock = npixels < ILI9341_FILLBLOCK ? npixels : ILI9341_FILLBLOCK;
+		lcd->sendgram(lcd, block, nblock);
+		dev->stats.transfers++;
+		npixels -= nblock;
+	}
+}
+
 /*******************************************************************************
  * Name:  ili9341_putrun
  *
@@ -654,7 +840,7 @@ static int ili9341_putrun(int devno, fb_coord_t row, fb_coord_t col, FAR const u
 	DEBUGASSERT(buffer && ((uintptr_t)buffer & 1) == 0);
 
 	/* Check if position outside of area */
-	if (col + npixels > ili9341_getxres(dev) || row > ili9341_getyres(dev)) {
+	if (col + npixels > ili9341_getxres(dev) || row >= ili9341_getyres(dev)) {
 		return -EINVAL;
 	}
 
@@ -662,17 +848,13 @@ static int ili9341_putrun(int devno, fb_coord_t row, fb_coord_t col, FAR const u
 
 	lcd->select(lcd);
 
-	/* Select column and area similar to the partial raster line */
+	/* Open or continue the address window of the run */
 
-	ili9341_selectarea(lcd, col, row, col + npixels - 1, row);
+	ili9341_openwindow(dev, row, col, npixels);
 
-	/* Send memory write cmd */
-
-	lcd->sendcmd(lcd, ILI9341_MEMORY_WRITE);
+	/* Send the whole run to gram in one transfer */
 
-	/* Send pixel to gram */
-
-	lcd->sendgram(lcd, src, npixels);
+	ili9341_sendpixels(dev, src, npixels);
 
 	/* Deselect the lcd driver */
 
@@ -708,11 +890,14 @@ static int ili9341_getrun(int devno, fb_coord_t row, fb_coord_t col, FAR uint8_t
 	FAR struct ili9341_dev_s *dev = &g_lcddev[devno];
 	FAR struct ili9341_lcd_s *lcd = dev->lcd;
 	FAR uint16_t *dest = (uint16_t *) buffer;
+#if CONFIG_LCD_ILI9341_BOUNCEBUF > 0
+	size_t nblock;
+#endif
 
 	DEBUGASSERT(buffer && ((uintptr_t)buffer & 1) == 0);
 
 	/* Check if position outside of area */
-	if (col + npixels > ili9341_getxres(dev) || row > ili9341_getyres(dev)) {
+	if (col + npixels > ili9341_getxres(dev) || row >= ili9341_getyres(dev)) {
 		return -EINVAL;
 	}
 
@@ -727,10 +912,25 @@ static int ili9341_getrun(int devno, fb_coord_t row, fb_coord_t col, FAR uint8_t
 	/* Send memory read cmd */
 
 	lcd->sendcmd(lcd, ILI9341_MEMORY_READ);
+	ili9341_closewindow(dev);
+	dev->stats.cmdbytes += 11;
+	dev->stats.rxbytes += npixels * sizeof(uint16_t);
 
 	/* Receive pixel to gram */
 
+#if CONFIG_LCD_ILI9341_BOUNCEBUF > 0
+	while (npixels > 0) {
+		nblock = npixels < CONFIG_LCD_ILI9341_BOUNCEBUF ? npixels : CONFIG_LCD_ILI9341_BOUNCEBUF;
+		lcd->recvgram(lcd, dev->bounce, nblock);
+		memcpy(dest, dev->bounce, nblock * sizeof(uint16_t));
+		dev->stats.transfers++;
+		dest += nblock;
+		npixels -= nblock;
+	}
+#else
 	lcd->recvgram(lcd, dest, npixels);
+	dev->stats.transfers++;
+#endif
 
 	/* Deselect the lcd driver */
 
@@ -740,6 +940,58 @@ static int ili9341_getrun(int devno, fb_coord_t row, fb_coord_t col, FAR uint8_t
 }
 #endif
 
+/*******************************************************************************
+ * Name:  ili9341_fillrun
+ *
+ * Description:
+ *   Fill a partial raster line of the LCD with one color.  The run is written
+ *   into the address window of the rectangle being filled, repeating a block
+ *   of pixels, so the caller need not fill a whole run buffer.
+ *
+ * Parameters:
+ *   devno   - Number of lcd device
+ *   row     - Starting row to write to (range: 0 <= row < yres)
+ *   col     - Starting column to write to (range: 0 <= col <= xres-npixels)
+ *   color   - The color to fill with
+ *   npixels - The number of pixels to write to the
+ *             (range: 0 < npixels <= xres-col)
+ *
+ * Returned Value:
+ *
+ *   On success - OK
+ *   On error   - -EINVAL
+ *
+ ******************************************************************************/
+
+static int ili9341_fillrun(int devno, fb_coord_t row, fb_coord_t col, uint32_t color, size_t npixels)
+{
+	FAR struct ili9341_dev_s *dev = &g_lcddev[devno];
+	FAR struct ili9341_lcd_s *lcd = dev->lcd;
+
+	/* Check if position outside of area */
+	if (col + npixels > ili9341_getxres(dev) || row >= ili9341_getyres(dev)) {
+		return -EINVAL;
+	}
+
+	/* Select lcd driver */
+
+	lcd->select(lcd);
+
+	/* Open or continue the address window of the run */
+
+	ili9341_openwindow(dev, row, col, npixels);
+
+	/* Send the color until the run is full */
+
+	ili9341_fillpixels(dev, (uint16_t)color, npixels);
+
+	/* Deselect the lcd driver */
+
+	lcd->deselect(lcd);
+
+	return OK;
+}
+
 /*******************************************************************************
  * Name:  ili9341_hwinitialize
  *
@@ -904,6 +1156,40 @@ static int ili9341_getrun1(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer,
 #endif
 #endif
 
+/*******************************************************************************
+ * Name:  ili9341_fillrunx
+ *
+ * Description:
+ *   Fill a partial raster line of the LCD with one color.
+ *
+ * Parameter:
+ *   row     - Starting row to write to (range: 0 <= row < yres)
+ *   col     - Starting column to write to (range: 0 <= col <= xres-npixels)
+ *   color   - The color to fill with
+ *   npixels - The number of pixels to write to the
+ *             (range: 0 < npixels <= xres-col)
+ *
+ * Returned Value:
+ *
+ *   On success - OK
+ *   On error   - -EINVAL
+ *
+ ******************************************************************************/
+
+#ifdef CONFIG_LCD_ILI9341_IFACE0
+static int ili9341_fillrun0(fb_coord_t row, fb_coord_t col, uint32_t color, size_t npixels)
+{
+	return ili9341_fillrun(0, row, col, color, npixels);
+}
+#endif
+
+#ifdef CONFIG_LCD_ILI9341_IFACE1
+static int ili9341_fillrun1(fb_coord_t row, fb_coord_t col, uint32_t color, size_t npixels)
+{
+	return ili9341_fillrun(1, row, col, color, npixels);
+}
+#endif
+
 /*******************************************************************************
  * Name:  ili9341_getvideoinfo
  *
@@ -966,6 +1252,7 @@ static int ili9341_getplaneinfo(FAR struct lcd_dev_s *dev, unsigned int planeno,
 #ifndef CONFIG_LCD_NOGETRUN
 		pinfo->getrun = priv->getrun;
 #endif
+		pinfo->fillrun = priv->fillrun;
 		pinfo->bpp = priv->bpp;
 		pinfo->buffer = (uint8_t *) priv->runbuffer;	/* Run scratch buffer */
 
@@ -1051,6 +1338,7 @@ static int ili9341_setpower(FAR struct lcd_dev_s *dev, int power)
 		}
 
 		lcd->deselect(lcd);
+		ili9341_closewindow(priv);
 
 		priv->power = power;
 
@@ -1104,6 +1392,49 @@ static int ili9341_setcontrast(struct lcd_dev_s *dev, unsigned int contrast)
 	return -ENOSYS;
 }
 
+/*******************************************************************************
+ * Name:  ili9341_ioctl
+ *
+ * Description:
+ *   Driver specific controls, see ILI9341IOC_* in include/tinyara/lcd/ili9341.h
+ *
+ * Parameter:
+ *   dev   - A reference to the lcd driver structure
+ *   cmd   - The ioctl command
+ *   arg   - The argument of the command
+ *
+ * Returned Value:
+ *
+ *  On success - OK
+ *  On error   - -EINVAL, or -ENOTTY for an unknown command
+ *
+ ******************************************************************************/
+
+static int ili9341_ioctl(FAR struct lcd_dev_s *dev, int cmd, unsigned long arg)
+{
+	FAR struct ili9341_dev_s *priv = (FAR struct ili9341_dev_s *)dev;
+
+	switch (cmd) {
+	case ILI9341IOC_GETSTATS: {
+		FAR struct ili9341_stats_s *stats = (FAR struct ili9341_stats_s *)((uintptr_t)arg);
+
+		if (!stats) {
+			return -EINVAL;
+		}
+
+		memcpy(stats, &priv->stats, sizeof(struct ili9341_stats_s));
+		return OK;
+	}
+
+	case ILI9341IOC_RESETSTATS:
+		memset(&priv->stats, 0, sizeof(struct ili9341_stats_s));
+		return OK;
+
+	default:
+		return -ENOTTY;
+	}
+}
+
 /*******************************************************************************
  * Name:  ili9341_initialize
  *
@@ -1146,6 +1477,7 @@ FAR struct lcd_dev_s *ili9341_initialize(FAR struct ili9341_lcd_s *lcd, int devn
 			dev->setpower = ili9341_setpower;
 			dev->getcontrast = ili9341_getcontrast;
 			dev->setcontrast = ili9341_setcontrast;
+			dev->ioctl = ili9341_ioctl;
 			priv->lcd = lcd;
 
 			/* Initialze the LCD driver */
@@ -1163,6 +1495,33 @@ FAR struct lcd_dev_s *ili9341_initialize(FAR struct ili9341_lcd_s *lcd, int devn
 	return NULL;
 }
 
+/******************************************************************************
+ * Name:  ili9341_getdev
+ *
+ * Description:
+ *   Return the LCD driver object of a display that has been initialized by
+ *   ili9341_initialize().
+ *
+ * Input Parameters:
+ *
+ *   devno - A value in the range of 0 through CONFIG_ILI9341_NINTERFACES-1.
+ *
+ * Returned Value:
+ *
+ *   A reference to the LCD driver object, or NULL if the display has not been
+ *   initialized.
+ *
+ ******************************************************************************/
+
+FAR struct lcd_dev_s *ili9341_getdev(int devno)
+{
+	if (devno >= 0 && devno < CONFIG_LCD_ILI9341_NINTERFACES && g_lcddev[devno].lcd) {
+		return &g_lcddev[devno].dev;
+	}
+
+	return NULL;
+}
+
 /******************************************************************************
  * Name:  ili9341_clear
  *
@@ -1189,7 +1548,6 @@ int ili9341_clear(FAR struct lcd_dev_s *dev, uint16_t color)
 	FAR struct ili9341_lcd_s *lcd = priv->lcd;
 	uint16_t xres = ili9341_getxres(priv);
 	uint16_t yres = ili9341_getyres(priv);
-	uint32_t n;
 
 	if (!lcd) {
 		return -EINVAL;
@@ -1201,19 +1559,18 @@ int ili9341_clear(FAR struct lcd_dev_s *dev, uint16_t color)
 
 	/* Select column and area similar to the visible area */
 
-	ili9341_selectarea(lcd, 0, 0, xres, yres);
+	ili9341_selectarea(lcd, 0, 0, xres - 1, yres - 1);
 
 	/* Send memory write cmd */
 
 	lcd->sendcmd(lcd, ILI9341_MEMORY_WRITE);
+	ili9341_closewindow(priv);
+	priv->stats.windows++;
+	priv->stats.cmdbytes += 11;
 
-	/* clear the visible area */
-
-	for (n = 0; n < xres * yres; n++) {
-		/* Send pixel to gram */
+	/* Stream the color over the whole visible area in blocks */
 
-		lcd->sendgram(lcd, &color, 1);
-	}
+	ili9341_fillpixels(priv, color, (size_t)xres * yres);
 
 	/* Deselect the lcd driver */
 
@@ -0,0 +1,286 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * drivers/lcd/ili9341_procfs.c
+ *
+ * Shows the bus transfer counters of each initialized ILI9341 display, as
+ * reported by its ILI9341IOC_GETSTATS ioctl.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/kmalloc.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/procfs.h>
+
+#include <tinyara/lcd/lcd.h>
+#include <tinyara/lcd/ili9341.h>
+
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_ILI9341)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define ILI9341_LINELEN 256
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+/* This structure describes one open "file" */
+
+struct ili9341_file_s {
+	struct procfs_file_s base;	/* Base open file structure */
+	unsigned int linesize;		/* Number of valid characters in line[] */
+	char line[ILI9341_LINELEN * CONFIG_LCD_ILI9341_NINTERFACES];	/* Pre-allocated buffer for formatted lines */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+/* File system methods */
+
+static int ili9341_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode);
+static int ili9341_close(FAR struct file *filep);
+static ssize_t ili9341_read(FAR struct file *filep, FAR char *buffer, size_t buflen);
+
+static int ili9341_dup(FAR const struct file *oldp, FAR struct file *newp);
+
+static int ili9341_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_procfs.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations ili9341_procfsoperations = {
+	ili9341_open,				/* open */
+	ili9341_close,				/* close */
+	ili9341_read,				/* read */
+	NULL,						/* write */
+
+	ili9341_dup,				/* dup */
+
+	NULL,						/* opendir */
+	NULL,						/* closedir */
+	NULL,						/* readdir */
+	NULL,						/* rewinddir */
+
+	ili9341_stat				/* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ili9341_open
+ ****************************************************************************/
+
+static int ili9341_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode)
+{
+	FAR struct ili9341_file_s *attr;
+
+	fvdbg("Open '%s'\n", relpath);
+
+	/* PROCFS is read-only.  Any attempt to open with any kind of write
+	 * access is not permitted.
+	 */
+
+	if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0) {
+		fdbg("ERROR: Only O_RDONLY supported\n");
+		return -EACCES;
+	}
+
+	/* Allocate a container to hold the file attributes */
+
+	attr = (FAR struct ili9341_file_s *)kmm_zalloc(sizeof(struct ili9341_file_s));
+	if (!attr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* Save the attributes as the open-specific state in filep->f_priv */
+
+	filep->f_priv = (FAR void *)attr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: ili9341_close
+ ****************************************************************************/
+
+static int ili9341_close(FAR struct file *filep)
+{
+	FAR struct ili9341_file_s *attr;
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct ili9341_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Release the file attributes structure */
+
+	kmm_free(attr);
+	filep->f_priv = NULL;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: ili9341_read
+ ****************************************************************************/
+
+static ssize_t ili9341_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
+{
+	FAR struct ili9341_file_s *attr;
+	FAR struct lcd_dev_s *dev;
+	struct ili9341_stats_s stats;
+	int devno;
+	off_t offset;
+	ssize_t ret;
+
+	fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct ili9341_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Take a snapshot of the counters on the first read, so that they stay
+	 * stable if the user reads in small pieces.
+	 */
+
+	if (filep->f_pos == 0) {
+		attr->linesize = 0;
+
+		for (devno = 0; devno < CONFIG_LCD_ILI9341_NINTERFACES; devno++) {
+			dev = ili9341_getdev(devno);
+			if (dev == NULL || dev->ioctl(dev, ILI9341IOC_GETSTATS, (unsigned long)((uintptr_t)&stats)) < 0) {
+				continue;
+			}
+
+			attr->linesize += snprintf(&attr->line[attr->linesize], ILI9341_LINELEN,
+									   "Display %d:\n"
+									   "  Windows:   %lu\n"
+									   "  Streamed:  %lu\n"
+									   "  Transfers: %lu\n"
+									   "  Cmd bytes: %lu\n"
+									   "  TX bytes:  %llu\n"
+									   "  RX bytes:  %llu\n",
+									   devno,
+									   (unsigned long)stats.windows,
+									   (unsigned long)stats.streamed,
+									   (unsigned long)stats.transfers,
+									   (unsigned long)stats.cmdbytes,
+									   (unsigned long long)stats.txbytes,
+									   (unsigned long long)stats.rxbytes);
+		}
+	}
+
+	/* Transfer the counters to user receive buffer */
+
+	offset = filep->f_pos;
+	ret = procfs_memcpy(attr->line, attr->linesize, buffer, buflen, &offset);
+
+	/* Update the file offset */
+
+	if (ret > 0) {
+		filep->f_pos += ret;
+	}
+
+	return ret;
+}
+
+/****************************************************************************
+ * Name: ili9341_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int ili9341_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+	FAR struct ili9341_file_s *oldattr;
+	FAR struct ili9341_file_s *newattr;
+
+	fvdbg("Dup %p->%p\n", oldp, newp);
+
+	/* Recover our private data from the old struct file instance */
+
+	oldattr = (FAR struct ili9341_file_s *)oldp->f_priv;
+	DEBUGASSERT(oldattr);
+
+	/* Allocate a new container to hold the task and attribute selection */
+
+	newattr = (FAR struct ili9341_file_s *)kmm_zalloc(sizeof(struct ili9341_file_s));
+	if (!newattr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* The copy the file attributes from the old attributes to the new */
+
+	memcpy(newattr, oldattr, sizeof(struct ili9341_file_s));
+
+	/* Save the new attributes in the new file structure */
+
+	newp->f_priv = (FAR void *)newattr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: ili9341_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int ili9341_stat(const char *relpath, struct stat *buf)
+{
+	/* File/directory size, access block size */
+
+	buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+	buf->st_size = 0;
+	buf->st_blksize = 0;
+	buf->st_blocks = 0;
+	return OK;
+}
+
+#endif /* CONFIG_FS_PROCFS && !CONFIG_FS_PROCFS_EXCLUDE_ILI9341 */
@@ -47,10 +47,13 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <semaphore.h>
+#include <assert.h>
 #include <errno.h>
 #include <debug.h>
 
 #include <tinyara/arch.h>
+#include <tinyara/wqueue.h>
 #include <tinyara/spi/spi.h>
 #include <tinyara/lcd/lcd.h>
 #include <tinyara/lcd/ra8875.h>
@@ -154,16 +157,86 @@
 #  define RA8875_PACK_RGB(r,g,b) (((r)&0x7) << 5 | ((g)&0x7) << 2 | ((b)&0x3))
 #endif
 
+#if defined(CONFIG_LCD_RA8875_COLOREXPAND) && !defined(CONFIG_LCD_LANDSCAPE)
+#  error "CONFIG_LCD_RA8875_COLOREXPAND requires CONFIG_LCD_LANDSCAPE"
+#endif
+
 #if RA8875_HW_XRES >= 800 && RA8875_HW_YRES >= 480 && RA8875_BPP > 8
 #  undef RA8875_2LAYER_POSSIBLE
 #else
 #  define RA8875_2LAYER_POSSIBLE 1
 #endif
 
+/* Page flipping needs two layers.  Where they do not fit, as at 800x480 with 65K
+ * colors, ra8875_flip() and RA8875IOC_FLIP fail with -ENOSYS.
+ */
+
+#if defined(CONFIG_LCD_RA8875_PAGEFLIP) && defined(RA8875_2LAYER_POSSIBLE)
+#  define RA8875_PAGEFLIP 1
+#endif
+
+/* The layer that is drawn to.  Layer numbers match the layer select bit of MWCR1 and
+ * the display mode of LTPR0.
+ */
+
+#ifdef RA8875_PAGEFLIP
+#  define RA8875_DRAWLAYER(p) ((p)->current_layer)
+#else
+#  define RA8875_DRAWLAYER(p) 0
+#endif
+
+#ifndef MIN
+#  define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#  define MAX(a,b) ((a) > (b) ? (a) : (b))
+#endif
+
+/* BTE source/destination layer bit, as part of a 16-bit VSBE/VDBE value */
+
+#define RA8875_BTELAYER(l)    ((l) ? (RA8875_VBE1_LAYER_2 << 8) : (RA8875_VBE1_LAYER_1 << 8))
+
+/* Register queue *********************************************************************/
+/* Frequently written registers that are shadowed by the register queue, as ranges of
+ * (first, last) register addresses.  Registers that start an operation (MRWC, DCR,
+ * BECR0, MCLR) are never shadowed.  Both g_shadowranges[] and the number of shadowed
+ * registers are generated from this list, so they cannot disagree.
+ */
+
+#define RA8875_SHADOWRANGES(range) \
+  range(RA8875_HSAW0,  RA8875_VEAW1)   /* Active window */ \
+  range(RA8875_MWCR0,  RA8875_MWCR1)   /* Memory write control */ \
+  range(RA8875_MRDC,   RA8875_RCURV1)  /* Read direction, write and read cursors */ \
+  range(RA8875_BECR1,  RA8875_BECR1)   /* BTE operation */ \
+  range(RA8875_HSBE0,  RA8875_FGCR2)   /* BTE points and size, colors */ \
+  range(RA8875_DLHSR0, RA8875_DCRR)    /* Line, square and circle coordinates */ \
+  range(RA8875_DTPH0,  RA8875_DTPV1)   /* Triangle point 2 */
+
+#define RA8875_SHADOWENTRY(first, last) { first, last },
+#define RA8875_SHADOWCOUNT(first, last) + ((last) - (first) + 1)
+
+/* Number of shadowed registers and the maximum number of register writes held back
+ * before a flush.
+ */
+
+#define RA8875_NSHADOW    (0 RA8875_SHADOWRANGES(RA8875_SHADOWCOUNT))
+#define RA8875_QUEUESIZE  32
+
 /**************************************************************************************
  * Private Type Definition
  **************************************************************************************/
 
+#ifdef RA8875_PAGEFLIP
+/* An area of the display, in display coordinates.  Empty if x1 < x0. */
+
+struct ra8875_area_s
+{
+  uint16_t x0, y0;                /* Upper left corner */
+  uint16_t x1, y1;                /* Lower right corner, inclusive */
+};
+#endif
+
 /* This structure describes the state of this driver */
 
 struct ra8875_dev_s
@@ -181,9 +254,34 @@ struct ra8875_dev_s
   uint8_t current_layer;          /* Current drawing layer, 0=disabled */
 #endif
 
-  /* Shadow these registers to speed up rendering */
-  uint8_t shadow_mwcr0;
-  uint16_t shadow_w_curh, shadow_w_curv;
+#ifdef RA8875_PAGEFLIP
+  /* Page flipping.  Drawing goes to the hidden layer, current_layer (0 or 1).  On a
+   * flip the layers change roles and the area drawn during the last frame is copied
+   * from the new visible layer to the new hidden one, so that drawing can continue
+   * from the same picture.
+   */
+
+  sem_t exclsem;                  /* Serializes access to the controller */
+  bool syncpending;               /* The hidden layer still needs the copy */
+  struct ra8875_area_s dirty;     /* Area drawn to the hidden layer */
+  struct ra8875_area_s sync;      /* Area to copy into the hidden layer */
+  struct work_s syncwork;         /* Runs the copy in the background */
+#endif
+
+  /* Shadow these registers to speed up rendering.  Writes that would not change a
+   * shadowed register are dropped; the rest are queued and sent as one burst before
+   * the next drawing command.
+   */
+
+  uint8_t shadow[RA8875_NSHADOW];              /* Last value written */
+  uint8_t valid[(RA8875_NSHADOW + 7) >> 3];    /* Shadow value is known */
+  uint8_t nqueued;                             /* Number of queued writes */
+  uint8_t queue[RA8875_QUEUESIZE][2];          /* Queued (register, value) pairs */
+
+#ifdef CONFIG_LCD_RA8875_REGSTATS
+  uint32_t hits[RA8875_NSHADOW];               /* Writes dropped by the shadow */
+  uint32_t misses[RA8875_NSHADOW];             /* Writes sent to the controller */
+#endif
 
   /* These fields simplify and reduce debug output */
 
@@ -214,10 +312,17 @@ struct ra8875_dev_s
  **************************************************************************************/
 /* Low Level LCD access */
 
-static inline void ra8875_putreg(FAR struct ra8875_lcd_s *lcd, uint8_t regaddr,
-                           uint8_t regval);
-static inline void ra8875_putreg16(FAR struct ra8875_lcd_s *lcd, uint8_t regaddr,
+static int ra8875_shadowslot(uint8_t regaddr);
+static void ra8875_flushregs(FAR struct ra8875_dev_s *priv);
+static void ra8875_putreg(FAR struct ra8875_dev_s *priv, uint8_t regaddr,
+                          uint8_t regval);
+static void ra8875_setreg(FAR struct ra8875_dev_s *priv, uint8_t regaddr,
+                          uint8_t regval);
+static void ra8875_setreg16(FAR struct ra8875_dev_s *priv, uint8_t regaddr,
                             uint16_t regval);
+static void ra8875_advancereg16(FAR struct ra8875_dev_s *priv, uint8_t regaddr,
+                                int16_t increment);
+static void ra8875_invalidatereg16(FAR struct ra8875_dev_s *priv, uint8_t regaddr);
 #ifndef CONFIG_LCD_NOGETRUN
 static inline uint8_t ra8875_readreg(FAR struct ra8875_lcd_s *lcd, uint8_t regaddr);
 static inline void ra8875_waitreg(FAR struct ra8875_lcd_s *lcd, uint8_t regaddr,
@@ -225,14 +330,31 @@ static inline void ra8875_waitreg(FAR struct ra8875_lcd_s *lcd, uint8_t regaddr,
 #endif
 static void ra8875_set_writecursor(FAR struct ra8875_dev_s *dev, uint16_t column,
                                     uint16_t row);
-static void ra8875_set_readcursor(FAR struct ra8875_lcd_s *lcd, uint16_t column,
+static void ra8875_set_readcursor(FAR struct ra8875_dev_s *dev, uint16_t column,
                                     uint16_t row);
 static void ra8875_set_mwcr0(FAR struct ra8875_dev_s *dev, uint8_t value);
-static void ra8875_setwindow(FAR struct ra8875_lcd_s *lcd, uint16_t x, uint16_t y,
+static void ra8875_setwindow(FAR struct ra8875_dev_s *priv, uint16_t x, uint16_t y,
                               uint16_t width, uint16_t height);
-static inline void ra8875_setbackground(FAR struct ra8875_lcd_s *lcd, uint16_t color);
-static inline void ra8875_setforeground(FAR struct ra8875_lcd_s *lcd, uint16_t color);
-static void ra8875_clearmem(FAR struct ra8875_lcd_s *lcd);
+static inline void ra8875_setbackground(FAR struct ra8875_dev_s *priv, uint16_t color);
+static inline void ra8875_setforeground(FAR struct ra8875_dev_s *priv, uint16_t color);
+static void ra8875_clearmem(FAR struct ra8875_dev_s *priv);
+static void ra8875_btemove(FAR struct ra8875_dev_s *priv, uint16_t sx, uint16_t sy,
+                           uint16_t width, uint16_t height, uint16_t dx, uint16_t dy,
+                           uint16_t srclayer, uint16_t dstlayer);
+
+/* Page Flipping */
+
+#ifdef RA8875_PAGEFLIP
+static void ra8875_lock(FAR struct ra8875_dev_s *priv);
+static void ra8875_unlock(FAR struct ra8875_dev_s *priv);
+static void ra8875_markdirty(FAR struct ra8875_dev_s *priv, int x0, int y0, int x1,
+                             int y1);
+static void ra8875_syncworker(FAR void *arg);
+#else
+#  define ra8875_lock(p)
+#  define ra8875_unlock(p)
+#  define ra8875_markdirty(p,x0,y0,x1,y1)
+#endif
 
 /* LCD Data Transfer Methods */
 
@@ -253,6 +375,12 @@ static int ra8875_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buff
              size_t npixels);
 static int ra8875_getrun(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer,
              size_t npixels);
+static int ra8875_fillrun(fb_coord_t row, fb_coord_t col, uint32_t color,
+             size_t npixels);
+#ifdef CONFIG_LCD_RA8875_COLOREXPAND
+static int ra8875_putrun1bpp(fb_coord_t row, fb_coord_t col, FAR const uint8_t *bits,
+             uint32_t fg, uint32_t bg, size_t npixels);
+#endif
 
 /* LCD Configuration */
 
@@ -279,6 +407,7 @@ static int ra8875_getpower(FAR struct lcd_dev_s *dev);
 static int ra8875_setpower(FAR struct lcd_dev_s *dev, int power);
 static int ra8875_getcontrast(FAR struct lcd_dev_s *dev);
 static int ra8875_setcontrast(FAR struct lcd_dev_s *dev, unsigned int contrast);
+static int ra8875_ioctl(FAR struct lcd_dev_s *dev, int cmd, unsigned long arg);
 
 /* Initialization */
 
@@ -295,44 +424,209 @@ static inline int ra8875_hwinitialize(FAR struct ra8875_dev_s *priv);
 
 static struct ra8875_dev_s g_lcddev;
 
+/* The shadowed register ranges, see RA8875_SHADOWRANGES */
+
+static const uint8_t g_shadowranges[][2] =
+{
+  RA8875_SHADOWRANGES(RA8875_SHADOWENTRY)
+};
+
+#define RA8875_NSHADOWRANGES (sizeof(g_shadowranges) / sizeof(g_shadowranges[0]))
+
 /**************************************************************************************
  * Private Functions
  **************************************************************************************/
 
 /**************************************************************************************
- * Name:  ra8875_putreg(lcd,
+ * Name:  ra8875_shadowslot
+ *
+ * Description:
+ *   Return the shadow slot of a register, or -1 if the register is not shadowed
+ *
+ **************************************************************************************/
+
+static int ra8875_shadowslot(uint8_t regaddr)
+{
+  int slot = 0;
+  int i;
+
+  for (i = 0; i < RA8875_NSHADOWRANGES; i++)
+    {
+      if (regaddr >= g_shadowranges[i][0] && regaddr <= g_shadowranges[i][1])
+        {
+          return slot + regaddr - g_shadowranges[i][0];
+        }
+
+      slot += g_shadowranges[i][1] - g_shadowranges[i][0] + 1;
+    }
+
+  return -1;
+}
+
+/**************************************************************************************
+ * Name:  ra8875_flushregs
+ *
+ * Description:
+ *   Send all queued register writes to the LCD in one burst
+ *
+ **************************************************************************************/
+
+static void ra8875_flushregs(FAR struct ra8875_dev_s *priv)
+{
+  FAR struct ra8875_lcd_s *lcd = priv->lcd;
+  int i;
+
+  if (priv->nqueued == 0)
+    {
+      return;
+    }
+
+  if (lcd->write_regs != NULL)
+    {
+      lcd->write_regs(lcd, &priv->queue[0][0], priv->nqueued);
+    }
+  else
+    {
+      for (i = 0; i < priv->nqueued; i++)
+        {
+          lcd->write_reg(lcd, priv->queue[i][0], priv->queue[i][1]);
+        }
+    }
+
+  priv->nqueued = 0;
+}
+
+/**************************************************************************************
+ * Name:  ra8875_putreg
  *
  * Description:
- *   Write to an LCD register
+ *   Write to an LCD register immediately, after any queued writes.  Used for the
+ *   registers that start an operation and for configuration.
  *
  **************************************************************************************/
 
-static void ra8875_putreg(FAR struct ra8875_lcd_s *lcd, uint8_t regaddr,
+static void ra8875_putreg(FAR struct ra8875_dev_s *priv, uint8_t regaddr,
                           uint8_t regval)
 {
+  int slot;
+
+  ra8875_flushregs(priv);
+
   /* Set the index register to the register address and write the register contents */
 
   lcdinfo("putreg 0x%02x = 0x%02x\n", regaddr, regval);
 
-  lcd->write_reg(lcd, regaddr, regval);
+  priv->lcd->write_reg(priv->lcd, regaddr, regval);
+
+  slot = ra8875_shadowslot(regaddr);
+  if (slot >= 0)
+    {
+      priv->shadow[slot] = regval;
+      priv->valid[slot >> 3] |= 1 << (slot & 7);
+    }
+}
+
+/**************************************************************************************
+ * Name:  ra8875_setreg
+ *
+ * Description:
+ *   Queue a write to an LCD register.  The write is dropped if the register is
+ *   shadowed and already holds the value.
+ *
+ **************************************************************************************/
+
+static void ra8875_setreg(FAR struct ra8875_dev_s *priv, uint8_t regaddr,
+                          uint8_t regval)
+{
+  int slot = ra8875_shadowslot(regaddr);
+
+  if (slot >= 0)
+    {
+      if ((priv->valid[slot >> 3] & (1 << (slot & 7))) != 0 &&
+          priv->shadow[slot] == regval)
+        {
+#ifdef CONFIG_LCD_RA8875_REGSTATS
+          priv->hits[slot]++;
+#endif
+          return;
+        }
+
+#ifdef CONFIG_LCD_RA8875_REGSTATS
+      priv->misses[slot]++;
+#endif
+      priv->shadow[slot] = regval;
+      priv->valid[slot >> 3] |= 1 << (slot & 7);
+    }
+
+  lcdinfo("setreg 0x%02x = 0x%02x\n", regaddr, regval);
+
+  if (priv->nqueued >= RA8875_QUEUESIZE)
+    {
+      ra8875_flushregs(priv);
+    }
+
+  priv->queue[priv->nqueued][0] = regaddr;
+  priv->queue[priv->nqueued][1] = regval;
+  priv->nqueued++;
 }
 
 /**************************************************************************************
- * Name:  ra8875_putreg16(lcd,
+ * Name:  ra8875_setreg16
  *
  * Description:
- *   Write to an LCD register
+ *   Queue a write to a 16-bit LCD register pair (low byte at regaddr).  Each byte is
+ *   shadowed on its own, so only the bytes that change are sent.
  *
  **************************************************************************************/
 
-static void ra8875_putreg16(FAR struct ra8875_lcd_s *lcd, uint8_t regaddr,
+static void ra8875_setreg16(FAR struct ra8875_dev_s *priv, uint8_t regaddr,
                             uint16_t regval)
 {
-  /* Set the index register to the register address and write the register contents */
+  ra8875_setreg(priv, regaddr, regval & 0xff);
+  ra8875_setreg(priv, regaddr + 1, regval >> 8);
+}
+
+/**************************************************************************************
+ * Name:  ra8875_advancereg16
+ *
+ * Description:
+ *   Track a 16-bit register pair that the controller advanced by itself (the memory
+ *   cursors move as pixels are written).
+ *
+ **************************************************************************************/
+
+static void ra8875_advancereg16(FAR struct ra8875_dev_s *priv, uint8_t regaddr,
+                                int16_t increment)
+{
+  int slot = ra8875_shadowslot(regaddr);
+  uint16_t regval;
+
+  DEBUGASSERT(slot >= 0 && ra8875_shadowslot(regaddr + 1) == slot + 1);
+
+  regval  = priv->shadow[slot] | (priv->shadow[slot + 1] << 8);
+  regval += increment;
+
+  priv->shadow[slot]     = regval & 0xff;
+  priv->shadow[slot + 1] = regval >> 8;
+}
+
+/**************************************************************************************
+ * Name:  ra8875_invalidatereg16
+ *
+ * Description:
+ *   Forget the shadowed value of a 16-bit register pair that the controller changed
+ *   in a way that cannot be tracked.
+ *
+ **************************************************************************************/
 
-  lcdinfo("putreg 0x%02x = 0x%04x\n", regaddr, regval);
+static void ra8875_invalidatereg16(FAR struct ra8875_dev_s *priv, uint8_t regaddr)
+{
+  int slot = ra8875_shadowslot(regaddr);
+
+  DEBUGASSERT(slot >= 0 && ra8875_shadowslot(regaddr + 1) == slot + 1);
 
-  lcd->write_reg16(lcd, regaddr, regval);
+  priv->valid[slot >> 3]       &= ~(1 << (slot & 7));
+  priv->valid[(slot + 1) >> 3] &= ~(1 << ((slot + 1) & 7));
 }
 
 /**************************************************************************************
@@ -387,32 +681,12 @@ static void ra8875_waitreg(FAR struct ra8875_lcd_s *lcd, uint8_t regaddr, uint8_
 static void ra8875_set_writecursor(FAR struct ra8875_dev_s *dev, uint16_t column,
                                    uint16_t row)
 {
-  FAR struct ra8875_lcd_s *lcd = dev->lcd;
-
 #if defined(CONFIG_LCD_PORTRAIT) || defined(CONFIG_LCD_RPORTRAIT)
-  if (dev->shadow_w_curh != row)
-    {
-      ra8875_putreg16(lcd, RA8875_CURH0, row);
-      dev->shadow_w_curh = row;
-    }
-
-  if (dev->shadow_w_curv != column)
-    {
-      ra8875_putreg16(lcd, RA8875_CURV0, column);
-      dev->shadow_w_curv = column;
-    }
+  ra8875_setreg16(dev, RA8875_CURH0, row);
+  ra8875_setreg16(dev, RA8875_CURV0, column);
 #elif defined(CONFIG_LCD_LANDSCAPE) || defined(CONFIG_LCD_RLANDSCAPE)
-  if (dev->shadow_w_curh != column)
-    {
-      ra8875_putreg16(lcd, RA8875_CURH0, column);
-      dev->shadow_w_curh = column;
-    }
-
-  if (dev->shadow_w_curv != row)
-    {
-      ra8875_putreg16(lcd, RA8875_CURV0, row);
-      dev->shadow_w_curv = row;
-    }
+  ra8875_setreg16(dev, RA8875_CURH0, column);
+  ra8875_setreg16(dev, RA8875_CURV0, row);
 #endif
 }
 
@@ -424,27 +698,21 @@ static void ra8875_set_writecursor(FAR struct ra8875_dev_s *dev, uint16_t column
  *
  **************************************************************************************/
 
-static void ra8875_set_readcursor(FAR struct ra8875_lcd_s *lcd, uint16_t column,
+static void ra8875_set_readcursor(FAR struct ra8875_dev_s *dev, uint16_t column,
                                   uint16_t row)
 {
 #if defined(CONFIG_LCD_PORTRAIT) || defined(CONFIG_LCD_RPORTRAIT)
-  ra8875_putreg16(lcd, RA8875_RCURH0, row);
-  ra8875_putreg16(lcd, RA8875_RCURV0, column);
+  ra8875_setreg16(dev, RA8875_RCURH0, row);
+  ra8875_setreg16(dev, RA8875_RCURV0, column);
 #elif defined(CONFIG_LCD_LANDSCAPE) || defined(CONFIG_LCD_RLANDSCAPE)
-  ra8875_putreg16(lcd, RA8875_RCURH0, column);
-  ra8875_putreg16(lcd, RA8875_RCURV0, row);
+  ra8875_setreg16(dev, RA8875_RCURH0, column);
+  ra8875_setreg16(dev, RA8875_RCURV0, row);
 #endif
 }
 
 static void ra8875_set_mwcr0(FAR struct ra8875_dev_s *dev, uint8_t value)
 {
-  FAR struct ra8875_lcd_s *lcd = dev->lcd;
-
-  if (dev->shadow_mwcr0 != value)
-    {
-      ra8875_putreg(lcd, RA8875_MWCR0, value);
-      dev->shadow_mwcr0 = value;
-    }
+  ra8875_setreg(dev, RA8875_MWCR0, value);
 }
 
 /**************************************************************************************
@@ -455,19 +723,19 @@ static void ra8875_set_mwcr0(FAR struct ra8875_dev_s *dev, uint8_t value)
  *
  **************************************************************************************/
 
-static void ra8875_setwindow(FAR struct ra8875_lcd_s *lcd, uint16_t x, uint16_t y,
+static void ra8875_setwindow(FAR struct ra8875_dev_s *priv, uint16_t x, uint16_t y,
                              uint16_t width, uint16_t height)
 {
 #if defined(CONFIG_LCD_PORTRAIT) || defined(CONFIG_LCD_RPORTRAIT)
-  ra8875_putreg16(lcd, RA8875_HSAW0, y);
-  ra8875_putreg16(lcd, RA8875_VSAW0, x);
-  ra8875_putreg16(lcd, RA8875_HEAW0, (y+height-1));
-  ra8875_putreg16(lcd, RA8875_VEAW0, (x+width-1));
+  ra8875_setreg16(priv, RA8875_HSAW0, y);
+  ra8875_setreg16(priv, RA8875_VSAW0, x);
+  ra8875_setreg16(priv, RA8875_HEAW0, (y+height-1));
+  ra8875_setreg16(priv, RA8875_VEAW0, (x+width-1));
 #elif defined(CONFIG_LCD_LANDSCAPE) || defined(CONFIG_LCD_RLANDSCAPE)
-  ra8875_putreg16(lcd, RA8875_HSAW0, x);
-  ra8875_putreg16(lcd, RA8875_VSAW0, y);
-  ra8875_putreg16(lcd, RA8875_HEAW0, (x+width-1));
-  ra8875_putreg16(lcd, RA8875_VEAW0, (y+height-1));
+  ra8875_setreg16(priv, RA8875_HSAW0, x);
+  ra8875_setreg16(priv, RA8875_VSAW0, y);
+  ra8875_setreg16(priv, RA8875_HEAW0, (x+width-1));
+  ra8875_setreg16(priv, RA8875_VEAW0, (y+height-1));
 #endif
 }
 
@@ -479,11 +747,11 @@ static void ra8875_setwindow(FAR struct ra8875_lcd_s *lcd, uint16_t x, uint16_t
  *
  **************************************************************************************/
 
-static inline void ra8875_setbackground(FAR struct ra8875_lcd_s *lcd, uint16_t color)
+static inline void ra8875_setbackground(FAR struct ra8875_dev_s *priv, uint16_t color)
 {
-  ra8875_putreg(lcd, RA8875_BGCR0, RA8875_UNPACK_RED(color));
-  ra8875_putreg(lcd, RA8875_BGCR1, RA8875_UNPACK_GREEN(color));
-  ra8875_putreg(lcd, RA8875_BGCR2, RA8875_UNPACK_BLUE(color));
+  ra8875_setreg(priv, RA8875_BGCR0, RA8875_UNPACK_RED(color));
+  ra8875_setreg(priv, RA8875_BGCR1, RA8875_UNPACK_GREEN(color));
+  ra8875_setreg(priv, RA8875_BGCR2, RA8875_UNPACK_BLUE(color));
 }
 
 /**************************************************************************************
@@ -494,11 +762,11 @@ static inline void ra8875_setbackground(FAR struct ra8875_lcd_s *lcd, uint16_t c
  *
  **************************************************************************************/
 
-static inline void ra8875_setforeground(FAR struct ra8875_lcd_s *lcd, uint16_t color)
+static inline void ra8875_setforeground(FAR struct ra8875_dev_s *priv, uint16_t color)
 {
-  ra8875_putreg(lcd, RA8875_FGCR0, RA8875_UNPACK_RED(color));
-  ra8875_putreg(lcd, RA8875_FGCR1, RA8875_UNPACK_GREEN(color));
-  ra8875_putreg(lcd, RA8875_FGCR2, RA8875_UNPACK_BLUE(color));
+  ra8875_setreg(priv, RA8875_FGCR0, RA8875_UNPACK_RED(color));
+  ra8875_setreg(priv, RA8875_FGCR1, RA8875_UNPACK_GREEN(color));
+  ra8875_setreg(priv, RA8875_FGCR2, RA8875_UNPACK_BLUE(color));
 }
 
 /**************************************************************************************
@@ -509,17 +777,202 @@ static inline void ra8875_setforeground(FAR struct ra8875_lcd_s *lcd, uint16_t c
  *
  **************************************************************************************/
 
-static void ra8875_clearmem(FAR struct ra8875_lcd_s *lcd)
+static void ra8875_clearmem(FAR struct ra8875_dev_s *priv)
 {
   lcdinfo("clearmem start\n");
-  ra8875_putreg(lcd, RA8875_MCLR, RA8875_MCLR_CLEAR | RA8875_MCLR_FULL);
+  ra8875_putreg(priv, RA8875_MCLR, RA8875_MCLR_CLEAR | RA8875_MCLR_FULL);
 
   /* Wait for operation to finish */
 
-  ra8875_waitreg(lcd, RA8875_MCLR, RA8875_MCLR_CLEAR);
+  ra8875_waitreg(priv->lcd, RA8875_MCLR, RA8875_MCLR_CLEAR);
   lcdinfo("clearmem done\n");
 }
 
+/**************************************************************************************
+ * Name:  ra8875_btemove
+ *
+ * Description:
+ *   Move a rectangle with the Block Transfer Engine, possibly from one layer to the
+ *   other.
+ *
+ **************************************************************************************/
+
+static void ra8875_btemove(FAR struct ra8875_dev_s *priv, uint16_t sx, uint16_t sy,
+                           uint16_t width, uint16_t height, uint16_t dx, uint16_t dy,
+                           uint16_t srclayer, uint16_t dstlayer)
+{
+  uint8_t move_cmd = RA8875_BECR1_OP_MOVE_POS;
+  uint16_t hsx, hsy, hdx, hdy, hw, hh;
+
+  /* Transform to hardware coordinates */
+
+#ifdef CONFIG_LCD_LANDSCAPE
+
+  hsx = sx;
+  hsy = sy;
+  hdx = dx;
+  hdy = dy;
+  hw  = width;
+  hh  = height;
+
+#elif defined(CONFIG_LCD_RLANDSCAPE)
+
+  hsx = RA8875_XRES - sx - width;
+  hsy = RA8875_YRES - sy - height;
+  hdx = RA8875_XRES - dx - width;
+  hdy = RA8875_YRES - dy - height;
+  hw  = width;
+  hh  = height;
+
+#elif defined(CONFIG_LCD_PORTRAIT)
+
+  hsx = RA8875_YRES - sy - height;
+  hsy = sx;
+  hdx = RA8875_YRES - dy - height;
+  hdy = dx;
+  hw  = height;
+  hh  = width;
+
+#else /* CONFIG_LCD_RPORTRAIT */
+
+  hsx = sy;
+  hsy = RA8875_XRES - sx - width;
+  hdx = dy;
+  hdy = RA8875_XRES - dx - width;
+  hw  = height;
+  hh  = width;
+
+#endif
+
+  /* The BTE copies in scan order.  If the destination lies later in that order
+   * than the source, copy backwards from the lower, right-hand corners so that
+   * overlapping source pixels are read before they are overwritten.
+   */
+
+  if (hdy > hsy || (hdy == hsy && hdx > hsx))
+    {
+      move_cmd = RA8875_BECR1_OP_MOVE_NEG;
+
+      hsx += hw - 1;
+      hsy += hh - 1;
+      hdx += hw - 1;
+      hdy += hh - 1;
+    }
+
+  ra8875_setreg16(priv, RA8875_HSBE0, hsx);
+  ra8875_setreg16(priv, RA8875_VSBE0, hsy | RA8875_BTELAYER(srclayer));
+  ra8875_setreg16(priv, RA8875_HDBE0, hdx);
+  ra8875_setreg16(priv, RA8875_VDBE0, hdy | RA8875_BTELAYER(dstlayer));
+  ra8875_setreg16(priv, RA8875_BEWR0, hw);
+  ra8875_setreg16(priv, RA8875_BEHR0, hh);
+
+  /* Run the block move */
+
+  ra8875_setreg(priv, RA8875_BECR1, RA8875_BECR1_ROP_S | move_cmd);
+  ra8875_putreg(priv, RA8875_BECR0, RA8875_BECR0_ENABLE | RA8875_BECR0_SRC_BLOCK |
+                                   RA8875_BECR0_DEST_BLOCK);
+
+  ra8875_waitreg(priv->lcd, RA8875_BECR0, RA8875_BECR0_ENABLE);
+}
+
+#ifdef RA8875_PAGEFLIP
+/**************************************************************************************
+ * Name:  ra8875_lock
+ *
+ * Description:
+ *   Get exclusive access to the controller.  If the hidden layer has not yet been
+ *   brought up to date after a flip, do that first so that nothing is drawn to it
+ *   before the copy.
+ *
+ **************************************************************************************/
+
+static void ra8875_lock(FAR struct ra8875_dev_s *priv)
+{
+  FAR struct ra8875_area_s *sync = &priv->sync;
+
+  while (sem_wait(&priv->exclsem) < 0)
+    {
+      /* The only case that an error should occur here is if the wait was awakened
+       * by a signal.
+       */
+
+      DEBUGASSERT(get_errno() == EINTR);
+    }
+
+  if (priv->syncpending)
+    {
+      ra8875_btemove(priv, sync->x0, sync->y0, sync->x1 - sync->x0 + 1,
+                     sync->y1 - sync->y0 + 1, sync->x0, sync->y0,
+                     priv->current_layer ^ 1, priv->current_layer);
+      priv->syncpending = false;
+    }
+}
+
+/**************************************************************************************
+ * Name:  ra8875_unlock
+ **************************************************************************************/
+
+static void ra8875_unlock(FAR struct ra8875_dev_s *priv)
+{
+  sem_post(&priv->exclsem);
+}
+
+/**************************************************************************************
+ * Name:  ra8875_markdirty
+ *
+ * Description:
+ *   Add an area, given by its inclusive corners, to the area drawn this frame
+ *
+ **************************************************************************************/
+
+static void ra8875_markdirty(FAR struct ra8875_dev_s *priv, int x0, int y0, int x1,
+                             int y1)
+{
+  FAR struct ra8875_area_s *dirty = &priv->dirty;
+
+  x0 = x0 < 0 ? 0 : x0;
+  y0 = y0 < 0 ? 0 : y0;
+  x1 = x1 >= RA8875_XRES ? RA8875_XRES - 1 : x1;
+  y1 = y1 >= RA8875_YRES ? RA8875_YRES - 1 : y1;
+
+  if (x1 < x0 || y1 < y0)
+    {
+      return;
+    }
+
+  if (dirty->x1 < dirty->x0)
+    {
+      dirty->x0 = x0;
+      dirty->y0 = y0;
+      dirty->x1 = x1;
+      dirty->y1 = y1;
+    }
+  else
+    {
+      dirty->x0 = x0 < dirty->x0 ? x0 : dirty->x0;
+      dirty->y0 = y0 < dirty->y0 ? y0 : dirty->y0;
+      dirty->x1 = x1 > dirty->x1 ? x1 : dirty->x1;
+      dirty->y1 = y1 > dirty->y1 ? y1 : dirty->y1;
+    }
+}
+
+/**************************************************************************************
+ * Name:  ra8875_syncworker
+ *
+ * Description:
+ *   Bring the hidden layer up to date after a flip, unless drawing got there first
+ *
+ **************************************************************************************/
+
+static void ra8875_syncworker(FAR void *arg)
+{
+  FAR struct ra8875_dev_s *priv = (FAR struct ra8875_dev_s *)arg;
+
+  ra8875_lock(priv);
+  ra8875_unlock(priv);
+}
+#endif
+
 /**************************************************************************************
  * Name:  ra8875_showrun
  *
@@ -599,6 +1052,7 @@ static int ra8875_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buff
   FAR struct ra8875_lcd_s *lcd = priv->lcd;
   int16_t curhinc = 0;
   int16_t curvinc = 0;
+  bool wrapped;
 
 #if RA8875_BPP == 16
   DEBUGASSERT(buffer && ((uintptr_t)buffer & 1) == 0);
@@ -613,6 +1067,9 @@ static int ra8875_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buff
 
   ra8875_showrun(priv, row, col, npixels, true);
 
+  ra8875_lock(priv);
+  ra8875_markdirty(priv, col, row, col + npixels - 1, row);
+
 #ifdef CONFIG_LCD_LANDSCAPE
 
   /* Set the cursor position */
@@ -623,6 +1080,7 @@ static int ra8875_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buff
 
   curhinc = npixels;
   curvinc = 0;
+  wrapped = (col + npixels >= RA8875_XRES);
 
 #elif defined(CONFIG_LCD_RLANDSCAPE)
 
@@ -638,6 +1096,7 @@ static int ra8875_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buff
 
   curhinc = -npixels;
   curvinc = 0;
+  wrapped = (npixels > col);
 
 #elif defined(CONFIG_LCD_PORTRAIT)
 
@@ -651,6 +1110,7 @@ static int ra8875_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buff
 
   curhinc = 0;
   curvinc = npixels;
+  wrapped = (col + npixels >= RA8875_XRES);
 
 #else /* CONFIG_LCD_RPORTRAIT */
 
@@ -664,31 +1124,58 @@ static int ra8875_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buff
 
   curhinc = 0;
   curvinc = -npixels;
+  wrapped = (npixels > col);
 
 #endif
 
   /* Write data, handle order automatically */
 
+  ra8875_flushregs(priv);
   lcd->pwrite_prepare(lcd, RA8875_MRWC);
 
+#if RA8875_BPP == 8
   for (i = 0; i < npixels; i++)
     {
       /* Write the next pixel to this position */
 
-#if RA8875_BPP == 8
       lcd->pwrite_data8(lcd, *src++);
+    }
 #else
-      lcd->pwrite_data16(lcd, *src++);
-#endif
+  if (lcd->pwrite_run != NULL)
+    {
+      /* Stream the whole run in one transfer */
+
+      lcd->pwrite_run(lcd, src, npixels);
+    }
+  else
+    {
+      for (i = 0; i < npixels; i++)
+        {
+          /* Write the next pixel to this position */
+
+          lcd->pwrite_data16(lcd, *src++);
+        }
     }
+#endif
 
   lcd->pwrite_finish(lcd);
 
-  /* Update shadowed cursor */
+  /* Track the write cursor, which the controller advanced past the run.  At the edge
+   * of the active window it wraps to the next line, so there it is just forgotten.
+   */
 
-  priv->shadow_w_curh += curhinc;
-  priv->shadow_w_curv += curvinc;
+  if (wrapped)
+    {
+      ra8875_invalidatereg16(priv, RA8875_CURH0);
+      ra8875_invalidatereg16(priv, RA8875_CURV0);
+    }
+  else
+    {
+      ra8875_advancereg16(priv, RA8875_CURH0, curhinc);
+      ra8875_advancereg16(priv, RA8875_CURV0, curvinc);
+    }
 
+  ra8875_unlock(priv);
   return OK;
 }
 
@@ -720,16 +1207,17 @@ static int ra8875_getrun(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer,
   ra8875_showrun(priv, row, col, npixels, false);
   DEBUGASSERT(buffer && ((uintptr_t)buffer & 1) == 0);
 
+  ra8875_lock(priv);
 
 #ifdef CONFIG_LCD_LANDSCAPE
   /* Set the cursor position */
 
-  ra8875_putreg(lcd, RA8875_MWCR0, RA8875_MWCR0_MODE_GRAPHICS |
+  ra8875_setreg(priv, RA8875_MWCR0, RA8875_MWCR0_MODE_GRAPHICS |
                                    RA8875_MWCR0_MEMDIR_LEFTRIGHT |
                                    RA8875_MWCR0_RINC_ENABLE);
-  ra8875_putreg(lcd, RA8875_MRDC, RA8875_MRCD_MEMDIR_LEFTRIGHT);
+  ra8875_setreg(priv, RA8875_MRDC, RA8875_MRCD_MEMDIR_LEFTRIGHT);
 
-  ra8875_set_readcursor(lcd, col, row);
+  ra8875_set_readcursor(priv, col, row);
 
 #elif defined(CONFIG_LCD_RLANDSCAPE)
   /* Retransform coordinates, write right to left */
@@ -739,12 +1227,12 @@ static int ra8875_getrun(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer,
 
   /* Set the cursor position */
 
-  ra8875_putreg(lcd, RA8875_MWCR0, RA8875_MWCR0_MODE_GRAPHICS |
+  ra8875_setreg(priv, RA8875_MWCR0, RA8875_MWCR0_MODE_GRAPHICS |
                                    RA8875_MWCR0_MEMDIR_RIGHTLEFT |
                                    RA8875_MWCR0_RINC_ENABLE);
-  ra8875_putreg(lcd, RA8875_MRDC, RA8875_MRCD_MEMDIR_RIGHTLEFT);
+  ra8875_setreg(priv, RA8875_MRDC, RA8875_MRCD_MEMDIR_RIGHTLEFT);
 
-  ra8875_set_readcursor(lcd, col, row);
+  ra8875_set_readcursor(priv, col, row);
 
 #elif defined(CONFIG_LCD_PORTRAIT)
   /* Retransform coordinates, write right to left */
@@ -753,12 +1241,12 @@ static int ra8875_getrun(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer,
 
   /* Set the cursor position */
 
-  ra8875_putreg(lcd, RA8875_MWCR0, RA8875_MWCR0_MODE_GRAPHICS |
+  ra8875_setreg(priv, RA8875_MWCR0, RA8875_MWCR0_MODE_GRAPHICS |
                                    RA8875_MWCR0_MEMDIR_TPDOWN |
                                    RA8875_MWCR0_RINC_ENABLE);
-  ra8875_putreg(lcd, RA8875_MRDC, RA8875_MRCD_MEMDIR_TOPDOWN);
+  ra8875_setreg(priv, RA8875_MRDC, RA8875_MRCD_MEMDIR_TOPDOWN);
 
-  ra8875_set_readcursor(lcd, col, row);
+  ra8875_set_readcursor(priv, col, row);
 
 #else /* CONFIG_LCD_RPORTRAIT */
   /* Retransform coordinates, write right to left */
@@ -767,17 +1255,18 @@ static int ra8875_getrun(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer,
 
   /* Set the cursor position */
 
-  ra8875_putreg(lcd, RA8875_MWCR0, RA8875_MWCR0_MODE_GRAPHICS |
+  ra8875_setreg(priv, RA8875_MWCR0, RA8875_MWCR0_MODE_GRAPHICS |
                                    RA8875_MWCR0_MEMDIR_DOWNTOP |
                                    RA8875_MWCR0_RINC_ENABLE);
-  ra8875_putreg(lcd, RA8875_MRDC, RA8875_MRCD_MEMDIR_DOWNTOP);
+  ra8875_setreg(priv, RA8875_MRDC, RA8875_MRCD_MEMDIR_DOWNTOP);
 
-  ra8875_set_readcursor(lcd, col, row);
+  ra8875_set_readcursor(priv, col, row);
 
 #endif
 
   /* Read data, handle order automatically */
 
+  ra8875_flushregs(priv);
   lcd->pread_prepare(lcd, RA8875_MRWC);
 
   for (i = 0; i < npixels; i++)
@@ -789,12 +1278,52 @@ static int ra8875_getrun(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer,
 
   lcd->pread_finish(lcd);
 
+  /* The read cursor has moved on */
+
+  ra8875_invalidatereg16(priv, RA8875_RCURH0);
+  ra8875_invalidatereg16(priv, RA8875_RCURV0);
+
+  ra8875_unlock(priv);
   return OK;
 #else
   return -ENOSYS;
 #endif
 }
 
+/**************************************************************************************
+ * Name:  ra8875_fillrun
+ *
+ * Description:
+ *   Fill a partial raster line with one color.  The drawing engine does the filling,
+ *   so no pixel data crosses the bus.
+ *
+ **************************************************************************************/
+
+static int ra8875_fillrun(fb_coord_t row, fb_coord_t col, uint32_t color,
+                          size_t npixels)
+{
+  ra8875_drawrectangle(NULL, col, row, npixels, 1, (uint16_t)color, true);
+  return OK;
+}
+
+/**************************************************************************************
+ * Name:  ra8875_putrun1bpp
+ *
+ * Description:
+ *   Write a partial raster line given as one bit per pixel.  The Block Transfer
+ *   Engine color expansion turns the bits into pixels.
+ *
+ **************************************************************************************/
+
+#ifdef CONFIG_LCD_RA8875_COLOREXPAND
+static int ra8875_putrun1bpp(fb_coord_t row, fb_coord_t col, FAR const uint8_t *bits,
+                             uint32_t fg, uint32_t bg, size_t npixels)
+{
+  ra8875_expandbitmap(NULL, col, row, npixels, 1, bits, (uint16_t)fg, (uint16_t)bg);
+  return OK;
+}
+#endif
+
 /**************************************************************************************
  * Name:  ra8875_getvideoinfo
  *
@@ -835,6 +1364,10 @@ static int ra8875_getplaneinfo(FAR struct lcd_dev_s *dev, unsigned int planeno,
 
   pinfo->putrun = ra8875_putrun;                  /* Put a run into LCD memory */
   pinfo->getrun = ra8875_getrun;                  /* Get a run from LCD memory */
+  pinfo->fillrun = ra8875_fillrun;                /* Fill a run in LCD memory */
+#ifdef CONFIG_LCD_RA8875_COLOREXPAND
+  pinfo->putrun1bpp = ra8875_putrun1bpp;          /* Expand a 1bpp run into LCD memory */
+#endif
   pinfo->buffer = (FAR uint8_t *)priv->runbuffer; /* Run scratch buffer */
   pinfo->bpp    = RA8875_BPP;                     /* Bits-per-pixel */
   return OK;
@@ -864,16 +1397,16 @@ static int ra8875_getpower(FAR struct lcd_dev_s *dev)
  *
  **************************************************************************************/
 
-static int ra8875_poweroff(FAR struct ra8875_lcd_s *lcd)
+static int ra8875_poweroff(FAR struct ra8875_dev_s *priv)
 {
   /* Set the backlight off */
 
-  ra8875_putreg(lcd, RA8875_P1CR, RA8875_P1CR_PWM_DISABLE);
-  ra8875_putreg(lcd, RA8875_P1DCR, 0);
+  ra8875_putreg(priv, RA8875_P1CR, RA8875_P1CR_PWM_DISABLE);
+  ra8875_putreg(priv, RA8875_P1DCR, 0);
 
   /* Turn the display off */
 
-  ra8875_putreg(lcd, RA8875_PWRR, RA8875_PWRR_DISPLAY_OFF);
+  ra8875_putreg(priv, RA8875_PWRR, RA8875_PWRR_DISPLAY_OFF);
 
   /* Remember the power off state */
 
@@ -893,28 +1426,29 @@ static int ra8875_poweroff(FAR struct ra8875_lcd_s *lcd)
 static int ra8875_setpower(FAR struct lcd_dev_s *dev, int power)
 {
   FAR struct ra8875_dev_s *priv = (FAR struct ra8875_dev_s *)dev;
-  FAR struct ra8875_lcd_s *lcd  = priv->lcd;
 
   lcdinfo("power: %d\n", power);
   DEBUGASSERT((unsigned)power <= CONFIG_LCD_MAXPOWER);
 
   /* Set new power level */
 
+  ra8875_lock(priv);
+
   if (power > 0)
     {
       if (g_lcddev.power == 0)
         {
           /* Set the backlight level */
 
-          ra8875_putreg(lcd, RA8875_P1CR, RA8875_P1CR_PWM_ENABLE);
-          ra8875_putreg(lcd, RA8875_P1CR, RA8875_P1CR_PWM_ENABLE | RA8875_P1CR_CSDIV(1));
+          ra8875_putreg(priv, RA8875_P1CR, RA8875_P1CR_PWM_ENABLE);
+          ra8875_putreg(priv, RA8875_P1CR, RA8875_P1CR_PWM_ENABLE | RA8875_P1CR_CSDIV(1));
         }
 
-      ra8875_putreg(lcd, RA8875_P1DCR, power);
+      ra8875_putreg(priv, RA8875_P1DCR, power);
 
       /* Turn on display */
 
-      ra8875_putreg(lcd, RA8875_PWRR, RA8875_PWRR_DISPLAY_ON);
+      ra8875_putreg(priv, RA8875_PWRR, RA8875_PWRR_DISPLAY_ON);
 
       g_lcddev.power = power;
     }
@@ -922,9 +1456,10 @@ static int ra8875_setpower(FAR struct lcd_dev_s *dev, int power)
     {
       /* Turn the display off */
 
-      ra8875_poweroff(lcd);
+      ra8875_poweroff(priv);
     }
 
+  ra8875_unlock(priv);
   return OK;
 }
 
@@ -956,6 +1491,30 @@ static int ra8875_setcontrast(FAR struct lcd_dev_s *dev, unsigned int contrast)
   return -ENOSYS;
 }
 
+/**************************************************************************************
+ * Name:  ra8875_ioctl
+ *
+ * Description:
+ *   Driver specific controls, see RA8875IOC_* in include/tinyara/lcd/ra8875.h
+ *
+ **************************************************************************************/
+
+static int ra8875_ioctl(FAR struct lcd_dev_s *dev, int cmd, unsigned long arg)
+{
+  switch (cmd)
+    {
+      case RA8875IOC_FLIP:
+#ifdef CONFIG_LCD_RA8875_PAGEFLIP
+        return ra8875_flip(dev);
+#else
+        return -ENOSYS;
+#endif
+
+      default:
+        return -ENOTTY;
+    }
+}
+
 /**************************************************************************************
  * Name:  ra8875_hwinitialize
  *
@@ -967,25 +1526,29 @@ static int ra8875_setcontrast(FAR struct lcd_dev_s *dev, unsigned int contrast)
 static inline int ra8875_hwinitialize(FAR struct ra8875_dev_s *priv)
 {
   uint8_t rv;
-  FAR struct ra8875_lcd_s *lcd  = priv->lcd;
 
   /* REVISIT: Maybe some of these values needs to be configurable?? */
 
   lcdinfo("hwinitialize\n");
 
+  /* Nothing is known about the register contents yet */
+
+  memset(priv->valid, 0, sizeof(priv->valid));
+  priv->nqueued = 0;
+
   /* Reset */
 
 #if defined(CONFIG_LCD_RA8875_RESET)
-  ra8875_putreg(lcd, RA8875_PWRR, RA8875_PWRR_SWRESET);
+  ra8875_putreg(priv, RA8875_PWRR, RA8875_PWRR_SWRESET);
   up_mdelay(100);
-  ra8875_putreg(lcd, RA8875_PWRR, 0);
+  ra8875_putreg(priv, RA8875_PWRR, 0);
 #endif
 
   /* Setup the PLL config */
 
-  ra8875_putreg(lcd, RA8875_PLLC1, RA8875_PLLC1_PLLDIVN(11));
+  ra8875_putreg(priv, RA8875_PLLC1, RA8875_PLLC1_PLLDIVN(11));
   up_mdelay(10);
-  ra8875_putreg(lcd, RA8875_PLLC2, RA8875_PLLC2_PLLDIVK(2));
+  ra8875_putreg(priv, RA8875_PLLC2, RA8875_PLLC2_PLLDIVK(2));
   up_mdelay(10);
 
   /* Interface and color depth */
@@ -1000,62 +1563,68 @@ static inline int ra8875_hwinitialize(FAR struct ra8875_dev_s *priv)
 #elif defined(CONFIG_LCD_RA8875_16BIT)
   rv |= RA8875_SYSR_MCUIF_16BIT;
 #endif
-  ra8875_putreg(lcd, RA8875_SYSR, rv);
+  ra8875_putreg(priv, RA8875_SYSR, rv);
 
   /* Pixel clock, invert + 4*SYS */
 
-  ra8875_putreg(lcd, RA8875_PCSR, RA8875_PCSR_PCLK_INV | RA8875_PCSR_PERIOD_4SYS);
+  ra8875_putreg(priv, RA8875_PCSR, RA8875_PCSR_PCLK_INV | RA8875_PCSR_PERIOD_4SYS);
   up_mdelay(1);
 
   /* Horizontal Settings */
 
-  ra8875_putreg(lcd, RA8875_HDWR, RA8875_HDWR_WIDTH(RA8875_HW_XRES));
-  ra8875_putreg(lcd, RA8875_HNDFTR, 0x02);
-  ra8875_putreg(lcd, RA8875_HNDR, 0x03);
-  ra8875_putreg(lcd, RA8875_HSTR, 0x01);
-  ra8875_putreg(lcd, RA8875_HPWR, 0x03);
+  ra8875_putreg(priv, RA8875_HDWR, RA8875_HDWR_WIDTH(RA8875_HW_XRES));
+  ra8875_putreg(priv, RA8875_HNDFTR, 0x02);
+  ra8875_putreg(priv, RA8875_HNDR, 0x03);
+  ra8875_putreg(priv, RA8875_HSTR, 0x01);
+  ra8875_putreg(priv, RA8875_HPWR, 0x03);
 
   /* Vertical Settings */
 
-  ra8875_putreg(lcd, RA8875_VDHR0, RA8875_VDHR0_HEIGHT(RA8875_HW_YRES));
-  ra8875_putreg(lcd, RA8875_VDHR1, RA8875_VDHR1_HEIGHT(RA8875_HW_YRES));
-  ra8875_putreg(lcd, RA8875_VNDR0, 0x0f);
-  ra8875_putreg(lcd, RA8875_VNDR1, 0x00);
-  ra8875_putreg(lcd, RA8875_VSTR0, 0x0e);
-  ra8875_putreg(lcd, RA8875_VSTR1, 0x06);
-  ra8875_putreg(lcd, RA8875_VPWR, 0x01);
+  ra8875_putreg(priv, RA8875_VDHR0, RA8875_VDHR0_HEIGHT(RA8875_HW_YRES));
+  ra8875_putreg(priv, RA8875_VDHR1, RA8875_VDHR1_HEIGHT(RA8875_HW_YRES));
+  ra8875_putreg(priv, RA8875_VNDR0, 0x0f);
+  ra8875_putreg(priv, RA8875_VNDR1, 0x00);
+  ra8875_putreg(priv, RA8875_VSTR0, 0x0e);
+  ra8875_putreg(priv, RA8875_VSTR1, 0x06);
+  ra8875_putreg(priv, RA8875_VPWR, 0x01);
 
 #if !defined(RA8875_2LAYER_POSSIBLE)
   /* Too high, only one layer possible */
 
-  ra8875_putreg(lcd, RA8875_DPCR, RA8875_DPCR_LAYERS_ONE);
+  ra8875_putreg(priv, RA8875_DPCR, RA8875_DPCR_LAYERS_ONE);
 #else
   /* Two layers */
 
-  ra8875_putreg(lcd, RA8875_DPCR, RA8875_DPCR_LAYERS_TWO);
+  ra8875_putreg(priv, RA8875_DPCR, RA8875_DPCR_LAYERS_TWO);
+#endif
+
+#ifdef RA8875_PAGEFLIP
+  /* Show layer 1 and draw to layer 2 */
+
+  priv->current_layer = 1;
+  priv->syncpending   = false;
+  priv->dirty.x0      = 1;
+  priv->dirty.x1      = 0;
+
+  ra8875_putreg(priv, RA8875_LTPR0, RA8875_LTPR0_MODE_L1);
+  ra8875_putreg(priv, RA8875_MWCR1, RA8875_MWCR1_LAYER_2);
 #endif
 
   /* Setup window to be full screen */
 
-  ra8875_setwindow(lcd, 0, 0, RA8875_XRES, RA8875_YRES);
+  ra8875_setwindow(priv, 0, 0, RA8875_XRES, RA8875_YRES);
 
   /* Set background and foreground colors to black and white (respectively) */
 
-  ra8875_setbackground(lcd, 0x0000);
-  ra8875_setforeground(lcd, 0xffff);
+  ra8875_setbackground(priv, 0x0000);
+  ra8875_setforeground(priv, 0xffff);
 
   /* Clear the memory */
 
-  ra8875_clearmem(lcd);
+  ra8875_clearmem(priv);
 
   ra8875_setpower(&priv->dev, 0x0);
 
-  /* Initialize the shadow registers */
-
-  priv->shadow_mwcr0 = 0;
-  priv->shadow_w_curh = 0;
-  priv->shadow_w_curv = 0;
-
   lcdinfo("hwinitialize done\n");
   return OK;
 }
@@ -1095,8 +1664,13 @@ FAR struct lcd_dev_s *ra8875_lcdinitialize(FAR struct ra8875_lcd_s *lcd)
   priv->dev.setpower     = ra8875_setpower;
   priv->dev.getcontrast  = ra8875_getcontrast;
   priv->dev.setcontrast  = ra8875_setcontrast;
+  priv->dev.ioctl        = ra8875_ioctl;
   priv->lcd              = lcd;
 
+#ifdef RA8875_PAGEFLIP
+  sem_init(&priv->exclsem, 0, 1);
+#endif
+
   /* Configure and enable LCD */
 
   ret = ra8875_hwinitialize(priv);
@@ -1108,7 +1682,7 @@ FAR struct lcd_dev_s *ra8875_lcdinitialize(FAR struct ra8875_lcd_s *lcd)
 
       /* Turn the display off */
 
-      ra8875_poweroff(lcd);
+      ra8875_poweroff(priv);
 
       lcdinfo("Initialized\n");
 
@@ -1140,17 +1714,17 @@ void ra8875_clear(FAR struct lcd_dev_s *dev, uint16_t color)
 
   /* Set the color to use for filling */
 
-  ra8875_setforeground(lcd, color);
+  ra8875_setforeground(priv, color);
 
   /* Draw a rectangle over entire screen */
 
-  ra8875_putreg16(lcd, RA8875_DLHSR0, 0);
-  ra8875_putreg16(lcd, RA8875_DLVSR0, 0);
-  ra8875_putreg16(lcd, RA8875_DLHER0, RA8875_XRES);
-  ra8875_putreg16(lcd, RA8875_DLVER0, RA8875_YRES);
+  ra8875_setreg16(priv, RA8875_DLHSR0, 0);
+  ra8875_setreg16(priv, RA8875_DLVSR0, 0);
+  ra8875_setreg16(priv, RA8875_DLHER0, RA8875_XRES);
+  ra8875_setreg16(priv, RA8875_DLVER0, RA8875_YRES);
 
-  ra8875_putreg(lcd, RA8875_DCR, RA8875_DCR_FILL | RA8875_DCR_SQUARE);
-  ra8875_putreg(lcd, RA8875_DCR, RA8875_DCR_FILL | RA8875_DCR_SQUARE |
+  ra8875_putreg(priv, RA8875_DCR, RA8875_DCR_FILL | RA8875_DCR_SQUARE);
+  ra8875_putreg(priv, RA8875_DCR, RA8875_DCR_FILL | RA8875_DCR_SQUARE |
                                  RA8875_DCR_LINE_START);
 
   ra8875_waitreg(lcd, RA8875_DCR, RA8875_DCR_LINE_START);
@@ -1181,21 +1755,26 @@ void ra8875_drawrectangle(FAR struct lcd_dev_s *dev, uint16_t x, uint16_t y,
   uint8_t draw_cmd = RA8875_DCR_SQUARE;
   uint16_t sx, sy, ex, ey;
 
-  /* Set the color to use for filling */
-
-  ra8875_setforeground(lcd, color);
-
   /* Handle degenerate cases */
 
   if (width == 1)
     {
-      ra8875_drawline(dev, x, y, x, y+height, color);
+      ra8875_drawline(dev, x, y, x, y + height - 1, color);
+      return;
     }
   else if (height == 1)
     {
-      ra8875_drawline(dev, x, y, x+width, y, color);
+      ra8875_drawline(dev, x, y, x + width - 1, y, color);
+      return;
     }
 
+  ra8875_lock(priv);
+  ra8875_markdirty(priv, x, y, x + width - 1, y + height - 1);
+
+  /* Set the color to use for filling */
+
+  ra8875_setforeground(priv, color);
+
   if (fill)
     {
       draw_cmd |= RA8875_DCR_FILL;
@@ -1233,17 +1812,18 @@ void ra8875_drawrectangle(FAR struct lcd_dev_s *dev, uint16_t x, uint16_t y,
 
 #endif
 
-  ra8875_putreg16(lcd, RA8875_DLHSR0, sx);
-  ra8875_putreg16(lcd, RA8875_DLVSR0, sy);
-  ra8875_putreg16(lcd, RA8875_DLHER0, ex);
-  ra8875_putreg16(lcd, RA8875_DLVER0, ey);
+  ra8875_setreg16(priv, RA8875_DLHSR0, sx);
+  ra8875_setreg16(priv, RA8875_DLVSR0, sy);
+  ra8875_setreg16(priv, RA8875_DLHER0, ex);
+  ra8875_setreg16(priv, RA8875_DLVER0, ey);
 
   /* Run drawing */
 
-  ra8875_putreg(lcd, RA8875_DCR, draw_cmd);
-  ra8875_putreg(lcd, RA8875_DCR, draw_cmd | RA8875_DCR_LINE_START);
+  ra8875_putreg(priv, RA8875_DCR, draw_cmd);
+  ra8875_putreg(priv, RA8875_DCR, draw_cmd | RA8875_DCR_LINE_START);
 
   ra8875_waitreg(lcd, RA8875_DCR, RA8875_DCR_LINE_START);
+  ra8875_unlock(priv);
 }
 
 /**************************************************************************************
@@ -1267,9 +1847,12 @@ void ra8875_drawline(FAR struct lcd_dev_s *dev, uint16_t x1, uint16_t y1, uint16
   uint8_t draw_cmd = RA8875_DCR_LINE;
   uint16_t sx, sy, ex, ey;
 
+  ra8875_lock(priv);
+  ra8875_markdirty(priv, MIN(x1, x2), MIN(y1, y2), MAX(x1, x2), MAX(y1, y2));
+
   /* Set the color to use for filling */
 
-  ra8875_setforeground(lcd, color);
+  ra8875_setforeground(priv, color);
 
   /* Handle degenerate cases */
   /* Setup coordinates */
@@ -1290,18 +1873,204 @@ void ra8875_drawline(FAR struct lcd_dev_s *dev, uint16_t x1, uint16_t y1, uint16
 
 #endif
 
-  ra8875_putreg16(lcd, RA8875_DLHSR0, sx);
-  ra8875_putreg16(lcd, RA8875_DLVSR0, sy);
-  ra8875_putreg16(lcd, RA8875_DLHER0, ex);
-  ra8875_putreg16(lcd, RA8875_DLVER0, ey);
+  ra8875_setreg16(priv, RA8875_DLHSR0, sx);
+  ra8875_setreg16(priv, RA8875_DLVSR0, sy);
+  ra8875_setreg16(priv, RA8875_DLHER0, ex);
+  ra8875_setreg16(priv, RA8875_DLVER0, ey);
 
   /* Run drawing */
 
-  ra8875_putreg(lcd, RA8875_DCR, draw_cmd);
-  ra8875_putreg(lcd, RA8875_DCR, draw_cmd | RA8875_DCR_LINE_START);
+  ra8875_putreg(priv, RA8875_DCR, draw_cmd);
+  ra8875_putreg(priv, RA8875_DCR, draw_cmd | RA8875_DCR_LINE_START);
 
   ra8875_waitreg(lcd, RA8875_DCR, RA8875_DCR_LINE_START);
+  ra8875_unlock(priv);
+}
+
+/**************************************************************************************
+ * Name:  ra8875_moverectangle
+ *
+ * Description:
+ *   This is a non-standard function to move a rectangular region of display memory
+ *   with the Block Transfer Engine, so that no pixel data crosses the bus.  The
+ *   source is the width x height rectangle at (sx, sy); (dx, dy) is the new position
+ *   of its upper, left-hand corner.  Overlapping regions are handled.
+ *
+ *   NOTE: This non-standard function is not available to applications in the
+ *   protected or kernel build modes.
+ *
+ **************************************************************************************/
+
+void ra8875_moverectangle(FAR struct lcd_dev_s *dev, uint16_t sx, uint16_t sy,
+                          uint16_t width, uint16_t height, uint16_t dx, uint16_t dy)
+{
+  FAR struct ra8875_dev_s *priv = RA8875_DEV(dev);
+
+  ra8875_lock(priv);
+  ra8875_btemove(priv, sx, sy, width, height, dx, dy, RA8875_DRAWLAYER(priv),
+                 RA8875_DRAWLAYER(priv));
+  ra8875_markdirty(priv, dx, dy, dx + width - 1, dy + height - 1);
+  ra8875_unlock(priv);
+}
+
+/**************************************************************************************
+ * Name:  ra8875_expandbitmap
+ *
+ * Description:
+ *   This is a non-standard function to draw a 1bpp bitmap with the Block Transfer
+ *   Engine color expansion.  Set bits are drawn in the foreground color, clear bits in
+ *   the background color.  Each bitmap row starts on a byte boundary and is packed
+ *   most significant bit first, so only one bit per pixel crosses the bus.
+ *
+ *   NOTE: This non-standard function is not available to applications in the
+ *   protected or kernel build modes.
+ *
+ **************************************************************************************/
+
+#ifdef CONFIG_LCD_RA8875_COLOREXPAND
+void ra8875_expandbitmap(FAR struct lcd_dev_s *dev, uint16_t x, uint16_t y,
+                         uint16_t width, uint16_t height, FAR const uint8_t *bits,
+                         uint16_t fg, uint16_t bg)
+{
+  FAR struct ra8875_dev_s *priv = RA8875_DEV(dev);
+  FAR struct ra8875_lcd_s *lcd  = priv->lcd;
+  size_t nbytes = ((width + 7) >> 3) * height;
+  size_t i;
+
+  ra8875_lock(priv);
+  ra8875_markdirty(priv, x, y, x + width - 1, y + height - 1);
+
+  /* Set the colors to expand the bits to */
+
+  ra8875_setforeground(priv, fg);
+  ra8875_setbackground(priv, bg);
+
+  /* Setup destination and size.  The bitmap rows follow the display rows, which is
+   * why only the landscape orientation is supported.
+   */
+
+  ra8875_setreg16(priv, RA8875_HDBE0, x);
+  ra8875_setreg16(priv, RA8875_VDBE0, y | RA8875_BTELAYER(RA8875_DRAWLAYER(priv)));
+  ra8875_setreg16(priv, RA8875_BEWR0, width);
+  ra8875_setreg16(priv, RA8875_BEHR0, height);
+
+  /* Start the color expansion, then feed it the bitmap */
+
+  ra8875_setreg(priv, RA8875_BECR1, RA8875_BECR1_EXPAND_MSB | RA8875_BECR1_OP_EXPAND);
+  ra8875_putreg(priv, RA8875_BECR0, RA8875_BECR0_ENABLE);
+
+  lcd->pwrite_prepare(lcd, RA8875_MRWC);
+
+  if (lcd->pwrite_block != NULL)
+    {
+      lcd->pwrite_block(lcd, bits, nbytes);
+    }
+  else
+    {
+      for (i = 0; i < nbytes; i++)
+        {
+          lcd->pwrite_data8(lcd, *bits++);
+        }
+    }
+
+  lcd->pwrite_finish(lcd);
+
+  ra8875_waitreg(lcd, RA8875_BECR0, RA8875_BECR0_ENABLE);
+
+  /* The memory write cursor is not defined after a BTE write */
+
+  ra8875_invalidatereg16(priv, RA8875_CURH0);
+  ra8875_invalidatereg16(priv, RA8875_CURV0);
+  ra8875_unlock(priv);
+}
+#endif
+
+/**************************************************************************************
+ * Name:  ra8875_flip
+ *
+ * Description:
+ *   Show the layer that has been drawn to and continue drawing to the other one.  The
+ *   area drawn during the frame is copied to the new hidden layer by the Block
+ *   Transfer Engine, on the low priority work queue, so the caller does not wait for
+ *   it.  Drawing that arrives before the copy has run does the copy first.  Drawing
+ *   itself still sends its pixels over SPI on the drawing thread.
+ *
+ **************************************************************************************/
+
+#ifdef CONFIG_LCD_RA8875_PAGEFLIP
+int ra8875_flip(FAR struct lcd_dev_s *dev)
+{
+#ifdef RA8875_PAGEFLIP
+  FAR struct ra8875_dev_s *priv = RA8875_DEV(dev);
+  int ret = OK;
+
+  ra8875_lock(priv);
+
+  /* Show the layer that was drawn to, then draw to the other one */
+
+  ra8875_putreg(priv, RA8875_LTPR0, priv->current_layer ? RA8875_LTPR0_MODE_L2 :
+                                                          RA8875_LTPR0_MODE_L1);
+  priv->current_layer ^= 1;
+  ra8875_putreg(priv, RA8875_MWCR1, priv->current_layer ? RA8875_MWCR1_LAYER_2 :
+                                                          RA8875_MWCR1_LAYER_1);
+
+  /* The new hidden layer still lacks what was drawn during the frame */
+
+  if (priv->dirty.x0 <= priv->dirty.x1)
+    {
+      priv->sync        = priv->dirty;
+      priv->syncpending = true;
+      priv->dirty.x0    = 1;
+      priv->dirty.x1    = 0;
+
+      if (work_available(&priv->syncwork))
+        {
+          ret = work_queue(LPWORK, &priv->syncwork, ra8875_syncworker, priv, 0);
+        }
+    }
+
+  ra8875_unlock(priv);
+  return ret;
+#else
+  return -ENOSYS;
+#endif
+}
+#endif
+
+/**************************************************************************************
+ * Name:  ra8875_getregstat
+ *
+ * Description:
+ *   Return the write statistics of the index'th shadowed register, or -ENOENT if
+ *   there are not that many shadowed registers.  Used by the procfs interface.
+ *
+ **************************************************************************************/
+
+#ifdef CONFIG_LCD_RA8875_REGSTATS
+int ra8875_getregstat(int index, FAR struct ra8875_regstat_s *stat)
+{
+  FAR struct ra8875_dev_s *priv = &g_lcddev;
+  int offset = index;
+  int i;
+
+  if (index < 0 || index >= RA8875_NSHADOW)
+    {
+      return -ENOENT;
+    }
+
+  /* Find the register address of the shadow slot */
+
+  for (i = 0; offset > g_shadowranges[i][1] - g_shadowranges[i][0]; i++)
+    {
+      offset -= g_shadowranges[i][1] - g_shadowranges[i][0] + 1;
+    }
+
+  stat->regaddr = g_shadowranges[i][0] + offset;
+  stat->hits    = priv->hits[index];
+  stat->misses  = priv->misses[index];
+  return OK;
 }
+#endif
 
 /**************************************************************************************
  * Name:  ra8875_drawtriangle
@@ -1326,9 +2095,13 @@ void ra8875_drawtriangle(FAR struct lcd_dev_s *dev, uint16_t x0, uint16_t y0, ui
   uint16_t _x0, _x1, _x2;
   uint16_t _y0, _y1, _y2;
 
+  ra8875_lock(priv);
+  ra8875_markdirty(priv, MIN(x0, MIN(x1, x2)), MIN(y0, MIN(y1, y2)),
+                   MAX(x0, MAX(x1, x2)), MAX(y0, MAX(y1, y2)));
+
   /* Set the color to use for filling */
 
-  ra8875_setforeground(lcd, color);
+  ra8875_setforeground(priv, color);
 
   if (fill)
     {
@@ -1359,19 +2132,20 @@ void ra8875_drawtriangle(FAR struct lcd_dev_s *dev, uint16_t x0, uint16_t y0, ui
 
 #endif
 
-  ra8875_putreg16(lcd, RA8875_DLHSR0, _x0);
-  ra8875_putreg16(lcd, RA8875_DLVSR0, _y0);
-  ra8875_putreg16(lcd, RA8875_DLHER0, _x1);
-  ra8875_putreg16(lcd, RA8875_DLVER0, _y1);
-  ra8875_putreg16(lcd, RA8875_DTPH0, _x2);
-  ra8875_putreg16(lcd, RA8875_DTPV0, _y2);
+  ra8875_setreg16(priv, RA8875_DLHSR0, _x0);
+  ra8875_setreg16(priv, RA8875_DLVSR0, _y0);
+  ra8875_setreg16(priv, RA8875_DLHER0, _x1);
+  ra8875_setreg16(priv, RA8875_DLVER0, _y1);
+  ra8875_setreg16(priv, RA8875_DTPH0, _x2);
+  ra8875_setreg16(priv, RA8875_DTPV0, _y2);
 
   /* Run drawing */
 
-  ra8875_putreg(lcd, RA8875_DCR, draw_cmd);
-  ra8875_putreg(lcd, RA8875_DCR, draw_cmd | RA8875_DCR_LINE_START);
+  ra8875_putreg(priv, RA8875_DCR, draw_cmd);
+  ra8875_putreg(priv, RA8875_DCR, draw_cmd | RA8875_DCR_LINE_START);
 
   ra8875_waitreg(lcd, RA8875_DCR, RA8875_DCR_LINE_START);
+  ra8875_unlock(priv);
 }
 #endif
 
@@ -1397,9 +2171,12 @@ void ra8875_drawcircle(FAR struct lcd_dev_s *dev, uint16_t x, uint16_t y, uint8_
   uint8_t draw_cmd = 0;
   uint16_t _x, _y;
 
+  ra8875_lock(priv);
+  ra8875_markdirty(priv, x - radius, y - radius, x + radius, y + radius);
+
   /* Set the color to use for filling */
 
-  ra8875_setforeground(lcd, color);
+  ra8875_setforeground(priv, color);
 
   if (fill)
     {
@@ -1420,16 +2197,17 @@ void ra8875_drawcircle(FAR struct lcd_dev_s *dev, uint16_t x, uint16_t y, uint8_
 
 #endif
 
-  ra8875_putreg16(lcd, RA8875_DCHR0, _x);
-  ra8875_putreg16(lcd, RA8875_DCVR0, _y);
-  ra8875_putreg(lcd, RA8875_DCRR, radius);
+  ra8875_setreg16(priv, RA8875_DCHR0, _x);
+  ra8875_setreg16(priv, RA8875_DCVR0, _y);
+  ra8875_setreg(priv, RA8875_DCRR, radius);
 
     /* Run drawing */
 
-  ra8875_putreg(lcd, RA8875_DCR, draw_cmd);
-  ra8875_putreg(lcd, RA8875_DCR, draw_cmd | RA8875_DCR_CIRCLE_START);
+  ra8875_putreg(priv, RA8875_DCR, draw_cmd);
+  ra8875_putreg(priv, RA8875_DCR, draw_cmd | RA8875_DCR_CIRCLE_START);
 
   ra8875_waitreg(lcd, RA8875_DCR, RA8875_DCR_CIRCLE_START);
+  ra8875_unlock(priv);
 }
 #endif
 
@@ -108,7 +108,22 @@
 
 /* BTE Control Registers */
 
-#define RA8875_LTPR0      0x50  /* Layer Transparency Register 0 */
+#define RA8875_BECR0      0x50  /* BTE Function Control Register 0 */
+#define RA8875_BECR1      0x51  /* BTE Function Control Register 1 */
+#define RA8875_LTPR0      0x52  /* Layer Transparency Register 0 */
+#define RA8875_LTPR1      0x53  /* Layer Transparency Register 1 */
+#define RA8875_HSBE0      0x54  /* Horizontal Source Point 0 of BTE */
+#define RA8875_HSBE1      0x55  /* Horizontal Source Point 1 of BTE */
+#define RA8875_VSBE0      0x56  /* Vertical Source Point 0 of BTE */
+#define RA8875_VSBE1      0x57  /* Vertical Source Point 1 of BTE */
+#define RA8875_HDBE0      0x58  /* Horizontal Destination Point 0 of BTE */
+#define RA8875_HDBE1      0x59  /* Horizontal Destination Point 1 of BTE */
+#define RA8875_VDBE0      0x5A  /* Vertical Destination Point 0 of BTE */
+#define RA8875_VDBE1      0x5B  /* Vertical Destination Point 1 of BTE */
+#define RA8875_BEWR0      0x5C  /* BTE Width Register 0 */
+#define RA8875_BEWR1      0x5D  /* BTE Width Register 1 */
+#define RA8875_BEHR0      0x5E  /* BTE Height Register 0 */
+#define RA8875_BEHR1      0x5F  /* BTE Height Register 1 */
 #define RA8875_BGCR0      0x60  /* Background Color Register 0 */
 #define RA8875_BGCR1      0x61  /* Background Color Register 1 */
 #define RA8875_BGCR2      0x62  /* Background Color Register 2 */
@@ -230,6 +245,34 @@
 #  define RA8875_MRCD_MEMDIR_TOPDOWN    (2<<RA8875_MWCR0_MEMDIR_SHIFT)
 #  define RA8875_MRCD_MEMDIR_DOWNTOP    (3<<RA8875_MWCR0_MEMDIR_SHIFT)
 
+/* BTE Function Control Register 0 */
+
+#define RA8875_BECR0_ENABLE             (1<<7)  /* Write: start, read: busy */
+#define RA8875_BECR0_SRC_BLOCK          (0)
+#define RA8875_BECR0_SRC_LINEAR         (1<<6)
+#define RA8875_BECR0_DEST_BLOCK         (0)
+#define RA8875_BECR0_DEST_LINEAR        (1<<5)
+
+/* BTE Function Control Register 1 */
+
+#define RA8875_BECR1_ROP_SHIFT          (4)
+#define RA8875_BECR1_ROP_MASK           (0xf<<RA8875_BECR1_ROP_SHIFT)
+#  define RA8875_BECR1_ROP(r)           ((r)<<RA8875_BECR1_ROP_SHIFT)
+#  define RA8875_BECR1_ROP_S            RA8875_BECR1_ROP(0xc)
+#define RA8875_BECR1_OP_MASK            (0xf)
+#  define RA8875_BECR1_OP_MOVE_POS      (0x2)
+#  define RA8875_BECR1_OP_MOVE_NEG      (0x3)
+#  define RA8875_BECR1_OP_EXPAND        (0x8)
+
+/* For color expansion, the ROP field holds the first bit of each MCU data byte */
+
+#define RA8875_BECR1_EXPAND_MSB         RA8875_BECR1_ROP(7)
+
+/* Vertical Source/Destination Point 1 of BTE */
+
+#define RA8875_VBE1_LAYER_1             (0)
+#define RA8875_VBE1_LAYER_2             (1<<7)
+
 /* Layer Transparency Register 0 */
 
 #define RA8875_LTPR0_MODE_MASK          (7)
@@ -272,5 +315,35 @@
 #define RA8875_DCR_SQUARE               (1<<4)
 #define RA8875_DCR_TRIANGLE             (1<<0)
 
+/**************************************************************************************
+ * Public Types
+ **************************************************************************************/
+
+#ifdef CONFIG_LCD_RA8875_REGSTATS
+/* Write statistics of one shadowed register */
+
+struct ra8875_regstat_s
+{
+  uint8_t  regaddr;   /* Register address */
+  uint32_t hits;      /* Writes dropped because the register already held the value */
+  uint32_t misses;    /* Writes sent to the controller */
+};
+
+/**************************************************************************************
+ * Public Function Prototypes
+ **************************************************************************************/
+
+/**************************************************************************************
+ * Name:  ra8875_getregstat
+ *
+ * Description:
+ *   Return the write statistics of the index'th shadowed register, or -ENOENT if
+ *   there are not that many shadowed registers.  Used by the procfs interface.
+ *
+ **************************************************************************************/
+
+int ra8875_getregstat(int index, FAR struct ra8875_regstat_s *stat);
+#endif
+
 #endif /* CONFIG_LCD_RA8875 */
 #endif /* __DRIVERS_LCD_RA8875_H */
@@ -0,0 +1,264 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * drivers/lcd/ra8875_procfs.c
+ *
+ * Shows how often each shadowed RA8875 register write was dropped (hit)
+ * or sent to the controller (miss).
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/kmalloc.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/procfs.h>
+
+#include "ra8875.h"
+
+#if defined(CONFIG_LCD_RA8875_REGSTATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_RA8875)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+/* This structure describes one open "file" */
+
+struct ra8875_file_s {
+	struct procfs_file_s base;	/* Base open file structure */
+	int nextreg;				/* Index of the next register to show */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+/* File system methods */
+
+static int ra8875_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode);
+static int ra8875_close(FAR struct file *filep);
+static ssize_t ra8875_read(FAR struct file *filep, FAR char *buffer, size_t buflen);
+
+static int ra8875_dup(FAR const struct file *oldp, FAR struct file *newp);
+
+static int ra8875_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_procfs.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations ra8875_procfsoperations = {
+	ra8875_open,				/* open */
+	ra8875_close,				/* close */
+	ra8875_read,				/* read */
+	NULL,						/* write */
+
+	ra8875_dup,					/* dup */
+
+	NULL,						/* opendir */
+	NULL,						/* closedir */
+	NULL,						/* readdir */
+	NULL,						/* rewinddir */
+
+	ra8875_stat					/* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ra8875_open
+ ****************************************************************************/
+
+static int ra8875_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode)
+{
+	FAR struct ra8875_file_s *attr;
+
+	fvdbg("Open '%s'\n", relpath);
+
+	/* PROCFS is read-only.  Any attempt to open with any kind of write
+	 * access is not permitted.
+	 */
+
+	if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0) {
+		fdbg("ERROR: Only O_RDONLY supported\n");
+		return -EACCES;
+	}
+
+	/* Allocate a context structure */
+
+	attr = (FAR struct ra8875_file_s *)kmm_zalloc(sizeof(struct ra8875_file_s));
+	if (!attr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* Save the context as the open-specific state in filep->f_priv */
+
+	filep->f_priv = (FAR void *)attr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: ra8875_close
+ ****************************************************************************/
+
+static int ra8875_close(FAR struct file *filep)
+{
+	FAR struct ra8875_file_s *attr;
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct ra8875_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Release the file attributes structure */
+
+	kmm_free(attr);
+	filep->f_priv = NULL;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: ra8875_read
+ ****************************************************************************/
+
+static ssize_t ra8875_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
+{
+	FAR struct ra8875_file_s *priv;
+	struct ra8875_regstat_s stat;
+	ssize_t total = 0;
+	ssize_t ret;
+
+	fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+	/* Recover our private data from the struct file instance */
+
+	priv = (FAR struct ra8875_file_s *)filep->f_priv;
+	DEBUGASSERT(priv);
+
+	/* Output a header before the first entry */
+
+	if (priv->nextreg == 0) {
+		total = snprintf(buffer, buflen, "Reg   %10s %10s\n", "Hits", "Misses");
+		if (total >= buflen) {
+			return 0;
+		}
+	}
+
+	/* Then one line per shadowed register, for as many as fit */
+
+	while (ra8875_getregstat(priv->nextreg, &stat) == OK) {
+		ret = snprintf(&buffer[total], buflen - total, "0x%02x  %10lu %10lu\n", stat.regaddr, (unsigned long)stat.hits, (unsigned long)stat.misses);
+
+		if (ret + total < buflen) {
+			total += ret;
+			priv->nextreg++;
+		} else {
+			buffer[total] = '\0';
+			break;
+		}
+	}
+
+	/* Update the file offset */
+
+	if (total > 0) {
+		filep->f_pos += total;
+	}
+
+	return total;
+}
+
+/****************************************************************************
+ * Name: ra8875_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int ra8875_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+	FAR struct ra8875_file_s *oldattr;
+	FAR struct ra8875_file_s *newattr;
+
+	fvdbg("Dup %p->%p\n", oldp, newp);
+
+	/* Recover our private data from the old struct file instance */
+
+	oldattr = (FAR struct ra8875_file_s *)oldp->f_priv;
+	DEBUGASSERT(oldattr);
+
+	/* Allocate a new container to hold the task and attribute selection */
+
+	newattr = (FAR struct ra8875_file_s *)kmm_zalloc(sizeof(struct ra8875_file_s));
+	if (!newattr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* The copy the file attributes from the old attributes to the new */
+
+	memcpy(newattr, oldattr, sizeof(struct ra8875_file_s));
+
+	/* Save the new attributes in the new file structure */
+
+	newp->f_priv = (FAR void *)newattr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: ra8875_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int ra8875_stat(const char *relpath, struct stat *buf)
+{
+	/* File/directory size, access block size */
+
+	buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+	buf->st_size = 0;
+	buf->st_blksize = 0;
+	buf->st_blocks = 0;
+	return OK;
+}
+
+#endif /* CONFIG_LCD_RA8875_REGSTATS && !CONFIG_FS_PROCFS_EXCLUDE_RA8875 */
@@ -32,11 +32,14 @@ static FAR struct spi_dev_s *init_ra8875_spi(void);
 
 static void spi_write_reg(FAR struct ra8875_lcd_s *dev, uint8_t regnum, uint8_t data);
 static void spi_write_reg16(FAR struct ra8875_lcd_s *dev, uint8_t regnum, uint16_t data);
+static void spi_write_regs(FAR struct ra8875_lcd_s *dev, FAR const uint8_t *regs, size_t nregs);
 static uint8_t spi_read_reg(FAR struct ra8875_lcd_s *dev, uint8_t regnum);
 static uint8_t spi_read_status(FAR struct ra8875_lcd_s *dev);
 static void spi_pwrite_prepare(FAR struct ra8875_lcd_s *dev, uint8_t regnum);
 static void spi_pwrite_data8(FAR struct ra8875_lcd_s *dev, uint8_t data);
 static void spi_pwrite_data16(FAR struct ra8875_lcd_s *dev, uint16_t data);
+static void spi_pwrite_run(FAR struct ra8875_lcd_s *dev, FAR const void *pixels, size_t npixels);
+static void spi_pwrite_block(FAR struct ra8875_lcd_s *dev, FAR const uint8_t *data, size_t nbytes);
 static void spi_pwrite_finish(FAR struct ra8875_lcd_s *dev);
 static void spi_pread_prepare(FAR struct ra8875_lcd_s *dev, uint8_t regnum);
 static uint16_t spi_pread_data16(FAR struct ra8875_lcd_s *dev);
@@ -52,6 +55,14 @@ static uint8_t ra8875_spi_status_read(void);
 #define SPI_WRITERUN_SPEED 20000000
 #define SPI_READ_SPEED     6000000
 
+/* Staging buffer for pixel runs, kept to an even number of bytes */
+
+#ifndef CONFIG_LCD_RA8875_SPI_RUNBUFSIZE
+#define CONFIG_LCD_RA8875_SPI_RUNBUFSIZE 1024
+#endif
+
+#define RUNBUFSIZE (CONFIG_LCD_RA8875_SPI_RUNBUFSIZE & ~1)
+
 #define CYCLE_START() do { SPI_SELECT(spi_device, 0, TRUE); } while (0)
 #define CYCLE_END() do { SPI_SELECT(spi_device, 0, FALSE); } while (0)
 
@@ -63,11 +74,14 @@ static uint8_t ra8875_spi_status_read(void);
 static struct ra8875_lcd_s ra8875_spi = {
     .write_reg = spi_write_reg,
     .write_reg16 = spi_write_reg16,
+    .write_regs = spi_write_regs,
     .read_reg = spi_read_reg,
     .read_status = spi_read_status,
     .pwrite_prepare = spi_pwrite_prepare,
     .pwrite_data8 = spi_pwrite_data8,
     .pwrite_data16 = spi_pwrite_data16,
+    .pwrite_run = spi_pwrite_run,
+    .pwrite_block = spi_pwrite_block,
     .pwrite_finish = spi_pwrite_finish,
     .pread_prepare = spi_pread_prepare,
     .pread_data16 = spi_pread_data16,
@@ -76,6 +90,7 @@ static struct ra8875_lcd_s ra8875_spi = {
 
 FAR static struct spi_dev_s *spi_device;
 FAR static struct lcd_dev_s *lcd_device;
+static uint8_t run_buffer[RUNBUFSIZE];
 
 int board_lcd_initialize(void) {
     spi_device = init_ra8875_spi();
@@ -127,6 +142,17 @@ static void spi_write_reg16(FAR struct ra8875_lcd_s *dev, uint8_t regnum, uint16
     ra8875_spi_data_write(data >> 8);
 }
 
+static void spi_write_regs(FAR struct ra8875_lcd_s *dev, FAR const uint8_t *regs, size_t nregs) {
+    /* The bus needs a separate chip select cycle for each command and data byte, so
+     * a burst is just the sequence of writes without going back through the driver.
+     */
+
+    for (; nregs > 0; nregs--, regs += 2) {
+        ra8875_spi_command_write(regs[0]);
+        ra8875_spi_data_write(regs[1]);
+    }
+}
+
 static uint8_t spi_read_reg(FAR struct ra8875_lcd_s *dev, uint8_t regnum) {
 	SPI_SETFREQUENCY(spi_device, SPI_READ_SPEED);
     ra8875_spi_command_write(regnum);
@@ -156,6 +182,27 @@ static void spi_pwrite_data16(FAR struct ra8875_lcd_s *dev, uint16_t data) {
     SPI_SNDBLOCK(spi_device, buffer, 2);
 }
 
+static void spi_pwrite_run(FAR struct ra8875_lcd_s *dev, FAR const void *pixels, size_t npixels) {
+    FAR const uint16_t *src = (FAR const uint16_t *)pixels;
+    size_t nbytes;
+
+    /* Lay the pixels out in bus order (low byte first) and send each full staging
+     * buffer as one block, so a run costs one transfer instead of one per pixel.
+     */
+
+    while (npixels > 0) {
+        for (nbytes = 0; npixels > 0 && nbytes < RUNBUFSIZE; npixels--) {
+            run_buffer[nbytes++] = *src & 0xff;
+            run_buffer[nbytes++] = *src++ >> 8;
+        }
+        SPI_SNDBLOCK(spi_device, run_buffer, nbytes);
+    }
+}
+
+static void spi_pwrite_block(FAR struct ra8875_lcd_s *dev, FAR const uint8_t *data, size_t nbytes) {
+    SPI_SNDBLOCK(spi_device, data, nbytes);
+}
+
 static void spi_pwrite_finish(FAR struct ra8875_lcd_s *dev) {
     CYCLE_END();
     SPI_SETFREQUENCY(spi_device, SPI_WRITE_SPEED);
@@ -40,6 +40,9 @@
 #include <tinyara/kmalloc.h>
 #include <tinyara/fs/fs.h>
 #include <tinyara/arch.h>
+#include <tinyara/clock.h>
+#include <ttrace.h>
+#include <tinyara/ttrace_internal.h>
 
 #include <arch/irq.h>
 
@@ -65,6 +68,14 @@
 
 #define NO_HOLDER               ((pid_t)-1)
 
+#ifdef CONFIG_TTRACE_RING
+#define TTRACE_RING_MASK        (CONFIG_TTRACE_RING_RECORDS - 1)
+
+#if (CONFIG_TTRACE_RING_RECORDS & TTRACE_RING_MASK) != 0
+#error "CONFIG_TTRACE_RING_RECORDS must be a power of two"
+#endif
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -96,8 +107,20 @@ static const struct file_operations g_ttracefops = {
 	ttrace_ioctl  /* ioctl */
 };
 
+#ifdef CONFIG_TTRACE_RING
+/* The ring of trace records.  g_ring_head counts the records ever reserved
+ * and g_ring_tail the records read or lost, so the record with index i is
+ * in g_ring[i & TTRACE_RING_MASK].
+ */
+
+static struct ttrace_record_s g_ring[CONFIG_TTRACE_RING_RECORDS];
+static uint32_t g_ring_head;
+static uint32_t g_ring_tail;
+static uint32_t g_ring_lost;
+#else
 /* This is the pre-allocated buffer used for the T-trace */
 static char g_packets[CONFIG_TTRACE_BUFSIZE];
+#endif
 static uint32_t g_state = TTRACE_STATE_IDLE;
 static uint32_t g_selected_tag = 0;
 
@@ -108,14 +131,149 @@ static uint32_t g_selected_tag = 0;
 
 static struct ttrace_dev_s g_sysdev = {
 	0,                        /* ttrace_head */
+#ifdef CONFIG_TTRACE_RING
+	sizeof(g_ring),           /* ttrace_bufsize */
+	(FAR char *)g_ring        /* ttrace_packets_buffer */
+#else
 	CONFIG_TTRACE_BUFSIZE,    /* ttrace_bufsize */
 	g_packets                 /* ttrace_packets_buffer */
+#endif
 };
 
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_TTRACE_RING
+/****************************************************************************
+ * Name: ttrace_ring_get
+ *
+ * Description:
+ *   Take the oldest unread record out of the ring.  Records that were
+ *   overwritten before they could be read are reported as one record of
+ *   type TTRACE_EVENT_TYPE_LOST.  Returns false if there is no complete
+ *   record to read.
+ *
+ ****************************************************************************/
+
+static bool ttrace_ring_get(FAR struct ttrace_record_s *rec)
+{
+	FAR struct ttrace_record_s *slot;
+	uint32_t tail = g_ring_tail;
+	uint32_t head;
+	uint32_t seq;
+
+	for (;;) {
+		head = __atomic_load_n(&g_ring_head, __ATOMIC_ACQUIRE);
+		if (head - tail > CONFIG_TTRACE_RING_RECORDS) {
+			g_ring_lost += head - tail - CONFIG_TTRACE_RING_RECORDS;
+			tail = head - CONFIG_TTRACE_RING_RECORDS;
+		}
+
+		if (g_ring_lost > 0) {
+			memset(rec, 0, sizeof(struct ttrace_record_s));
+			rec->event_type = TTRACE_EVENT_TYPE_LOST;
+			rec->codelen = TTRACE_CODE_VARIABLE | sizeof(uint32_t);
+			memcpy(rec->msg.message, &g_ring_lost, sizeof(uint32_t));
+			g_ring_lost = 0;
+			break;
+		}
+
+		if (tail == head) {
+			g_ring_tail = tail;
+			return false;
+		}
+
+		slot = &g_ring[tail & TTRACE_RING_MASK];
+		seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+		if (seq == tail + 1) {
+			/* Copy the record and check that no writer started to reuse
+			 * the slot meanwhile.
+			 */
+
+			memcpy(rec, slot, sizeof(struct ttrace_record_s));
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) {
+				tail++;
+				break;
+			}
+		} else if ((int32_t)(seq - (tail + 1)) < 0) {
+			/* The record is still being written */
+
+			g_ring_tail = tail;
+			return false;
+		}
+
+		/* The record was overwritten */
+
+		g_ring_lost++;
+		tail++;
+	}
+
+	g_ring_tail = tail;
+	return true;
+}
+
+/****************************************************************************
+ * Name: ttrace_read
+ *
+ * Description:
+ *   Read the stream header on the first read of an open file and then as
+ *   many whole records as fit.  Records are removed from the ring when they
+ *   are read, also while tracing is running.
+ *
+ ****************************************************************************/
+
+static ssize_t ttrace_read(FAR struct file *filep, FAR char *buffer, size_t len)
+{
+	struct ttrace_ringhdr_s hdr;
+	struct ttrace_record_s rec;
+	size_t nread = 0;
+
+	sched_lock();
+
+	if (filep->f_pos == 0) {
+		if (len < sizeof(struct ttrace_ringhdr_s)) {
+			sched_unlock();
+			return -EINVAL;
+		}
+
+		hdr.magic = TTRACE_RING_MAGIC;
+		hdr.version = TTRACE_RING_VERSION;
+		hdr.recsize = sizeof(struct ttrace_record_s);
+#ifdef CONFIG_ARCH_HAVE_PERF_EVENTS
+		hdr.freq = up_perf_getfreq();
+#else
+		hdr.freq = 0;
+#endif
+		hdr.usec_per_tick = USEC_PER_TICK;
+
+		memcpy(buffer, &hdr, sizeof(struct ttrace_ringhdr_s));
+		nread = sizeof(struct ttrace_ringhdr_s);
+	}
+
+	while (len - nread >= sizeof(struct ttrace_record_s) && ttrace_ring_get(&rec)) {
+		memcpy(buffer + nread, &rec, sizeof(struct ttrace_record_s));
+		nread += sizeof(struct ttrace_record_s);
+	}
+
+	filep->f_pos += nread;
+
+	sched_unlock();
+	return nread;
+}
+
+/****************************************************************************
+ * Name: ttrace_write
+ ****************************************************************************/
+
+static ssize_t ttrace_write(FAR struct file *filep, FAR const char *buffer, size_t len)
+{
+	/* Trace points store records with ttrace_ring_put() */
+
+	return -ENOSYS;
+}
+#else
 /****************************************************************************
  * Name: ttrace_read
  ****************************************************************************/
@@ -169,6 +327,7 @@ static ssize_t ttrace_write(FAR struct file *filep, FAR const char *buffer, size
 	sched_unlock();
 	return len;
 }
+#endif
 
 /****************************************************************************
  * Name: ttrace_ioctl
@@ -185,6 +344,11 @@ static ssize_t ttrace_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
 	switch (cmd) {
 	case TTRACE_START:
+#ifdef CONFIG_TTRACE_RING
+		/* Skip the records of earlier runs */
+		g_ring_tail = __atomic_load_n(&g_ring_head, __ATOMIC_ACQUIRE);
+		g_ring_lost = 0;
+#endif
 		g_state = TTRACE_STATE_RUNNING;
 		priv->ttrace_head = 0;
 		break;
@@ -211,8 +375,16 @@ static ssize_t ttrace_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 		}
 		break;
 	case TTRACE_USED_BUFSIZE:
-		ttdbg("used bufsize: %d\r\n", priv->ttrace_head);
+#ifdef CONFIG_TTRACE_RING
+		ret = __atomic_load_n(&g_ring_head, __ATOMIC_ACQUIRE) - g_ring_tail;
+		if (ret > CONFIG_TTRACE_RING_RECORDS) {
+			ret = CONFIG_TTRACE_RING_RECORDS;
+		}
+		ret = sizeof(struct ttrace_ringhdr_s) + (ret + 1) * sizeof(struct ttrace_record_s);
+#else
 		ret = priv->ttrace_head;
+#endif
+		ttdbg("used bufsize: %d\r\n", ret);
 		break;
 	case TTRACE_BUFFER:
 		ttdbg("Resize of trace buffer is not supported yet.\r\n");
@@ -239,6 +411,62 @@ static ssize_t ttrace_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
  *
  ****************************************************************************/
 
+#ifdef CONFIG_TTRACE_RING
+/****************************************************************************
+ * Name: ttrace_ring_enabled
+ *
+ * Description:
+ *   Return non-zero if tracing is running with 'tag' selected.  Trace
+ *   points call this before they prepare a record.
+ *
+ ****************************************************************************/
+
+int ttrace_ring_enabled(int tag)
+{
+	return g_state == TTRACE_STATE_RUNNING && (g_selected_tag & tag) != 0;
+}
+
+/****************************************************************************
+ * Name: ttrace_ring_put
+ *
+ * Description:
+ *   Store a record in the ring, overwriting the oldest one if the ring is
+ *   full.  The cycles, ticks and seq fields are filled in here.  Takes no
+ *   lock and does not disable interrupts, so it may be called from
+ *   interrupt handlers and from the scheduler.
+ *
+ ****************************************************************************/
+
+void ttrace_ring_put(FAR const struct ttrace_record_s *rec)
+{
+	FAR struct ttrace_record_s *slot;
+	uint32_t index;
+
+	index = __atomic_fetch_add(&g_ring_head, 1, __ATOMIC_RELAXED);
+	slot = &g_ring[index & TTRACE_RING_MASK];
+
+	/* Invalidate the slot before its contents change, so that a reader
+	 * copying the old record notices.
+	 */
+
+	__atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+#ifdef CONFIG_ARCH_HAVE_PERF_EVENTS
+	slot->cycles = up_perf_gettime();
+#else
+	slot->cycles = 0;
+#endif
+	slot->ticks = (uint32_t)clock_systimer();
+	slot->pid = rec->pid;
+	slot->event_type = rec->event_type;
+	slot->codelen = rec->codelen;
+	memcpy(&slot->msg, &rec->msg, sizeof(union trace_message));
+
+	__atomic_store_n(&slot->seq, index + 1, __ATOMIC_RELEASE);
+}
+#endif
+
 int ttrace_init(void)
 {
 	/* Register the syslog character driver */
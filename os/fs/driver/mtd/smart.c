@@ -68,12 +68,19 @@
 #include <string.h>
 #include <debug.h>
 #include <errno.h>
+#ifdef CONFIG_MTD_SMART_GC_BACKGROUND
+#include <semaphore.h>
+#endif
 
 #include <crc8.h>
 #include <crc16.h>
 #include <crc32.h>
 #include <tinyara/math.h>
 #include <tinyara/kmalloc.h>
+#ifdef CONFIG_MTD_SMART_GC_BACKGROUND
+#include <tinyara/clock.h>
+#include <tinyara/wqueue.h>
+#endif
 #include <tinyara/fs/fs.h>
 #include <tinyara/fs/ioctl.h>
 #include <tinyara/fs/mtd.h>
@@ -189,6 +196,54 @@
 #define SET_TO_TRUE(v, n) v[n/8] |= (1<<(7-(n%8)))
 #define GET_VAL(v, n) (v[n/8] & 1<<(7-(n%8)))
 
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+/* The sector cache is divided in sets of CONFIG_MTD_SMART_SECTOR_CACHE_WAYS
+ * entries.  A logical sector is cached in the set picked by the high bits
+ * of a multiplicative hash of its number, so that neither runs nor strides
+ * of sector numbers end up in the same set.
+ */
+
+#define SMART_CACHE_NSETS         ((CONFIG_MTD_SMART_SECTOR_CACHE_SIZE + CONFIG_MTD_SMART_SECTOR_CACHE_WAYS - 1) / CONFIG_MTD_SMART_SECTOR_CACHE_WAYS)
+#define SMART_CACHE_ENTRIES       (SMART_CACHE_NSETS * CONFIG_MTD_SMART_SECTOR_CACHE_WAYS)
+#define SMART_CACHE_SET(l)        ((uint16_t)(((uint32_t)(uint16_t)((l) * 40503u) * SMART_CACHE_NSETS) >> 16))
+#endif
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+#define SMART_CKPT_MAGIC          0x504b4d53	/* "SMKP" */
+#define SMART_CKPT_VERSION        1
+
+/* Map checkpoint record types.  Each record takes one MTD block. */
+
+#define SMART_CKPT_HEADER         1	/* First block of a copy, written last */
+#define SMART_CKPT_DIRTY          2	/* The device is about to change */
+#define SMART_CKPT_CHUNK          3	/* New contents of one chunk of the map */
+#define SMART_CKPT_CLEAN          4	/* The map matches the device again */
+
+/* Values of dev->ckptstate */
+
+#define SMART_CKPT_STATE_NONE     0	/* No usable checkpoint on the device */
+#define SMART_CKPT_STATE_CLEAN    1	/* The checkpoint matches the device */
+#define SMART_CKPT_STATE_DIRTY    2	/* The device changed since */
+
+/* The map is saved together with the releasecount and freecount arrays
+ * that follow it in RAM.  The journal replaces it in chunks of what is
+ * left of an MTD block after the record header.
+ */
+
+#define SMART_CKPT_BODYLEN(d)     (((uint32_t)(d)->totalsectors + (d)->neraseblocks) << 1)
+#define SMART_CKPT_BODYBLKS(d)    ((SMART_CKPT_BODYLEN(d) + (d)->geo.blocksize - 1) / (d)->geo.blocksize)
+#define SMART_CKPT_CHUNKLEN(d)    ((d)->geo.blocksize - sizeof(struct smart_ckpt_rec_s))
+#define SMART_CKPT_NCHUNKS(d)     ((SMART_CKPT_BODYLEN(d) + SMART_CKPT_CHUNKLEN(d) - 1) / SMART_CKPT_CHUNKLEN(d))
+#endif
+
+#ifdef CONFIG_MTD_SMART_GC_BACKGROUND
+/* The background collection keeps this many free sectors on top of the
+ * 1/32 of the device below which writes collect garbage themselves.
+ */
+
+#define SMART_GC_RESERVE(d)       (((d)->totalsectors >> 5) + CONFIG_MTD_SMART_GC_RESERVE * (d)->sectorsPerBlk)
+#endif
+
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
 /* Bit mapping for wear level bits */
 /* These are defined to allow updating the wear leveling with the minimum
@@ -228,9 +283,8 @@ static const uint8_t gWearBitToLevelMap4[] = {
 
 #ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
 struct smart_cache_s {
-	uint16_t logical;			/* Logical sector number */
+	uint16_t logical;			/* Logical sector number, 0xFFFF if unused */
 	uint16_t physical;			/* Associated physical sector */
-	uint16_t birth;				/* The "birthday" of this entry */
 };
 #endif
 
@@ -250,6 +304,34 @@ struct smart_allocsector_s {
 };
 #endif
 
+/* The sector map checkpoint is kept in two copies at the end of the device.
+ * A copy is a header block, the map and counts, and a journal of records
+ * of what changed since.  A record is this structure at the start of an
+ * MTD block, followed by its payload.
+ */
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+struct smart_ckpt_rec_s {
+	uint32_t magic;				/* SMART_CKPT_MAGIC */
+	uint32_t seq;				/* Sequence number of the copy */
+	uint8_t type;				/* SMART_CKPT_HEADER, _DIRTY, _CHUNK or _CLEAN */
+	uint8_t version;			/* SMART_CKPT_VERSION */
+	uint16_t index;				/* Chunk number of a SMART_CKPT_CHUNK record */
+	uint32_t crc;				/* CRC-32 of the whole block with this as zero */
+};
+
+/* Payload of a SMART_CKPT_HEADER record */
+
+struct smart_ckpt_info_s {
+	uint16_t totalsectors;		/* Geometry the copy was written for */
+	uint16_t neraseblocks;
+	uint16_t sectorsize;
+	uint16_t reserved;
+	uint32_t bodylen;			/* Length of the map and counts */
+	uint32_t bodycrc;			/* CRC-32 of the map and counts */
+};
+#endif
+
 struct smart_struct_s {
 	FAR struct mtd_dev_s *mtd;	/* Contained MTD interface */
 	struct mtd_geometry_s geo;	/* Device geometry */
@@ -302,10 +384,37 @@ struct smart_struct_s {
 #else
 	FAR uint8_t *sBitMap;		/* Virtual sector used bit-map */
 	FAR struct smart_cache_s *sCache;	/* Sector cache */
-	uint16_t cache_entries;	/* Number of valid entries in the cache */
-	uint16_t cache_lastlog;	/* Keep track of the last sector accessed */
-	uint16_t cache_lastphys;	/* Keep the physical sector number also */
-	uint16_t cache_nextbirth;	/* Sector cache aging value */
+	FAR uint8_t *cache_ref;		/* Per set bit map of the ways used recently */
+	FAR uint8_t *cache_hand;	/* Per set CLOCK hand */
+	uint32_t cache_hits;		/* Lookups found in the cache */
+	uint32_t cache_misses;		/* Lookups that scanned the device */
+	uint32_t cache_scanreads;	/* Sector headers read by those scans */
+	uint32_t cache_prefetches;	/* Entries cached by those scans */
+#endif
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+	FAR uint32_t *ckptcrc;		/* CRC of each chunk of the map in the checkpoint */
+	uint32_t ckptbase;			/* First MTD block of the checkpoint area */
+	uint32_t ckptslotlen;		/* MTD blocks per copy of the checkpoint */
+	uint32_t ckptseq;			/* Sequence number of the current copy */
+	uint32_t ckptpos;			/* Next free journal block in the current copy */
+	uint16_t ckptblock;			/* First erase block of the checkpoint area */
+	uint16_t ckptslotblks;		/* Erase blocks per copy, zero if disabled */
+	uint8_t ckptslot;			/* Which copy is current */
+	uint8_t ckptstate;			/* SMART_CKPT_STATE_* */
+#endif
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+	FAR uint16_t *gcheap;		/* Erase blocks in a max-heap of their gckey */
+	FAR uint16_t *gcpos;		/* Index of each erase block in gcheap */
+	FAR uint16_t *gckey;		/* Collection score of each erase block */
+	FAR uint16_t *gcstamp;		/* gcclock at the last write to each erase block */
+	uint16_t gcclock;			/* Count of sectors written */
+	uint16_t gcbuilt;			/* gcclock when the heap was last built */
+	bool gcvalid;				/* The heap was built for the current counts */
+#endif
+#ifdef CONFIG_MTD_SMART_GC_BACKGROUND
+	sem_t exclsem;				/* Keeps the background collection out */
+	struct work_s gcwork;		/* Background collection work */
+	uint32_t gclastwrite;		/* System time of the last change */
 #endif
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
 	FAR uint8_t *erasecounts;	/* Number of erases for each erase block */
@@ -420,6 +529,15 @@ static int smart_relocate_static_data(FAR struct smart_struct_s *dev, uint16_t b
 
 static int smart_relocate_sector(FAR struct smart_struct_s *dev, uint16_t oldsector, uint16_t newsector);
 
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+static int smart_ckpt_dirty(FAR struct smart_struct_s *dev);
+static int smart_ckpt_flush(FAR struct smart_struct_s *dev);
+#endif
+
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+static void smart_gc_update(FAR struct smart_struct_s *dev, uint16_t block);
+#endif
+
 #ifndef CONFIG_MTD_SMART_ENABLE_CRC
 static int smart_validate_crc(FAR struct smart_struct_s *dev);
 static crc_t smart_calc_sector_crc(FAR struct smart_struct_s *dev);
@@ -515,6 +633,34 @@ static void smart_free(FAR struct smart_struct_s *dev, FAR void *ptr)
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: smart_semtake / smart_semgive
+ *
+ * Description: Get and release exclusive access to the device, which the
+ *              background garbage collection shares with the file system.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_GC_BACKGROUND
+static void smart_semtake(FAR struct smart_struct_s *dev)
+{
+	/* Take the semaphore (perhaps waiting) */
+
+	while (sem_wait(&dev->exclsem) != 0) {
+		/* The only case that an error should occur here is if
+		 * the wait was awakened by a signal.
+		 */
+
+		DEBUGASSERT(errno == EINTR);
+	}
+}
+
+#define smart_semgive(d) sem_post(&(d)->exclsem)
+#else
+#define smart_semtake(d)
+#define smart_semgive(d)
+#endif
+
 /****************************************************************************
  * Name: smart_open
  *
@@ -537,8 +683,30 @@ static int smart_open(FAR struct inode *inode)
 
 static int smart_close(FAR struct inode *inode)
 {
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+	FAR struct smart_struct_s *dev;
+	int ret;
+#endif
+
 	fvdbg("Entry\n");
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+	DEBUGASSERT(inode && inode->i_private);
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+	dev = ((FAR struct smart_multiroot_device_s *)inode->i_private)->dev;
+#else
+	dev = (FAR struct smart_struct_s *)inode->i_private;
+#endif
+
+	/* Bring the map checkpoint up to date, e.g. on unmount */
+
+	smart_semtake(dev);
+	ret = smart_ckpt_flush(dev);
+	smart_semgive(dev);
+	return ret;
+#else
 	return OK;
+#endif
 }
 
 /****************************************************************************
@@ -818,6 +986,13 @@ static ssize_t smart_write(FAR struct inode *inode, FAR const unsigned char *buf
 
 	/* I think maybe we need to lock on a mutex here */
 
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+	ret = smart_ckpt_dirty(dev);
+	if (ret < 0) {
+		return ret;
+	}
+#endif
+
 	/* Get the aligned block.  Here is is assumed: (1) The number of R/W blocks
 	 * per erase block is a power of 2, and (2) the erase begins with that same
 	 * alignment.
@@ -957,6 +1132,9 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 	uint32_t erasesize;
 	uint32_t totalsectors;
 	uint32_t allocsize;
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+	uint32_t crcoffset;
+#endif
 
 #ifdef CONFIG_SMARTFS_BAD_SECTOR
 	int sector;
@@ -1021,10 +1199,6 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 		smart_free(dev, dev->sBitMap);
 		dev->sBitMap = NULL;
 	}
-
-	dev->cache_entries = 0;
-	dev->cache_lastlog = 0xFFFF;
-	dev->cache_nextbirth = 0;
 #endif
 
 	if (dev->rwbuffer != NULL) {
@@ -1095,6 +1269,12 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
 	allocsize = dev->neraseblocks << 1;
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+	/* Keep the CRCs of the chunks of the checkpointed map after the counts */
+
+	crcoffset = (totalsectors * sizeof(uint16_t) + allocsize + 3) & ~3;
+	allocsize = crcoffset - totalsectors * sizeof(uint16_t) + SMART_CKPT_NCHUNKS(dev) * sizeof(uint32_t);
+#endif
 	dev->sMap = (FAR uint16_t *)smart_malloc(dev, totalsectors * sizeof(uint16_t) + allocsize, "Sector map");
 	if (!dev->sMap) {
 		fdbg("Error allocating SMART virtual map buffer\n");
@@ -1103,6 +1283,9 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 
 	dev->releasecount = (FAR uint8_t *)dev->sMap + (totalsectors * sizeof(uint16_t));
 	dev->freecount = dev->releasecount + dev->neraseblocks;
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+	dev->ckptcrc = (FAR uint32_t *)((FAR uint8_t *)dev->sMap + crcoffset);
+#endif
 #else
 	dev->sBitMap = (FAR uint8_t *)smart_malloc(dev, (totalsectors + 7) >> 3, "Sector Bitmap");
 	if (dev->sBitMap == NULL) {
@@ -1125,10 +1308,10 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 	allocsize = dev->neraseblocks << 1;
 #endif
 
-	/* Allocate the sector cache */
+	/* Allocate the sector cache, followed by the state of its sets */
 
 	if (dev->sCache == NULL) {
-		dev->sCache = (FAR struct smart_cache_s *)smart_malloc(dev, CONFIG_MTD_SMART_SECTOR_CACHE_SIZE * sizeof(struct smart_cache_s) + allocsize, "Sector Cache");
+		dev->sCache = (FAR struct smart_cache_s *)smart_malloc(dev, SMART_CACHE_ENTRIES * sizeof(struct smart_cache_s) + SMART_CACHE_NSETS * 2 + allocsize, "Sector Cache");
 	}
 
 	if (!dev->sCache) {
@@ -1136,7 +1319,16 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 		goto errexit;
 	}
 
-	dev->releasecount = (FAR uint8_t *)dev->sCache + (CONFIG_MTD_SMART_SECTOR_CACHE_SIZE * sizeof(struct smart_cache_s));
+	memset(dev->sCache, 0xFF, SMART_CACHE_ENTRIES * sizeof(struct smart_cache_s));
+	dev->cache_ref = (FAR uint8_t *)&dev->sCache[SMART_CACHE_ENTRIES];
+	dev->cache_hand = dev->cache_ref + SMART_CACHE_NSETS;
+	memset(dev->cache_ref, 0, SMART_CACHE_NSETS * 2);
+	dev->cache_hits = 0;
+	dev->cache_misses = 0;
+	dev->cache_scanreads = 0;
+	dev->cache_prefetches = 0;
+
+	dev->releasecount = dev->cache_hand + SMART_CACHE_NSETS;
 
 #ifdef CONFIG_MTD_SMART_PACK_COUNTS
 	if (dev->sectorsPerBlk > 16) {
@@ -1168,6 +1360,26 @@ static int smart_setsectorsize(FAR struct smart_struct_s *dev, uint16_t size)
 	memset(dev->erasecounts, 0, dev->neraseblocks);
 #endif
 
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+	/* Allocate the garbage collection heap, positions, keys and stamps */
+
+	if (dev->gcheap == NULL) {
+		dev->gcheap = (FAR uint16_t *)smart_malloc(dev, dev->neraseblocks * 4 * sizeof(uint16_t), "GC heap");
+	}
+
+	if (!dev->gcheap) {
+		fdbg("Error allocating garbage collection heap\n");
+		goto errexit;
+	}
+
+	dev->gcpos = dev->gcheap + dev->neraseblocks;
+	dev->gckey = dev->gcpos + dev->neraseblocks;
+	dev->gcstamp = dev->gckey + dev->neraseblocks;
+	memset(dev->gcstamp, 0, dev->neraseblocks * sizeof(uint16_t));
+	dev->gcclock = 0;
+	dev->gcvalid = false;
+#endif
+
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
 	/* Allocate the wear leveling status array */
 
@@ -1239,6 +1451,12 @@ errexit:
 	}
 #endif
 
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+	if (dev->gcheap) {
+		smart_free(dev, dev->gcheap);
+	}
+#endif
+
 	kmm_free(dev);
 	return -ENOMEM;
 }
@@ -1305,71 +1523,161 @@ errout:
 }
 
 /****************************************************************************
- * Name: smart_add_sector_to_cache
+ * Name: smart_cache_find
  *
- * Description: Adds a logical to physical sector maaping to the sector
- *              map cache.  The cache is used to minimize RAM by eliminating
- *              a one-to-one mapping of all logical sectors and only keeping
- *              a fixed number of mappings per the
- *              CONFIG_MTD_SMART_SECTOR_CACHE_SIZE parameter.  Sectors are
- *              automatically managed and removed based on the time since
- *              they were accessed last.
+ * Description: Returns the index of the sector cache entry of a logical
+ *              sector, or -1 if it is not cached.  A logical sector can
+ *              only be cached in the ways of the set its number hashes to.
  *
  ****************************************************************************/
 
 #ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
-static int smart_add_sector_to_cache(FAR struct smart_struct_s *dev, uint16_t logical, uint16_t physical, int line)
+static int smart_cache_find(FAR struct smart_struct_s *dev, uint16_t logical)
+{
+	FAR struct smart_cache_s *entry;
+	uint16_t base;
+	uint16_t way;
+
+	base = SMART_CACHE_SET(logical) * CONFIG_MTD_SMART_SECTOR_CACHE_WAYS;
+	entry = &dev->sCache[base];
+	for (way = 0; way < CONFIG_MTD_SMART_SECTOR_CACHE_WAYS; way++, entry++) {
+		if (entry->logical == logical) {
+			return base + way;
+		}
+	}
+
+	return -1;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_cache_victim
+ *
+ * Description: Chooses the way of a set that a new entry goes to.  An
+ *              empty way is used first.  Otherwise the CLOCK hand of the
+ *              set gives the entries used since it last passed a second
+ *              chance.  Entries for system sectors are only replaced when
+ *              all the ways hold one.  A prefetch only takes a way that is
+ *              empty or was not used, and doesn't move the hand.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+static int smart_cache_victim(FAR struct smart_struct_s *dev, uint16_t set, bool prefetch)
 {
-	uint16_t index, x;
-	uint16_t oldest;
+	FAR struct smart_cache_s *entry = &dev->sCache[set * CONFIG_MTD_SMART_SECTOR_CACHE_WAYS];
+	uint8_t hand;
+	uint8_t way;
+	uint8_t x;
 
-	/* If we aren't full yet, just add the sector to the end of the list */
+	for (way = 0; way < CONFIG_MTD_SMART_SECTOR_CACHE_WAYS; way++) {
+		if (entry[way].logical == 0xFFFF) {
+			return way;
+		}
+	}
 
-	index = 1;
-	if (dev->cache_entries < CONFIG_MTD_SMART_SECTOR_CACHE_SIZE) {
-		index = dev->cache_entries++;
-	} else {
-		/* Cache is full.  We must find the least accessed entry and replace it */
+	hand = dev->cache_hand[set];
+	for (x = 0; x < 2 * CONFIG_MTD_SMART_SECTOR_CACHE_WAYS; x++) {
+		way = hand;
+		if (++hand >= CONFIG_MTD_SMART_SECTOR_CACHE_WAYS) {
+			hand = 0;
+		}
 
-		oldest = 0xFFFF;
-		for (x = 0; x < CONFIG_MTD_SMART_SECTOR_CACHE_SIZE; x++) {
-			/* Never replace cache entries for system sectors */
+		if (entry[way].logical < dev->reservedsector) {
+			continue;
+		}
 
-			if (dev->sCache[x].logical < dev->reservedsector) {
-				continue;
+		if (dev->cache_ref[set] & (1 << way)) {
+			if (!prefetch) {
+				dev->cache_ref[set] &= ~(1 << way);
 			}
 
-			/* If the hit count is zero, then choose this entry */
+			continue;
+		}
 
-			if (dev->sCache[x].birth < oldest) {
-				oldest = dev->sCache[x].birth;
-				index = x;
-			}
+		if (!prefetch) {
+			dev->cache_hand[set] = hand;
 		}
+
+		return way;
+	}
+
+	if (prefetch) {
+		return -1;
+	}
+
+	way = hand;
+	if (++hand >= CONFIG_MTD_SMART_SECTOR_CACHE_WAYS) {
+		hand = 0;
 	}
 
-	/* Now add the sector at index */
+	dev->cache_hand[set] = hand;
+	return way;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_add_sector_to_cache
+ *
+ * Description: Adds a logical to physical sector maaping to the sector
+ *              map cache.  The cache is used to minimize RAM by eliminating
+ *              a one-to-one mapping of all logical sectors and only keeping
+ *              a fixed number of mappings per the
+ *              CONFIG_MTD_SMART_SECTOR_CACHE_SIZE parameter.  The cache is
+ *              CONFIG_MTD_SMART_SECTOR_CACHE_WAYS way set associative, and
+ *              each set replaces its entries with the CLOCK algorithm.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+static int smart_add_sector_to_cache(FAR struct smart_struct_s *dev, uint16_t logical, uint16_t physical, int line)
+{
+	uint16_t set = SMART_CACHE_SET(logical);
+	int index;
+
+	/* Update the entry if the sector is cached already */
+
+	index = smart_cache_find(dev, logical);
+	if (index < 0) {
+		index = set * CONFIG_MTD_SMART_SECTOR_CACHE_WAYS + smart_cache_victim(dev, set, false);
+	}
 
 	dev->sCache[index].logical = logical;
 	dev->sCache[index].physical = physical;
-	dev->sCache[index].birth = dev->cache_nextbirth++;
-	dev->cache_lastlog = logical;
-	dev->cache_lastphys = physical;
+	dev->cache_ref[set] |= 1 << (index % CONFIG_MTD_SMART_SECTOR_CACHE_WAYS);
 	if (dev->debuglevel > 1) {
 		dbg("Add Cache sector:  Log=%d, Phys=%d at index %d from line %d\n", logical, physical, index, line);
 	}
 
-	/* Test if the birthdays need to be adjusted */
+	return index;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_cache_prefetch
+ *
+ * Description: Caches a mapping seen while scanning the device for another
+ *              logical sector, unless that would replace a used entry.
+ *
+ ****************************************************************************/
 
-	if (oldest >= CONFIG_MTD_SMART_SECTOR_CACHE_SIZE + 1024) {
-		for (x = 0; x < dev->cache_entries; x++) {
-			dev->sCache[x].birth -= 1024;
-		}
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+static void smart_cache_prefetch(FAR struct smart_struct_s *dev, uint16_t logical, uint16_t physical)
+{
+	uint16_t set;
+	int way;
 
-		dev->cache_nextbirth -= 1024;
+	if (logical >= dev->totalsectors || smart_cache_find(dev, logical) >= 0) {
+		return;
 	}
 
-	return index;
+	set = SMART_CACHE_SET(logical);
+	way = smart_cache_victim(dev, set, true);
+	if (way >= 0) {
+		dev->sCache[set * CONFIG_MTD_SMART_SECTOR_CACHE_WAYS + way].logical = logical;
+		dev->sCache[set * CONFIG_MTD_SMART_SECTOR_CACHE_WAYS + way].physical = physical;
+		dev->cache_prefetches++;
+	}
 }
 #endif
 
@@ -1377,10 +1685,11 @@ static int smart_add_sector_to_cache(FAR struct smart_struct_s *dev, uint16_t lo
  * Name: smart_cache_lookup
  *
  * Description: Perform a cache lookup for the requested logical sector.
- *              If the sector is in the cache, then update the hitcount and
+ *              If the sector is in the cache, then mark the entry used and
  *              return the physical mapping.  If a cache miss occurs, then
  *              the routine will scan the volume to find the logical sector
  *              and add / replace a cache entry with the newly located sector.
+ *              The other sectors seen by the scan are prefetched.
  *
  ****************************************************************************/
 
@@ -1388,99 +1697,101 @@ static int smart_add_sector_to_cache(FAR struct smart_struct_s *dev, uint16_t lo
 static uint16_t smart_cache_lookup(FAR struct smart_struct_s *dev, uint16_t logical)
 {
 	int ret;
+	int index;
 	uint16_t block, sector;
-	uint16_t x, physical, logicalsector;
+	uint16_t physical, logicalsector;
 	struct smart_sect_header_s header;
 	size_t readaddress;
 
 	physical = 0xFFFF;
 
-	/* Test if searching for the last sector used */
+	/* A sector that is not allocated can't be found */
 
-	if (logical == dev->cache_lastlog) {
-		return dev->cache_lastphys;
+	if (logical >= dev->totalsectors || !(dev->sBitMap[logical >> 3] & (1 << (logical & 0x07)))) {
+		return physical;
 	}
 
 	/* First search for the entry in the cache */
 
-	for (x = 0; x < dev->cache_entries; x++) {
-		if (dev->sCache[x].logical == logical) {
-			/* Entry found in the cache.  Grab the physical mapping. */
+	index = smart_cache_find(dev, logical);
+	if (index >= 0) {
+		/* Entry found in the cache.  Grab the physical mapping. */
 
-			physical = dev->sCache[x].physical;
-			break;
-		}
+		dev->cache_hits++;
+		dev->cache_ref[index / CONFIG_MTD_SMART_SECTOR_CACHE_WAYS] |= 1 << (index % CONFIG_MTD_SMART_SECTOR_CACHE_WAYS);
+		return dev->sCache[index].physical;
 	}
 
 	/* If the entry wasn't found in the cache, then we must search the volume
 	 * for it and add it to the cache.
 	 */
 
-	if (physical == 0xFFFF) {
-		/* Now scan the MTD device.  Instead of scanning start to end, we
-		 * span the erase blocks and read one sector from each at a time.
-		 * this helps speed up the search on volumes that aren't full
-		 * because of sector allocation scheme will use the lower sector
-		 * numbers in each erase block first.
-		 */
+	dev->cache_misses++;
+
+	/* Now scan the MTD device.  Instead of scanning start to end, we
+	 * span the erase blocks and read one sector from each at a time.
+	 * this helps speed up the search on volumes that aren't full
+	 * because of sector allocation scheme will use the lower sector
+	 * numbers in each erase block first.
+	 */
 
-		for (sector = 0; sector < dev->sectorsPerBlk && physical == 0xFFFF; sector++) {
-			/* Now scan across each erase block */
+	for (sector = 0; sector < dev->sectorsPerBlk && physical == 0xFFFF; sector++) {
+		/* Now scan across each erase block */
 
-			for (block = 0; block < dev->geo.neraseblocks; block++) {
-				/* Calculate the read address for this sector */
+		for (block = 0; block < dev->geo.neraseblocks; block++) {
+			/* Calculate the read address for this sector */
 
-				readaddress = block * dev->erasesize + sector * CONFIG_MTD_SMART_SECTOR_SIZE;
+			readaddress = block * dev->erasesize + sector * CONFIG_MTD_SMART_SECTOR_SIZE;
 
-				/* Read the header for this sector */
+			/* Read the header for this sector */
 
-				ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s), (FAR uint8_t *)&header);
-				if (ret != sizeof(struct smart_sect_header_s)) {
-					goto err_out;
-				}
+			ret = MTD_READ(dev->mtd, readaddress, sizeof(struct smart_sect_header_s), (FAR uint8_t *)&header);
+			if (ret != sizeof(struct smart_sect_header_s)) {
+				goto err_out;
+			}
 
-				/* Get the logical sector number for this physical sector */
+			dev->cache_scanreads++;
 
-				logicalsector = *((FAR uint16_t *)header.logicalsector);
+			/* Get the logical sector number for this physical sector */
+
+			logicalsector = *((FAR uint16_t *)header.logicalsector);
 #if CONFIG_SMARTFS_ERASEDSTATE == 0x00
-				if (logicalsector == 0) {
-					continue;
-				}
+			if (logicalsector == 0) {
+				continue;
+			}
 #endif
 
-				/* Test if this sector has been committed */
+			/* Test if this sector has been committed */
 
-				if (!(SECTOR_IS_COMMITTED(header))) {
-					continue;
-				}
+			if (!(SECTOR_IS_COMMITTED(header))) {
+				continue;
+			}
 
-				/* Test if this sector has been release and skip it if it has */
+			/* Test if this sector has been release and skip it if it has */
 
-				if (SECOR_IS_RELEASED(header)) {
-					continue;
-				}
+			if (SECTOR_IS_RELEASED(header)) {
+				continue;
+			}
 
-				if ((header.status & SMART_STATUS_VERBITS) != SMART_STATUS_VERSION) {
-					continue;
-				}
+			if ((header.status & SMART_STATUS_VERBITS) != SMART_STATUS_VERSION) {
+				continue;
+			}
 
-				/* Test if this is the sector we are looking for */
+			/* Test if this is the sector we are looking for */
 
-				if (logicalsector == logical) {
-					/* This is the sector we are looking for!  Add it to the cache */
+			if (logicalsector == logical) {
+				/* This is the sector we are looking for!  Add it to the cache */
 
-					physical = block * dev->sectorsPerBlk + sector;
-					smart_add_sector_to_cache(dev, logical, physical, __LINE__);
-					break;
-				}
+				physical = block * dev->sectorsPerBlk + sector;
+				smart_add_sector_to_cache(dev, logical, physical, __LINE__);
+				break;
 			}
-		}
-	}
 
-	/* Update the last logical sector found variable */
+			/* Keep what we read of other sectors if there is room */
 
-	dev->cache_lastlog = logical;
-	dev->cache_lastphys = physical;
+			smart_cache_prefetch(dev, logicalsector, block * dev->sectorsPerBlk + sector);
+		}
+	}
 
 err_out:
 	return physical;
@@ -1492,43 +1803,34 @@ err_out:
  *
  * Description: Updates a cache entry (if present) replacing the logical
  *              sector's physical sector mapping with the new one provided.
- *              This does not affect the hit count.
+ *              This does not mark the entry used.
  *
  ****************************************************************************/
 
 #ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
 static void smart_update_cache(FAR struct smart_struct_s *dev, uint16_t logical, uint16_t physical)
 {
-	uint16_t x;
+	int index;
 
-	/* Scan through all cache entries and find the logical sector entry */
+	/* Find the logical sector entry */
 
-	for (x = 0; x < dev->cache_entries; x++) {
-		if (dev->sCache[x].logical == logical) {
-			/* Entry found.  Update it's physical mapping */
-
-			dev->sCache[x].physical = physical;
-
-			/* If we are freeing a sector, then remove the logical entry from
-			   the cache.
-			 */
-
-			if (physical == 0xFFFF) {
-				dev->sCache[x].logical = dev->sCache[dev->cache_entries - 1].logical;
-				dev->sCache[x].physical = dev->sCache[dev->cache_entries - 1].physical;
-				dev->cache_entries--;
-			}
+	index = smart_cache_find(dev, logical);
+	if (index < 0) {
+		return;
+	}
 
-			if (dev->debuglevel > 1) {
-				dbg("Update Cache:  Log=%d, Phys=%d at index %d\n", logical, physical, x);
-			}
+	/* Update it's physical mapping.  If we are freeing a sector, then remove
+	 * the logical entry from the cache.
+	 */
 
-			break;
-		}
+	dev->sCache[index].physical = physical;
+	if (physical == 0xFFFF) {
+		dev->sCache[index].logical = 0xFFFF;
+		dev->cache_ref[index / CONFIG_MTD_SMART_SECTOR_CACHE_WAYS] &= ~(1 << (index % CONFIG_MTD_SMART_SECTOR_CACHE_WAYS));
 	}
 
-	if (dev->cache_lastlog == logical) {
-		dev->cache_lastphys = physical;
+	if (dev->debuglevel > 1) {
+		dbg("Update Cache:  Log=%d, Phys=%d at index %d\n", logical, physical, index);
 	}
 }
 #endif
@@ -1821,66 +2123,733 @@ static int smart_find_failure(FAR struct smart_struct_s *dev, int erase_block)
 }
 #endif
 /****************************************************************************
- * Name: smart_scan
+ * Name: smart_read_format
  *
- * Description: Performs a scan of the MTD device searching for format
- *              information and fills in logical sector mapping, freesector
- *              count, etc.
+ * Description: Reads the format information from the physical sector that
+ *              holds logical sector zero.
  *
  ****************************************************************************/
 
-static int smart_scan(FAR struct smart_struct_s *dev)
+static int smart_read_format(FAR struct smart_struct_s *dev, uint16_t physsector)
 {
-	int sector;
 	int ret;
-	uint16_t totalsectors;
-	uint16_t sectorsize, prerelease;
-	uint16_t logicalsector;
-	uint16_t loser;
-	uint16_t winner;
 	uint32_t readaddress;
-	uint32_t offset;
-	uint16_t seq1;
-	uint16_t seq2;
-	struct smart_sect_header_s header;
-	uint8_t *sector_seq_log = NULL;
-	bool status_released, status_committed;
-#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
-	int dupsector;
-	uint16_t duplogsector;
-#endif
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
 	int x;
 	char devname[22];
 	FAR struct smart_multiroot_device_s *rootdirdev;
 #endif
-#ifdef CONFIG_DEBUG_FS
-	int i;
-#endif
-	fvdbg("Entry\n");
-
-	sectorsize = CONFIG_MTD_SMART_SECTOR_SIZE;
 
-	/* Now set the sectorsize and other sectorsize derived variables */
+	/* Read the sector data */
 
-	ret = smart_setsectorsize(dev, sectorsize);
-	if (ret != OK) {
-		goto err_out;
+	readaddress = physsector * dev->mtdBlksPerSector * dev->geo.blocksize;
+	ret = MTD_READ(dev->mtd, readaddress, 32, (FAR uint8_t *)dev->rwbuffer);
+	if (ret != 32) {
+		fdbg("Error reading physical sector %d.\n", physsector);
+		return ret < 0 ? ret : -EIO;
 	}
 
-	/* Initialize the device variables */
+	dev->formatstatus = SMART_FMT_STAT_FORMATTED;
+	dev->namesize = dev->rwbuffer[SMART_FMT_NAMESIZE_POS];
+	dev->formatversion = dev->rwbuffer[SMART_FMT_VERSION_POS];
 
-	totalsectors = dev->totalsectors;
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+	dev->rootdirentries = dev->rwbuffer[SMART_FMT_ROOTDIRS_POS];
 
-	dev->reservedsector = SMART_FIRST_ALLOC_SECTOR;
-#ifdef CONFIG_SMARTFS_JOURNALING
-	if (totalsectors > CONFIG_SMARTFS_JOURNALING_THRESHOLD) {
-		dev->reservedsector += 2 * CONFIG_SMARTFS_NLOGGING_SECTORS;
-	}
-#endif
+	/* If rootdirentries is greater than 1, then we need to register
+	 * additional block devices.
+	 */
 
-	dev->formatstatus = SMART_FMT_STAT_NOFMT;
-	dev->freesectors = dev->availSectPerBlk * dev->geo.neraseblocks;
+	for (x = 1; x < dev->rootdirentries; x++) {
+		if (dev->partname[0] != '\0') {
+			snprintf(dev->rwbuffer, sizeof(devname), "/dev/smart%d%sd%d", dev->minor, dev->partname, x + 1);
+		} else {
+			snprintf(devname, sizeof(devname), "/dev/smart%dd%d", dev->minor, x + 1);
+		}
+
+		/* Inode private data is a reference to a struct containing
+		 * the SMART device structure and the root directory number.
+		 */
+
+		rootdirdev = (struct smart_multiroot_device_s *)smart_malloc(dev, sizeof(*rootdirdev), "Root Dir");
+		if (rootdirdev == NULL) {
+			fdbg("Memory alloc failed\n");
+			return -ENOMEM;
+		}
+
+		/* Populate the rootdirdev */
+
+		rootdirdev->dev = dev;
+		rootdirdev->rootdirnum = x;
+		ret = register_blockdriver(dev->rwbuffer, &g_bops, 0, rootdirdev);
+
+		/* Inode private data is a reference to the SMART device structure */
+
+		ret = register_blockdriver(devname, &g_bops, 0, rootdirdev);
+	}
+#endif
+
+	return OK;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_reserve
+ *
+ * Description: Takes the erase blocks for the two copies of the sector map
+ *              checkpoint off the end of the device.  Called before the
+ *              sector size is set, so the map is sized for the whole
+ *              device.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+static void smart_ckpt_reserve(FAR struct smart_struct_s *dev)
+{
+	uint32_t erasesize;
+	uint32_t blksperblk;
+	uint32_t nsectors;
+	uint32_t slotlen;
+	uint32_t slotblks;
+
+	dev->ckptslotblks = 0;
+	dev->ckptstate = SMART_CKPT_STATE_NONE;
+	dev->ckptslot = 0;
+	dev->ckptseq = 0;
+
+	/* The header record must fit in a block, and smart_ckpt_putrec() uses
+	 * the sector sized bytebuffer.
+	 */
+
+	if (dev->geo.blocksize < sizeof(struct smart_ckpt_rec_s) + sizeof(struct smart_ckpt_info_s) || dev->geo.blocksize > CONFIG_MTD_SMART_SECTOR_SIZE) {
+		fdbg("MTD block size %d not supported by the map checkpoint\n", dev->geo.blocksize);
+		return;
+	}
+
+	/* MTD_ERASE() needs the real erase block size */
+
+	erasesize = dev->geo.erasesize;
+	if (erasesize == 0) {
+		fdbg("MTD erase size unknown\n");
+		return;
+	}
+
+	blksperblk = erasesize / dev->geo.blocksize;
+	nsectors = erasesize / CONFIG_MTD_SMART_SECTOR_SIZE;
+	if (nsectors > 256) {
+		nsectors = 256;
+	}
+
+	nsectors *= dev->geo.neraseblocks;
+	if (nsectors > 65536) {
+		nsectors = 65536;
+	}
+
+	/* A copy is the header block, the map and counts, and the journal */
+
+	slotlen = 1 + ((nsectors + dev->geo.neraseblocks) * 2 + dev->geo.blocksize - 1) / dev->geo.blocksize;
+	slotlen += (CONFIG_MTD_SMART_MAP_JOURNAL_SIZE + dev->geo.blocksize - 1) / dev->geo.blocksize;
+	slotblks = (slotlen + blksperblk - 1) / blksperblk;
+
+	/* Don't let the two copies take more than an eighth of the device */
+
+	if (slotblks * 16 > dev->geo.neraseblocks) {
+		fdbg("Device too small for the map checkpoint\n");
+		return;
+	}
+
+	dev->geo.neraseblocks -= slotblks * 2;
+	dev->ckptblock = dev->geo.neraseblocks;
+	dev->ckptslotblks = slotblks;
+	dev->ckptbase = dev->ckptblock * blksperblk;
+
+	/* The journal also gets the rest of the last erase block */
+
+	dev->ckptslotlen = slotblks * blksperblk;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_crc
+ *
+ * Description: Calculates the CRC of the map checkpoint record in the
+ *              bytebuffer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+static uint32_t smart_ckpt_crc(FAR struct smart_struct_s *dev)
+{
+	FAR struct smart_ckpt_rec_s *rec = (FAR struct smart_ckpt_rec_s *)dev->bytebuffer;
+	uint32_t saved;
+	uint32_t crc;
+
+	saved = rec->crc;
+	rec->crc = 0;
+	crc = crc32(dev->bytebuffer, dev->geo.blocksize);
+	rec->crc = saved;
+
+	return crc;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_chunkcrc
+ *
+ * Description: Calculates the CRC of one chunk of the map and counts as
+ *              they are in RAM.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+static uint32_t smart_ckpt_chunkcrc(FAR struct smart_struct_s *dev, uint16_t chunk)
+{
+	uint32_t offset = chunk * SMART_CKPT_CHUNKLEN(dev);
+	uint32_t len = SMART_CKPT_BODYLEN(dev) - offset;
+
+	if (len > SMART_CKPT_CHUNKLEN(dev)) {
+		len = SMART_CKPT_CHUNKLEN(dev);
+	}
+
+	return crc32((FAR const uint8_t *)dev->sMap + offset, len);
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_putrec
+ *
+ * Description: Writes a map checkpoint record to a block of the current
+ *              copy.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+static int smart_ckpt_putrec(FAR struct smart_struct_s *dev, uint32_t block, uint8_t type, uint16_t index, FAR const void *payload, size_t len)
+{
+	FAR struct smart_ckpt_rec_s *rec = (FAR struct smart_ckpt_rec_s *)dev->bytebuffer;
+	ssize_t ret;
+
+	DEBUGASSERT(block < dev->ckptslotlen && len <= SMART_CKPT_CHUNKLEN(dev));
+
+	memset(dev->bytebuffer, CONFIG_SMARTFS_ERASEDSTATE, dev->geo.blocksize);
+	rec->magic = SMART_CKPT_MAGIC;
+	rec->seq = dev->ckptseq;
+	rec->type = type;
+	rec->version = SMART_CKPT_VERSION;
+	rec->index = index;
+	if (len > 0) {
+		memcpy(rec + 1, payload, len);
+	}
+
+	rec->crc = smart_ckpt_crc(dev);
+
+	ret = MTD_BWRITE(dev->mtd, dev->ckptbase + dev->ckptslot * dev->ckptslotlen + block, 1, dev->bytebuffer);
+	if (ret != 1) {
+		fdbg("Error %d writing map checkpoint block %d\n", ret, block);
+		return ret < 0 ? ret : -EIO;
+	}
+
+	return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_getrec
+ *
+ * Description: Reads a block of a copy of the map checkpoint into the
+ *              bytebuffer.  Returns OK if it holds a valid record, -ENOENT
+ *              if it is erased, and another negated errno otherwise.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+static int smart_ckpt_getrec(FAR struct smart_struct_s *dev, uint8_t slot, uint32_t block)
+{
+	FAR struct smart_ckpt_rec_s *rec = (FAR struct smart_ckpt_rec_s *)dev->bytebuffer;
+	ssize_t ret;
+	uint16_t x;
+
+	ret = MTD_BREAD(dev->mtd, dev->ckptbase + slot * dev->ckptslotlen + block, 1, dev->bytebuffer);
+	if (ret != 1) {
+		return ret < 0 ? ret : -EIO;
+	}
+
+	for (x = 0; x < dev->geo.blocksize; x++) {
+		if (dev->bytebuffer[x] != CONFIG_SMARTFS_ERASEDSTATE) {
+			break;
+		}
+	}
+
+	if (x == dev->geo.blocksize) {
+		return -ENOENT;
+	}
+
+	if (rec->magic != SMART_CKPT_MAGIC || rec->version != SMART_CKPT_VERSION || rec->crc != smart_ckpt_crc(dev)) {
+		return -EINVAL;
+	}
+
+	return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_invalidate
+ *
+ * Description: Erases the headers of both copies of the map checkpoint so
+ *              that the next mount scans the device.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+static int smart_ckpt_invalidate(FAR struct smart_struct_s *dev)
+{
+	int ret;
+	int slot;
+
+	dev->ckptstate = SMART_CKPT_STATE_NONE;
+
+	for (slot = 0; slot < 2; slot++) {
+		ret = MTD_ERASE(dev->mtd, dev->ckptblock + slot * dev->ckptslotblks, 1);
+		if (ret < 0) {
+			fdbg("Error %d erasing map checkpoint\n", ret);
+			return ret;
+		}
+	}
+
+	return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_write
+ *
+ * Description: Writes a full copy of the map and counts over the older of
+ *              the two copies of the map checkpoint.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+static int smart_ckpt_write(FAR struct smart_struct_s *dev)
+{
+	FAR const uint8_t *body = (FAR const uint8_t *)dev->sMap;
+	struct smart_ckpt_info_s info;
+	uint32_t bodylen = SMART_CKPT_BODYLEN(dev);
+	uint32_t nblocks = bodylen / dev->geo.blocksize;
+	uint32_t base;
+	uint16_t chunk;
+	uint8_t slot;
+	ssize_t ret;
+
+	slot = dev->ckptslot ^ 1;
+	base = dev->ckptbase + slot * dev->ckptslotlen;
+
+	ret = MTD_ERASE(dev->mtd, dev->ckptblock + slot * dev->ckptslotblks, dev->ckptslotblks);
+	if (ret < 0) {
+		fdbg("Error %d erasing map checkpoint\n", ret);
+		goto errout;
+	}
+
+	/* The map and the counts follow each other in RAM */
+
+	if (nblocks > 0) {
+		ret = MTD_BWRITE(dev->mtd, base + 1, nblocks, body);
+		if (ret != nblocks) {
+			goto errout;
+		}
+	}
+
+	if (bodylen > nblocks * dev->geo.blocksize) {
+		memset(dev->bytebuffer, CONFIG_SMARTFS_ERASEDSTATE, dev->geo.blocksize);
+		memcpy(dev->bytebuffer, body + nblocks * dev->geo.blocksize, bodylen - nblocks * dev->geo.blocksize);
+		ret = MTD_BWRITE(dev->mtd, base + 1 + nblocks, 1, dev->bytebuffer);
+		if (ret != 1) {
+			goto errout;
+		}
+	}
+
+	for (chunk = 0; chunk < SMART_CKPT_NCHUNKS(dev); chunk++) {
+		dev->ckptcrc[chunk] = smart_ckpt_chunkcrc(dev, chunk);
+	}
+
+	/* The copy becomes valid, and newer than the other one, with its header */
+
+	info.totalsectors = dev->totalsectors;
+	info.neraseblocks = dev->neraseblocks;
+	info.sectorsize = dev->sectorsize;
+	info.reserved = 0;
+	info.bodylen = bodylen;
+	info.bodycrc = crc32(body, bodylen);
+
+	dev->ckptslot = slot;
+	dev->ckptseq++;
+	ret = smart_ckpt_putrec(dev, 0, SMART_CKPT_HEADER, 0, &info, sizeof(info));
+	if (ret != OK) {
+		goto errout;
+	}
+
+	dev->ckptpos = 1 + SMART_CKPT_BODYBLKS(dev);
+	dev->ckptstate = SMART_CKPT_STATE_CLEAN;
+	return OK;
+
+errout:
+	/* The copy we were writing is not valid, and the other one is either
+	 * not valid or marked dirty.
+	 */
+
+	fdbg("Error %d writing map checkpoint\n", ret);
+	dev->ckptstate = SMART_CKPT_STATE_NONE;
+	return ret < 0 ? ret : -EIO;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_flush
+ *
+ * Description: Brings the map checkpoint up to date.  The chunks of the map
+ *              and counts that changed since it was written are appended
+ *              to the journal of the current copy.  If they don't fit, a
+ *              new copy is written.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+static int smart_ckpt_flush(FAR struct smart_struct_s *dev)
+{
+	FAR const uint8_t *body = (FAR const uint8_t *)dev->sMap;
+	uint32_t bodylen = SMART_CKPT_BODYLEN(dev);
+	uint32_t chunklen = SMART_CKPT_CHUNKLEN(dev);
+	uint32_t nchanged;
+	uint32_t crc;
+	uint32_t len;
+	uint16_t chunk;
+	int ret;
+
+	if (dev->ckptslotblks == 0 || dev->ckptstate == SMART_CKPT_STATE_CLEAN || dev->formatstatus != SMART_FMT_STAT_FORMATTED) {
+		return OK;
+	}
+#ifdef CONFIG_MTD_SMART_ENABLE_CRC
+	/* Sectors allocated but not written yet are only mapped in RAM */
+
+	if (dev->allocsector != NULL) {
+		return OK;
+	}
+#endif
+
+	if (dev->ckptstate == SMART_CKPT_STATE_DIRTY) {
+		nchanged = 0;
+		for (chunk = 0; chunk < SMART_CKPT_NCHUNKS(dev); chunk++) {
+			if (smart_ckpt_chunkcrc(dev, chunk) != dev->ckptcrc[chunk]) {
+				nchanged++;
+			}
+		}
+
+		/* Leave room for the next SMART_CKPT_DIRTY record */
+
+		if (dev->ckptpos + nchanged + 2 <= dev->ckptslotlen) {
+			for (chunk = 0; chunk < SMART_CKPT_NCHUNKS(dev); chunk++) {
+				crc = smart_ckpt_chunkcrc(dev, chunk);
+				if (crc == dev->ckptcrc[chunk]) {
+					continue;
+				}
+
+				len = bodylen - chunk * chunklen;
+				if (len > chunklen) {
+					len = chunklen;
+				}
+
+				ret = smart_ckpt_putrec(dev, dev->ckptpos++, SMART_CKPT_CHUNK, chunk, body + chunk * chunklen, len);
+				if (ret != OK) {
+					return ret;
+				}
+
+				dev->ckptcrc[chunk] = crc;
+			}
+
+			ret = smart_ckpt_putrec(dev, dev->ckptpos++, SMART_CKPT_CLEAN, 0, NULL, 0);
+			if (ret != OK) {
+				return ret;
+			}
+
+			dev->ckptstate = SMART_CKPT_STATE_CLEAN;
+			return OK;
+		}
+	}
+
+	return smart_ckpt_write(dev);
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_dirty
+ *
+ * Description: Marks the map checkpoint as out of date.  This must reach
+ *              the device before the first change to it after the
+ *              checkpoint was written.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+static int smart_ckpt_dirty(FAR struct smart_struct_s *dev)
+{
+	if (dev->ckptstate != SMART_CKPT_STATE_CLEAN) {
+		return OK;
+	}
+
+	if (dev->ckptpos < dev->ckptslotlen && smart_ckpt_putrec(dev, dev->ckptpos, SMART_CKPT_DIRTY, 0, NULL, 0) == OK) {
+		dev->ckptpos++;
+		dev->ckptstate = SMART_CKPT_STATE_DIRTY;
+		return OK;
+	}
+
+	/* No room for the record.  Make sure the copy is not used. */
+
+	return smart_ckpt_invalidate(dev);
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_ckpt_load
+ *
+ * Description: Loads the map and counts from the newest copy of the map
+ *              checkpoint and replays its journal.  Fails if there is no
+ *              copy or if the device changed after it was last brought up
+ *              to date, in which case the device must be scanned.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+static int smart_ckpt_load(FAR struct smart_struct_s *dev)
+{
+	FAR struct smart_ckpt_rec_s *rec = (FAR struct smart_ckpt_rec_s *)dev->bytebuffer;
+	FAR struct smart_ckpt_info_s *info = (FAR struct smart_ckpt_info_s *)(rec + 1);
+	FAR uint8_t *body = (FAR uint8_t *)dev->sMap;
+	struct smart_sect_header_s header;
+	uint32_t bodylen = SMART_CKPT_BODYLEN(dev);
+	uint32_t chunklen = SMART_CKPT_CHUNKLEN(dev);
+	uint32_t nblocks = bodylen / dev->geo.blocksize;
+	uint32_t bodycrc = 0;
+	uint32_t base;
+	uint32_t block;
+	uint32_t len;
+	uint16_t physsector;
+	uint16_t x;
+	bool dirty = false;
+	int slot = -1;
+	int ret;
+
+	dev->ckptstate = SMART_CKPT_STATE_NONE;
+	if (dev->ckptslotblks == 0) {
+		return -ENOSYS;
+	}
+
+	/* Find the newest copy written for this geometry */
+
+	for (x = 0; x < 2; x++) {
+		if (smart_ckpt_getrec(dev, x, 0) != OK || rec->type != SMART_CKPT_HEADER) {
+			continue;
+		}
+
+		if (info->totalsectors != dev->totalsectors || info->neraseblocks != dev->neraseblocks || info->sectorsize != dev->sectorsize || info->bodylen != bodylen) {
+			continue;
+		}
+
+		if (slot < 0 || (int32_t)(rec->seq - dev->ckptseq) > 0) {
+			slot = x;
+			dev->ckptseq = rec->seq;
+			bodycrc = info->bodycrc;
+		}
+	}
+
+	if (slot < 0) {
+		fvdbg("No map checkpoint\n");
+		return -ENOENT;
+	}
+
+	dev->ckptslot = slot;
+	base = dev->ckptbase + slot * dev->ckptslotlen;
+
+	/* Read the map and counts */
+
+	if (nblocks > 0 && MTD_BREAD(dev->mtd, base + 1, nblocks, body) != nblocks) {
+		goto errout;
+	}
+
+	if (bodylen > nblocks * dev->geo.blocksize) {
+		if (MTD_BREAD(dev->mtd, base + 1 + nblocks, 1, dev->bytebuffer) != 1) {
+			goto errout;
+		}
+
+		memcpy(body + nblocks * dev->geo.blocksize, dev->bytebuffer, bodylen - nblocks * dev->geo.blocksize);
+	}
+
+	if (crc32(body, bodylen) != bodycrc) {
+		fdbg("Map checkpoint CRC error\n");
+		goto errout;
+	}
+
+	/* Replay the journal up to the first block that is not a valid record.
+	 * Records are written in order, so a record that was cut short by a
+	 * power loss can only be the last one.
+	 */
+
+	ret = -ENOENT;
+	for (block = 1 + SMART_CKPT_BODYBLKS(dev); block < dev->ckptslotlen; block++) {
+		ret = smart_ckpt_getrec(dev, slot, block);
+		if (ret == OK && rec->seq != dev->ckptseq) {
+			ret = -EINVAL;
+		}
+
+		if (ret != OK) {
+			break;
+		}
+
+		if (rec->type == SMART_CKPT_DIRTY) {
+			dirty = true;
+		} else if (rec->type == SMART_CKPT_CLEAN) {
+			dirty = false;
+		} else if (rec->type == SMART_CKPT_CHUNK && rec->index < SMART_CKPT_NCHUNKS(dev)) {
+			len = bodylen - rec->index * chunklen;
+			if (len > chunklen) {
+				len = chunklen;
+			}
+
+			memcpy(body + rec->index * chunklen, rec + 1, len);
+		} else {
+			ret = -EINVAL;
+			break;
+		}
+	}
+
+	if (dirty) {
+		fdbg("Map checkpoint out of date\n");
+		goto errout;
+	}
+
+	/* New records can only be written after the last one if it ended at an
+	 * erased block.  Otherwise the next flush writes a new copy.
+	 */
+
+	dev->ckptpos = ret == -ENOENT ? block : dev->ckptslotlen;
+
+	/* Check the map against the format sector and read the format */
+
+	physsector = dev->sMap[0];
+	if (physsector >= dev->totalsectors) {
+		goto errout;
+	}
+
+	ret = MTD_READ(dev->mtd, physsector * dev->mtdBlksPerSector * dev->geo.blocksize, sizeof(struct smart_sect_header_s), (FAR uint8_t *)&header);
+	if (ret != sizeof(struct smart_sect_header_s) || UINT8TOUINT16(header.logicalsector) != 0 || !SECTOR_IS_COMMITTED(header) || SECTOR_IS_RELEASED(header) || (header.status & SMART_STATUS_VERBITS) != SMART_STATUS_VERSION) {
+		fdbg("Map checkpoint does not match the device\n");
+		goto errout;
+	}
+
+	ret = smart_read_format(dev, physsector);
+	if (ret != OK) {
+		goto errout;
+	}
+
+	/* The totals are the sums of the erase block counts */
+
+	dev->freesectors = 0;
+	dev->releasesectors = 0;
+	for (x = 0; x < dev->neraseblocks; x++) {
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+		dev->freesectors += smart_get_count(dev, dev->freecount, x);
+		dev->releasesectors += smart_get_count(dev, dev->releasecount, x);
+#else
+		dev->freesectors += dev->freecount[x];
+		dev->releasesectors += dev->releasecount[x];
+#endif
+	}
+
+	for (x = 0; x < SMART_CKPT_NCHUNKS(dev); x++) {
+		dev->ckptcrc[x] = smart_ckpt_chunkcrc(dev, x);
+	}
+
+	dev->ckptstate = SMART_CKPT_STATE_CLEAN;
+	fdbg("Loaded map checkpoint %d\n", dev->ckptseq);
+	return OK;
+
+errout:
+	/* Don't leave a copy that the device no longer matches, as the scan and
+	 * the use of the device may change it.
+	 */
+
+	dev->formatstatus = SMART_FMT_STAT_NOFMT;
+	smart_ckpt_invalidate(dev);
+	return -EIO;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_scan
+ *
+ * Description: Performs a scan of the MTD device searching for format
+ *              information and fills in logical sector mapping, freesector
+ *              count, etc.
+ *
+ ****************************************************************************/
+
+static int smart_scan(FAR struct smart_struct_s *dev)
+{
+	int sector;
+	int ret;
+	uint16_t totalsectors;
+	uint16_t sectorsize, prerelease;
+	uint16_t logicalsector;
+	uint16_t loser;
+	uint16_t winner;
+	uint32_t readaddress;
+	uint32_t offset;
+	uint16_t seq1;
+	uint16_t seq2;
+	struct smart_sect_header_s header;
+	uint8_t *sector_seq_log = NULL;
+	bool status_released, status_committed;
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+	int dupsector;
+	uint16_t duplogsector;
+#endif
+#ifdef CONFIG_DEBUG_FS
+	int i;
+#endif
+	fvdbg("Entry\n");
+
+	sectorsize = CONFIG_MTD_SMART_SECTOR_SIZE;
+
+	/* Now set the sectorsize and other sectorsize derived variables */
+
+	ret = smart_setsectorsize(dev, sectorsize);
+	if (ret != OK) {
+		goto err_out;
+	}
+
+	/* Initialize the device variables */
+
+	totalsectors = dev->totalsectors;
+
+	dev->reservedsector = SMART_FIRST_ALLOC_SECTOR;
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+	dev->gcvalid = false;
+#endif
+#ifdef CONFIG_SMARTFS_JOURNALING
+	if (totalsectors > CONFIG_SMARTFS_JOURNALING_THRESHOLD) {
+		dev->reservedsector += 2 * CONFIG_SMARTFS_NLOGGING_SECTORS;
+	}
+#endif
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+	/* The map and counts saved when the device was last synced are good
+	 * unless it changed since.
+	 */
+
+	if (smart_ckpt_load(dev) == OK) {
+		goto scan_done;
+	}
+#endif
+
+	dev->formatstatus = SMART_FMT_STAT_NOFMT;
+	dev->freesectors = dev->availSectPerBlk * dev->geo.neraseblocks;
 	dev->releasesectors = 0;
 
 	/* Initialize the freecount and releasecount arrays */
@@ -2105,54 +3074,10 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 		 */
 
 		if (logicalsector == 0) {
-			/* Read the sector data */
-
-			ret = MTD_READ(dev->mtd, readaddress, 32, (FAR uint8_t *)dev->rwbuffer);
-			if (ret != 32) {
-				fdbg("Error reading physical sector %d.\n", sector);
+			ret = smart_read_format(dev, sector);
+			if (ret != OK) {
 				goto err_out;
 			}
-
-			dev->formatstatus = SMART_FMT_STAT_FORMATTED;
-			dev->namesize = dev->rwbuffer[SMART_FMT_NAMESIZE_POS];
-			dev->formatversion = dev->rwbuffer[SMART_FMT_VERSION_POS];
-
-#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
-			dev->rootdirentries = dev->rwbuffer[SMART_FMT_ROOTDIRS_POS];
-
-			/* If rootdirentries is greater than 1, then we need to register
-			 * additional block devices.
-			 */
-
-			for (x = 1; x < dev->rootdirentries; x++) {
-				if (dev->partname[0] != '\0') {
-					snprintf(dev->rwbuffer, sizeof(devname), "/dev/smart%d%sd%d", dev->minor, dev->partname, x + 1);
-				} else {
-					snprintf(devname, sizeof(devname), "/dev/smart%dd%d", dev->minor, x + 1);
-				}
-
-				/* Inode private data is a reference to a struct containing
-				 * the SMART device structure and the root directory number.
-				 */
-
-				rootdirdev = (struct smart_multiroot_device_s *)smart_malloc(dev, sizeof(*rootdirdev), "Root Dir");
-				if (rootdirdev == NULL) {
-					fdbg("Memory alloc failed\n");
-					ret = -ENOMEM;
-					goto err_out;
-				}
-
-				/* Populate the rootdirdev */
-
-				rootdirdev->dev = dev;
-				rootdirdev->rootdirnum = x;
-				ret = register_blockdriver(dev->rwbuffer, &g_bops, 0, rootdirdev);
-
-				/* Inode private data is a reference to the SMART device structure */
-
-				ret = register_blockdriver(devname, &g_bops, 0, rootdirdev);
-			}
-#endif
 		}
 
 		/* Test for duplicate logical sectors on the device */
@@ -2299,6 +3224,11 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 
 		if (logicalsector < dev->reservedsector) {
 			smart_add_sector_to_cache(dev, logicalsector, winner, __LINE__);
+		} else {
+			/* A duplicate found later replaces this mapping */
+
+			smart_update_cache(dev, logicalsector, winner);
+			smart_cache_prefetch(dev, logicalsector, winner);
 		}
 #endif
 	}
@@ -2367,6 +3297,9 @@ static int smart_scan(FAR struct smart_struct_s *dev)
 #endif							/* CONFIG_MTD_SMART_CONVERT_WEAR_FORMAT */
 #endif							/* CONFIG_MTD_SMART_WEAR_LEVEL && SMART_STATUS_VERSION == 1 */
 
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+scan_done:
+#endif
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
 	/* Read the wear leveling status bits */
 
@@ -2525,6 +3458,9 @@ static void smart_erase_block_if_empty(FAR struct smart_struct_s *dev, uint16_t
 		dev->releasecount[block] = prerelease;
 		dev->freecount[block] = dev->availSectPerBlk - prerelease;
 #endif							/* CONFIG_MTD_SMART_PACK_COUNTS */
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+		smart_gc_update(dev, block);
+#endif
 
 		/* Now that we have erased this block and updated the release / free counts,
 		 * if we are in WEAR LEVELING enabled mode, we must check if this erase block's
@@ -3423,6 +4359,9 @@ static int smart_relocate_block(FAR struct smart_struct_s *dev, uint16_t block)
 	dev->freecount[block] = dev->availSectPerBlk - prerelease;
 	dev->releasecount[block] = prerelease;
 #endif
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+	smart_gc_update(dev, block);
+#endif
 
 #ifdef CONFIG_SMART_LOCAL_CHECKFREE
 	if (smart_checkfree(dev, __LINE__) != OK) {
@@ -3586,139 +4525,468 @@ retry:
 		} else
 #endif
 
-		{
-			fdbg("Program bug!  Expected a free sector, free=%d\n", dev->freesectors);
-			for (x = 0; x < dev->neraseblocks; x++) {
-				fdbg("%d ", dev->freecount[x]);
-			}
-
-			/* No free sectors found!  Bug? */
+		{
+			fdbg("Program bug!  Expected a free sector, free=%d\n", dev->freesectors);
+			for (x = 0; x < dev->neraseblocks; x++) {
+				fdbg("%d ", dev->freecount[x]);
+			}
+
+			/* No free sectors found!  Bug? */
+
+			return -1;
+		}
+	}
+
+	/* Now find a free physical sector within this selected erase block to allocate. */
+	sector_buff = (uint8_t *)zalloc(dev->mtdBlksPerSector * dev->geo.blocksize);
+	if (sector_buff == NULL) {
+		fdbg("sector_buff allocation fail\n");
+		return physicalsector;
+	}
+
+	for (x = allocblock * dev->sectorsPerBlk; x < allocblock * dev->sectorsPerBlk + dev->availSectPerBlk; x++) {
+		/* Check if this physical sector is available. */
+
+#ifdef CONFIG_MTD_SMART_ENABLE_CRC
+		/* First check if there is a temporary alloc in place */
+
+		FAR struct smart_allocsector_s *allocsect;
+		allocsect = dev->allocsector;
+
+		while (allocsect) {
+			if (allocsect->physical == x) {
+				break;
+			}
+			allocsect = allocsect->next;
+		}
+
+		/* If we found this physical sector above, then continue on
+		 * to the next physical sector in this block ... this one has
+		 * a temporary allocation assigned.
+		 */
+
+		if (allocsect) {
+			continue;
+		}
+#endif
+
+		/* Now check on the physical media */
+
+		readaddr = x * dev->mtdBlksPerSector * dev->geo.blocksize;
+		ret = MTD_READ(dev->mtd, readaddr, sizeof(struct smart_sect_header_s), (FAR uint8_t *)&header);
+		if (ret != sizeof(struct smart_sect_header_s)) {
+			fdbg("Error reading phys sector %d\n", physicalsector);
+			free(sector_buff);
+			return -1;
+		}
+		if ((UINT8TOUINT16(header.logicalsector) == 0xFFFF) &&
+#if SMART_STATUS_VERSION == 1
+			((header.seq == 0xFF) && (header.crc8 == 0xFF)) &&
+#else
+			(header.seq == CONFIG_SMARTFS_ERASEDSTATE) &&
+#endif
+			(!(SECTOR_IS_COMMITTED(header)))) {
+#ifdef CONFIG_SMARTFS_BAD_SECTOR
+			if (dev->badSectorList[x] == FALSE) {
+#endif
+				ret = MTD_READ(dev->mtd, readaddr, dev->mtdBlksPerSector * dev->geo.blocksize, sector_buff);
+				for (i = 0; i < dev->mtdBlksPerSector * dev->geo.blocksize; i++) {
+					if (sector_buff[i] != 0xff)
+						break;
+				}
+
+				if (i == dev->mtdBlksPerSector * dev->geo.blocksize) {
+					physicalsector = x;
+					dev->lastallocblock = allocblock;
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+					dev->gcstamp[allocblock] = dev->gcclock++;
+#endif
+					break;
+				} else {
+					bitflipped = TRUE;
+					fdbg("bit flip occur %d offset %d byte %x\n", x, i, sector_buff[i]);
+					fdbg("set Released and committed to Erase%d\n", x);
+#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
+					header.status = header.status & ~(SMART_STATUS_COMMITTED | SMART_STATUS_RELEASED);
+#else
+					header.status = header.status | SMART_STATUS_COMMITTED | SMART_STATUS_RELEASED;
+#endif
+					ret = smart_bytewrite(dev, readaddr + offsetof(struct smart_sect_header_s, status), 1, &header.status);
+					if (ret < 0) {
+						fdbg("Error %d releasing corrupted sector\n", -ret);
+						goto error;
+					}
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+					smart_add_count(dev, dev->freecount, x / dev->sectorsPerBlk, -1);
+					smart_add_count(dev, dev->releasecount, allocblock, 1);
+#else
+					dev->freecount[x / dev->sectorsPerBlk]--;
+					dev->releasecount[allocblock]++;
+#endif
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+					smart_gc_update(dev, allocblock);
+#endif
+					dev->freesectors--;
+					dev->releasesectors++;
+				}
+#ifdef CONFIG_SMARTFS_BAD_SECTOR
+			}
+#endif
+		}
+	}
+
+error:
+	if (physicalsector == 0xFFFF) {
+		if (bitflipped) {
+			fdbg("retry allocation\n");
+			canrelocate = FALSE;
+			free(sector_buff);
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+			goto retry;
+#endif
+		}
+		dbg("Program bug!  Expected a free sector %d\n", allocblock);
+	}
+
+	if (physicalsector >= dev->totalsectors) {
+		if (bitflipped) {
+			fdbg("retry allocation\n");
+			canrelocate = FALSE;
+			free(sector_buff);
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+			goto retry;
+#endif
+		}
+		dbg("Program bug!  Selected sector too big!!!\n");
+	}
+
+	free(sector_buff);
+
+	return physicalsector;
+}
+
+/****************************************************************************
+ * Name: smart_gc_score
+ *
+ * Description:  Computes how worthwhile collecting an erase block is: the
+ *               released sectors it gives back, weighted by the age of the
+ *               data in it, per sector read and written to relocate it.
+ *               Zero if the block can't be collected.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+static uint16_t smart_gc_score(FAR struct smart_struct_s *dev, uint16_t block)
+{
+	uint16_t released;
+	uint16_t live;
+	uint16_t age;
+	uint32_t score;
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+	released = smart_get_count(dev, dev->releasecount, block);
+	live = dev->availSectPerBlk - released - smart_get_count(dev, dev->freecount, block);
+#else
+	released = dev->releasecount[block];
+	live = dev->availSectPerBlk - released - dev->freecount[block];
+#endif
+
+	if (released == 0 || live > dev->availSectPerBlk) {
+		return 0;
+	}
+
+	/* The age is the number of sectors written anywhere since the block was
+	 * last written to.  Only its order of magnitude counts, so that old
+	 * blocks don't win with a single released sector.
+	 */
+
+	age = dev->gcclock - dev->gcstamp[block];
+	score = ((uint32_t)released * (32 - __builtin_clz((uint32_t)age + 1)) << 8) / (dev->availSectPerBlk + live);
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+	/* Don't collect blocks that have been worn completely.  Evening out the
+	 * wear of the others is left to the static data relocation.
+	 */
+
+	if (smart_get_wear_level(dev, block) >= SMART_WEAR_REORG_THRESHOLD) {
+		return 0;
+	}
+#endif
+
+	return (uint16_t)score + 1;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_gc_siftup / smart_gc_siftdown
+ *
+ * Description:  Restore the order of the garbage collection heap after the
+ *               key of the block at the given index went up or down.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+static void smart_gc_siftup(FAR struct smart_struct_s *dev, uint16_t index)
+{
+	uint16_t block = dev->gcheap[index];
+	uint16_t parent;
+
+	while (index > 0) {
+		parent = (index - 1) >> 1;
+		if (dev->gckey[dev->gcheap[parent]] >= dev->gckey[block]) {
+			break;
+		}
+
+		dev->gcheap[index] = dev->gcheap[parent];
+		dev->gcpos[dev->gcheap[index]] = index;
+		index = parent;
+	}
+
+	dev->gcheap[index] = block;
+	dev->gcpos[block] = index;
+}
+
+static void smart_gc_siftdown(FAR struct smart_struct_s *dev, uint16_t index)
+{
+	uint16_t block = dev->gcheap[index];
+	uint32_t child;
+
+	while ((child = ((uint32_t)index << 1) + 1) < dev->neraseblocks) {
+		if (child + 1 < dev->neraseblocks && dev->gckey[dev->gcheap[child + 1]] > dev->gckey[dev->gcheap[child]]) {
+			child++;
+		}
+
+		if (dev->gckey[dev->gcheap[child]] <= dev->gckey[block]) {
+			break;
+		}
+
+		dev->gcheap[index] = dev->gcheap[child];
+		dev->gcpos[dev->gcheap[index]] = index;
+		index = child;
+	}
+
+	dev->gcheap[index] = block;
+	dev->gcpos[block] = index;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_gc_build
+ *
+ * Description:  Scores all erase blocks and orders them in the garbage
+ *               collection heap.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+static void smart_gc_build(FAR struct smart_struct_s *dev)
+{
+	uint16_t block;
+	int x;
+
+	for (block = 0; block < dev->neraseblocks; block++) {
+		/* Keep the age of blocks not written to for long from wrapping */
+
+		if ((uint16_t)(dev->gcclock - dev->gcstamp[block]) > 0x8000) {
+			dev->gcstamp[block] = dev->gcclock - 0x8000;
+		}
+
+		dev->gcheap[block] = block;
+		dev->gcpos[block] = block;
+		dev->gckey[block] = smart_gc_score(dev, block);
+	}
+
+	for (x = (dev->neraseblocks >> 1) - 1; x >= 0; x--) {
+		smart_gc_siftdown(dev, x);
+	}
+
+	dev->gcbuilt = dev->gcclock;
+	dev->gcvalid = true;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_gc_update
+ *
+ * Description:  Scores an erase block again after sectors in it were
+ *               released or it was erased.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+static void smart_gc_update(FAR struct smart_struct_s *dev, uint16_t block)
+{
+	uint16_t key;
+
+	if (!dev->gcvalid) {
+		return;
+	}
+
+	key = smart_gc_score(dev, block);
+	if (key > dev->gckey[block]) {
+		dev->gckey[block] = key;
+		smart_gc_siftup(dev, dev->gcpos[block]);
+	} else if (key < dev->gckey[block]) {
+		dev->gckey[block] = key;
+		smart_gc_siftdown(dev, dev->gcpos[block]);
+	}
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_gc_select
+ *
+ * Description:  Returns the erase block most worth collecting, or 0xFFFF
+ *               if there is none.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+static uint16_t smart_gc_select(FAR struct smart_struct_s *dev)
+{
+	uint16_t block;
+	uint16_t key;
+	uint16_t freecount;
+
+	/* The ages only grow, so the whole heap is scored again after as many
+	 * sectors were written as there are erase blocks.
+	 */
+
+	if (!dev->gcvalid || (uint16_t)(dev->gcclock - dev->gcbuilt) >= dev->neraseblocks) {
+		smart_gc_build(dev);
+	}
+
+	/* Writes to a block lower its score without updating the heap.  Fix
+	 * the top until its key is right.
+	 */
+
+	for (;;) {
+		block = dev->gcheap[0];
+		key = smart_gc_score(dev, block);
+		if (key >= dev->gckey[block]) {
+			dev->gckey[block] = key;
+			break;
+		}
+
+		dev->gckey[block] = key;
+		smart_gc_siftdown(dev, 0);
+	}
+
+	if (key == 0) {
+		return 0xFFFF;
+	}
+
+	/* Don't relocate the only block with free sectors, take the next best
+	 * block instead, which is one of the children of the top.
+	 */
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+	freecount = smart_get_count(dev, dev->freecount, block);
+#else
+	freecount = dev->freecount[block];
+#endif
+
+	if (freecount >= dev->freesectors) {
+		if (dev->neraseblocks < 2) {
+			return 0xFFFF;
+		}
 
-			return -1;
+		block = dev->gcheap[1];
+		if (dev->neraseblocks > 2 && dev->gckey[dev->gcheap[2]] > dev->gckey[block]) {
+			block = dev->gcheap[2];
 		}
-	}
 
-	/* Now find a free physical sector within this selected erase block to allocate. */
-	sector_buff = (uint8_t *)zalloc(dev->mtdBlksPerSector * dev->geo.blocksize);
-	if (sector_buff == NULL) {
-		fdbg("sector_buff allocation fail\n");
-		return physicalsector;
+		if (smart_gc_score(dev, block) == 0) {
+			return 0xFFFF;
+		}
 	}
 
-	for (x = allocblock * dev->sectorsPerBlk; x < allocblock * dev->sectorsPerBlk + dev->availSectPerBlk; x++) {
-		/* Check if this physical sector is available. */
+	return block;
+}
+#endif
 
-#ifdef CONFIG_MTD_SMART_ENABLE_CRC
-		/* First check if there is a temporary alloc in place */
+/****************************************************************************
+ * Name: smart_collectblock
+ *
+ * Description:  Relocates the live sectors of the erase block most worth
+ *               collecting and erases it.
+ *
+ ****************************************************************************/
 
-		FAR struct smart_allocsector_s *allocsect;
-		allocsect = dev->allocsector;
+#ifdef CONFIG_FS_WRITABLE
+static int smart_collectblock(FAR struct smart_struct_s *dev)
+{
+	uint16_t collectblock;
+	int ret;
+#ifndef CONFIG_MTD_SMART_GC_COSTBENEFIT
+	uint16_t releasemax;
+	int x;
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+	uint8_t count;
+#endif
+#endif
 
-		while (allocsect) {
-			if (allocsect->physical == x) {
-				break;
-			}
-			allocsect = allocsect->next;
-		}
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+	collectblock = smart_gc_select(dev);
+#else
+	/* Find the block with the most released sectors */
 
-		/* If we found this physical sector above, then continue on
-		 * to the next physical sector in this block ... this one has
-		 * a temporary allocation assigned.
-		 */
+	collectblock = 0xFFFF;
+	releasemax = 0;
+	for (x = 0; x < dev->neraseblocks; x++) {
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+		/* Don't collect blocks that have been worn completely */
 
-		if (allocsect) {
+		if (smart_get_wear_level(dev, x) >= SMART_WEAR_REORG_THRESHOLD) {
 			continue;
 		}
 #endif
 
-		/* Now check on the physical media */
-
-		readaddr = x * dev->mtdBlksPerSector * dev->geo.blocksize;
-		ret = MTD_READ(dev->mtd, readaddr, sizeof(struct smart_sect_header_s), (FAR uint8_t *)&header);
-		if (ret != sizeof(struct smart_sect_header_s)) {
-			fdbg("Error reading phys sector %d\n", physicalsector);
-			free(sector_buff);
-			return -1;
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+		count = smart_get_count(dev, dev->releasecount, x);
+		if (count > releasemax) {
+			releasemax = count;
+			collectblock = x;
 		}
-		if ((UINT8TOUINT16(header.logicalsector) == 0xFFFF) &&
-#if SMART_STATUS_VERSION == 1
-			((header.seq == 0xFF) && (header.crc8 == 0xFF)) &&
 #else
-			(header.seq == CONFIG_SMARTFS_ERASEDSTATE) &&
+		if (dev->releasecount[x] > releasemax) {
+			releasemax = dev->releasecount[x];
+			collectblock = x;
+		}
 #endif
-			(!(SECTOR_IS_COMMITTED(header)))) {
-#ifdef CONFIG_SMARTFS_BAD_SECTOR
-			if (dev->badSectorList[x] == FALSE) {
+	}
 #endif
-				ret = MTD_READ(dev->mtd, readaddr, dev->mtdBlksPerSector * dev->geo.blocksize, sector_buff);
-				for (i = 0; i < dev->mtdBlksPerSector * dev->geo.blocksize; i++) {
-					if (sector_buff[i] != 0xff)
-						break;
-				}
 
-				if (i == dev->mtdBlksPerSector * dev->geo.blocksize) {
-					physicalsector = x;
-					dev->lastallocblock = allocblock;
-					break;
-				} else {
-					bitflipped = TRUE;
-					fdbg("bit flip occur %d offset %d byte %x\n", x, i, sector_buff[i]);
-					fdbg("set Released and committed to Erase%d\n", x);
-#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
-					header.status = header.status & ~(SMART_STATUS_COMMITTED | SMART_STATUS_RELEASED);
-#else
-					header.status = header.status | SMART_STATUS_COMMITTED | SMART_STATUS_RELEASED;
+	if (collectblock == 0xFFFF) {
+		/* Need to collect, but no sectors with released blocks! */
+
+		return -ENOSPC;
+	}
+#ifdef CONFIG_SMART_LOCAL_CHECKFREE
+	if (smart_checkfree(dev, __LINE__) != OK) {
+		fdbg("   ...before collecting block %d\n", collectblock);
+	}
 #endif
-					ret = smart_bytewrite(dev, readaddr + offsetof(struct smart_sect_header_s, status), 1, &header.status);
-					if (ret < 0) {
-						fdbg("Error %d releasing corrupted sector\n", -ret);
-						goto error;
-					}
+
 #ifdef CONFIG_MTD_SMART_PACK_COUNTS
-					smart_add_count(dev, dev->freecount, x / dev->sectorsPerBlk, -1);
-					smart_add_count(dev, dev->releasecount, allocblock, 1);
+	fvdbg("Collecting block %d, free=%d released=%d, totalfree=%d, totalrelease=%d\n", collectblock, smart_get_count(dev, dev->freecount, collectblock), smart_get_count(dev, dev->releasecount, collectblock), dev->freesectors, dev->releasesectors);
 #else
-					dev->freecount[x / dev->sectorsPerBlk]--;
-					dev->releasecount[allocblock]++;
-#endif
-					dev->freesectors--;
-					dev->releasesectors++;
-				}
-#ifdef CONFIG_SMARTFS_BAD_SECTOR
-			}
+	fvdbg("Collecting block %d, free=%d released=%d\n", collectblock, dev->freecount[collectblock], dev->releasecount[collectblock]);
 #endif
-		}
-	}
 
-error:
-	if (physicalsector == 0xFFFF) {
-		if (bitflipped) {
-			fdbg("retry allocation\n");
-			canrelocate = FALSE;
-			free(sector_buff);
-#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
-			goto retry;
-#endif
-		}
-		dbg("Program bug!  Expected a free sector %d\n", allocblock);
-	}
+	/* Relocate the active data in the collection block */
 
-	if (physicalsector >= dev->totalsectors) {
-		if (bitflipped) {
-			fdbg("retry allocation\n");
-			canrelocate = FALSE;
-			free(sector_buff);
-#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
-			goto retry;
-#endif
-		}
-		dbg("Program bug!  Selected sector too big!!!\n");
-	}
+	ret = smart_relocate_block(dev, collectblock);
 
-	free(sector_buff);
+#ifdef CONFIG_SMART_LOCAL_CHECKFREE
+	if (smart_checkfree(dev, __LINE__) != OK) {
+		fdbg("   ...while collecting block %d\n", collectblock);
+	}
+#endif
 
-	return physicalsector;
+	return ret;
 }
+#endif							/* CONFIG_FS_WRITABLE */
 
 /****************************************************************************
  * Name: smart_garbagecollect
@@ -3732,14 +5000,8 @@ error:
 #ifdef CONFIG_FS_WRITABLE
 static int smart_garbagecollect(FAR struct smart_struct_s *dev)
 {
-	uint16_t collectblock;
-	uint16_t releasemax;
 	bool collect = TRUE;
-	int x;
 	int ret;
-#ifdef CONFIG_MTD_SMART_PACK_COUNTS
-	uint8_t count;
-#endif
 
 	while (collect) {
 		collect = FALSE;
@@ -3761,62 +5023,7 @@ static int smart_garbagecollect(FAR struct smart_struct_s *dev)
 		/* Test if we need to garbage collect */
 
 		if (collect) {
-			/* Find the block with the most released sectors */
-
-			collectblock = 0xFFFF;
-			releasemax = 0;
-			for (x = 0; x < dev->neraseblocks; x++) {
-#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
-				/* Don't collect blocks that have been worn completely */
-
-				if (smart_get_wear_level(dev, x) >= SMART_WEAR_REORG_THRESHOLD) {
-					continue;
-				}
-#endif
-
-#ifdef CONFIG_MTD_SMART_PACK_COUNTS
-				count = smart_get_count(dev, dev->releasecount, x);
-				if (count > releasemax) {
-					releasemax = count;
-					collectblock = x;
-				}
-#else
-				if (dev->releasecount[x] > releasemax) {
-					releasemax = dev->releasecount[x];
-					collectblock = x;
-				}
-#endif
-			}
-			//releasemax = smart_get_count(dev, dev->releasecount, collectblock);
-
-			if (collectblock == 0xFFFF) {
-				/* Need to collect, but no sectors with released blocks! */
-
-				ret = -ENOSPC;
-				goto errout;
-			}
-#ifdef CONFIG_SMART_LOCAL_CHECKFREE
-			if (smart_checkfree(dev, __LINE__) != OK) {
-				fdbg("   ...before collecting block %d\n", collectblock);
-			}
-#endif
-
-#ifdef CONFIG_MTD_SMART_PACK_COUNTS
-			fvdbg("Collecting block %d, free=%d released=%d, totalfree=%d, totalrelease=%d\n", collectblock, smart_get_count(dev, dev->freecount, collectblock), smart_get_count(dev, dev->releasecount, collectblock), dev->freesectors, dev->releasesectors);
-#else
-			fvdbg("Collecting block %d, free=%d released=%d\n", collectblock, dev->freecount[collectblock], dev->releasecount[collectblock]);
-#endif
-
-			/* Relocate the active data in the collection block */
-
-			ret = smart_relocate_block(dev, collectblock);
-
-#ifdef CONFIG_SMART_LOCAL_CHECKFREE
-			if (smart_checkfree(dev, __LINE__) != OK) {
-				fdbg("   ...while collecting block %d\n", collectblock);
-			}
-#endif
-
+			ret = smart_collectblock(dev);
 			if (ret != OK) {
 				goto errout;
 			}
@@ -4493,6 +5700,9 @@ relocate_good_sector:
 #else
 		dev->releasecount[block]++;
 		dev->freecount[physsector / dev->sectorsPerBlk]--;
+#endif
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+		smart_gc_update(dev, block);
 #endif
 		dev->freesectors--;
 		dev->releasesectors++;
@@ -4613,6 +5823,9 @@ errout:
 #else
 		dev->releasecount[block]++;
 		dev->freecount[physsector / dev->sectorsPerBlk]--;
+#endif
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+		smart_gc_update(dev, block);
 #endif
 		dev->freesectors--;
 		dev->releasesectors++;
@@ -5080,6 +6293,9 @@ static inline int smart_freesector(FAR struct smart_struct_s *dev, unsigned long
 #else
 	dev->releasecount[block]++;
 #endif
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+	smart_gc_update(dev, block);
+#endif
 
 	/* Unmap this logical sector */
 
@@ -5100,6 +6316,75 @@ errout:
 }
 #endif							/* CONFIG_FS_WRITABLE */
 
+/****************************************************************************
+ * Name: smart_gc_worker
+ *
+ * Description:  Collects garbage on the low priority work queue, one erase
+ *               block per run, until the free sectors reach the reserve.
+ *               It waits for the device to have been idle for a while
+ *               first, and stops as soon as it is used again.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_GC_BACKGROUND
+static void smart_gc_worker(FAR void *arg)
+{
+	FAR struct smart_struct_s *dev = (FAR struct smart_struct_s *)arg;
+	uint32_t delay = MSEC2TICK(CONFIG_MTD_SMART_GC_DELAY);
+	uint32_t idle;
+
+	smart_semtake(dev);
+
+	/* Stop when there is too little garbage to be worth moving a block of
+	 * live data for.  Writes will collect it if they have to.
+	 */
+
+	if (dev->formatstatus != SMART_FMT_STAT_FORMATTED || dev->freesectors >= SMART_GC_RESERVE(dev) || dev->releasesectors < dev->sectorsPerBlk) {
+		goto out;
+	}
+
+	idle = clock_systimer() - dev->gclastwrite;
+	if (idle < delay) {
+		delay -= idle;
+	} else {
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+		if (smart_ckpt_dirty(dev) != OK) {
+			goto out;
+		}
+#endif
+
+		if (smart_collectblock(dev) != OK) {
+			goto out;
+		}
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+		if (dev->wearflags & SMART_WEARFLAGS_WRITE_NEEDED) {
+			/* Write new wear status bits to the device */
+
+			smart_write_wearstatus(dev);
+		}
+#endif
+
+		if (dev->freesectors >= SMART_GC_RESERVE(dev)) {
+			goto out;
+		}
+
+		/* Go on with the next block while the device stays idle */
+
+		delay = 0;
+	}
+
+	/* A write may have queued the work again while this waited */
+
+	if (work_available(&dev->gcwork)) {
+		work_queue(LPWORK, &dev->gcwork, smart_gc_worker, dev, delay);
+	}
+
+out:
+	smart_semgive(dev);
+}
+#endif
+
 /****************************************************************************
  * Name: smart_ioctl
  *
@@ -5124,6 +6409,21 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 	dev = (FAR struct smart_struct_s *)inode->i_private;
 #endif
 
+	smart_semtake(dev);
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+	/* The map checkpoint must be marked out of date before the first
+	 * change to the device.
+	 */
+
+	if (cmd == BIOC_LLFORMAT || cmd == BIOC_ALLOCSECT || cmd == BIOC_FREESECT || cmd == BIOC_WRITESECT) {
+		ret = smart_ckpt_dirty(dev);
+		if (ret != OK) {
+			goto ok_out;
+		}
+	}
+#endif
+
 	/* Process the ioctl's we care about first, pass any we don't respond
 	 * to directly to the underlying MTD device.
 	 */
@@ -5138,7 +6438,8 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 #ifdef CONFIG_DEBUG
 		if (arg == 0) {
 			fdbg("ERROR: BIOC_XIPBASE argument is NULL\n");
-			return -EINVAL;
+			ret = -EINVAL;
+			goto ok_out;
 		}
 #endif
 
@@ -5170,6 +6471,15 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 		/* Perform a low-level format on the flash */
 
 		ret = smart_llformat(dev, arg);
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+
+		/* The bulk erase also erased the map checkpoint */
+
+		dev->ckptstate = SMART_CKPT_STATE_NONE;
+#endif
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+		dev->gcvalid = false;
+#endif
 		goto ok_out;
 
 	case BIOC_ALLOCSECT:
@@ -5201,6 +6511,15 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 #endif
 
 		goto ok_out;
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+	case BIOC_FLUSH:
+
+		/* Bring the map checkpoint up to date */
+
+		ret = smart_ckpt_flush(dev);
+		goto ok_out;
+#endif
 #endif							/* CONFIG_FS_WRITABLE */
 
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
@@ -5237,6 +6556,12 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 #endif
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
 		procfs_data->uneven_wearcount = dev->uneven_wearcount;
+#endif
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+		procfs_data->cachehits = dev->cache_hits;
+		procfs_data->cachemisses = dev->cache_misses;
+		procfs_data->cachescanreads = dev->cache_scanreads;
+		procfs_data->cacheprefetches = dev->cache_prefetches;
 #endif
 		ret = OK;
 		goto ok_out;
@@ -5270,6 +6595,18 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 	}
 
 ok_out:
+#ifdef CONFIG_MTD_SMART_GC_BACKGROUND
+	/* Collect garbage in the background once the writes pause */
+
+	if (cmd == BIOC_ALLOCSECT || cmd == BIOC_FREESECT || cmd == BIOC_WRITESECT) {
+		dev->gclastwrite = clock_systimer();
+		if (dev->freesectors < SMART_GC_RESERVE(dev) && work_available(&dev->gcwork)) {
+			work_queue(LPWORK, &dev->gcwork, smart_gc_worker, dev, MSEC2TICK(CONFIG_MTD_SMART_GC_DELAY));
+		}
+	}
+#endif
+
+	smart_semgive(dev);
 	return ret;
 }
 
@@ -5358,11 +6695,22 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, FAR const char *partn
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
 		dev->erasecounts = NULL;
 #endif
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+		dev->gcheap = NULL;
+#endif
+#ifdef CONFIG_MTD_SMART_GC_BACKGROUND
+		sem_init(&dev->exclsem, 0, 1);
+		memset(&dev->gcwork, 0, sizeof(struct work_s));
+		dev->gclastwrite = 0;
+#endif
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
 		dev->wearstatus = NULL;
 #endif
 #ifdef CONFIG_MTD_SMART_ENABLE_CRC
 		dev->allocsector = NULL;
+#endif
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+		smart_ckpt_reserve(dev);
 #endif
 		dev->sectorsize = 0;
 		ret = smart_setsectorsize(dev, CONFIG_MTD_SMART_SECTOR_SIZE);
@@ -5590,6 +6938,12 @@ int smart_recoversectors(FAR struct inode *inode, char *validsectors, int *nobso
 			header.status &= ~SMART_STATUS_RELEASED;
 #else
 			header.status |= SMART_STATUS_RELEASED;
+#endif
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+			ret = smart_ckpt_dirty(dev);
+			if (ret < 0) {
+				goto err_out;
+			}
 #endif
 			offset = readaddress + offsetof(struct smart_sect_header_s, status);
 			ret = smart_bytewrite(dev, offset, 1, &header.status);
@@ -5605,6 +6959,9 @@ int smart_recoversectors(FAR struct inode *inode, char *validsectors, int *nobso
 #else
 			dev->releasecount[block]++;
 #endif
+#ifdef CONFIG_MTD_SMART_GC_COSTBENEFIT
+			smart_gc_update(dev, block);
+#endif
 
 			/* if the mapping is sane, Unmap this logical->physicalsector map */
 			if (physsector == sector) {
@@ -94,6 +94,7 @@
 
 extern const struct procfs_operations proc_operations;
 extern const struct procfs_operations cpuload_operations;
+extern const struct procfs_operations latency_operations;
 extern const struct procfs_operations uptime_operations;
 extern const struct procfs_operations version_operations;
 
@@ -106,6 +107,10 @@ extern const struct procfs_operations part_procfsoperations;
 extern const struct procfs_operations smartfs_procfsoperations;
 extern const struct procfs_operations power_procfsoperations;
 extern const struct procfs_operations cm_operations;
+extern const struct procfs_operations ili9341_procfsoperations;
+extern const struct procfs_operations ra8875_procfsoperations;
+extern const struct procfs_operations nxshadowfb_procfsoperations;
+extern const struct procfs_operations vnc_procfsoperations;
 
 /* And even worse, this one is specific to the STM32.  The solution to
  * this nasty couple would be to replace this hard-coded, ROM-able
@@ -127,6 +132,10 @@ static const struct procfs_entry_s g_procfsentries[] = {
 	{"cpuload", &cpuload_operations},
 #endif
 
+#if defined(CONFIG_SCHED_LATENCY) && !defined(CONFIG_FS_PROCFS_EXCLUDE_LATENCY)
+	{"latency", &latency_operations},
+#endif
+
 #if defined(CONFIG_FS_SMARTFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
 	{"fs/smartfs**", &smartfs_procfsoperations},
 #endif
@@ -143,6 +152,22 @@ static const struct procfs_entry_s g_procfsentries[] = {
 	{"power/domains**", &power_procfsoperations},
 #endif
 
+#if defined(CONFIG_NX_SHADOWFB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_NXSHADOWFB)
+	{"nxshadowfb", &nxshadowfb_procfsoperations},
+#endif
+
+#if defined(CONFIG_VNCSERVER) && !defined(CONFIG_FS_PROCFS_EXCLUDE_VNC)
+	{"vnc", &vnc_procfsoperations},
+#endif
+
+#if defined(CONFIG_LCD_ILI9341) && !defined(CONFIG_FS_PROCFS_EXCLUDE_ILI9341)
+	{"ili9341", &ili9341_procfsoperations},
+#endif
+
+#if defined(CONFIG_LCD_RA8875_REGSTATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_RA8875)
+	{"ra8875", &ra8875_procfsoperations},
+#endif
+
 #if !defined(CONFIG_FS_PROCFS_EXCLUDE_UPTIME)
 	{"uptime", &uptime_operations},
 #endif
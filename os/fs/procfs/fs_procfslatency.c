@@ -0,0 +1,280 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * fs/procfs/fs_procfslatency.c
+ *
+ * /proc/latency shows the scheduling latency statistics of all threads
+ * since boot.  /proc/<pid>/schedstat shows those of one thread.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <sys/statfs.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/sched.h>
+#include <tinyara/kmalloc.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_SCHED_LATENCY) && !defined(CONFIG_FS_PROCFS_EXCLUDE_LATENCY)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* Determines the size of an intermediate buffer that must be large enough
+ * to handle the longest line generated by this logic.
+ */
+
+#define LATENCY_LINELEN 32
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct latency_file_s {
+	struct procfs_file_s base;	/* Base open file structure */
+	struct sched_latency_s latency;	/* Statistics sampled at f_pos == 0 */
+	char line[LATENCY_LINELEN];	/* Pre-allocated buffer for formatted lines */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int latency_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode);
+static int latency_close(FAR struct file *filep);
+static ssize_t latency_read(FAR struct file *filep, FAR char *buffer, size_t buflen);
+static int latency_dup(FAR const struct file *oldp, FAR struct file *newp);
+static int latency_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations latency_operations = {
+	latency_open,				/* open */
+	latency_close,				/* close */
+	latency_read,				/* read */
+	NULL,						/* write */
+
+	latency_dup,				/* dup */
+
+	NULL,						/* opendir */
+	NULL,						/* closedir */
+	NULL,						/* readdir */
+	NULL,						/* rewinddir */
+
+	latency_stat				/* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: latency_open
+ ****************************************************************************/
+
+static int latency_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode)
+{
+	FAR struct latency_file_s *attr;
+
+	fvdbg("Open '%s'\n", relpath);
+
+	/* PROCFS is read-only.  Any attempt to open with any kind of write
+	 * access is not permitted.
+	 */
+
+	if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0) {
+		fdbg("ERROR: Only O_RDONLY supported\n");
+		return -EACCES;
+	}
+
+	/* "latency" is the only acceptable value for the relpath */
+
+	if (strcmp(relpath, "latency") != 0) {
+		fdbg("ERROR: relpath is '%s'\n", relpath);
+		return -ENOENT;
+	}
+
+	/* Allocate a container to hold the file attributes */
+
+	attr = (FAR struct latency_file_s *)kmm_zalloc(sizeof(struct latency_file_s));
+	if (!attr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* Save the attributes as the open-specific state in filep->f_priv */
+
+	filep->f_priv = (FAR void *)attr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: latency_close
+ ****************************************************************************/
+
+static int latency_close(FAR struct file *filep)
+{
+	FAR struct latency_file_s *attr;
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct latency_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Release the file attributes structure */
+
+	kmm_free(attr);
+	filep->f_priv = NULL;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: latency_read
+ ****************************************************************************/
+
+static ssize_t latency_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
+{
+	FAR struct latency_file_s *attr;
+	off_t offset;
+	ssize_t ret;
+
+	fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct latency_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Sample the statistics when reading from the start, so that they stay
+	 * consistent if the user reads the file in pieces.
+	 */
+
+	if (filep->f_pos == 0) {
+		ret = sched_latency(-1, &attr->latency);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	offset = filep->f_pos;
+	ret = procfs_latency(&attr->latency, attr->line, LATENCY_LINELEN, buffer, buflen, &offset);
+
+	/* Update the file offset */
+
+	if (ret > 0) {
+		filep->f_pos += ret;
+	}
+
+	return ret;
+}
+
+/****************************************************************************
+ * Name: latency_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int latency_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+	FAR struct latency_file_s *oldattr;
+	FAR struct latency_file_s *newattr;
+
+	fvdbg("Dup %p->%p\n", oldp, newp);
+
+	/* Recover our private data from the old struct file instance */
+
+	oldattr = (FAR struct latency_file_s *)oldp->f_priv;
+	DEBUGASSERT(oldattr);
+
+	/* Allocate a new container to hold the task and attribute selection */
+
+	newattr = (FAR struct latency_file_s *)kmm_malloc(sizeof(struct latency_file_s));
+	if (!newattr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* The copy the file attributes from the old attributes to the new */
+
+	memcpy(newattr, oldattr, sizeof(struct latency_file_s));
+
+	/* Save the new attributes in the new file structure */
+
+	newp->f_priv = (FAR void *)newattr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: latency_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int latency_stat(const char *relpath, struct stat *buf)
+{
+	/* "latency" is the only acceptable value for the relpath */
+
+	if (strcmp(relpath, "latency") != 0) {
+		fdbg("ERROR: relpath is '%s'\n", relpath);
+		return -ENOENT;
+	}
+
+	/* "latency" is the name for a read-only file */
+
+	buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+	buf->st_size = 0;
+	buf->st_blksize = 0;
+	buf->st_blocks = 0;
+	return OK;
+}
+
+#endif							/* CONFIG_SCHED_LATENCY && !CONFIG_FS_PROCFS_EXCLUDE_LATENCY */
+#endif							/* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
@@ -111,6 +111,12 @@ enum proc_node_e {
 	PROC_LOADAVG,				/* Average CPU utilization */
 #endif
 	PROC_STACK,					/* Task stack info */
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+	PROC_MAGAZINE,				/* Cached slab objects */
+#endif
+#ifdef CONFIG_SCHED_LATENCY
+	PROC_SCHEDSTAT,				/* Scheduling latency statistics */
+#endif
 	PROC_GROUP,					/* Group directory */
 	PROC_GROUP_STATUS,			/* Task group status */
 	PROC_GROUP_FD				/* Group file descriptors */
@@ -156,6 +162,12 @@ static ssize_t proc_cmdline(FAR struct proc_file_s *procfile, FAR struct tcb_s *
 static ssize_t proc_loadavg(FAR struct proc_file_s *procfile, FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen, off_t offset);
 #endif
 static ssize_t proc_stack(FAR struct proc_file_s *procfile, FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen, off_t offset);
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+static ssize_t proc_magazine(FAR struct proc_file_s *procfile, FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen, off_t offset);
+#endif
+#ifdef CONFIG_SCHED_LATENCY
+static ssize_t proc_schedstat(FAR struct proc_file_s *procfile, FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen, off_t offset);
+#endif
 static ssize_t proc_groupstatus(FAR struct proc_file_s *procfile, FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen, off_t offset);
 static ssize_t proc_groupfd(FAR struct proc_file_s *procfile, FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen, off_t offset);
 
@@ -227,6 +239,18 @@ static const struct proc_node_s g_stack = {
 	"stack", "stack", (uint8_t)PROC_STACK, DTYPE_FILE	/* Task stack info */
 };
 
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+static const struct proc_node_s g_magazine = {
+	"magazine", "magazine", (uint8_t)PROC_MAGAZINE, DTYPE_FILE	/* Cached slab objects */
+};
+#endif
+
+#ifdef CONFIG_SCHED_LATENCY
+static const struct proc_node_s g_schedstat = {
+	"schedstat", "schedstat", (uint8_t)PROC_SCHEDSTAT, DTYPE_FILE	/* Scheduling latency statistics */
+};
+#endif
+
 static const struct proc_node_s g_group = {
 	"group", "group", (uint8_t)PROC_GROUP, DTYPE_DIRECTORY	/* Group directory */
 };
@@ -248,6 +272,12 @@ static FAR const struct proc_node_s *const g_nodeinfo[] = {
 	&g_loadavg,					/* Average CPU utilization */
 #endif
 	&g_stack,					/* Task stack info */
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+	&g_magazine,				/* Cached slab objects */
+#endif
+#ifdef CONFIG_SCHED_LATENCY
+	&g_schedstat,				/* Scheduling latency statistics */
+#endif
 	&g_group,					/* Group directory */
 	&g_groupstatus,				/* Task group status */
 	&g_groupfd					/* Group file descriptors */
@@ -264,6 +294,12 @@ static const struct proc_node_s *const g_level0info[] = {
 	&g_loadavg,					/* Average CPU utilization */
 #endif
 	&g_stack,					/* Task stack info */
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+	&g_magazine,				/* Cached slab objects */
+#endif
+#ifdef CONFIG_SCHED_LATENCY
+	&g_schedstat,				/* Scheduling latency statistics */
+#endif
 	&g_group,					/* Group directory */
 };
 
@@ -601,6 +637,74 @@ static ssize_t proc_stack(FAR struct proc_file_s *procfile, FAR struct tcb_s *tc
 	return totalsize;
 }
 
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+/****************************************************************************
+ * Name: proc_magazine
+ ****************************************************************************/
+
+static ssize_t proc_magazine(FAR struct proc_file_s *procfile, FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen, off_t offset)
+{
+	size_t remaining;
+	size_t linesize;
+	size_t copysize;
+	size_t totalsize;
+	int sclass;
+
+	remaining = buflen;
+	totalsize = 0;
+
+	/* Show a header line */
+
+	linesize = snprintf(procfile->line, STATUS_LINELEN, "%-6s%s\n", "Size", "Cached");
+	copysize = procfs_memcpy(procfile->line, linesize, buffer, remaining, &offset);
+
+	totalsize += copysize;
+	buffer += copysize;
+	remaining -= copysize;
+
+	/* Then the number of objects cached for each size class */
+
+	for (sclass = 0; sclass < MM_SLAB_NCLASSES; sclass++) {
+		if (totalsize >= buflen) {
+			return totalsize;
+		}
+
+		linesize = snprintf(procfile->line, STATUS_LINELEN, "%-6d%d\n", (int)mm_slab_classsize(sclass), tcb->magazine.count[sclass]);
+		copysize = procfs_memcpy(procfile->line, linesize, buffer, remaining, &offset);
+
+		totalsize += copysize;
+		buffer += copysize;
+		remaining -= copysize;
+	}
+
+	return totalsize;
+}
+#endif
+
+/****************************************************************************
+ * Name: proc_schedstat
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_LATENCY
+static ssize_t proc_schedstat(FAR struct proc_file_s *procfile, FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen, off_t offset)
+{
+	struct sched_latency_s latency;
+	int ret;
+
+	/* A thread that exited since it was looked up has no statistics left;
+	 * show it as empty.
+	 */
+
+	ret = sched_latency(procfile->pid, &latency);
+	if (ret < 0) {
+		fdbg("ERROR: No statistics of PID %d: %d\n", (int)procfile->pid, ret);
+		return 0;
+	}
+
+	return procfs_latency(&latency, procfile->line, STATUS_LINELEN, buffer, buflen, &offset);
+}
+#endif
+
 /****************************************************************************
  * Name: proc_groupstatus
  ****************************************************************************/
@@ -941,6 +1045,18 @@ static ssize_t proc_read(FAR struct file *filep, FAR char *buffer, size_t buflen
 		ret = proc_stack(procfile, tcb, buffer, buflen, filep->f_pos);
 		break;
 
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+	case PROC_MAGAZINE:			/* Cached slab objects */
+		ret = proc_magazine(procfile, tcb, buffer, buflen, filep->f_pos);
+		break;
+#endif
+
+#ifdef CONFIG_SCHED_LATENCY
+	case PROC_SCHEDSTAT:		/* Scheduling latency statistics */
+		ret = proc_schedstat(procfile, tcb, buffer, buflen, filep->f_pos);
+		break;
+#endif
+
 	case PROC_GROUP_STATUS:	/* Task group status */
 		ret = proc_groupstatus(procfile, tcb, buffer, buflen, filep->f_pos);
 		break;
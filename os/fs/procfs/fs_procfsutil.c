@@ -57,8 +57,12 @@
 #include <tinyara/config.h>
 
 #include <sys/types.h>
+#include <stdio.h>
 #include <string.h>
 
+#ifdef CONFIG_SCHED_LATENCY
+#include <tinyara/sched.h>
+#endif
 #include <tinyara/fs/procfs.h>
 
 #if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
@@ -164,4 +168,58 @@ size_t procfs_memcpy(FAR const char *src, size_t srclen, FAR char *dest, size_t
 	return copysize;
 }
 
+/****************************************************************************
+ * Name: procfs_latency
+ *
+ * Description:
+ *   Format scheduling latency statistics into the user's receive buffer.
+ *   Blocked times are shown in milliseconds.  Each histogram row is
+ *   labeled with the shortest time of its bucket.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_LATENCY
+size_t procfs_latency(FAR const struct sched_latency_s *latency, FAR char *line, size_t linelen, FAR char *dest, size_t destlen, off_t *offset)
+{
+	static const char *const names[] = {
+		"Switches:", "Preemptions:", "Max wake us:", "Sem wait ms:", "MQ wait ms:", "Other wait ms:"
+	};
+	unsigned long values[6];
+	size_t linesize;
+	size_t copysize;
+	size_t totalsize = 0;
+	int i;
+
+	values[0] = latency->switches;
+	values[1] = latency->preemptions;
+	values[2] = latency->maxwake;
+	values[3] = (unsigned long)(latency->semwait / 1000);
+	values[4] = (unsigned long)(latency->mqwait / 1000);
+	values[5] = (unsigned long)(latency->otherwait / 1000);
+
+	for (i = 0; i < 6 && totalsize < destlen; i++) {
+		linesize = snprintf(line, linelen, "%-15s%lu\n", names[i], values[i]);
+		copysize = procfs_memcpy(line, linesize, dest, destlen - totalsize, offset);
+		totalsize += copysize;
+		dest += copysize;
+	}
+
+	if (totalsize < destlen) {
+		linesize = snprintf(line, linelen, "%-8s%-11s%s\n", "Usec>=", "Wake", "Slice");
+		copysize = procfs_memcpy(line, linesize, dest, destlen - totalsize, offset);
+		totalsize += copysize;
+		dest += copysize;
+	}
+
+	for (i = 0; i < CONFIG_SCHED_LATENCY_NBUCKETS && totalsize < destlen; i++) {
+		linesize = snprintf(line, linelen, "%-8lu%-11lu%lu\n", i > 0 ? 1ul << i : 0ul, (unsigned long)latency->wake[i], (unsigned long)latency->slice[i]);
+		copysize = procfs_memcpy(line, linesize, dest, destlen - totalsize, offset);
+		totalsize += copysize;
+		dest += copysize;
+	}
+
+	return totalsize;
+}
+#endif
+
 #endif							/* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
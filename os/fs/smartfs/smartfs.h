@@ -349,6 +349,23 @@ struct smartfs_chain_header_s {
 };
 #endif
 
+#ifdef CONFIG_SMARTFS_DCACHE
+/* This structure is one entry of the directory entry cache */
+
+struct smartfs_dcache_s {
+	uint16_t parent;			/* First sector of the parent directory, or
+								 * 0xFFFF if the entry is unused */
+	uint16_t hash;				/* Hash of parent and name */
+	uint16_t firstsector;		/* First sector of the entry's data */
+	uint16_t flags;				/* Flags of the entry */
+	uint16_t dsector;			/* Directory sector holding the entry */
+	uint16_t doffset;			/* Offset of the entry in dsector */
+	uint32_t utc;				/* Time stamp of the entry */
+	uint8_t recent;				/* The most recently used entry of its set */
+	char name[CONFIG_SMARTFS_MAXNAMLEN];	/* Name, not NULL terminated if full */
+};
+#endif
+
 /* This structure describes the state of one open file.  This structure
  * is protected by the volume semaphore.
  */
@@ -371,6 +388,11 @@ struct smartfs_ofile_s {
 								 * used field until the file is closed,
 								 * a seek, or more data is written that
 								 * causes the sector to change. */
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+	uint16_t *seekindex;		/* Every seekstep'th sector of the chain */
+	uint16_t seekstep;			/* Sectors between index entries */
+	uint16_t seekcount;			/* Number of index entries known so far */
+#endif
 };
 
 /* This structure represents the overall mountpoint state.  An instance of this
@@ -395,6 +417,11 @@ struct smartfs_mountpt_s {
 #endif
 #ifdef CONFIG_SMARTFS_JOURNALING
 	struct journal_transaction_manager_s *journal;
+#endif
+#ifdef CONFIG_SMARTFS_DCACHE
+	struct smartfs_dcache_s *fs_dcache;	/* Directory entry cache */
+	uint32_t fs_dcachehits;		/* Lookups found in the cache */
+	uint32_t fs_dcachemisses;	/* Lookups that read the directory */
 #endif
 	uint8_t fs_rootsector;		/* Root directory sector num */
 };
@@ -525,6 +552,10 @@ int smartfs_createentry(struct smartfs_mountpt_s *fs, uint16_t parentdirsector,
 
 int smartfs_deleteentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *entry);
 
+#ifdef CONFIG_SMARTFS_DCACHE
+void smartfs_dcache_remove(struct smartfs_mountpt_s *fs, uint16_t dsector, uint16_t doffset);
+#endif
+
 int smartfs_countdirentries(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *entry);
 
 int smartfs_truncatefile(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *entry, FAR struct smartfs_ofile_s *sf);
@@ -736,6 +736,9 @@ static size_t smartfs_status_read(FAR struct file *filep, FAR char *buffer, size
 	size_t len;
 #ifdef CONFIG_DEBUG_FS
 	int utilization;
+#endif
+#ifdef CONFIG_SMARTFS_DCACHE
+	uint32_t lookups;
 #endif
 	priv = (FAR struct smartfs_file_s *)filep->f_priv;
 
@@ -752,6 +755,13 @@ static size_t smartfs_status_read(FAR struct file *filep, FAR char *buffer, size
 		if (ret == OK) {
 			/* Format and return data in the buffer */
 			len = snprintf(buffer, buflen, "Total Sectors    %d\nFree Sectors     %d\n" "Released Sectors %d\n", procfs_data.totalsectors, procfs_data.freesectors, procfs_data.releasesectors);
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+			len += snprintf(&buffer[len], buflen - len, "Cache Hits       %u\nCache Misses     %u\n" "Scan Reads       %u\nPrefetches       %u\n", procfs_data.cachehits, procfs_data.cachemisses, procfs_data.cachescanreads, procfs_data.cacheprefetches);
+#endif
+#ifdef CONFIG_SMARTFS_DCACHE
+			lookups = priv->level1.mount->fs_dcachehits + priv->level1.mount->fs_dcachemisses;
+			len += snprintf(&buffer[len], buflen - len, "Dcache Hits      %u\nDcache Misses    %u\n" "Dcache Hit Rate  %u%%\n", priv->level1.mount->fs_dcachehits, priv->level1.mount->fs_dcachemisses, lookups ? (uint32_t)((uint64_t)priv->level1.mount->fs_dcachehits * 100 / lookups) : 0);
+#endif
 #ifdef CONFIG_DEBUG_FS
 			/* Calculate the sector utilization percentage */
 			if (procfs_data.blockerases == 0) {
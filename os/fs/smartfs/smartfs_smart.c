@@ -82,6 +82,10 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#ifndef CONFIG_SMARTFS_SEEK_INDEX
+#define smartfs_seekindex_add(fs, sf)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -115,6 +119,9 @@ static int smartfs_rename(struct inode *mountpt, const char *oldrelpath, const c
 static int smartfs_stat(struct inode *mountpt, const char *relpath, struct stat *buf);
 
 static off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *sf, off_t offset, int whence);
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+static void smartfs_seekindex_add(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *sf);
+#endif
 
 /****************************************************************************
  * Private Variables
@@ -317,6 +324,10 @@ static int smartfs_open(FAR struct file *filep, const char *relpath, int oflags,
 	sf->curroffset = sizeof(struct smartfs_chain_header_s);
 	sf->currsector = sf->entry.firstsector;
 	sf->byteswritten = 0;
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+	sf->seekindex = NULL;
+	sf->seekcount = 0;
+#endif
 
 	/* Test if we opened for APPEND mode.  If we did, then seek to the
 	 * end of the file.
@@ -443,6 +454,11 @@ static int smartfs_close(FAR struct file *filep)
 		kmm_free(sf->buffer);
 	}
 #endif
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+	if (sf->seekindex) {
+		kmm_free(sf->seekindex);
+	}
+#endif
 
 	kmm_free(sf);
 
@@ -550,6 +566,7 @@ static ssize_t smartfs_read(FAR struct file *filep, char *buffer, size_t buflen)
 
 			sf->currsector = SMARTFS_NEXTSECTOR(header);
 			sf->curroffset = sizeof(struct smartfs_chain_header_s);
+			smartfs_seekindex_add(fs, sf);
 
 			/* Test if at end of data */
 
@@ -842,6 +859,7 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 
 			sf->curroffset = sizeof(struct smartfs_chain_header_s);
 			sf->currsector = SMARTFS_NEXTSECTOR(header);
+			smartfs_seekindex_add(fs, sf);
 		}
 	}
 
@@ -937,6 +955,7 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 			sf->bflags = SMARTFS_BFLAG_DIRTY;
 			sf->currsector = SMARTFS_NEXTSECTOR(header);
 			sf->curroffset = sizeof(struct smartfs_chain_header_s);
+			smartfs_seekindex_add(fs, sf);
 			memset(sf->buffer, CONFIG_SMARTFS_ERASEDSTATE, fs->fs_llformat.availbytes);
 			header->type = SMARTFS_DIRENT_TYPE_FILE;
 		}
@@ -1004,6 +1023,7 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer, size_t
 
 				sf->currsector = SMARTFS_NEXTSECTOR(header);
 				sf->curroffset = sizeof(struct smartfs_chain_header_s);
+				smartfs_seekindex_add(fs, sf);
 			}
 		}
 #endif							/* CONFIG_SMARTFS_USE_SECTOR_BUFFER */
@@ -1016,6 +1036,90 @@ errout_with_semaphore:
 	return ret;
 }
 
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+/****************************************************************************
+ * Name: smartfs_seekindex_add
+ *
+ * Description: Records the current sector of an open file in its seek
+ *              index if it is the next sector the index is missing.  All
+ *              the sectors of a file but the last are full, so the place
+ *              of a sector in the chain follows from its file position.
+ *
+ ****************************************************************************/
+
+static void smartfs_seekindex_add(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *sf)
+{
+	size_t datalen = fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s);
+	size_t chainpos;
+	int x;
+
+	if (sf->seekindex == NULL || sf->currsector == SMARTFS_ERASEDSTATE_16BIT || sf->filepos % datalen != 0) {
+		return;
+	}
+
+	chainpos = sf->filepos / datalen;
+	if (chainpos != (size_t)sf->seekcount * sf->seekstep) {
+		return;
+	}
+
+	/* When the index is full, keep every other entry and double the step */
+
+	if (sf->seekcount == CONFIG_SMARTFS_SEEK_INDEX_SIZE) {
+		for (x = 1; x < CONFIG_SMARTFS_SEEK_INDEX_SIZE / 2; x++) {
+			sf->seekindex[x] = sf->seekindex[x * 2];
+		}
+
+		sf->seekcount = CONFIG_SMARTFS_SEEK_INDEX_SIZE / 2;
+		sf->seekstep <<= 1;
+		if (chainpos != (size_t)sf->seekcount * sf->seekstep) {
+			return;
+		}
+	}
+
+	sf->seekindex[sf->seekcount++] = sf->currsector;
+}
+
+/****************************************************************************
+ * Name: smartfs_seekindex_find
+ *
+ * Description: Finds the last indexed sector of an open file at or before
+ *              the sector holding a file position, allocating the index on
+ *              first use.  Returns the file position of that sector, or
+ *              zero and the first sector if there is no index.
+ *
+ ****************************************************************************/
+
+static size_t smartfs_seekindex_find(struct smartfs_mountpt_s *fs, struct smartfs_ofile_s *sf, size_t pos, uint16_t *sector)
+{
+	size_t datalen = fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s);
+	size_t entry;
+
+	if (sf->seekindex == NULL) {
+		sf->seekindex = (uint16_t *)kmm_malloc(CONFIG_SMARTFS_SEEK_INDEX_SIZE * sizeof(uint16_t));
+		if (sf->seekindex == NULL) {
+			*sector = sf->entry.firstsector;
+			return 0;
+		}
+
+		sf->seekindex[0] = sf->entry.firstsector;
+		sf->seekstep = CONFIG_SMARTFS_SEEK_INDEX_INTERVAL;
+		sf->seekcount = 1;
+	}
+
+	/* A position at the end of a sector is reached from that sector, as the
+	 * next one may not exist yet.
+	 */
+
+	entry = (pos > 0 ? (pos - 1) / datalen : 0) / sf->seekstep;
+	if (entry >= sf->seekcount) {
+		entry = sf->seekcount - 1;
+	}
+
+	*sector = sf->seekindex[entry];
+	return entry * sf->seekstep * datalen;
+}
+#endif							/* CONFIG_SMARTFS_SEEK_INDEX */
+
 /****************************************************************************
  * Name: smartfs_seek_internal
  *
@@ -1033,8 +1137,12 @@ static off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_
 	int ret;
 	off_t newpos;
 	off_t sectorstartpos;
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+	size_t indexpos;
+	uint16_t indexsector;
+#endif
 #ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
-	int sector_used = 0;
+	int sector_used;
 #endif
 	/* Test if this is a seek to get the current file pos */
 
@@ -1103,6 +1211,21 @@ static off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_
 		sf->filepos = 0;
 	}
 
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+	/* Start from the last indexed sector before the new position instead
+	 * if that is closer.
+	 */
+
+	indexpos = smartfs_seekindex_find(fs, sf, newpos, &indexsector);
+	if (indexpos > sf->filepos) {
+		sf->currsector = indexsector;
+		sf->filepos = indexpos;
+	}
+#endif
+#ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
+	sector_used = sf->filepos / (fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s));
+#endif
+
 	header = (struct smartfs_chain_header_s *)fs->fs_rwbuffer;
 	while ((sf->currsector != SMARTFS_ERASEDSTATE_16BIT) && (sf->filepos + fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s) < newpos)) {
 		/* Read the sector's header */
@@ -1127,6 +1250,7 @@ static off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs, struct smartfs_
 		sf->filepos += SMARTFS_USED(header);
 #endif
 		sf->currsector = SMARTFS_NEXTSECTOR(header);
+		smartfs_seekindex_add(fs, sf);
 	}
 
 #ifdef CONFIG_SMARTFS_USE_SECTOR_BUFFER
@@ -1240,6 +1364,14 @@ static int smartfs_sync(FAR struct file *filep)
 	smartfs_semtake(fs);
 
 	ret = smartfs_sync_internal(fs, sf);
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+
+	/* Also save the sector map, so that the next mount needs no scan */
+
+	if (ret == OK) {
+		ret = FS_IOCTL(fs, BIOC_FLUSH, 0);
+	}
+#endif
 
 	smartfs_semgive(fs);
 	return ret;
@@ -2046,6 +2178,9 @@ int smartfs_rename(struct inode *mountpt, const char *oldrelpath, const char *ne
 
 		/* Now mark the old entry as inactive */
 
+#ifdef CONFIG_SMARTFS_DCACHE
+		smartfs_dcache_remove(fs, oldentry.dsector, oldentry.doffset);
+#endif
 		readwrite.logsector = oldentry.dsector;
 		readwrite.offset = 0;
 		readwrite.count = fs->fs_llformat.availbytes;
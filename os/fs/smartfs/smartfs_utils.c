@@ -486,6 +486,9 @@ int smartfs_mount(struct smartfs_mountpt_s *fs, bool writeable)
 #if defined(CONFIG_SMARTFS_MULTI_ROOT_DIRS)
 	struct smartfs_mountpt_s *nextfs;
 #endif
+#ifdef CONFIG_SMARTFS_DCACHE
+	int x;
+#endif
 
 	/* Assume that the mount is not successful */
 
@@ -588,6 +591,25 @@ int smartfs_mount(struct smartfs_mountpt_s *fs, bool writeable)
 	fs->fs_workbuffer = (char *)kmm_malloc(256);
 	fs->fs_rootsector = SMARTFS_ROOT_DIR_SECTOR;
 
+#ifdef CONFIG_SMARTFS_DCACHE
+	/* Allocate the directory entry cache.  Without it, every lookup reads
+	 * the directories.  Longer names than the cache holds are not cached.
+	 */
+
+	fs->fs_dcachehits = 0;
+	fs->fs_dcachemisses = 0;
+	fs->fs_dcache = NULL;
+	if (fs->fs_llformat.namesize <= CONFIG_SMARTFS_MAXNAMLEN) {
+		fs->fs_dcache = (struct smartfs_dcache_s *)kmm_malloc(CONFIG_SMARTFS_DCACHE_SIZE * sizeof(struct smartfs_dcache_s));
+		if (fs->fs_dcache != NULL) {
+			for (x = 0; x < CONFIG_SMARTFS_DCACHE_SIZE; x++) {
+				fs->fs_dcache[x].parent = 0xFFFF;
+				fs->fs_dcache[x].recent = FALSE;
+			}
+		}
+	}
+#endif
+
 	/* We did it! */
 
 	fs->fs_mounted = TRUE;
@@ -731,10 +753,128 @@ int smartfs_unmount(struct smartfs_mountpt_s *fs)
 	kmm_free(fs->fs_rwbuffer);
 	kmm_free(fs->fs_workbuffer);
 #endif
+#ifdef CONFIG_SMARTFS_DCACHE
+	if (fs->fs_dcache != NULL) {
+		kmm_free(fs->fs_dcache);
+		fs->fs_dcache = NULL;
+	}
+#endif
 
 	return ret;
 }
 
+#ifdef CONFIG_SMARTFS_DCACHE
+/****************************************************************************
+ * Name: smartfs_dcache_hash
+ *
+ * Description: Hashes the first namesize characters of a name together
+ *              with the first sector of its parent directory.
+ *
+ ****************************************************************************/
+
+static uint16_t smartfs_dcache_hash(struct smartfs_mountpt_s *fs, uint16_t parent, const char *name)
+{
+	uint32_t hash = parent;
+	int x;
+
+	for (x = 0; x < fs->fs_llformat.namesize && name[x] != '\0'; x++) {
+		hash = hash * 31 + (uint8_t)name[x];
+	}
+
+	return (uint16_t)(hash ^ (hash >> 16));
+}
+
+/****************************************************************************
+ * Name: smartfs_dcache_find
+ *
+ * Description: Looks up a name in a directory in the directory entry
+ *              cache.  Returns the cache entry or NULL if it isn't cached.
+ *
+ ****************************************************************************/
+
+static FAR struct smartfs_dcache_s *smartfs_dcache_find(struct smartfs_mountpt_s *fs, uint16_t parent, const char *name, uint16_t hash)
+{
+	FAR struct smartfs_dcache_s *set;
+	int x;
+
+	if (fs->fs_dcache == NULL) {
+		return NULL;
+	}
+
+	set = &fs->fs_dcache[(hash % (CONFIG_SMARTFS_DCACHE_SIZE / 2)) * 2];
+	for (x = 0; x < 2; x++) {
+		if (set[x].parent == parent && set[x].hash == hash && strncmp(set[x].name, name, fs->fs_llformat.namesize) == 0) {
+			set[x].recent = TRUE;
+			set[x ^ 1].recent = FALSE;
+			fs->fs_dcachehits++;
+			return &set[x];
+		}
+	}
+
+	fs->fs_dcachemisses++;
+	return NULL;
+}
+
+/****************************************************************************
+ * Name: smartfs_dcache_add
+ *
+ * Description: Takes the least recently used entry of the set of a name in
+ *              the directory entry cache for it.  The caller fills in the
+ *              rest of the entry.
+ *
+ ****************************************************************************/
+
+static FAR struct smartfs_dcache_s *smartfs_dcache_add(struct smartfs_mountpt_s *fs, uint16_t parent, const char *name, uint16_t hash)
+{
+	FAR struct smartfs_dcache_s *dcache;
+
+	if (fs->fs_dcache == NULL) {
+		return NULL;
+	}
+
+	/* Use the second entry of the set if the first one is in use and
+	 * either the more recently used or the only one in use.
+	 */
+
+	dcache = &fs->fs_dcache[(hash % (CONFIG_SMARTFS_DCACHE_SIZE / 2)) * 2];
+	if (dcache[0].parent != 0xFFFF && (dcache[0].recent || dcache[1].parent == 0xFFFF)) {
+		dcache++;
+	}
+
+	dcache->parent = parent;
+	dcache->hash = hash;
+	strncpy(dcache->name, name, fs->fs_llformat.namesize);
+	dcache->recent = TRUE;
+	fs->fs_dcache[(dcache - fs->fs_dcache) ^ 1].recent = FALSE;
+	return dcache;
+}
+
+/****************************************************************************
+ * Name: smartfs_dcache_remove
+ *
+ * Description: Drops the directory entry at a place in a directory sector
+ *              from the directory entry cache.  Called whenever an entry is
+ *              created, deleted or renamed.
+ *
+ ****************************************************************************/
+
+void smartfs_dcache_remove(struct smartfs_mountpt_s *fs, uint16_t dsector, uint16_t doffset)
+{
+	int x;
+
+	if (fs->fs_dcache == NULL) {
+		return;
+	}
+
+	for (x = 0; x < CONFIG_SMARTFS_DCACHE_SIZE; x++) {
+		if (fs->fs_dcache[x].dsector == dsector && fs->fs_dcache[x].doffset == doffset) {
+			fs->fs_dcache[x].parent = 0xFFFF;
+			fs->fs_dcache[x].recent = FALSE;
+		}
+	}
+}
+#endif							/* CONFIG_SMARTFS_DCACHE */
+
 /****************************************************************************
  * Name: smartfs_finddirentry
  *
@@ -762,9 +902,19 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *d
 	uint16_t dirsector;
 	uint16_t entrysize;
 	uint16_t offset;
+	uint16_t entryfirst = 0;
+	uint16_t entryflags = 0;
+	uint16_t entrysector = 0;
+	uint16_t entryoffset = 0;
+	uint32_t entryutc = 0;
+	bool found;
 	struct smartfs_chain_header_s *header;
 	struct smart_read_write_s readwrite;
 	struct smartfs_entry_header_s *entry;
+#ifdef CONFIG_SMARTFS_DCACHE
+	FAR struct smartfs_dcache_s *dcache;
+	uint16_t hash;
+#endif
 #ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
 	int used_value;
 #endif
@@ -838,16 +988,28 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *d
 		} else {
 			/* Search for the entry in the current directory */
 
-			dirsector = dirstack[depth];
+			found = false;
+#ifdef CONFIG_SMARTFS_DCACHE
+			hash = smartfs_dcache_hash(fs, dirstack[depth], fs->fs_workbuffer);
+			dcache = smartfs_dcache_find(fs, dirstack[depth], fs->fs_workbuffer, hash);
+			if (dcache != NULL) {
+				entryfirst = dcache->firstsector;
+				entryflags = dcache->flags;
+				entryutc = dcache->utc;
+				entrysector = dcache->dsector;
+				entryoffset = dcache->doffset;
+				found = true;
+			}
+#endif
 
 			/* Read the directory */
 
-			offset = 0xFFFF;
+			dirsector = dirstack[depth];
 
 #if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
-			while (dirsector != 0xFFFF)
+			while (!found && dirsector != 0xFFFF)
 #else
-			while (dirsector != 0)
+			while (!found && dirsector != 0)
 #endif
 			{
 				/* Read the next directory in the chain */
@@ -886,170 +1048,157 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *d
 					/* Test if the name matches */
 
 					if (strncmp(entry->name, fs->fs_workbuffer, fs->fs_llformat.namesize) == 0) {
-						/* We found it!  If this is the last segment entry,
-						 * then report the entry.  If it isn't the last
-						 * entry, then validate it is a directory entry and
-						 * open it and continue searching.
-						 */
-
-						if (*ptr == '\0') {
-							/* We are at the last segment.  Report the entry */
-
-							/* Fill in the entry */
+						/* We found it!  Remember the entry */
 
 #ifdef CONFIG_SMARTFS_ALIGNED_ACCESS
-							direntry->firstsector = smartfs_rdle16(&entry->firstsector);
-							direntry->flags = smartfs_rdle16(&entry->flags);
-							direntry->utc = smartfs_rdle32(&entry->utc);
+						entryfirst = smartfs_rdle16(&entry->firstsector);
+						entryflags = smartfs_rdle16(&entry->flags);
+						entryutc = smartfs_rdle32(&entry->utc);
 #else
-							direntry->firstsector = entry->firstsector;
-							direntry->flags = entry->flags;
-							direntry->utc = entry->utc;
+						entryfirst = entry->firstsector;
+						entryflags = entry->flags;
+						entryutc = entry->utc;
 #endif
-							direntry->dsector = readwrite.logsector;
-							direntry->doffset = offset;
-							direntry->dfirst = dirstack[depth];
-							if (direntry->name == NULL) {
-								direntry->name = (char *)kmm_malloc(fs->fs_llformat.namesize + 1);
-								if (direntry->name == NULL) {
-									ret = ERROR;
-									goto errout;
-								}
-							}
+						entrysector = readwrite.logsector;
+						entryoffset = offset;
+						found = true;
+#ifdef CONFIG_SMARTFS_DCACHE
+						dcache = smartfs_dcache_add(fs, dirstack[depth], fs->fs_workbuffer, hash);
+						if (dcache != NULL) {
+							dcache->firstsector = entryfirst;
+							dcache->flags = entryflags;
+							dcache->utc = entryutc;
+							dcache->dsector = entrysector;
+							dcache->doffset = entryoffset;
+						}
+#endif
+						break;
+					}
 
-							memset(direntry->name, 0, fs->fs_llformat.namesize + 1);
-							strncpy(direntry->name, entry->name, fs->fs_llformat.namesize);
-							direntry->datlen = 0;
+					/* Not this entry.  Skip to the next one */
 
-							/* Scan the file's sectors to calculate the length and perform
-							 * a rudimentary check.
-							 */
+					offset += entrysize;
+					entry = (struct smartfs_entry_header_s *)
+							&fs->fs_rwbuffer[offset];
+				}
+			}
 
-#ifdef CONFIG_SMARTFS_ALIGNED_ACCESS
-							if ((smartfs_rdle16(&entry->flags) & SMARTFS_DIRENT_TYPE) == SMARTFS_DIRENT_TYPE_FILE) {
-								dirsector = smartfs_rdle16(&entry->firstsector);
-#else
-							if ((entry->flags & SMARTFS_DIRENT_TYPE) == SMARTFS_DIRENT_TYPE_FILE) {
-								dirsector = entry->firstsector;
-#endif
-								readwrite.count = sizeof(struct smartfs_chain_header_s);
-								readwrite.buffer = (uint8_t *)fs->fs_rwbuffer;
-								readwrite.offset = 0;
-
-								while (dirsector != SMARTFS_ERASEDSTATE_16BIT) {
-									/* Read the next sector of the file */
-
-									readwrite.logsector = dirsector;
-									ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
-									if (ret < 0) {
-										fdbg("Error in sector chain at %d!\n", dirsector);
-										break;
-									}
-#ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
-									if (SMARTFS_NEXTSECTOR(header) == SMARTFS_ERASEDSTATE_16BIT) {
-
-										readwrite.count = fs->fs_llformat.availbytes;
-										readwrite.buffer = (uint8_t *)fs->fs_chunk_buffer;
-
-										ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
-										if (ret < 0) {
-											fdbg("Error %d reading sector %d header\n", ret, sf->currsector);
-											break;
-										}
-										used_value = get_leftover_used_byte_count((uint8_t *)readwrite.buffer, get_used_byte_count((uint8_t *)header->used));
-										direntry->datlen += used_value;
-									} else {
-										direntry->datlen += (fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s));
-									}
-									readwrite.buffer = (uint8_t *)fs->fs_rwbuffer;
-#else
-									/* Add used bytes to the total and point to next sector */
-									if (SMARTFS_USED(header) != SMARTFS_ERASEDSTATE_16BIT) {
-										direntry->datlen += SMARTFS_USED(header);
-									}
-#endif
-									dirsector = SMARTFS_NEXTSECTOR(header);
-								}
-							}
+			/* Entry not found!  Report the error.  Also, if this is the last
+			 * segment, then report the parent directory sector.
+			 */
 
-							*parentdirsector = dirstack[depth];
-							*filename = segment;
-							ret = OK;
-							goto errout;
-						} else {
-							/* Validate it's a directory */
+			if (!found) {
+				if (*ptr == '\0') {
+					*parentdirsector = dirstack[depth];
+					*filename = segment;
+				} else {
+					*parentdirsector = 0xFFFF;
+					*filename = NULL;
+				}
 
-#ifdef CONFIG_SMARTFS_ALIGNED_ACCESS
-							if ((smartfs_rdle16(&entry->flags) & SMARTFS_DIRENT_TYPE) != SMARTFS_DIRENT_TYPE_DIR)
-#else
-							if ((entry->flags & SMARTFS_DIRENT_TYPE) != SMARTFS_DIRENT_TYPE_DIR)
-#endif
-							{
-								/* Not a directory!  Report the error */
+				ret = -ENOENT;
+				goto errout;
+			}
 
-								ret = -ENOTDIR;
-								goto errout;
-							}
+			/* If this is the last segment entry, then report the entry.  If
+			 * it isn't the last entry, then validate it is a directory entry
+			 * and open it and continue searching.
+			 */
+
+			if (*ptr == '\0') {
+				/* We are at the last segment.  Fill in the entry */
+
+				direntry->firstsector = entryfirst;
+				direntry->flags = entryflags;
+				direntry->utc = entryutc;
+				direntry->dsector = entrysector;
+				direntry->doffset = entryoffset;
+				direntry->dfirst = dirstack[depth];
+				if (direntry->name == NULL) {
+					direntry->name = (char *)kmm_malloc(fs->fs_llformat.namesize + 1);
+					if (direntry->name == NULL) {
+						ret = ERROR;
+						goto errout;
+					}
+				}
 
-							/* "Push" the directory and continue searching */
+				memset(direntry->name, 0, fs->fs_llformat.namesize + 1);
+				strncpy(direntry->name, fs->fs_workbuffer, fs->fs_llformat.namesize);
+				direntry->datlen = 0;
 
-							if (depth >= CONFIG_SMARTFS_DIRDEPTH - 1) {
-								/* Directory depth too big */
+				/* Scan the file's sectors to calculate the length and perform
+				 * a rudimentary check.
+				 */
 
-								ret = -ENAMETOOLONG;
-								goto errout;
-							}
-#ifdef CONFIG_SMARTFS_ALIGNED_ACCESS
-							dirstack[++depth] = smartfs_rdle16(&entry->firstsector);
-#else
-							dirstack[++depth] = entry->firstsector;
-#endif
-							segment = ptr + 1;
+				if ((entryflags & SMARTFS_DIRENT_TYPE) == SMARTFS_DIRENT_TYPE_FILE) {
+					dirsector = entryfirst;
+					header = (struct smartfs_chain_header_s *)fs->fs_rwbuffer;
+					readwrite.count = sizeof(struct smartfs_chain_header_s);
+					readwrite.buffer = (uint8_t *)fs->fs_rwbuffer;
+					readwrite.offset = 0;
+
+					while (dirsector != SMARTFS_ERASEDSTATE_16BIT) {
+						/* Read the next sector of the file */
+
+						readwrite.logsector = dirsector;
+						ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
+						if (ret < 0) {
+							fdbg("Error in sector chain at %d!\n", dirsector);
 							break;
 						}
-					}
+#ifdef CONFIG_SMARTFS_DYNAMIC_HEADER
+						if (SMARTFS_NEXTSECTOR(header) == SMARTFS_ERASEDSTATE_16BIT) {
 
-					/* Not this entry.  Skip to the next one */
+							readwrite.count = fs->fs_llformat.availbytes;
+							readwrite.buffer = (uint8_t *)fs->fs_chunk_buffer;
 
-					offset += entrysize;
-					entry = (struct smartfs_entry_header_s *)
-							&fs->fs_rwbuffer[offset];
+							ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long)&readwrite);
+							if (ret < 0) {
+								fdbg("Error %d reading sector %d header\n", ret, dirsector);
+								break;
+							}
+							used_value = get_leftover_used_byte_count((uint8_t *)readwrite.buffer, get_used_byte_count((uint8_t *)header->used));
+							direntry->datlen += used_value;
+						} else {
+							direntry->datlen += (fs->fs_llformat.availbytes - sizeof(struct smartfs_chain_header_s));
+						}
+						readwrite.buffer = (uint8_t *)fs->fs_rwbuffer;
+#else
+						/* Add used bytes to the total and point to next sector */
+						if (SMARTFS_USED(header) != SMARTFS_ERASEDSTATE_16BIT) {
+							direntry->datlen += SMARTFS_USED(header);
+						}
+#endif
+						dirsector = SMARTFS_NEXTSECTOR(header);
+					}
 				}
 
-				/* Test if a directory entry was found and break if it was */
-
-				if (offset < readwrite.count) {
-					break;
-				}
+				*parentdirsector = dirstack[depth];
+				*filename = segment;
+				ret = OK;
+				goto errout;
 			}
 
-			/* If we found a dir entry, then continue searching */
+			/* Validate it's a directory */
 
-			if (offset < readwrite.count) {
-				/* Update the segment pointer */
+			if ((entryflags & SMARTFS_DIRENT_TYPE) != SMARTFS_DIRENT_TYPE_DIR) {
+				/* Not a directory!  Report the error */
 
-				if (*ptr != '\0') {
-					ptr++;
-				}
-
-				segment = ptr;
-				continue;
+				ret = -ENOTDIR;
+				goto errout;
 			}
 
-			/* Entry not found!  Report the error.  Also, if this is the last
-			 * segment, then report the parent directory sector.
-			 */
+			/* "Push" the directory and continue searching */
 
-			if (*ptr == '\0') {
-				*parentdirsector = dirstack[depth];
-				*filename = segment;
-			} else {
-				*parentdirsector = 0xFFFF;
-				*filename = NULL;
+			if (depth >= CONFIG_SMARTFS_DIRDEPTH - 1) {
+				/* Directory depth too big */
+
+				ret = -ENAMETOOLONG;
+				goto errout;
 			}
 
-			ret = -ENOENT;
-			goto errout;
+			dirstack[++depth] = entryfirst;
+			segment = ptr + 1;
 		}
 	}
 
@@ -1257,6 +1406,10 @@ int smartfs_createentry(struct smartfs_mountpt_s *fs, uint16_t parentdirsector,
 	memset(entry->name, 0, fs->fs_llformat.namesize);
 	strncpy(entry->name, filename, fs->fs_llformat.namesize);
 
+#ifdef CONFIG_SMARTFS_DCACHE
+	smartfs_dcache_remove(fs, psector, offset);
+#endif
+
 	/* Now write the new entry to the parent directory sector */
 
 	readwrite.logsector = psector;
@@ -1362,6 +1515,9 @@ int smartfs_deleteentry(struct smartfs_mountpt_s *fs, struct smartfs_entry_s *en
 
 	/* Remove the entry from the directory tree */
 
+#ifdef CONFIG_SMARTFS_DCACHE
+	smartfs_dcache_remove(fs, entry->dsector, entry->doffset);
+#endif
 	readwrite.logsector = entry->dsector;
 	readwrite.offset = 0;
 	readwrite.count = fs->fs_llformat.availbytes;
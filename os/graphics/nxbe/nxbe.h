@@ -44,6 +44,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <time.h>
+#include <semaphore.h>
 
 #include <tinyara/nx/nx.h>
 #include <tinyara/nx/nxglib.h>
@@ -61,6 +63,14 @@
 #define NX_CLIPORDER_BRLT    (3)   /* Bottom-right-left-top */
 #define NX_CLIPORDER_DEFAULT NX_CLIPORDER_TLRB
 
+/* Tile-parallel rasterization */
+
+#ifdef CONFIG_NX_TILES
+#  ifndef CONFIG_NX_TILES_NWORKERS
+#    define CONFIG_NX_TILES_NWORKERS 2
+#  endif
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -119,6 +129,44 @@ struct nxbe_clipops_s
                    FAR const struct nxgl_rect_s *rect);
 };
 
+/* Tiles ********************************************************************/
+
+/* Draws one tile of a rectangle on 'plane' */
+
+typedef CODE void (*nxbe_tiledraw_t)(FAR void *arg,
+                                     FAR struct nxbe_plane_s *plane,
+                                     FAR const struct nxgl_rect_s *tile);
+
+#ifdef CONFIG_NX_TILES
+/* One tile worker thread */
+
+struct nxbe_tilepool_s;
+struct nxbe_tileworker_s
+{
+  FAR struct nxbe_tilepool_s *pool; /* The pool the worker belongs to */
+  struct nxbe_plane_s plane[CONFIG_NX_NPLANES]; /* Private copies of the planes */
+};
+
+/* The pool of tile workers and the rectangle being rasterized */
+
+struct nxbe_tilepool_s
+{
+  uint8_t nworkers;                 /* Number of workers running */
+
+  sem_t exclsem;                    /* Protects 'next' */
+  sem_t startsem;                   /* Posted once for each worker to join */
+  sem_t donesem;                    /* Posted by a worker that found no tile */
+
+  nxbe_tiledraw_t draw;             /* Draws one tile */
+  FAR void *arg;                    /* Argument of draw() */
+  int planeno;                      /* Plane being drawn */
+  struct nxgl_rect_s rect;          /* Rectangle being drawn */
+  nxgl_coord_t next;                /* First row of the next tile */
+
+  struct nxbe_tileworker_s worker[CONFIG_NX_TILES_NWORKERS];
+};
+#endif
+
 /* Back-end state ***********************************************************/
 
 /* This structure describes the overall back-end window state */
@@ -148,8 +196,25 @@ struct nxbe_state_s
   /* Rasterizing functions selected to match the BPP reported in pinfo[] */
 
   struct nxbe_plane_s plane[CONFIG_NX_NPLANES];
+
+#ifdef CONFIG_NX_TILES
+  /* The tile workers that share the rasterization of large rectangles */
+
+  struct nxbe_tilepool_s tiles;
+#endif
 };
 
+#ifdef CONFIG_NX_SHADOWFB
+/* Counters of the shadow framebuffer */
+
+struct nxbe_shadowfb_stats_s
+{
+  uint64_t drawn;                   /* Pixels drawn into the shadow */
+  uint64_t sent;                    /* Pixels sent to the display */
+  uint32_t flushes;                 /* Number of times damage was sent */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -189,6 +254,87 @@ int nxbe_colormap(FAR NX_DRIVERTYPE *dev);
 
 int nxbe_configure(FAR NX_DRIVERTYPE *dev, FAR struct nxbe_state_s *be);
 
+/****************************************************************************
+ * Name: nxbe_shadowfb_initialize
+ *
+ * Description:
+ *   Put a RAM shadow of the display between the rasterizers of plane 0 and
+ *   the LCD driver.  Drawing then only updates the shadow and records the
+ *   damaged areas; nxbe_shadowfb_update() sends the merged damage to the
+ *   display.  Only one shadowed display is supported.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_SHADOWFB
+int nxbe_shadowfb_initialize(FAR struct nxbe_state_s *be);
+
+/****************************************************************************
+ * Name: nxbe_shadowfb_deadline
+ *
+ * Description:
+ *   If there is damage waiting to be sent, return true and the absolute
+ *   time (CLOCK_REALTIME) at which it is due.
+ *
+ ****************************************************************************/
+
+bool nxbe_shadowfb_deadline(FAR struct timespec *abstime);
+
+/****************************************************************************
+ * Name: nxbe_shadowfb_update
+ *
+ * Description:
+ *   Send the damaged areas to the display if they are due, or right away if
+ *   'force' is true.
+ *
+ ****************************************************************************/
+
+void nxbe_shadowfb_update(bool force);
+
+/****************************************************************************
+ * Name: nxbe_shadowfb_getstats
+ *
+ * Description:
+ *   Return the counters of the shadow framebuffer
+ *
+ ****************************************************************************/
+
+void nxbe_shadowfb_getstats(FAR struct nxbe_shadowfb_stats_s *stats);
+#endif
+
+/****************************************************************************
+ * Name: nxbe_tile_initialize
+ *
+ * Description:
+ *   Start the tile workers.  Must be called after the rasterizers of every
+ *   plane have been selected.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_TILES
+int nxbe_tile_initialize(FAR struct nxbe_state_s *be);
+#endif
+
+/****************************************************************************
+ * Name: nxbe_tile_run
+ *
+ * Description:
+ *   Call draw(arg, plane, tile) for tiles that together cover 'rect'.  With
+ *   CONFIG_NX_TILES, large rectangles are split into tiles drawn in
+ *   parallel by the tile workers; otherwise the whole rectangle is drawn
+ *   at once.  Returns when the whole rectangle has been drawn.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_TILES
+void nxbe_tile_run(FAR struct nxbe_state_s *be,
+                   FAR struct nxbe_plane_s *plane,
+                   FAR const struct nxgl_rect_s *rect,
+                   nxbe_tiledraw_t draw, FAR void *arg);
+#else
+#  define nxbe_tile_run(be, plane, rect, draw, arg) \
+     (draw)((arg), (plane), (rect))
+#endif
+
 /****************************************************************************
  * Name: nxbe_closewindow
  *
@@ -52,6 +52,7 @@
 struct nx_bitmap_s
 {
   struct nxbe_clipops_s cops;
+  FAR struct nxbe_state_s *be;      /* Back-end state, for the tile workers */
   FAR const void *src;              /* The start of the source image. */
   struct nxgl_point_s origin;       /* Offset into the source image data */
   unsigned int stride;              /* The width of the full source image in pixels. */
@@ -62,7 +63,7 @@ struct nx_bitmap_s
  ****************************************************************************/
 
 /****************************************************************************
- * Name: nxs_clipcopy
+ * Name: nxs_tilecopy / nxs_clipcopy
  *
  * Description:
  *  Called from nxbe_clipper() to performed the fill operation on visible portions
@@ -70,16 +71,23 @@ struct nx_bitmap_s
  *
  ****************************************************************************/
 
+static void nxs_tilecopy(FAR void *arg, FAR struct nxbe_plane_s *plane,
+                         FAR const struct nxgl_rect_s *rect)
+{
+  struct nx_bitmap_s *bminfo = (struct nx_bitmap_s *)arg;
+
+  plane->copyrectangle(&plane->pinfo, rect, bminfo->src,
+                       &bminfo->origin, bminfo->stride);
+}
+
 static void nxs_clipcopy(FAR struct nxbe_clipops_s *cops,
                          FAR struct nxbe_plane_s *plane,
                          FAR const struct nxgl_rect_s *rect)
 {
-  struct nx_bitmap_s *bminfo = (struct nx_bitmap_s *)cops;
-
   /* Copy the rectangular region */
 
-  plane->copyrectangle(&plane->pinfo, rect, bminfo->src,
-                       &bminfo->origin, bminfo->stride);
+  nxbe_tile_run(((FAR struct nx_bitmap_s *)cops)->be, plane, rect,
+                nxs_tilecopy, cops);
 
 #ifdef CONFIG_NX_UPDATE
   /* Notify external logic that the display has been updated */
@@ -178,6 +186,7 @@ void nxbe_bitmap(FAR struct nxbe_window_s *wnd, FAR const struct nxgl_rect_s *de
     {
       info.cops.visible  = nxs_clipcopy;
       info.cops.obscured = nxbe_clipnull;
+      info.be            = wnd->be;
       info.src           = src[i];
       info.origin.x      = offset.x;
       info.origin.y      = offset.y;
@@ -40,6 +40,7 @@
 #include <tinyara/config.h>
 
 #include <stddef.h>
+#include <string.h>
 #include <errno.h>
 #include <debug.h>
 
@@ -117,6 +118,9 @@ int nxbe_configure(FAR NX_DRIVERTYPE *dev, FAR struct nxbe_state_s *be)
 
   for (i = 0; i < be->vinfo.nplanes; i++)
     {
+      /* Drivers only set the optional methods that they provide */
+
+      memset(&be->plane[i].pinfo, 0, sizeof(struct lcd_planeinfo_s));
       ret = dev->getplaneinfo(dev, i, &be->plane[i].pinfo);
       if (ret < 0)
         {
@@ -220,5 +224,35 @@ int nxbe_configure(FAR NX_DRIVERTYPE *dev, FAR struct nxbe_state_s *be)
           return -ENOSYS;
         }
     }
+
+#ifdef CONFIG_NX_SHADOWFB
+  /* Draw into a RAM shadow of the display.  Without memory for it, just
+   * draw to the display directly.
+   */
+
+  ret = nxbe_shadowfb_initialize(be);
+  if (ret < 0)
+    {
+      gwarn("WARNING: No shadow framebuffer: %d\n", ret);
+    }
+#endif
+
+#ifdef CONFIG_NX_TILES
+  /* Rasterize large areas on the tile workers.  An LCD can only be drawn
+   * from several threads through the shadow framebuffer.
+   */
+
+#ifdef CONFIG_NX_LCDDRIVER
+  if (ret >= 0)
+#endif
+    {
+      ret = nxbe_tile_initialize(be);
+      if (ret < 0)
+        {
+          gwarn("WARNING: No tile workers: %d\n", ret);
+        }
+    }
+#endif
+
   return OK;
 }
@@ -51,6 +51,7 @@
 struct nxbe_fill_s
 {
   struct nxbe_clipops_s cops;
+  FAR struct nxbe_state_s *be;
   nxgl_mxpixel_t color;
 };
 
@@ -59,7 +60,7 @@ struct nxbe_fill_s
  ****************************************************************************/
 
 /****************************************************************************
- * Name: nxbe_clipfill
+ * Name: nxbe_tilefill / nxbe_clipfill
  *
  * Description:
  *  Called from nxbe_clipper() to performed the fill operation on visible portions
@@ -67,15 +68,22 @@ struct nxbe_fill_s
  *
  ****************************************************************************/
 
+static void nxbe_tilefill(FAR void *arg, FAR struct nxbe_plane_s *plane,
+                          FAR const struct nxgl_rect_s *rect)
+{
+  struct nxbe_fill_s *fillinfo = (struct nxbe_fill_s *)arg;
+
+  plane->fillrectangle(&plane->pinfo, rect, fillinfo->color);
+}
+
 static void nxbe_clipfill(FAR struct nxbe_clipops_s *cops,
                         FAR struct nxbe_plane_s *plane,
                         FAR const struct nxgl_rect_s *rect)
 {
-  struct nxbe_fill_s *fillinfo = (struct nxbe_fill_s *)cops;
-
   /* Draw the rectangle */
 
-  plane->fillrectangle(&plane->pinfo, rect, fillinfo->color);
+  nxbe_tile_run(((FAR struct nxbe_fill_s *)cops)->be, plane, rect,
+                nxbe_tilefill, cops);
 
 #ifdef CONFIG_NX_UPDATE
   /* Notify external logic that the display has been updated */
@@ -146,6 +154,7 @@ void nxbe_fill(FAR struct nxbe_window_s *wnd,
         {
           info.cops.visible  = nxbe_clipfill;
           info.cops.obscured = nxbe_clipnull;
+          info.be            = wnd->be;
           info.color         = color[i];
 
           nxbe_clipper(wnd->above, &remaining, NX_CLIPORDER_DEFAULT,
@@ -63,6 +63,7 @@
 struct nxbe_filltrap_s
 {
   struct nxbe_clipops_s cops;
+  FAR struct nxbe_state_s *be;
   struct nxgl_trapezoid_s trap;
   nxgl_mxpixel_t color;
 };
@@ -72,7 +73,7 @@ struct nxbe_filltrap_s
  ****************************************************************************/
 
 /****************************************************************************
- * Name: nxbe_clipfilltrapezoid
+ * Name: nxbe_tilefilltrapezoid / nxbe_clipfilltrapezoid
  *
  * Description:
  *  Called from nxbe_clipper() to performed the fill operation on visible portions
@@ -80,6 +81,15 @@ struct nxbe_filltrap_s
  *
  ****************************************************************************/
 
+static void nxbe_tilefilltrapezoid(FAR void *arg,
+                                   FAR struct nxbe_plane_s *plane,
+                                   FAR const struct nxgl_rect_s *rect)
+{
+  struct nxbe_filltrap_s *fillinfo = (struct nxbe_filltrap_s *)arg;
+
+  plane->filltrapezoid(&plane->pinfo, &fillinfo->trap, rect, fillinfo->color);
+}
+
 static void nxbe_clipfilltrapezoid(FAR struct nxbe_clipops_s *cops,
                                    FAR struct nxbe_plane_s *plane,
                                    FAR const struct nxgl_rect_s *rect)
@@ -91,7 +101,7 @@ static void nxbe_clipfilltrapezoid(FAR struct nxbe_clipops_s *cops,
 
   /* Draw the trapezond */
 
-  plane->filltrapezoid(&plane->pinfo, &fillinfo->trap, rect, fillinfo->color);
+  nxbe_tile_run(fillinfo->be, plane, rect, nxbe_tilefilltrapezoid, fillinfo);
 
 #ifdef CONFIG_NX_UPDATE
   /* Notify external logic that the display has been updated */
@@ -175,6 +185,7 @@ void nxbe_filltrapezoid(FAR struct nxbe_window_s *wnd,
     {
       info.cops.visible  = nxbe_clipfilltrapezoid;
       info.cops.obscured = nxbe_clipnull;
+      info.be            = wnd->be;
 
       /* Then process each color plane */
 
@@ -0,0 +1,383 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * graphics/nxbe/nxbe_shadowfb.c
+ *
+ * A RAM shadow of the display for LCDs on a slow bus.  The rasterizers draw
+ * into the shadow through the usual putrun()/getrun() interface, the areas
+ * drawn are collected in a short list of damaged rectangles, and only that
+ * damage is sent to the LCD, at most CONFIG_NX_SHADOWFB_RATE times a
+ * second.  Pixels that are drawn several times between two flushes, as
+ * happens when overlapping windows are redrawn, cross the bus only once.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <semaphore.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/clock.h>
+#include <tinyara/kmalloc.h>
+#include <tinyara/nx/nxglib.h>
+
+#include "nxbe.h"
+
+#ifdef CONFIG_NX_SHADOWFB
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_NX_SHADOWFB_NRECTS
+#  define CONFIG_NX_SHADOWFB_NRECTS 8
+#endif
+
+#ifndef CONFIG_NX_SHADOWFB_RATE
+#  define CONFIG_NX_SHADOWFB_RATE 30
+#endif
+
+/* Time between two flushes of the damage, in milliseconds */
+
+#define SHADOWFB_PERIOD_MSEC (1000 / CONFIG_NX_SHADOWFB_RATE)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct nxbe_shadowfb_s
+{
+  FAR uint8_t *fb;                  /* The shadow of the display */
+  size_t stride;                    /* Length of one row of the shadow in bytes */
+  uint8_t bytesperpixel;            /* Size of one pixel in bytes */
+
+  /* The LCD driver's method to write to the display */
+
+  CODE int (*putrun)(fb_coord_t row, fb_coord_t col,
+                     FAR const uint8_t *buffer, size_t npixels);
+
+  systime_t lastflush;              /* Time of the last flush */
+  uint8_t ndamage;                  /* Number of damaged rectangles */
+  struct nxgl_rect_s damage[CONFIG_NX_SHADOWFB_NRECTS];
+
+  struct nxbe_shadowfb_stats_s stats;
+
+#ifdef CONFIG_NX_TILES
+  sem_t exclsem;                    /* Tile workers draw at the same time */
+#endif
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int nxbe_shadowfb_putrun(fb_coord_t row, fb_coord_t col,
+                                FAR const uint8_t *buffer, size_t npixels);
+static int nxbe_shadowfb_getrun(fb_coord_t row, fb_coord_t col,
+                                FAR uint8_t *buffer, size_t npixels);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* putrun() and getrun() carry no device pointer, so there can only be one */
+
+static struct nxbe_shadowfb_s g_shadowfb;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbe_shadowfb_adddamage
+ *
+ * Description:
+ *   Add a rectangle to the damage list.  It is merged with every damaged
+ *   rectangle that nxgl_rectmerge() finds worth sending as one box.  When
+ *   the list is full, the rectangle is merged with the one it wastes the
+ *   fewest pixels with.
+ *
+ ****************************************************************************/
+
+static void nxbe_shadowfb_adddamage(FAR struct nxbe_shadowfb_s *shadow,
+                                    FAR const struct nxgl_rect_s *rect)
+{
+  struct nxgl_rect_s update;
+  bool again;
+  int best;
+  int i;
+
+  nxgl_rectcopy(&update, rect);
+
+  do
+    {
+      again = false;
+
+      for (i = 0; i < shadow->ndamage; i++)
+        {
+          if (nxgl_rectmerge(&update, &update, &shadow->damage[i]))
+            {
+              /* Take the damaged rectangle out of the list and try again
+               * with the union, which may now touch others.
+               */
+
+              shadow->damage[i] = shadow->damage[--shadow->ndamage];
+              again = true;
+              break;
+            }
+        }
+    }
+  while (again);
+
+  if (shadow->ndamage >= CONFIG_NX_SHADOWFB_NRECTS)
+    {
+      /* No room.  Merge with the rectangle that wastes the fewest pixels. */
+
+      best = nxgl_rectcheapest(&update, shadow->damage, shadow->ndamage);
+      nxgl_rectunion(&shadow->damage[best], &shadow->damage[best], &update);
+      return;
+    }
+
+  nxgl_rectcopy(&shadow->damage[shadow->ndamage++], &update);
+}
+
+/****************************************************************************
+ * Name: nxbe_shadowfb_putrun
+ *
+ * Description:
+ *   Draw a run into the shadow and record it as damaged
+ *
+ ****************************************************************************/
+
+static int nxbe_shadowfb_putrun(fb_coord_t row, fb_coord_t col,
+                                FAR const uint8_t *buffer, size_t npixels)
+{
+  FAR struct nxbe_shadowfb_s *shadow = &g_shadowfb;
+  struct nxgl_rect_s rect;
+
+  memcpy(&shadow->fb[row * shadow->stride + col * shadow->bytesperpixel],
+         buffer, npixels * shadow->bytesperpixel);
+
+  rect.pt1.x = col;
+  rect.pt1.y = row;
+  rect.pt2.x = col + npixels - 1;
+  rect.pt2.y = row;
+
+#ifdef CONFIG_NX_TILES
+  while (sem_wait(&shadow->exclsem) < 0)
+    {
+      DEBUGASSERT(get_errno() == EINTR);
+    }
+#endif
+
+  nxbe_shadowfb_adddamage(shadow, &rect);
+  shadow->stats.drawn += npixels;
+
+#ifdef CONFIG_NX_TILES
+  sem_post(&shadow->exclsem);
+#endif
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxbe_shadowfb_getrun
+ *
+ * Description:
+ *   Read a run back from the shadow, without touching the bus
+ *
+ ****************************************************************************/
+
+static int nxbe_shadowfb_getrun(fb_coord_t row, fb_coord_t col,
+                                FAR uint8_t *buffer, size_t npixels)
+{
+  FAR struct nxbe_shadowfb_s *shadow = &g_shadowfb;
+
+  memcpy(buffer,
+         &shadow->fb[row * shadow->stride + col * shadow->bytesperpixel],
+         npixels * shadow->bytesperpixel);
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbe_shadowfb_initialize
+ *
+ * Description:
+ *   Put a RAM shadow of the display between the rasterizers of plane 0 and
+ *   the LCD driver.
+ *
+ ****************************************************************************/
+
+int nxbe_shadowfb_initialize(FAR struct nxbe_state_s *be)
+{
+  FAR struct nxbe_shadowfb_s *shadow = &g_shadowfb;
+  FAR struct lcd_planeinfo_s *pinfo = &be->plane[0].pinfo;
+
+  /* Runs of less than a byte per pixel do not start on byte boundaries */
+
+  if (pinfo->bpp < 8)
+    {
+      return -ENOSYS;
+    }
+
+  DEBUGASSERT(shadow->fb == NULL);
+
+  shadow->bytesperpixel = pinfo->bpp >> 3;
+  shadow->stride        = be->vinfo.xres * shadow->bytesperpixel;
+  shadow->fb            = (FAR uint8_t *)kmm_zalloc(shadow->stride * be->vinfo.yres);
+  if (shadow->fb == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  shadow->putrun    = pinfo->putrun;
+  shadow->lastflush = clock_systimer();
+
+#ifdef CONFIG_NX_TILES
+  sem_init(&shadow->exclsem, 0, 1);
+#endif
+
+  pinfo->putrun = nxbe_shadowfb_putrun;
+  pinfo->getrun = nxbe_shadowfb_getrun;
+
+  /* Everything has to go through the shadow */
+
+  pinfo->fillrun    = NULL;
+  pinfo->putrun1bpp = NULL;
+
+  ginfo("Shadow framebuffer %p, %u bytes\n", shadow->fb,
+        (unsigned int)(shadow->stride * be->vinfo.yres));
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxbe_shadowfb_deadline
+ *
+ * Description:
+ *   If there is damage waiting to be sent, return true and the absolute
+ *   time (CLOCK_REALTIME) at which it is due.
+ *
+ ****************************************************************************/
+
+bool nxbe_shadowfb_deadline(FAR struct timespec *abstime)
+{
+  FAR struct nxbe_shadowfb_s *shadow = &g_shadowfb;
+  uint32_t elapsed;
+  uint32_t remaining = 0;
+
+  if (shadow->ndamage == 0)
+    {
+      return false;
+    }
+
+  elapsed = TICK2MSEC(clock_systimer() - shadow->lastflush);
+  if (elapsed < SHADOWFB_PERIOD_MSEC)
+    {
+      remaining = SHADOWFB_PERIOD_MSEC - elapsed;
+    }
+
+  (void)clock_gettime(CLOCK_REALTIME, abstime);
+
+  abstime->tv_sec  += remaining / MSEC_PER_SEC;
+  abstime->tv_nsec += (remaining % MSEC_PER_SEC) * NSEC_PER_MSEC;
+  if (abstime->tv_nsec >= NSEC_PER_SEC)
+    {
+      abstime->tv_sec++;
+      abstime->tv_nsec -= NSEC_PER_SEC;
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: nxbe_shadowfb_update
+ *
+ * Description:
+ *   Send the damaged areas to the display if they are due, or right away if
+ *   'force' is true.
+ *
+ ****************************************************************************/
+
+void nxbe_shadowfb_update(bool force)
+{
+  FAR struct nxbe_shadowfb_s *shadow = &g_shadowfb;
+  FAR struct nxgl_rect_s *rect;
+  systime_t now;
+  size_t npixels;
+  fb_coord_t row;
+  int i;
+
+  if (shadow->ndamage == 0)
+    {
+      return;
+    }
+
+  now = clock_systimer();
+  if (!force && TICK2MSEC(now - shadow->lastflush) < SHADOWFB_PERIOD_MSEC)
+    {
+      return;
+    }
+
+  for (i = 0; i < shadow->ndamage; i++)
+    {
+      rect    = &shadow->damage[i];
+      npixels = rect->pt2.x - rect->pt1.x + 1;
+
+      for (row = rect->pt1.y; row <= rect->pt2.y; row++)
+        {
+          (void)shadow->putrun(row, rect->pt1.x,
+                               &shadow->fb[row * shadow->stride +
+                                           rect->pt1.x * shadow->bytesperpixel],
+                               npixels);
+        }
+
+      shadow->stats.sent += npixels * (rect->pt2.y - rect->pt1.y + 1);
+    }
+
+  shadow->ndamage   = 0;
+  shadow->lastflush = now;
+  shadow->stats.flushes++;
+}
+
+/****************************************************************************
+ * Name: nxbe_shadowfb_getstats
+ *
+ * Description:
+ *   Return the counters of the shadow framebuffer
+ *
+ ****************************************************************************/
+
+void nxbe_shadowfb_getstats(FAR struct nxbe_shadowfb_stats_s *stats)
+{
+  *stats = g_shadowfb.stats;
+}
+
+#endif /* CONFIG_NX_SHADOWFB */
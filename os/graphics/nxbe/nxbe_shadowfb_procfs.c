@@ -0,0 +1,266 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * graphics/nxbe/nxbe_shadowfb_procfs.c
+ *
+ * Shows how many pixels were drawn into the NX shadow framebuffer and how
+ * many of them were sent to the display.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/kmalloc.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/procfs.h>
+
+#include "nxbe.h"
+
+#if defined(CONFIG_NX_SHADOWFB) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_NXSHADOWFB)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SHADOWFB_LINELEN 128
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+/* This structure describes one open "file" */
+
+struct shadowfb_file_s {
+	struct procfs_file_s base;	/* Base open file structure */
+	unsigned int linesize;		/* Number of valid characters in line[] */
+	char line[SHADOWFB_LINELEN];	/* Pre-allocated buffer for formatted lines */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+/* File system methods */
+
+static int shadowfb_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode);
+static int shadowfb_close(FAR struct file *filep);
+static ssize_t shadowfb_read(FAR struct file *filep, FAR char *buffer, size_t buflen);
+
+static int shadowfb_dup(FAR const struct file *oldp, FAR struct file *newp);
+
+static int shadowfb_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_procfs.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations nxshadowfb_procfsoperations = {
+	shadowfb_open,				/* open */
+	shadowfb_close,				/* close */
+	shadowfb_read,				/* read */
+	NULL,						/* write */
+
+	shadowfb_dup,				/* dup */
+
+	NULL,						/* opendir */
+	NULL,						/* closedir */
+	NULL,						/* readdir */
+	NULL,						/* rewinddir */
+
+	shadowfb_stat				/* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: shadowfb_open
+ ****************************************************************************/
+
+static int shadowfb_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode)
+{
+	FAR struct shadowfb_file_s *attr;
+
+	fvdbg("Open '%s'\n", relpath);
+
+	/* PROCFS is read-only.  Any attempt to open with any kind of write
+	 * access is not permitted.
+	 */
+
+	if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0) {
+		fdbg("ERROR: Only O_RDONLY supported\n");
+		return -EACCES;
+	}
+
+	/* Allocate a container to hold the file attributes */
+
+	attr = (FAR struct shadowfb_file_s *)kmm_zalloc(sizeof(struct shadowfb_file_s));
+	if (!attr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* Save the attributes as the open-specific state in filep->f_priv */
+
+	filep->f_priv = (FAR void *)attr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: shadowfb_close
+ ****************************************************************************/
+
+static int shadowfb_close(FAR struct file *filep)
+{
+	FAR struct shadowfb_file_s *attr;
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct shadowfb_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Release the file attributes structure */
+
+	kmm_free(attr);
+	filep->f_priv = NULL;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: shadowfb_read
+ ****************************************************************************/
+
+static ssize_t shadowfb_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
+{
+	FAR struct shadowfb_file_s *attr;
+	struct nxbe_shadowfb_stats_s stats;
+	off_t offset;
+	ssize_t ret;
+
+	fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct shadowfb_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Take a snapshot of the counters on the first read, so that they stay
+	 * stable if the user reads in small pieces.
+	 */
+
+	if (filep->f_pos == 0) {
+		nxbe_shadowfb_getstats(&stats);
+		attr->linesize = snprintf(attr->line, SHADOWFB_LINELEN,
+								  "Drawn:   %llu\nSent:    %llu\nFlushes: %lu\n",
+								  (unsigned long long)stats.drawn,
+								  (unsigned long long)stats.sent,
+								  (unsigned long)stats.flushes);
+	}
+
+	/* Transfer the counters to user receive buffer */
+
+	offset = filep->f_pos;
+	ret = procfs_memcpy(attr->line, attr->linesize, buffer, buflen, &offset);
+
+	/* Update the file offset */
+
+	if (ret > 0) {
+		filep->f_pos += ret;
+	}
+
+	return ret;
+}
+
+/****************************************************************************
+ * Name: shadowfb_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int shadowfb_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+	FAR struct shadowfb_file_s *oldattr;
+	FAR struct shadowfb_file_s *newattr;
+
+	fvdbg("Dup %p->%p\n", oldp, newp);
+
+	/* Recover our private data from the old struct file instance */
+
+	oldattr = (FAR struct shadowfb_file_s *)oldp->f_priv;
+	DEBUGASSERT(oldattr);
+
+	/* Allocate a new container to hold the task and attribute selection */
+
+	newattr = (FAR struct shadowfb_file_s *)kmm_zalloc(sizeof(struct shadowfb_file_s));
+	if (!newattr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* The copy the file attributes from the old attributes to the new */
+
+	memcpy(newattr, oldattr, sizeof(struct shadowfb_file_s));
+
+	/* Save the new attributes in the new file structure */
+
+	newp->f_priv = (FAR void *)newattr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: shadowfb_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int shadowfb_stat(const char *relpath, struct stat *buf)
+{
+	/* File/directory size, access block size */
+
+	buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+	buf->st_size = 0;
+	buf->st_blksize = 0;
+	buf->st_blocks = 0;
+	return OK;
+}
+
+#endif /* CONFIG_NX_SHADOWFB && CONFIG_FS_PROCFS && !CONFIG_FS_PROCFS_EXCLUDE_NXSHADOWFB */
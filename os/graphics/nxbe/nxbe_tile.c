@@ -0,0 +1,314 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * graphics/nxbe/nxbe_tile.c
+ *
+ * Tile-parallel rasterization.  A visible rectangle that is large enough is
+ * cut into tiles of CONFIG_NX_TILES_ROWS full-width rows, which a pool of
+ * worker threads and the NX server itself take one at a time until none
+ * are left.  nxbe_tile_run() returns when every tile has been drawn, so
+ * the caller's arguments stay valid and display updates are still
+ * reported in order by the server thread.
+ *
+ * Each worker draws through private copies of the planes, so that the
+ * run buffer of an LCD plane is never shared between threads.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/kmalloc.h>
+#include <tinyara/kthread.h>
+#include <tinyara/nx/nxglib.h>
+
+#include "nxbe.h"
+
+#ifdef CONFIG_NX_TILES
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_NX_TILES_ROWS
+#  define CONFIG_NX_TILES_ROWS 16
+#endif
+
+#ifndef CONFIG_NX_TILES_MINPIXELS
+#  define CONFIG_NX_TILES_MINPIXELS 4096
+#endif
+
+#ifndef CONFIG_NX_TILES_STACKSIZE
+#  define CONFIG_NX_TILES_STACKSIZE 1024
+#endif
+
+#ifndef MIN
+#  define MIN(a,b) (((a) < (b)) ? (a) : (b))
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbe_tile_semtake
+ ****************************************************************************/
+
+static void nxbe_tile_semtake(FAR sem_t *sem)
+{
+  while (sem_wait(sem) < 0)
+    {
+      DEBUGASSERT(get_errno() == EINTR);
+    }
+}
+
+/****************************************************************************
+ * Name: nxbe_tile_work
+ *
+ * Description:
+ *   Draw tiles of the current rectangle through 'planes' until none are
+ *   left.
+ *
+ ****************************************************************************/
+
+static void nxbe_tile_work(FAR struct nxbe_tilepool_s *pool,
+                           FAR struct nxbe_plane_s *planes)
+{
+  FAR struct nxbe_plane_s *plane = &planes[pool->planeno];
+  struct nxgl_rect_s tile;
+  nxgl_coord_t row;
+
+  tile.pt1.x = pool->rect.pt1.x;
+  tile.pt2.x = pool->rect.pt2.x;
+
+  for (; ; )
+    {
+      nxbe_tile_semtake(&pool->exclsem);
+      row         = pool->next;
+      pool->next += CONFIG_NX_TILES_ROWS;
+      sem_post(&pool->exclsem);
+
+      if (row > pool->rect.pt2.y)
+        {
+          break;
+        }
+
+      tile.pt1.y = row;
+      tile.pt2.y = MIN(row + CONFIG_NX_TILES_ROWS - 1, pool->rect.pt2.y);
+
+      pool->draw(pool->arg, plane, &tile);
+    }
+}
+
+/****************************************************************************
+ * Name: nxbe_tile_worker
+ *
+ * Description:
+ *   Entry point of a worker thread.  argv[1] is the address of the worker
+ *   in hexadecimal.
+ *
+ ****************************************************************************/
+
+static int nxbe_tile_worker(int argc, char *argv[])
+{
+  FAR struct nxbe_tileworker_s *worker;
+  FAR struct nxbe_tilepool_s *pool;
+
+  DEBUGASSERT(argc > 1);
+  worker = (FAR struct nxbe_tileworker_s *)strtoul(argv[1], NULL, 16);
+  pool   = worker->pool;
+
+  for (; ; )
+    {
+      nxbe_tile_semtake(&pool->startsem);
+      nxbe_tile_work(pool, worker->plane);
+      sem_post(&pool->donesem);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbe_tile_initialize
+ *
+ * Description:
+ *   Start the tile workers at the priority of the calling NX server.  This
+ *   must be called after the rasterizers of every plane are selected.
+ *
+ ****************************************************************************/
+
+int nxbe_tile_initialize(FAR struct nxbe_state_s *be)
+{
+  FAR struct nxbe_tilepool_s *pool = &be->tiles;
+  FAR struct nxbe_tileworker_s *worker;
+  struct sched_param param;
+  FAR char *argv[2];
+  char addr[16];
+  pid_t pid;
+  int i;
+  int j;
+
+  memset(pool, 0, sizeof(struct nxbe_tilepool_s));
+
+  sem_init(&pool->exclsem, 0, 1);
+  sem_init(&pool->startsem, 0, 0);
+  sem_init(&pool->donesem, 0, 0);
+
+  /* startsem and donesem are used for signaling and, hence, should not
+   * have priority inheritance enabled.
+   */
+
+  sem_setprotocol(&pool->startsem, SEM_PRIO_NONE);
+  sem_setprotocol(&pool->donesem, SEM_PRIO_NONE);
+
+  (void)sched_getparam(0, &param);
+
+  for (i = 0; i < CONFIG_NX_TILES_NWORKERS; i++)
+    {
+      worker = &pool->worker[i];
+      worker->pool = pool;
+      memcpy(worker->plane, be->plane, sizeof(worker->plane));
+
+#ifdef CONFIG_NX_LCDDRIVER
+      /* Give the worker its own run buffer for each plane */
+
+      for (j = 0; j < be->vinfo.nplanes; j++)
+        {
+          worker->plane[j].pinfo.buffer = (FAR uint8_t *)
+            kmm_malloc((be->vinfo.xres * be->plane[j].pinfo.bpp + 7) >> 3);
+
+          if (worker->plane[j].pinfo.buffer == NULL)
+            {
+              gerr("ERROR: No run buffer for tile worker %d\n", i);
+              while (j-- > 0)
+                {
+                  kmm_free(worker->plane[j].pinfo.buffer);
+                }
+
+              return pool->nworkers > 0 ? OK : -ENOMEM;
+            }
+        }
+#else
+      UNUSED(j);
+#endif
+
+      snprintf(addr, sizeof(addr), "%lx", (unsigned long)(uintptr_t)worker);
+      argv[0] = addr;
+      argv[1] = NULL;
+
+      pid = kernel_thread("nxtile", param.sched_priority,
+                          CONFIG_NX_TILES_STACKSIZE, nxbe_tile_worker,
+                          (FAR char * const *)argv);
+      if (pid < 0)
+        {
+          gerr("ERROR: Failed to start tile worker %d: %d\n", i, errno);
+
+#ifdef CONFIG_NX_LCDDRIVER
+          for (j = 0; j < be->vinfo.nplanes; j++)
+            {
+              kmm_free(worker->plane[j].pinfo.buffer);
+            }
+#endif
+          return pool->nworkers > 0 ? OK : -errno;
+        }
+
+      pool->nworkers++;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxbe_tile_run
+ *
+ * Description:
+ *   Call draw(arg, plane, tile) for tiles that together cover 'rect',
+ *   spread over the tile workers.  Small rectangles are drawn directly by
+ *   the caller.  Returns when the whole rectangle has been drawn.
+ *
+ ****************************************************************************/
+
+void nxbe_tile_run(FAR struct nxbe_state_s *be,
+                   FAR struct nxbe_plane_s *plane,
+                   FAR const struct nxgl_rect_s *rect,
+                   nxbe_tiledraw_t draw, FAR void *arg)
+{
+  FAR struct nxbe_tilepool_s *pool = &be->tiles;
+  uint32_t width;
+  uint32_t height;
+  uint32_t ntiles;
+  int nhelpers;
+  int i;
+
+  width  = rect->pt2.x - rect->pt1.x + 1;
+  height = rect->pt2.y - rect->pt1.y + 1;
+
+  if (pool->nworkers == 0 || height <= CONFIG_NX_TILES_ROWS ||
+      width * height < CONFIG_NX_TILES_MINPIXELS)
+    {
+      draw(arg, plane, rect);
+      return;
+    }
+
+  DEBUGASSERT(plane >= be->plane && plane < &be->plane[CONFIG_NX_NPLANES]);
+
+  pool->draw    = draw;
+  pool->arg     = arg;
+  pool->planeno = plane - be->plane;
+  pool->next    = rect->pt1.y;
+  nxgl_rectcopy(&pool->rect, rect);
+
+  /* Wake no more workers than there are tiles left for them */
+
+  ntiles   = (height + CONFIG_NX_TILES_ROWS - 1) / CONFIG_NX_TILES_ROWS;
+  nhelpers = MIN(pool->nworkers, ntiles - 1);
+
+  for (i = 0; i < nhelpers; i++)
+    {
+      sem_post(&pool->startsem);
+    }
+
+  /* The server draws tiles too, then waits for the workers to finish theirs */
+
+  nxbe_tile_work(pool, be->plane);
+
+  for (i = 0; i < nhelpers; i++)
+    {
+      nxbe_tile_semtake(&pool->donesem);
+    }
+}
+
+#endif /* CONFIG_NX_TILES */
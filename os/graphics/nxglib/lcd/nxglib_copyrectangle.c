@@ -40,14 +40,180 @@
 #include <tinyara/config.h>
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
 #include <assert.h>
 
 #include <tinyara/lcd/lcd.h>
 #include <tinyara/nx/nxglib.h>
+#ifdef CONFIG_LCD_RA8875_COLOREXPAND
+#include <tinyara/lcd/ra8875.h>
+#endif
 
 #include "nxglib_bitblit.h"
 #include "nxglib_copyrun.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Two-color images, such as rendered font glyphs, can be sent at one bit
+ * per pixel if the pixels are addressable.
+ */
+
+#if NXGLIB_BITSPERPIXEL == 8 || NXGLIB_BITSPERPIXEL == 16 || \
+    NXGLIB_BITSPERPIXEL == 32
+#  define NXGL_TWOCOLOR 1
+
+/* Smaller images are cheaper to send as plain runs than to scan and pack */
+
+#  define NXGL_EXPAND_MINPIXELS 64
+#endif
+
+/* The RA8875 color expansion draws the whole image at once */
+
+#if defined(CONFIG_LCD_RA8875_COLOREXPAND) && !defined(CONFIG_NX_SHADOWFB) && \
+    (NXGLIB_BITSPERPIXEL == 8 || NXGLIB_BITSPERPIXEL == 16)
+#  define NXGL_COLOREXPAND 1
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxgl_twocolors
+ *
+ * Descripton:
+ *   Check if the source image holds no more than two colors.  If so, return
+ *   the background (first pixel) and foreground colors.
+ *
+ ****************************************************************************/
+
+#ifdef NXGL_TWOCOLOR
+static bool nxgl_twocolors(FAR const uint8_t *sline, unsigned int srcstride,
+                           unsigned int ncols, unsigned int nrows,
+                           FAR NXGL_PIXEL_T *fg, FAR NXGL_PIXEL_T *bg)
+{
+  FAR const NXGL_PIXEL_T *src;
+  unsigned int row;
+  unsigned int col;
+
+  *bg = *(FAR const NXGL_PIXEL_T *)sline;
+  *fg = *bg;
+
+  /* Give up as soon as a third color shows up */
+
+  for (row = 0; row < nrows; row++)
+    {
+      src = (FAR const NXGL_PIXEL_T *)(sline + row * srcstride);
+      for (col = 0; col < ncols; col++)
+        {
+          if (src[col] != *bg && src[col] != *fg)
+            {
+              if (*fg != *bg)
+                {
+                  return false;
+                }
+
+              *fg = src[col];
+            }
+        }
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: nxgl_packrow
+ *
+ * Descripton:
+ *   Pack one row of a two-color image to one bit per pixel, most
+ *   significant bit first.  Foreground pixels become set bits.
+ *
+ ****************************************************************************/
+
+static void nxgl_packrow(FAR uint8_t *bits, FAR const NXGL_PIXEL_T *src,
+                         unsigned int ncols, NXGL_PIXEL_T fg,
+                         NXGL_PIXEL_T bg)
+{
+  unsigned int col;
+
+  memset(bits, 0, (ncols + 7) >> 3);
+
+  if (fg != bg)
+    {
+      for (col = 0; col < ncols; col++)
+        {
+          if (src[col] == fg)
+            {
+              bits[col >> 3] |= 0x80 >> (col & 7);
+            }
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: nxgl_expandrectangle
+ *
+ * Descripton:
+ *   Pack a two-color image to 1bpp in the run buffer and let the RA8875
+ *   color expansion draw it.
+ *
+ ****************************************************************************/
+
+#ifdef NXGL_COLOREXPAND
+static void nxgl_expandrectangle(FAR struct lcd_planeinfo_s *pinfo,
+                                 FAR const struct nxgl_rect_s *dest,
+                                 FAR const uint8_t *sline,
+                                 unsigned int srcstride,
+                                 NXGL_PIXEL_T fg, NXGL_PIXEL_T bg)
+{
+  FAR uint8_t *bits;
+  unsigned int ncols;
+  unsigned int nrows;
+  unsigned int stride;
+  unsigned int maxrows;
+  unsigned int band;
+  unsigned int row;
+  unsigned int i;
+
+  ncols = dest->pt2.x - dest->pt1.x + 1;
+  nrows = dest->pt2.y - dest->pt1.y + 1;
+
+  /* The run buffer holds at least ncols pixels, so it fits this many rows
+   * of packed bits.
+   */
+
+  stride  = (ncols + 7) >> 3;
+  maxrows = (ncols * sizeof(NXGL_PIXEL_T)) / stride;
+
+  for (row = 0; row < nrows; row += band)
+    {
+      band = nrows - row;
+      if (band > maxrows)
+        {
+          band = maxrows;
+        }
+
+      /* Pack the band, one bit per pixel */
+
+      bits = pinfo->buffer;
+      for (i = 0; i < band; i++)
+        {
+          nxgl_packrow(bits,
+                       (FAR const NXGL_PIXEL_T *)(sline + (row + i) * srcstride),
+                       ncols, fg, bg);
+          bits += stride;
+        }
+
+      ra8875_expandbitmap(NULL, dest->pt1.x, dest->pt1.y + row, ncols, band,
+                          pinfo->buffer, fg, bg);
+    }
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -73,6 +239,11 @@ void NXGL_FUNCNAME(nxgl_copyrectangle, NXGLIB_SUFFIX)
 #if NXGLIB_BITSPERPIXEL < 8
   unsigned int remainder;
 #endif
+#ifdef NXGL_TWOCOLOR
+  unsigned int nrows;
+  NXGL_PIXEL_T fg;
+  NXGL_PIXEL_T bg;
+#endif
 
   /* Get the dimensions of the rectange to fill: width in pixels,
    * height in rows
@@ -88,6 +259,36 @@ void NXGL_FUNCNAME(nxgl_copyrectangle, NXGLIB_SUFFIX)
   remainder = NXGL_REMAINDERX(xoffset);
 #endif
 
+#ifdef NXGL_TWOCOLOR
+  /* Two-color images are sent at one bit per pixel */
+
+  nrows = dest->pt2.y - dest->pt1.y + 1;
+
+#ifdef NXGL_COLOREXPAND
+  if (ncols * nrows >= NXGL_EXPAND_MINPIXELS &&
+      nxgl_twocolors(sline, srcstride, ncols, nrows, &fg, &bg))
+    {
+      nxgl_expandrectangle(pinfo, dest, sline, srcstride, fg, bg);
+      return;
+    }
+#else
+  if (pinfo->putrun1bpp != NULL && ncols * nrows >= NXGL_EXPAND_MINPIXELS &&
+      nxgl_twocolors(sline, srcstride, ncols, nrows, &fg, &bg))
+    {
+      for (row = dest->pt1.y; row <= dest->pt2.y; row++)
+        {
+          nxgl_packrow(pinfo->buffer, (FAR const NXGL_PIXEL_T *)sline, ncols,
+                       fg, bg);
+          (void)pinfo->putrun1bpp(row, dest->pt1.x, pinfo->buffer, fg, bg,
+                                  ncols);
+          sline += srcstride;
+        }
+
+      return;
+    }
+#endif
+#endif
+
   /* Copy the image, one row at a time */
 
   for (row = dest->pt1.y; row <= dest->pt2.y; row++)
@@ -44,6 +44,9 @@
 
 #include <tinyara/lcd/lcd.h>
 #include <tinyara/nx/nxglib.h>
+#ifdef CONFIG_LCD_RA8875
+#include <tinyara/lcd/ra8875.h>
+#endif
 
 #include "nxglib_bitblit.h"
 #include "nxglib_fillrun.h"
@@ -56,6 +59,14 @@
 #  error "NXGLIB_SUFFIX must be defined before including this header file"
 #endif
 
+/* Let the RA8875 fill the rectangle itself, unless NX keeps a shadow of the
+ * display, which has to see every pixel.
+ */
+
+#if defined(CONFIG_LCD_RA8875) && !defined(CONFIG_NX_SHADOWFB)
+#  define NXGL_RA8875 1
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -74,7 +85,7 @@ void NXGL_FUNCNAME(nxgl_fillrectangle, NXGLIB_SUFFIX)
    NXGL_PIXEL_T color)
 {
   unsigned int ncols;
-#ifndef CONFIG_LCD_RA8875
+#ifndef NXGL_RA8875
   unsigned int row;
 #endif
 
@@ -82,10 +93,22 @@ void NXGL_FUNCNAME(nxgl_fillrectangle, NXGLIB_SUFFIX)
 
   ncols  = rect->pt2.x - rect->pt1.x + 1;
 
-#ifdef CONFIG_LCD_RA8875
+#ifdef NXGL_RA8875
   ra8875_drawrectangle(NULL, rect->pt1.x, rect->pt1.y, ncols, rect->pt2.y - rect->pt1.y + 1,
       color, true);
 #else
+  /* Let the driver repeat the color if it can */
+
+  if (pinfo->fillrun != NULL)
+    {
+      for (row = rect->pt1.y; row <= rect->pt2.y; row++)
+        {
+          (void)pinfo->fillrun(row, rect->pt1.x, color, ncols);
+        }
+
+      return;
+    }
+
   /* Fill the run buffer with the selected color */
 
   NXGL_FUNCNAME(nxgl_fillrun, NXGLIB_SUFFIX)((NXGLIB_RUNTYPE *)pinfo->buffer, color, ncols);
@@ -199,7 +199,10 @@ void NXGL_FUNCNAME(nxgl_filltrapezoid, NXGLIB_SUFFIX)
       ncols = botw;
     }
 
-  NXGL_FUNCNAME(nxgl_fillrun, NXGLIB_SUFFIX)((NXGLIB_RUNTYPE *)pinfo->buffer, color, ncols);
+  if (pinfo->fillrun == NULL)
+    {
+      NXGL_FUNCNAME(nxgl_fillrun, NXGLIB_SUFFIX)((NXGLIB_RUNTYPE *)pinfo->buffer, color, ncols);
+    }
 
   /* Then fill the trapezoid row-by-row */
 
@@ -232,7 +235,14 @@ void NXGL_FUNCNAME(nxgl_filltrapezoid, NXGLIB_SUFFIX)
           /* Then draw the run from ix1 to ix2 at row */
 
           ncols = ix2 - ix1 + 1;
-          (void)pinfo->putrun(row, ix1, pinfo->buffer, ncols);
+          if (pinfo->fillrun != NULL)
+            {
+              (void)pinfo->fillrun(row, ix1, color, ncols);
+            }
+          else
+            {
+              (void)pinfo->putrun(row, ix1, pinfo->buffer, ncols);
+            }
         }
 
       /* Add the dx/dy value to get the run positions on the next row */
@@ -43,9 +43,24 @@
 
 #include <tinyara/lcd/lcd.h>
 #include <tinyara/nx/nxglib.h>
+#ifdef CONFIG_LCD_RA8875
+#include <tinyara/lcd/ra8875.h>
+#endif
 
 #include "nxglib_bitblit.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Let the RA8875 move the rectangle itself, unless NX keeps a shadow of the
+ * display, which has to see every pixel.
+ */
+
+#if defined(CONFIG_LCD_RA8875) && !defined(CONFIG_NX_SHADOWFB)
+#  define NXGL_RA8875 1
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -66,13 +81,22 @@ void NXGL_FUNCNAME(nxgl_moverectangle, NXGLIB_SUFFIX)
  FAR struct nxgl_point_s *offset)
 {
   unsigned int ncols;
+#ifndef NXGL_RA8875
   unsigned int srcrow;
   unsigned int destrow;
+#endif
 
   /* Get the width of the rectange to move in pixels. */
 
   ncols = rect->pt2.x - rect->pt1.x + 1;
 
+#ifdef NXGL_RA8875
+  /* Let the Block Transfer Engine move the rectangle within display memory */
+
+  ra8875_moverectangle(NULL, rect->pt1.x, rect->pt1.y, ncols,
+                       rect->pt2.y - rect->pt1.y + 1, offset->x, offset->y);
+#else
+
   /* Case 1:  The destination position (offset) is above the displayed
    * position (rect)
    */
@@ -108,4 +132,5 @@ void NXGL_FUNCNAME(nxgl_moverectangle, NXGLIB_SUFFIX)
           (void)pinfo->putrun(destrow, offset->x, pinfo->buffer, ncols);
         }
     }
+#endif
 }
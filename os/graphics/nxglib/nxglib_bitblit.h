@@ -46,6 +46,8 @@
 
 #include <tinyara/nx/nxglib.h>
 
+#include "nxglib_wordrun.h"
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -187,6 +189,27 @@
 #endif /* CONFIG_NX_ANTIALIASING */
 #else /* NXGLIB_BITSPERPIXEL == 16 || NXGLIB_BITSPERPIXEL == 32 */
 
+#ifdef CONFIG_NX_WORDRUNS
+
+/* Fill and copy whole words at a time */
+
+#  if NXGLIB_BITSPERPIXEL == 16
+#    define NXGL_FILLWORDS         nxgl_fillwords_16bpp
+#    define NXGL_COPYWORDS         nxgl_copywords_16bpp
+#  else
+#    define NXGL_FILLWORDS         nxgl_fillwords_32bpp
+#    define NXGL_COPYWORDS         nxgl_copywords_32bpp
+#  endif
+
+#  define NXGL_MEMSET(dest,value,width) \
+   NXGL_FILLWORDS((FAR NXGL_PIXEL_T*)(dest), (NXGL_PIXEL_T)(value), (width))
+
+#  define NXGL_MEMCPY(dest,src,width) \
+   NXGL_COPYWORDS((FAR NXGL_PIXEL_T*)(dest), (FAR const NXGL_PIXEL_T*)(src), \
+                  (width))
+
+#else
+
 #  define NXGL_MEMSET(dest,value,width) \
    { \
      FAR NXGL_PIXEL_T *_ptr = (FAR NXGL_PIXEL_T*)(dest); \
@@ -208,6 +231,8 @@
        } \
    }
 
+#endif /* CONFIG_NX_WORDRUNS */
+
 #ifdef CONFIG_NX_ANTIALIASING
 
 #  define NXGL_BLEND(dest,color1,frac) \
@@ -44,6 +44,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "nxglib_wordrun.h"
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -159,12 +161,16 @@ static inline void nxgl_fillrun_8bpp(FAR uint8_t *run, nxgl_mxpixel_t color,
 static inline void nxgl_fillrun_16bpp(FAR uint16_t *run, nxgl_mxpixel_t color,
                                       size_t npixels)
 {
+#ifdef CONFIG_NX_WORDRUNS
+  nxgl_fillwords_16bpp(run, (uint16_t)color, npixels);
+#else
   /* Fill the run with the color (it is okay to run a fractional byte overy the end */
 
   while (npixels-- > 0)
     {
       *run++ = (uint16_t)color;
     }
+#endif
 }
 
 #elif NXGLIB_BITSPERPIXEL == 24
@@ -181,12 +187,16 @@ static inline void nxgl_fillrun_24bpp(FAR uint32_t *run, nxgl_mxpixel_t color, s
 #elif NXGLIB_BITSPERPIXEL == 32
 static inline void nxgl_fillrun_32bpp(FAR uint32_t *run, nxgl_mxpixel_t color, size_t npixels)
 {
+#ifdef CONFIG_NX_WORDRUNS
+  nxgl_fillwords_32bpp(run, (uint32_t)color, npixels);
+#else
   /* Fill the run with the color (it is okay to run a fractional byte overy the end */
 
   while (npixels-- > 0)
     {
       *run++ = (uint32_t)color;
     }
+#endif
 }
 #else
 #  error "Unsupported value of NXGLIB_BITSPERPIXEL"
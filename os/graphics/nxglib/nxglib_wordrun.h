@@ -0,0 +1,227 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * graphics/nxglib/nxglib_wordrun.h
+ *
+ * Word-wide run kernels for 16 and 32 bpp.  Runs are filled and copied
+ * 32 bits at a time, four words per loop iteration so that the compiler
+ * can use multiple-register stores (STM on ARM) or vector stores on hosts
+ * that have them.  A leading 16-bit pixel that is not on a word boundary
+ * and a trailing odd pixel are handled separately.
+ *
+ ****************************************************************************/
+
+#ifndef __GRAPHICS_NXGLIB_NXGLIB_WORDRUN_H
+#define __GRAPHICS_NXGLIB_NXGLIB_WORDRUN_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef CONFIG_NX_WORDRUNS
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Number of 32-bit words moved by one iteration of the unrolled loops */
+
+#define NXGL_WORDS_PER_LOOP 4
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxgl_fillwords
+ *
+ * Description:
+ *   Store 'wide' into 'nwords' consecutive, aligned words.
+ *
+ ****************************************************************************/
+
+static inline FAR uint32_t *nxgl_fillwords(FAR uint32_t *dest, uint32_t wide,
+                                           size_t nwords)
+{
+  while (nwords >= NXGL_WORDS_PER_LOOP)
+    {
+      dest[0] = wide;
+      dest[1] = wide;
+      dest[2] = wide;
+      dest[3] = wide;
+      dest   += NXGL_WORDS_PER_LOOP;
+      nwords -= NXGL_WORDS_PER_LOOP;
+    }
+
+  while (nwords-- > 0)
+    {
+      *dest++ = wide;
+    }
+
+  return dest;
+}
+
+/****************************************************************************
+ * Name: nxgl_copywords
+ *
+ * Description:
+ *   Copy 'nwords' aligned words from 'src' to 'dest'.  The copy runs
+ *   forward and every group of words is read before it is written, so, like
+ *   the pixel loops that it replaces, it may move a run to a lower address
+ *   within the same row.
+ *
+ ****************************************************************************/
+
+static inline void nxgl_copywords(FAR uint32_t *dest, FAR const uint32_t *src,
+                                  size_t nwords)
+{
+  uint32_t w0;
+  uint32_t w1;
+  uint32_t w2;
+  uint32_t w3;
+
+  while (nwords >= NXGL_WORDS_PER_LOOP)
+    {
+      w0      = src[0];
+      w1      = src[1];
+      w2      = src[2];
+      w3      = src[3];
+      dest[0] = w0;
+      dest[1] = w1;
+      dest[2] = w2;
+      dest[3] = w3;
+      src    += NXGL_WORDS_PER_LOOP;
+      dest   += NXGL_WORDS_PER_LOOP;
+      nwords -= NXGL_WORDS_PER_LOOP;
+    }
+
+  while (nwords-- > 0)
+    {
+      *dest++ = *src++;
+    }
+}
+
+/****************************************************************************
+ * Name: nxgl_fillwords_16bpp
+ *
+ * Description:
+ *   Fill a run of 16-bit pixels with the specified color.
+ *
+ ****************************************************************************/
+
+static inline void nxgl_fillwords_16bpp(FAR uint16_t *dest, uint16_t color,
+                                        size_t npixels)
+{
+  /* Bring the destination to a word boundary */
+
+  if (npixels > 0 && ((uintptr_t)dest & 2) != 0)
+    {
+      *dest++ = color;
+      npixels--;
+    }
+
+  dest = (FAR uint16_t *)
+    nxgl_fillwords((FAR uint32_t *)dest,
+                   (uint32_t)color | ((uint32_t)color << 16), npixels >> 1);
+
+  /* Then the odd pixel at the end, if any */
+
+  if ((npixels & 1) != 0)
+    {
+      *dest = color;
+    }
+}
+
+/****************************************************************************
+ * Name: nxgl_fillwords_32bpp
+ *
+ * Description:
+ *   Fill a run of 32-bit pixels with the specified color.
+ *
+ ****************************************************************************/
+
+static inline void nxgl_fillwords_32bpp(FAR uint32_t *dest, uint32_t color,
+                                        size_t npixels)
+{
+  (void)nxgl_fillwords(dest, color, npixels);
+}
+
+/****************************************************************************
+ * Name: nxgl_copywords_16bpp
+ *
+ * Description:
+ *   Copy a run of 16-bit pixels.  Runs whose source and destination are
+ *   not equally aligned are copied one pixel at a time.
+ *
+ ****************************************************************************/
+
+static inline void nxgl_copywords_16bpp(FAR uint16_t *dest,
+                                        FAR const uint16_t *src,
+                                        size_t npixels)
+{
+  if ((((uintptr_t)dest ^ (uintptr_t)src) & 2) != 0)
+    {
+      while (npixels-- > 0)
+        {
+          *dest++ = *src++;
+        }
+
+      return;
+    }
+
+  /* Bring both pointers to a word boundary */
+
+  if (npixels > 0 && ((uintptr_t)dest & 2) != 0)
+    {
+      *dest++ = *src++;
+      npixels--;
+    }
+
+  nxgl_copywords((FAR uint32_t *)dest, (FAR const uint32_t *)src,
+                 npixels >> 1);
+
+  /* Then the odd pixel at the end, if any */
+
+  if ((npixels & 1) != 0)
+    {
+      dest[npixels - 1] = src[npixels - 1];
+    }
+}
+
+/****************************************************************************
+ * Name: nxgl_copywords_32bpp
+ *
+ * Description:
+ *   Copy a run of 32-bit pixels.
+ *
+ ****************************************************************************/
+
+static inline void nxgl_copywords_32bpp(FAR uint32_t *dest,
+                                        FAR const uint32_t *src,
+                                        size_t npixels)
+{
+  nxgl_copywords(dest, src, npixels);
+}
+
+#endif /* CONFIG_NX_WORDRUNS */
+#endif /* __GRAPHICS_NXGLIB_NXGLIB_WORDRUN_H */
@@ -61,6 +61,15 @@
  * Private Types
  ****************************************************************************/
 
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_CMDRING
+static void nxmu_drainring(FAR struct nxfe_state_s *fe,
+                           FAR struct nxfe_conn_s *conn);
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -267,6 +276,285 @@ static inline int nxmu_setup(FAR const char *mqname, FAR NX_DRIVERTYPE *dev,
   return OK;
 }
 
+/****************************************************************************
+ * Name: nxmu_dispatch
+ *
+ * Description:
+ *   Execute one client-to-server message, taken either from the server
+ *   message queue or from the command ring of a client connection.
+ *
+ ****************************************************************************/
+
+static void nxmu_dispatch(FAR struct nxfe_state_s *fe,
+                          FAR struct nxsvrmsg_s *msg)
+{
+  switch (msg->msgid)
+    {
+    /* Messages sent from clients to the NX server *********************/
+
+    case NX_SVRMSG_CONNECT: /* Establish connection with new NX server client */
+      {
+        FAR struct nxsvrmsg_s *connmsg = (FAR struct nxsvrmsg_s *)msg;
+        nxmu_connect(connmsg->conn);
+      }
+      break;
+
+    case NX_SVRMSG_DISCONNECT: /* Tear down connection with terminating client */
+      {
+        FAR struct nxsvrmsg_s *disconnmsg = (FAR struct nxsvrmsg_s *)msg;
+        nxmu_disconnect(disconnmsg->conn);
+      }
+      break;
+
+    case NX_SVRMSG_OPENWINDOW: /* Create a new window */
+      {
+        FAR struct nxsvrmsg_openwindow_s *openmsg = (FAR struct nxsvrmsg_openwindow_s *)msg;
+        nxmu_openwindow(&fe->be, openmsg->wnd);
+      }
+      break;
+
+    case NX_SVRMSG_CLOSEWINDOW: /* Close an existing window */
+      {
+        FAR struct nxsvrmsg_closewindow_s *closemsg = (FAR struct nxsvrmsg_closewindow_s *)msg;
+        nxbe_closewindow(closemsg->wnd);
+      }
+      break;
+
+    case NX_SVRMSG_BLOCKED: /* Block messsages to a window */
+      {
+        FAR struct nxsvrmsg_blocked_s *blocked = (FAR struct nxsvrmsg_blocked_s *)msg;
+        nxmu_blocked(blocked->wnd, blocked->arg);
+      }
+      break;
+
+    case NX_SVRMSG_REQUESTBKGD: /* Give access to the background window */
+      {
+        FAR struct nxsvrmsg_requestbkgd_s *rqbgmsg = (FAR struct nxsvrmsg_requestbkgd_s *)msg;
+        nxmu_requestbkgd(rqbgmsg->conn, &fe->be, rqbgmsg->cb, rqbgmsg->arg);
+      }
+      break;
+
+    case NX_SVRMSG_RELEASEBKGD: /* End access to the background window */
+      {
+        nxmu_releasebkgd(fe);
+      }
+      break;
+
+    case NX_SVRMSG_SETPOSITION: /* Change window position */
+      {
+        FAR struct nxsvrmsg_setposition_s *setposmsg = (FAR struct nxsvrmsg_setposition_s *)msg;
+        nxbe_setposition(setposmsg->wnd, &setposmsg->pos);
+      }
+      break;
+
+    case NX_SVRMSG_SETSIZE: /* Change window size */
+      {
+        FAR struct nxsvrmsg_setsize_s *setsizemsg = (FAR struct nxsvrmsg_setsize_s *)msg;
+        nxbe_setsize(setsizemsg->wnd, &setsizemsg->size);
+      }
+      break;
+
+    case NX_SVRMSG_GETPOSITION: /* Get the window size/position */
+      {
+        FAR struct nxsvrmsg_getposition_s *getposmsg = (FAR struct nxsvrmsg_getposition_s *)msg;
+        nxfe_reportposition(getposmsg->wnd);
+      }
+      break;
+
+    case NX_SVRMSG_RAISE: /* Move the window to the top of the display */
+      {
+        FAR struct nxsvrmsg_raise_s *raisemsg = (FAR struct nxsvrmsg_raise_s *)msg;
+        nxbe_raise(raisemsg->wnd);
+      }
+      break;
+
+    case NX_SVRMSG_LOWER: /* Lower the window to the bottom of the display */
+      {
+        FAR struct nxsvrmsg_lower_s *lowermsg = (FAR struct nxsvrmsg_lower_s *)msg;
+        nxbe_lower(lowermsg->wnd);
+      }
+      break;
+
+    case NX_SVRMSG_SETPIXEL: /* Set a single pixel in the window with a color */
+      {
+        FAR struct nxsvrmsg_setpixel_s *setmsg = (FAR struct nxsvrmsg_setpixel_s *)msg;
+        nxbe_setpixel(setmsg->wnd, &setmsg->pos, setmsg->color);
+      }
+      break;
+
+    case NX_SVRMSG_FILL: /* Fill a rectangular region in the window with a color */
+      {
+        FAR struct nxsvrmsg_fill_s *fillmsg = (FAR struct nxsvrmsg_fill_s *)msg;
+        nxbe_fill(fillmsg->wnd, &fillmsg->rect, fillmsg->color);
+      }
+      break;
+
+    case NX_SVRMSG_GETRECTANGLE: /* Get a rectangular region from the window */
+      {
+        FAR struct nxsvrmsg_getrectangle_s *getmsg = (FAR struct nxsvrmsg_getrectangle_s *)msg;
+        nxbe_getrectangle(getmsg->wnd, &getmsg->rect, getmsg->plane, getmsg->dest, getmsg->deststride);
+
+        if (getmsg->sem_done)
+         {
+           sem_post(getmsg->sem_done);
+         }
+      }
+      break;
+
+    case NX_SVRMSG_FILLTRAP: /* Fill a trapezoidal region in the window with a color */
+      {
+        FAR struct nxsvrmsg_filltrapezoid_s *trapmsg = (FAR struct nxsvrmsg_filltrapezoid_s *)msg;
+        nxbe_filltrapezoid(trapmsg->wnd, &trapmsg->clip, &trapmsg->trap, trapmsg->color);
+      }
+      break;
+    case NX_SVRMSG_MOVE: /* Move a rectangular region within the window */
+      {
+        FAR struct nxsvrmsg_move_s *movemsg = (FAR struct nxsvrmsg_move_s *)msg;
+        nxbe_move(movemsg->wnd, &movemsg->rect, &movemsg->offset);
+      }
+      break;
+
+    case NX_SVRMSG_BITMAP: /* Copy a rectangular bitmap into the window */
+      {
+        FAR struct nxsvrmsg_bitmap_s *bmpmsg = (FAR struct nxsvrmsg_bitmap_s *)msg;
+        nxbe_bitmap(bmpmsg->wnd, &bmpmsg->dest, bmpmsg->src, &bmpmsg->origin, bmpmsg->stride);
+
+        if (bmpmsg->sem_done)
+         {
+           sem_post(bmpmsg->sem_done);
+         }
+      }
+      break;
+
+    case NX_SVRMSG_SETBGCOLOR: /* Set the color of the background */
+      {
+        FAR struct nxsvrmsg_setbgcolor_s *bgcolormsg =
+          (FAR struct nxsvrmsg_setbgcolor_s *)msg;
+
+        /* Has the background color changed? */
+
+        if (!nxgl_colorcmp(fe->be.bgcolor, bgcolormsg->color))
+          {
+            /* Yes.. fill the background */
+
+            nxgl_colorcopy(fe->be.bgcolor, bgcolormsg->color);
+            nxbe_fill(&fe->be.bkgd, &fe->be.bkgd.bounds, bgcolormsg->color);
+          }
+      }
+      break;
+
+#ifdef CONFIG_NX_XYINPUT
+    case NX_SVRMSG_MOUSEIN: /* New mouse report from mouse client */
+      {
+        FAR struct nxsvrmsg_mousein_s *mousemsg = (FAR struct nxsvrmsg_mousein_s *)msg;
+        nxmu_mousein(fe, &mousemsg->pt, mousemsg->buttons);
+      }
+      break;
+#endif
+#ifdef CONFIG_NX_KBD
+    case NX_SVRMSG_KBDIN: /* New keyboard report from keyboard client */
+      {
+        FAR struct nxsvrmsg_kbdin_s *kbdmsg = (FAR struct nxsvrmsg_kbdin_s *)msg;
+        nxmu_kbdin(fe, kbdmsg->nch, kbdmsg->ch);
+      }
+      break;
+#endif
+
+    case NX_SVRMSG_REDRAWREQ: /* Request re-drawing of rectangular region */
+      {
+        FAR struct nxsvrmsg_redrawreq_s *redrawmsg = (FAR struct nxsvrmsg_redrawreq_s *)msg;
+        nxfe_redrawreq(redrawmsg->wnd, &redrawmsg->rect);
+      }
+      break;
+
+#ifdef CONFIG_NX_CMDRING
+    case NX_SVRMSG_DRAIN: /* Execute the commands queued in a client's ring */
+      {
+        FAR struct nxsvrmsg_s *drainmsg = (FAR struct nxsvrmsg_s *)msg;
+        nxmu_drainring(fe, drainmsg->conn);
+      }
+      break;
+#endif
+
+  /* Messages sent to the background window **************************/
+
+    case NX_CLIMSG_REDRAW: /* Re-draw the background window */
+       {
+         FAR struct nxclimsg_redraw_s *redraw = (FAR struct nxclimsg_redraw_s *)msg;
+         DEBUGASSERT(redraw->wnd == &fe->be.bkgd);
+         ginfo("Re-draw background rect={(%d,%d),(%d,%d)}\n",
+               redraw->rect.pt1.x, redraw->rect.pt1.y,
+               redraw->rect.pt2.x, redraw->rect.pt2.y);
+         nxbe_fill(&fe->be.bkgd, &redraw->rect, fe->be.bgcolor);
+       }
+     break;
+
+    case NX_CLIMSG_MOUSEIN:      /* Ignored */
+    case NX_CLIMSG_KBDIN:
+      break;
+
+    case NX_CLIMSG_CONNECTED:    /* Shouldn't happen */
+    case NX_CLIMSG_DISCONNECTED:
+    default:
+      gerr("ERROR: Unrecognized command: %d\n", msg->msgid);
+      break;
+    }
+}
+
+#ifdef CONFIG_NX_CMDRING
+/****************************************************************************
+ * Name: nxmu_drainring
+ *
+ * Description:
+ *   Execute all of the commands queued in the command ring of a client
+ *   connection, in order, and signal the client when the fence that it
+ *   waits for is reached.
+ *
+ ****************************************************************************/
+
+static void nxmu_drainring(FAR struct nxfe_state_s *fe,
+                           FAR struct nxfe_conn_s *conn)
+{
+  FAR struct nxmu_ring_s *ring = conn->ring;
+  FAR struct nxsvrmsg_s *msg;
+  uint32_t nwaiters;
+
+  DEBUGASSERT(ring != NULL);
+
+  /* Clear the request first so that commands queued from now on wake the
+   * server again.
+   */
+
+  ring->kicked = false;
+
+  while (ring->tail != ring->head)
+    {
+      msg = &ring->slot[ring->tail % CONFIG_NX_CMDRING_NSLOTS].hdr;
+      ginfo("Ring cid=%d opcode=%d\n", conn->cid, msg->msgid);
+      nxmu_dispatch(fe, msg);
+
+      /* The slot may be reused by the client once tail moves past it.
+       * Every client thread that waits is woken to compare tail with its
+       * own fence.  tail is stored before the waiters are counted, and the
+       * waiters count themselves before they test tail, so no waiter can
+       * miss the update.
+       */
+
+      __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_SEQ_CST);
+
+      if (__atomic_load_n(&ring->nwaiters, __ATOMIC_SEQ_CST) > 0)
+        {
+          nwaiters = __atomic_exchange_n(&ring->nwaiters, 0,
+                                         __ATOMIC_SEQ_CST);
+          while (nwaiters-- > 0)
+            {
+              sem_post(&ring->fencesem);
+            }
+        }
+    }
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -298,6 +586,9 @@ int nx_runinstance(FAR const char *mqname, FAR NX_DRIVERTYPE *dev)
   char                   buffer[NX_MXSVRMSGLEN];
   int                    nbytes;
   int                    ret;
+#ifdef CONFIG_NX_SHADOWFB
+  struct timespec        abstime;
+#endif
 
   /* Initialization *********************************************************/
 
@@ -331,9 +622,29 @@ int nx_runinstance(FAR const char *mqname, FAR NX_DRIVERTYPE *dev)
     {
        /* Receive the next server message */
 
-       nbytes = mq_receive(fe.conn.crdmq, buffer, NX_MXSVRMSGLEN, 0);
+#ifdef CONFIG_NX_SHADOWFB
+       /* Wake up in time to send damage from the shadow framebuffer */
+
+       if (nxbe_shadowfb_deadline(&abstime))
+         {
+           nbytes = mq_timedreceive(fe.conn.crdmq, buffer, NX_MXSVRMSGLEN, 0, &abstime);
+         }
+       else
+#endif
+         {
+           nbytes = mq_receive(fe.conn.crdmq, buffer, NX_MXSVRMSGLEN, 0);
+         }
+
        if (nbytes < 0)
          {
+#ifdef CONFIG_NX_SHADOWFB
+           if (get_errno() == ETIMEDOUT)
+             {
+               nxbe_shadowfb_update(true);
+               continue;
+             }
+#endif
+
            if (nbytes != -EINTR)
              {
                gerr("ERROR: mq_receive() failed: %d\n", nbytes);
@@ -350,208 +661,13 @@ int nx_runinstance(FAR const char *mqname, FAR NX_DRIVERTYPE *dev)
        msg = (FAR struct nxsvrmsg_s *)buffer;
 
        ginfo("Received opcode=%d nbytes=%d\n", msg->msgid, nbytes);
-       switch (msg->msgid)
-         {
-         /* Messages sent from clients to the NX server *********************/
-
-         case NX_SVRMSG_CONNECT: /* Establish connection with new NX server client */
-           {
-             FAR struct nxsvrmsg_s *connmsg = (FAR struct nxsvrmsg_s *)buffer;
-             nxmu_connect(connmsg->conn);
-           }
-           break;
-
-         case NX_SVRMSG_DISCONNECT: /* Tear down connection with terminating client */
-           {
-             FAR struct nxsvrmsg_s *disconnmsg = (FAR struct nxsvrmsg_s *)buffer;
-             nxmu_disconnect(disconnmsg->conn);
-           }
-           break;
-
-         case NX_SVRMSG_OPENWINDOW: /* Create a new window */
-           {
-             FAR struct nxsvrmsg_openwindow_s *openmsg = (FAR struct nxsvrmsg_openwindow_s *)buffer;
-             nxmu_openwindow(&fe.be, openmsg->wnd);
-           }
-           break;
-
-         case NX_SVRMSG_CLOSEWINDOW: /* Close an existing window */
-           {
-             FAR struct nxsvrmsg_closewindow_s *closemsg = (FAR struct nxsvrmsg_closewindow_s *)buffer;
-             nxbe_closewindow(closemsg->wnd);
-           }
-           break;
-
-         case NX_SVRMSG_BLOCKED: /* Block messsages to a window */
-           {
-             FAR struct nxsvrmsg_blocked_s *blocked = (FAR struct nxsvrmsg_blocked_s *)buffer;
-             nxmu_blocked(blocked->wnd, blocked->arg);
-           }
-           break;
-
-         case NX_SVRMSG_REQUESTBKGD: /* Give access to the background window */
-           {
-             FAR struct nxsvrmsg_requestbkgd_s *rqbgmsg = (FAR struct nxsvrmsg_requestbkgd_s *)buffer;
-             nxmu_requestbkgd(rqbgmsg->conn, &fe.be, rqbgmsg->cb, rqbgmsg->arg);
-           }
-           break;
-
-         case NX_SVRMSG_RELEASEBKGD: /* End access to the background window */
-           {
-             nxmu_releasebkgd(&fe);
-           }
-           break;
-
-         case NX_SVRMSG_SETPOSITION: /* Change window position */
-           {
-             FAR struct nxsvrmsg_setposition_s *setposmsg = (FAR struct nxsvrmsg_setposition_s *)buffer;
-             nxbe_setposition(setposmsg->wnd, &setposmsg->pos);
-           }
-           break;
-
-         case NX_SVRMSG_SETSIZE: /* Change window size */
-           {
-             FAR struct nxsvrmsg_setsize_s *setsizemsg = (FAR struct nxsvrmsg_setsize_s *)buffer;
-             nxbe_setsize(setsizemsg->wnd, &setsizemsg->size);
-           }
-           break;
-
-         case NX_SVRMSG_GETPOSITION: /* Get the window size/position */
-           {
-             FAR struct nxsvrmsg_getposition_s *getposmsg = (FAR struct nxsvrmsg_getposition_s *)buffer;
-             nxfe_reportposition(getposmsg->wnd);
-           }
-           break;
-
-         case NX_SVRMSG_RAISE: /* Move the window to the top of the display */
-           {
-             FAR struct nxsvrmsg_raise_s *raisemsg = (FAR struct nxsvrmsg_raise_s *)buffer;
-             nxbe_raise(raisemsg->wnd);
-           }
-           break;
-
-         case NX_SVRMSG_LOWER: /* Lower the window to the bottom of the display */
-           {
-             FAR struct nxsvrmsg_lower_s *lowermsg = (FAR struct nxsvrmsg_lower_s *)buffer;
-             nxbe_lower(lowermsg->wnd);
-           }
-           break;
-
-         case NX_SVRMSG_SETPIXEL: /* Set a single pixel in the window with a color */
-           {
-             FAR struct nxsvrmsg_setpixel_s *setmsg = (FAR struct nxsvrmsg_setpixel_s *)buffer;
-             nxbe_setpixel(setmsg->wnd, &setmsg->pos, setmsg->color);
-           }
-           break;
-
-         case NX_SVRMSG_FILL: /* Fill a rectangular region in the window with a color */
-           {
-             FAR struct nxsvrmsg_fill_s *fillmsg = (FAR struct nxsvrmsg_fill_s *)buffer;
-             nxbe_fill(fillmsg->wnd, &fillmsg->rect, fillmsg->color);
-           }
-           break;
-
-         case NX_SVRMSG_GETRECTANGLE: /* Get a rectangular region from the window */
-           {
-             FAR struct nxsvrmsg_getrectangle_s *getmsg = (FAR struct nxsvrmsg_getrectangle_s *)buffer;
-             nxbe_getrectangle(getmsg->wnd, &getmsg->rect, getmsg->plane, getmsg->dest, getmsg->deststride);
-
-             if (getmsg->sem_done)
-              {
-                sem_post(getmsg->sem_done);
-              }
-           }
-           break;
-
-         case NX_SVRMSG_FILLTRAP: /* Fill a trapezoidal region in the window with a color */
-           {
-             FAR struct nxsvrmsg_filltrapezoid_s *trapmsg = (FAR struct nxsvrmsg_filltrapezoid_s *)buffer;
-             nxbe_filltrapezoid(trapmsg->wnd, &trapmsg->clip, &trapmsg->trap, trapmsg->color);
-           }
-           break;
-         case NX_SVRMSG_MOVE: /* Move a rectangular region within the window */
-           {
-             FAR struct nxsvrmsg_move_s *movemsg = (FAR struct nxsvrmsg_move_s *)buffer;
-             nxbe_move(movemsg->wnd, &movemsg->rect, &movemsg->offset);
-           }
-           break;
-
-         case NX_SVRMSG_BITMAP: /* Copy a rectangular bitmap into the window */
-           {
-             FAR struct nxsvrmsg_bitmap_s *bmpmsg = (FAR struct nxsvrmsg_bitmap_s *)buffer;
-             nxbe_bitmap(bmpmsg->wnd, &bmpmsg->dest, bmpmsg->src, &bmpmsg->origin, bmpmsg->stride);
-
-             if (bmpmsg->sem_done)
-              {
-                sem_post(bmpmsg->sem_done);
-              }
-           }
-           break;
-
-         case NX_SVRMSG_SETBGCOLOR: /* Set the color of the background */
-           {
-             FAR struct nxsvrmsg_setbgcolor_s *bgcolormsg =
-               (FAR struct nxsvrmsg_setbgcolor_s *)buffer;
-
-             /* Has the background color changed? */
-
-             if (!nxgl_colorcmp(fe.be.bgcolor, bgcolormsg->color))
-               {
-                 /* Yes.. fill the background */
-
-                 nxgl_colorcopy(fe.be.bgcolor, bgcolormsg->color);
-                 nxbe_fill(&fe.be.bkgd, &fe.be.bkgd.bounds, bgcolormsg->color);
-               }
-           }
-           break;
+       nxmu_dispatch(&fe, msg);
 
-#ifdef CONFIG_NX_XYINPUT
-         case NX_SVRMSG_MOUSEIN: /* New mouse report from mouse client */
-           {
-             FAR struct nxsvrmsg_mousein_s *mousemsg = (FAR struct nxsvrmsg_mousein_s *)buffer;
-             nxmu_mousein(&fe, &mousemsg->pt, mousemsg->buttons);
-           }
-           break;
-#endif
-#ifdef CONFIG_NX_KBD
-         case NX_SVRMSG_KBDIN: /* New keyboard report from keyboard client */
-           {
-             FAR struct nxsvrmsg_kbdin_s *kbdmsg = (FAR struct nxsvrmsg_kbdin_s *)buffer;
-             nxmu_kbdin(&fe, kbdmsg->nch, kbdmsg->ch);
-           }
-           break;
-#endif
-
-         case NX_SVRMSG_REDRAWREQ: /* Request re-drawing of rectangular region */
-           {
-             FAR struct nxsvrmsg_redrawreq_s *redrawmsg = (FAR struct nxsvrmsg_redrawreq_s *)buffer;
-             nxfe_redrawreq(redrawmsg->wnd, &redrawmsg->rect);
-           }
-           break;
-
-         /* Messages sent to the background window **************************/
+#ifdef CONFIG_NX_SHADOWFB
+       /* Send the damage if it is due, even while messages keep coming */
 
-         case NX_CLIMSG_REDRAW: /* Re-draw the background window */
-            {
-              FAR struct nxclimsg_redraw_s *redraw = (FAR struct nxclimsg_redraw_s *)buffer;
-              DEBUGASSERT(redraw->wnd == &fe.be.bkgd);
-              ginfo("Re-draw background rect={(%d,%d),(%d,%d)}\n",
-                    redraw->rect.pt1.x, redraw->rect.pt1.y,
-                    redraw->rect.pt2.x, redraw->rect.pt2.y);
-              nxbe_fill(&fe.be.bkgd, &redraw->rect, fe.be.bgcolor);
-            }
-          break;
-
-         case NX_CLIMSG_MOUSEIN:      /* Ignored */
-         case NX_CLIMSG_KBDIN:
-           break;
-
-         case NX_CLIMSG_CONNECTED:    /* Shouldn't happen */
-         case NX_CLIMSG_DISCONNECTED:
-         default:
-           gerr("ERROR: Unrecognized command: %d\n", msg->msgid);
-           break;
-         }
+       nxbe_shadowfb_update(false);
+#endif
     }
 
   nxmu_shutdown(&fe);
@@ -206,7 +206,7 @@ uint8_t vnc_convert_rgb8_222(lfb_color_t rgb)
 
   return (uint8_t)(((rgb >> 18) & 0x00000030)  |
                    ((rgb >> 12) & 0x0000000c)  |
-                    (rgb >> 6)  & 0x00000003));
+                    ((rgb >> 6)  & 0x00000003));
 }
 
 uint8_t vnc_convert_rgb8_332(lfb_color_t rgb)
@@ -220,7 +220,7 @@ uint8_t vnc_convert_rgb8_332(lfb_color_t rgb)
 
   return (uint8_t)(((rgb >> 16) & 0x00000070)  |
                    ((rgb >> 11) & 0x0000001c)  |
-                    (rgb >> 6)  & 0x00000003));
+                    ((rgb >> 6)  & 0x00000003));
 }
 
 uint16_t vnc_convert_rgb16_555(lfb_color_t rgb)
@@ -416,3 +416,77 @@ int vnc_colors(FAR struct vnc_session_s *session, FAR struct nxgl_rect_s *rect,
 
   return ncolors;
 }
+
+/****************************************************************************
+ * Name: vnc_putpixel
+ *
+ * Description:
+ *  Convert one pixel to the remote framebuffer color format and store it
+ *  with the byte order of the remote.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   dest    - The location to store the pixel.
+ *   rgb     - The color in the local framebuffer format.
+ *
+ * Returned Value:
+ *   The number of bytes stored or zero if the remote color format is not
+ *   supported.
+ *
+ ****************************************************************************/
+
+size_t vnc_putpixel(FAR struct vnc_session_s *session, FAR uint8_t *dest,
+                    lfb_color_t rgb)
+{
+  uint16_t pixel16;
+  uint32_t pixel32;
+
+  switch (session->colorfmt)
+    {
+      case FB_FMT_RGB8_222:
+        *dest = vnc_convert_rgb8_222(rgb);
+        return sizeof(uint8_t);
+
+      case FB_FMT_RGB8_332:
+        *dest = vnc_convert_rgb8_332(rgb);
+        return sizeof(uint8_t);
+
+      case FB_FMT_RGB16_555:
+      case FB_FMT_RGB16_565:
+        if (session->colorfmt == FB_FMT_RGB16_555)
+          {
+            pixel16 = vnc_convert_rgb16_555(rgb);
+          }
+        else
+          {
+            pixel16 = vnc_convert_rgb16_565(rgb);
+          }
+
+        if (session->bigendian)
+          {
+            rfb_putbe16(dest, pixel16);
+          }
+        else
+          {
+            rfb_putle16(dest, pixel16);
+          }
+
+        return sizeof(uint16_t);
+
+      case FB_FMT_RGB32:
+        pixel32 = vnc_convert_rgb32_888(rgb);
+        if (session->bigendian)
+          {
+            rfb_putbe32(dest, pixel32);
+          }
+        else
+          {
+            rfb_putle32(dest, pixel32);
+          }
+
+        return sizeof(uint32_t);
+
+      default:
+        return 0;
+    }
+}
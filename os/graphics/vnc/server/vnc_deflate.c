@@ -0,0 +1,324 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * graphics/vnc/server/vnc_deflate.c
+ *
+ * A small zlib compatible compressor for the ZRLE encoding.  Matches are
+ * found with a single probe of a hash table of three byte prefixes and are
+ * searched only within the data of one call, so no window has to be kept.
+ * Literals and matches are coded with the fixed Huffman codes of RFC 1951,
+ * which need no code tables in memory.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "vnc_server.h"
+
+#ifdef CONFIG_VNCSERVER_ZRLE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define DEFLATE_MINMATCH  3
+#define DEFLATE_MAXMATCH  258
+#define DEFLATE_MAXDIST   32768
+#define DEFLATE_EOB       256
+
+#define DEFLATE_HASH(p) \
+  ((((uint32_t)(p)[0] << 10) ^ ((uint32_t)(p)[1] << 5) ^ (p)[2]) & \
+   (VNC_DEFLATE_HASHSIZE - 1))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Writes bit fields least significant bit first */
+
+struct deflate_bits_s
+{
+  FAR uint8_t *out;            /* Output buffer */
+  size_t pos;                  /* Next byte of the output buffer */
+  uint32_t bits;               /* Bits not yet written */
+  unsigned int nbits;          /* Number of bits not yet written */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Base values and extra bits of the length and distance codes */
+
+static const uint16_t g_lenbase[29] =
+{
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+  67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const uint8_t g_lenextra[29] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+  4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const uint16_t g_distbase[30] =
+{
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+  513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+
+static const uint8_t g_distextra[30] =
+{
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7,
+  8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: deflate_putbits
+ *
+ * Description:
+ *   Append a bit field of up to 16 bits to the output.
+ *
+ ****************************************************************************/
+
+static void deflate_putbits(FAR struct deflate_bits_s *bw, uint32_t value,
+                            unsigned int nbits)
+{
+  bw->bits  |= value << bw->nbits;
+  bw->nbits += nbits;
+
+  while (bw->nbits >= 8)
+    {
+      bw->out[bw->pos++] = (uint8_t)bw->bits;
+      bw->bits >>= 8;
+      bw->nbits -= 8;
+    }
+}
+
+/****************************************************************************
+ * Name: deflate_putcode
+ *
+ * Description:
+ *   Append a Huffman code.  Huffman codes are stored most significant bit
+ *   first.
+ *
+ ****************************************************************************/
+
+static void deflate_putcode(FAR struct deflate_bits_s *bw, uint32_t code,
+                            unsigned int nbits)
+{
+  uint32_t reversed = 0;
+  unsigned int i;
+
+  for (i = 0; i < nbits; i++)
+    {
+      reversed = (reversed << 1) | (code & 1);
+      code >>= 1;
+    }
+
+  deflate_putbits(bw, reversed, nbits);
+}
+
+/****************************************************************************
+ * Name: deflate_putsymbol
+ *
+ * Description:
+ *   Append a literal/length symbol with its fixed Huffman code.
+ *
+ ****************************************************************************/
+
+static void deflate_putsymbol(FAR struct deflate_bits_s *bw,
+                              unsigned int symbol)
+{
+  if (symbol < 144)
+    {
+      deflate_putcode(bw, 0x30 + symbol, 8);
+    }
+  else if (symbol < 256)
+    {
+      deflate_putcode(bw, 0x190 + symbol - 144, 9);
+    }
+  else if (symbol < 280)
+    {
+      deflate_putcode(bw, symbol - 256, 7);
+    }
+  else
+    {
+      deflate_putcode(bw, 0xc0 + symbol - 280, 8);
+    }
+}
+
+/****************************************************************************
+ * Name: deflate_putmatch
+ *
+ * Description:
+ *   Append a length/distance pair.
+ *
+ ****************************************************************************/
+
+static void deflate_putmatch(FAR struct deflate_bits_s *bw,
+                             unsigned int length, unsigned int dist)
+{
+  int i;
+
+  for (i = 28; g_lenbase[i] > length; i--);
+
+  deflate_putsymbol(bw, 257 + i);
+  deflate_putbits(bw, length - g_lenbase[i], g_lenextra[i]);
+
+  for (i = 29; g_distbase[i] > dist; i--);
+
+  deflate_putcode(bw, i, 5);
+  deflate_putbits(bw, dist - g_distbase[i], g_distextra[i]);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vnc_deflate
+ *
+ * Description:
+ *  Compress 'inlen' bytes as the next part of the zlib stream of a session.
+ *  The output is a single block with fixed Huffman codes followed by a sync
+ *  flush, preceded by the zlib header on the first call.
+ *
+ * Input Parameters:
+ *   zs    - The zlib stream state.
+ *   in    - The data to compress (at most 64KiB).
+ *   inlen - The number of bytes to compress.
+ *   out   - The output buffer.  It must hold at least
+ *           inlen + inlen / 8 + 16 bytes.
+ *
+ * Returned Value:
+ *   The number of bytes written to 'out'.
+ *
+ ****************************************************************************/
+
+size_t vnc_deflate(FAR struct vnc_deflate_s *zs, FAR const uint8_t *in,
+                   size_t inlen, FAR uint8_t *out)
+{
+  struct deflate_bits_s bw;
+  unsigned int candidate = 0;
+  unsigned int maxlen;
+  unsigned int length;
+  unsigned int hash;
+  size_t i;
+  size_t j;
+
+  DEBUGASSERT(zs != NULL && in != NULL && out != NULL && inlen < 65536);
+
+  bw.out   = out;
+  bw.pos   = 0;
+  bw.bits  = 0;
+  bw.nbits = 0;
+
+  /* The stream starts with the zlib header:  deflate with a 32KiB window,
+   * no preset dictionary, fastest compression.
+   */
+
+  if (!zs->started)
+    {
+      out[bw.pos++] = 0x78;
+      out[bw.pos++] = 0x01;
+      zs->started   = true;
+    }
+
+  /* One block that is not the last, with fixed Huffman codes */
+
+  deflate_putbits(&bw, 0, 1);
+  deflate_putbits(&bw, 1, 2);
+
+  memset(zs->head, 0, sizeof(zs->head));
+
+  for (i = 0; i < inlen; i += length)
+    {
+      length = 0;
+
+      if (i + DEFLATE_MINMATCH <= inlen)
+        {
+          /* Look up the last position with the same prefix */
+
+          hash      = DEFLATE_HASH(&in[i]);
+          candidate = zs->head[hash];
+          zs->head[hash] = (uint16_t)(i + 1);
+
+          if (candidate-- > 0 && i - candidate <= DEFLATE_MAXDIST)
+            {
+              maxlen = MIN(inlen - i, DEFLATE_MAXMATCH);
+              while (length < maxlen && in[candidate + length] == in[i + length])
+                {
+                  length++;
+                }
+            }
+        }
+
+      if (length >= DEFLATE_MINMATCH)
+        {
+          deflate_putmatch(&bw, length, i - candidate);
+
+          /* Remember the prefixes inside of the match too */
+
+          for (j = i + 1; j < i + length && j + DEFLATE_MINMATCH <= inlen; j++)
+            {
+              zs->head[DEFLATE_HASH(&in[j])] = (uint16_t)(j + 1);
+            }
+        }
+      else
+        {
+          deflate_putsymbol(&bw, in[i]);
+          length = 1;
+        }
+    }
+
+  deflate_putsymbol(&bw, DEFLATE_EOB);
+
+  /* Sync flush:  an empty stored block ends on a byte boundary, after which
+   * the client can inflate everything sent so far.
+   */
+
+  deflate_putbits(&bw, 0, 1);
+  deflate_putbits(&bw, 0, 2);
+  if (bw.nbits > 0)
+    {
+      deflate_putbits(&bw, 0, 8 - bw.nbits);
+    }
+
+  out[bw.pos++] = 0x00;
+  out[bw.pos++] = 0x00;
+  out[bw.pos++] = 0xff;
+  out[bw.pos++] = 0xff;
+
+  return bw.pos;
+}
+
+#endif /* CONFIG_VNCSERVER_ZRLE */
@@ -0,0 +1,436 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * graphics/vnc/server/vnc_hextile.c
+ *
+ * Hextile encoding.  The update rectangle is cut into 16x16 tiles.  A tile
+ * is sent as its background color, which is omitted if it is the same as
+ * for the previous tile, plus sub-rectangles of the other colors.  The
+ * sub-rectangles are grown greedily to the right and then downwards.  A
+ * tile is sent raw if that is smaller.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#if defined(CONFIG_VNCSERVER_DEBUG) && !defined(CONFIG_DEBUG_GRAPHICS)
+#  undef  CONFIG_DEBUG_FEATURES
+#  undef  CONFIG_DEBUG_ERROR
+#  undef  CONFIG_DEBUG_WARN
+#  undef  CONFIG_DEBUG_INFO
+#  define CONFIG_DEBUG_FEATURES 1
+#  define CONFIG_DEBUG_ERROR    1
+#  define CONFIG_DEBUG_WARN     1
+#  define CONFIG_DEBUG_INFO     1
+#  define CONFIG_DEBUG_GRAPHICS 1
+#endif
+#include <debug.h>
+
+#include "vnc_server.h"
+
+#ifdef CONFIG_VNCSERVER_HEXTILE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Hextile subencoding mask bits */
+
+#define HEXTILE_RAW               (1 << 0)
+#define HEXTILE_BACKGROUND        (1 << 1)
+#define HEXTILE_FOREGROUND        (1 << 2)
+#define HEXTILE_ANYSUBRECTS       (1 << 3)
+#define HEXTILE_SUBRECTSCOLOURED  (1 << 4)
+
+#define HEXTILE_SIZE              16
+
+/* The largest coded tile is a raw tile */
+
+#define HEXTILE_MAXTILE(bpp)      (1 + HEXTILE_SIZE * HEXTILE_SIZE * (bpp))
+
+#define HEXTILE_HDRSIZE \
+  SIZEOF_RFB_FRAMEBUFFERUPDATE_S(SIZEOF_RFB_RECTANGE_S(0))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Colors carried over from one tile to the next */
+
+struct hextile_state_s
+{
+  bool bgvalid;                /* True: bg was sent and is still valid */
+  bool fgvalid;                /* True: fg was sent and is still valid */
+  lfb_color_t bg;              /* Last background color sent */
+  lfb_color_t fg;              /* Last foreground color sent */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vnc_hextile_send
+ *
+ * Description:
+ *   Send all bytes of the output buffer.
+ *
+ ****************************************************************************/
+
+static int vnc_hextile_send(FAR struct vnc_session_s *session, size_t size)
+{
+  FAR const uint8_t *src = session->outbuf;
+  ssize_t nsent;
+
+  while (size > 0)
+    {
+      nsent = psock_send(&session->connect, src, size, 0);
+      if (nsent < 0)
+        {
+          gerr("ERROR: Send Hextile FrameBufferUpdate failed: %d\n",
+               (int)nsent);
+          return (int)nsent;
+        }
+
+      DEBUGASSERT(nsent <= size);
+      src  += nsent;
+      size -= nsent;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: vnc_hextile_raw
+ *
+ * Description:
+ *   Code a tile as raw pixels.
+ *
+ ****************************************************************************/
+
+static size_t vnc_hextile_raw(FAR struct vnc_session_s *session,
+                              FAR struct hextile_state_s *state,
+                              FAR uint8_t *dest, FAR const uint8_t *tile,
+                              nxgl_coord_t width, nxgl_coord_t height)
+{
+  FAR const lfb_color_t *src;
+  FAR uint8_t *start = dest;
+  nxgl_coord_t x;
+  nxgl_coord_t y;
+
+  *dest++ = HEXTILE_RAW;
+  for (y = 0; y < height; y++)
+    {
+      src = (FAR const lfb_color_t *)(tile + y * RFB_STRIDE);
+      for (x = 0; x < width; x++)
+        {
+          dest += vnc_putpixel(session, dest, *src++);
+        }
+    }
+
+  /* The colors of a raw tile do not carry over */
+
+  state->bgvalid = false;
+  state->fgvalid = false;
+  return dest - start;
+}
+
+/****************************************************************************
+ * Name: vnc_hextile_tile
+ *
+ * Description:
+ *   Code one tile.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   state   - Colors carried over from the previous tile.
+ *   dest    - The location to store the coded tile.
+ *   tile    - The first pixel of the tile in the local framebuffer.
+ *   width,height - The size of the tile.
+ *   bpp     - The remote bytes per pixel.
+ *
+ * Returned Value:
+ *   The number of bytes coded.
+ *
+ ****************************************************************************/
+
+static size_t vnc_hextile_tile(FAR struct vnc_session_s *session,
+                               FAR struct hextile_state_s *state,
+                               FAR uint8_t *dest, FAR const uint8_t *tile,
+                               nxgl_coord_t width, nxgl_coord_t height,
+                               unsigned int bpp)
+{
+  FAR const lfb_color_t *row;
+  uint16_t covered[HEXTILE_SIZE];
+  lfb_color_t bg;
+  lfb_color_t fg = 0;
+  lfb_color_t color;
+  uint16_t mask;
+  size_t rawsize;
+  size_t pos;
+  size_t start;
+  size_t end;
+  unsigned int nsubrects = 0;
+  bool mono = true;
+  int x;
+  int y;
+  int x2;
+  int y2;
+  int i;
+
+  rawsize = 1 + width * height * bpp;
+  bg      = *(FAR const lfb_color_t *)tile;
+
+  /* Background first, if it is not the one of the previous tile */
+
+  dest[0] = 0;
+  pos     = 1;
+
+  if (!state->bgvalid || state->bg != bg)
+    {
+      dest[0]        |= HEXTILE_BACKGROUND;
+      pos            += vnc_putpixel(session, &dest[pos], bg);
+      state->bgvalid  = true;
+      state->bg       = bg;
+    }
+
+  /* Collect coloured sub-rectangles, leaving room for the foreground color
+   * and the count of sub-rectangles.
+   */
+
+  start = pos + bpp + 1;
+  end   = start;
+  memset(covered, 0, sizeof(covered));
+
+  for (y = 0; y < height; y++)
+    {
+      row = (FAR const lfb_color_t *)(tile + y * RFB_STRIDE);
+      for (x = 0; x < width; x++)
+        {
+          color = row[x];
+          if (color == bg || (covered[y] & (1 << x)) != 0)
+            {
+              continue;
+            }
+
+          /* Grow to the right, then downwards */
+
+          for (x2 = x + 1;
+               x2 < width && row[x2] == color && (covered[y] & (1 << x2)) == 0;
+               x2++);
+
+          mask = (uint16_t)(((1 << (x2 - x)) - 1) << x);
+
+          for (y2 = y + 1; y2 < height && (covered[y2] & mask) == 0; y2++)
+            {
+              FAR const lfb_color_t *next =
+                (FAR const lfb_color_t *)(tile + y2 * RFB_STRIDE);
+
+              for (i = x; i < x2 && next[i] == color; i++);
+              if (i < x2)
+                {
+                  break;
+                }
+            }
+
+          for (i = y; i < y2; i++)
+            {
+              covered[i] |= mask;
+            }
+
+          /* Give up if the sub-rectangles get larger than the raw tile */
+
+          if (++nsubrects > 255 || end + bpp + 2 > rawsize)
+            {
+              return vnc_hextile_raw(session, state, dest, tile, width,
+                                     height);
+            }
+
+          if (nsubrects == 1)
+            {
+              fg = color;
+            }
+          else if (color != fg)
+            {
+              mono = false;
+            }
+
+          end       += vnc_putpixel(session, &dest[end], color);
+          dest[end++] = (uint8_t)((x << 4) | y);
+          dest[end++] = (uint8_t)(((x2 - x - 1) << 4) | (y2 - y - 1));
+        }
+    }
+
+  if (nsubrects == 0)
+    {
+      return pos;
+    }
+
+  dest[0] |= HEXTILE_ANYSUBRECTS;
+
+  if (mono)
+    {
+      /* All sub-rectangles have the same color:  send it once and drop it
+       * from the sub-rectangles.
+       */
+
+      if (!state->fgvalid || state->fg != fg)
+        {
+          dest[0]        |= HEXTILE_FOREGROUND;
+          pos            += vnc_putpixel(session, &dest[pos], fg);
+          state->fgvalid  = true;
+          state->fg       = fg;
+        }
+
+      dest[pos++] = (uint8_t)nsubrects;
+      for (i = start; i < end; i += bpp + 2)
+        {
+          dest[pos++] = dest[i + bpp];
+          dest[pos++] = dest[i + bpp + 1];
+        }
+
+      return pos;
+    }
+
+  /* Coloured sub-rectangles do not use the foreground color and leave it
+   * undefined.
+   */
+
+  dest[0]        |= HEXTILE_SUBRECTSCOLOURED;
+  state->fgvalid  = false;
+
+  dest[pos++] = (uint8_t)nsubrects;
+  memmove(&dest[pos], &dest[start], end - start);
+  return pos + end - start;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vnc_hextile
+ *
+ * Description:
+ *  Send the framebuffer update using the Hextile encoding.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   rect  - Describes the rectangle in the local framebuffer.
+ *
+ * Returned Value:
+ *   Zero is returned if Hextile coding was not performed (but no error was
+ *   encountered).  Otherwise, the number of bytes sent is returned on
+ *   success or a negated errno value is returned on failure.
+ *
+ ****************************************************************************/
+
+int vnc_hextile(FAR struct vnc_session_s *session,
+                FAR struct nxgl_rect_s *rect)
+{
+  FAR struct rfb_framebufferupdate_s *update;
+  struct hextile_state_s state;
+  FAR const uint8_t *tile;
+  unsigned int bpp;
+  nxgl_coord_t width;
+  nxgl_coord_t height;
+  nxgl_coord_t x;
+  nxgl_coord_t y;
+  size_t pos;
+  int total = 0;
+  int ret;
+
+  /* Check if the client supports the Hextile encoding and if the update
+   * buffer can hold the largest tile.
+   */
+
+  bpp = (session->bpp + 7) >> 3;
+  if (!session->hextile ||
+      VNCSERVER_UPDATE_BUFSIZE < HEXTILE_HDRSIZE + HEXTILE_MAXTILE(bpp))
+    {
+      return 0;
+    }
+
+  /* Format the FramebufferUpdate message with a single Hextile rectangle.
+   * The tiles follow and are sent whenever the buffer fills up.
+   */
+
+  update          = (FAR struct rfb_framebufferupdate_s *)session->outbuf;
+  update->msgtype = RFB_FBUPDATE_MSG;
+  update->padding = 0;
+  rfb_putbe16(update->nrect, 1);
+
+  rfb_putbe16(update->rect[0].xpos, rect->pt1.x);
+  rfb_putbe16(update->rect[0].ypos, rect->pt1.y);
+  rfb_putbe16(update->rect[0].width, rect->pt2.x - rect->pt1.x + 1);
+  rfb_putbe16(update->rect[0].height, rect->pt2.y - rect->pt1.y + 1);
+  rfb_putbe32(update->rect[0].encoding, RFB_ENCODING_HEXTILE);
+
+  pos           = HEXTILE_HDRSIZE;
+  state.bgvalid = false;
+  state.fgvalid = false;
+  state.bg      = 0;
+  state.fg      = 0;
+
+  for (y = rect->pt1.y; y <= rect->pt2.y; y += HEXTILE_SIZE)
+    {
+      height = MIN(rect->pt2.y - y + 1, HEXTILE_SIZE);
+
+      for (x = rect->pt1.x; x <= rect->pt2.x; x += HEXTILE_SIZE)
+        {
+          width = MIN(rect->pt2.x - x + 1, HEXTILE_SIZE);
+
+          if (pos + HEXTILE_MAXTILE(bpp) > VNCSERVER_UPDATE_BUFSIZE)
+            {
+              ret = vnc_hextile_send(session, pos);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+
+              total += pos;
+              pos    = 0;
+            }
+
+          tile = session->fb + RFB_STRIDE * y + RFB_BYTESPERPIXEL * x;
+          pos += vnc_hextile_tile(session, &state, &session->outbuf[pos],
+                                  tile, width, height, bpp);
+        }
+    }
+
+  ret = vnc_hextile_send(session, pos);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  updinfo("Sent {(%d, %d),(%d, %d)}\n",
+          rect->pt1.x, rect->pt1.y, rect->pt2.x, rect->pt2.y);
+  return total + pos;
+}
+
+#endif /* CONFIG_VNCSERVER_HEXTILE */
@@ -0,0 +1,289 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * graphics/vnc/server/vnc_procfs.c
+ *
+ * Shows how the damage of each connected VNC display was coalesced before
+ * it was sent to the client.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/kmalloc.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/procfs.h>
+
+#include <tinyara/nx/nxglib.h>
+
+#include "vnc_server.h"
+
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_VNC)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define VNC_LINELEN 256
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+/* This structure describes one open "file" */
+
+struct vnc_procfs_file_s {
+	struct procfs_file_s base;	/* Base open file structure */
+	unsigned int linesize;		/* Number of valid characters in line[] */
+	char line[VNC_LINELEN * RFB_MAX_DISPLAYS];	/* Pre-allocated buffer for formatted lines */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+/* File system methods */
+
+static int vnc_procfs_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode);
+static int vnc_procfs_close(FAR struct file *filep);
+static ssize_t vnc_procfs_read(FAR struct file *filep, FAR char *buffer, size_t buflen);
+
+static int vnc_procfs_dup(FAR const struct file *oldp, FAR struct file *newp);
+
+static int vnc_procfs_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_procfs.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations vnc_procfsoperations = {
+	vnc_procfs_open,		/* open */
+	vnc_procfs_close,		/* close */
+	vnc_procfs_read,		/* read */
+	NULL,						/* write */
+
+	vnc_procfs_dup,		/* dup */
+
+	NULL,						/* opendir */
+	NULL,						/* closedir */
+	NULL,						/* readdir */
+	NULL,						/* rewinddir */
+
+	vnc_procfs_stat		/* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vnc_procfs_open
+ ****************************************************************************/
+
+static int vnc_procfs_open(FAR struct file *filep, FAR const char *relpath, int oflags, mode_t mode)
+{
+	FAR struct vnc_procfs_file_s *attr;
+
+	fvdbg("Open '%s'\n", relpath);
+
+	/* PROCFS is read-only.  Any attempt to open with any kind of write
+	 * access is not permitted.
+	 */
+
+	if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0) {
+		fdbg("ERROR: Only O_RDONLY supported\n");
+		return -EACCES;
+	}
+
+	/* Allocate a container to hold the file attributes */
+
+	attr = (FAR struct vnc_procfs_file_s *)kmm_zalloc(sizeof(struct vnc_procfs_file_s));
+	if (!attr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* Save the attributes as the open-specific state in filep->f_priv */
+
+	filep->f_priv = (FAR void *)attr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: vnc_procfs_close
+ ****************************************************************************/
+
+static int vnc_procfs_close(FAR struct file *filep)
+{
+	FAR struct vnc_procfs_file_s *attr;
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct vnc_procfs_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Release the file attributes structure */
+
+	kmm_free(attr);
+	filep->f_priv = NULL;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: vnc_procfs_read
+ ****************************************************************************/
+
+static ssize_t vnc_procfs_read(FAR struct file *filep, FAR char *buffer, size_t buflen)
+{
+	FAR struct vnc_procfs_file_s *attr;
+	FAR struct vnc_session_s *session;
+	struct vnc_update_stats_s stats;
+	int display;
+	off_t offset;
+	ssize_t ret;
+
+	fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+	/* Recover our private data from the struct file instance */
+
+	attr = (FAR struct vnc_procfs_file_s *)filep->f_priv;
+	DEBUGASSERT(attr);
+
+	/* Take a snapshot of the counters on the first read, so that they stay
+	 * stable if the user reads in small pieces.
+	 */
+
+	if (filep->f_pos == 0) {
+		attr->linesize = 0;
+
+		for (display = 0; display < RFB_MAX_DISPLAYS; display++) {
+			session = g_vnc_sessions[display];
+			if (session == NULL) {
+				continue;
+			}
+
+			vnc_update_getstats(session, &stats);
+			attr->linesize += snprintf(&attr->line[attr->linesize], VNC_LINELEN,
+									   "Display %d:\n"
+									   "  Depth:     %u (max %u)\n"
+									   "  Added:     %lu\n"
+									   "  Covered:   %lu\n"
+									   "  Merged:    %lu\n"
+									   "  Split:     %lu\n"
+									   "  Snapshots: %lu\n"
+									   "  Sent:      %lu\n",
+									   display, stats.depth, stats.maxdepth,
+									   (unsigned long)stats.added,
+									   (unsigned long)stats.covered,
+									   (unsigned long)stats.merged,
+									   (unsigned long)stats.split,
+									   (unsigned long)stats.snapshots,
+									   (unsigned long)stats.sent);
+		}
+	}
+
+	/* Transfer the counters to user receive buffer */
+
+	offset = filep->f_pos;
+	ret = procfs_memcpy(attr->line, attr->linesize, buffer, buflen, &offset);
+
+	/* Update the file offset */
+
+	if (ret > 0) {
+		filep->f_pos += ret;
+	}
+
+	return ret;
+}
+
+/****************************************************************************
+ * Name: vnc_procfs_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int vnc_procfs_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+	FAR struct vnc_procfs_file_s *oldattr;
+	FAR struct vnc_procfs_file_s *newattr;
+
+	fvdbg("Dup %p->%p\n", oldp, newp);
+
+	/* Recover our private data from the old struct file instance */
+
+	oldattr = (FAR struct vnc_procfs_file_s *)oldp->f_priv;
+	DEBUGASSERT(oldattr);
+
+	/* Allocate a new container to hold the task and attribute selection */
+
+	newattr = (FAR struct vnc_procfs_file_s *)kmm_zalloc(sizeof(struct vnc_procfs_file_s));
+	if (!newattr) {
+		fdbg("ERROR: Failed to allocate file attributes\n");
+		return -ENOMEM;
+	}
+
+	/* The copy the file attributes from the old attributes to the new */
+
+	memcpy(newattr, oldattr, sizeof(struct vnc_procfs_file_s));
+
+	/* Save the new attributes in the new file structure */
+
+	newp->f_priv = (FAR void *)newattr;
+	return OK;
+}
+
+/****************************************************************************
+ * Name: vnc_procfs_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int vnc_procfs_stat(const char *relpath, struct stat *buf)
+{
+	/* File/directory size, access block size */
+
+	buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+	buf->st_size = 0;
+	buf->st_blksize = 0;
+	buf->st_blocks = 0;
+	return OK;
+}
+
+#endif /* CONFIG_FS_PROCFS && !CONFIG_FS_PROCFS_EXCLUDE_VNC */
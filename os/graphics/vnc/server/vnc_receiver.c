@@ -305,7 +305,21 @@ int vnc_receiver(FAR struct vnc_session_s *session)
                   rect.pt2.x = rect.pt1.x + rfb_getbe16(update->width);
                   rect.pt2.y = rect.pt1.y + rfb_getbe16(update->height);
 
+#ifdef CONFIG_VNCSERVER_TILEHASH
+                  /* A non-incremental request asks for the contents of the
+                   * rectangle whether or not they changed.
+                   */
+
+                  if (!update->incremental)
+                    {
+                      vnc_tiles_invalidate(session, &rect);
+                    }
+
+                  ret = vnc_update_rectangle(session, &rect,
+                                             !update->incremental);
+#else
                   ret = vnc_update_rectangle(session, &rect, false);
+#endif
                   if (ret < 0)
                     {
                       gerr("ERROR: Failed to queue update: %d\n", ret);
@@ -474,6 +488,12 @@ int vnc_client_encodings(FAR struct vnc_session_s *session,
   /* Assume that there are no common encodings (other than RAW) */
 
   session->rre = false;
+#ifdef CONFIG_VNCSERVER_HEXTILE
+  session->hextile = false;
+#endif
+#ifdef CONFIG_VNCSERVER_ZRLE
+  session->zrle = false;
+#endif
 
   /* Loop for each client supported encoding */
 
@@ -490,6 +510,18 @@ int vnc_client_encodings(FAR struct vnc_session_s *session,
         {
           session->rre = true;
         }
+#ifdef CONFIG_VNCSERVER_HEXTILE
+      else if (encoding == RFB_ENCODING_HEXTILE)
+        {
+          session->hextile = true;
+        }
+#endif
+#ifdef CONFIG_VNCSERVER_ZRLE
+      else if (encoding == RFB_ENCODING_ZRLE)
+        {
+          session->zrle = true;
+        }
+#endif
     }
 
   session->change = true;
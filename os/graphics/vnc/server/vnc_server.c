@@ -102,8 +102,6 @@ FAR struct vnc_session_s *g_vnc_sessions[RFB_MAX_DISPLAYS];
 static void vnc_reset_session(FAR struct vnc_session_s *session,
                               FAR uint8_t *fb, int display)
 {
-  int i;
-
   /* Close any open sockets */
 
   if (session->state >= VNCSERVER_CONNECTED)
@@ -119,27 +117,32 @@ static void vnc_reset_session(FAR struct vnc_session_s *session,
   memset(&session->listen, 0, sizeof(struct socket));
   session->listen.s_crefs = 1;
 
-  /* Put all of the pre-allocated update structures into the freelist */
+  /* Discard any damage left by the previous client */
 
-  sq_init(&session->updqueue);
-  sq_init(&session->updfree);
-
-  for (i = 0; i < CONFIG_VNCSERVER_NUPDATES; i++)
-    {
-      sq_addlast((FAR sq_entry_t *)&session->updpool[i], &session->updfree);
-    }
+  session->ndamage = 0;
+  memset(&session->stats, 0, sizeof(struct vnc_update_stats_s));
 
   /* Set the INITIALIZED state */
 
-  nxsem_reset(&session->freesem, CONFIG_VNCSERVER_NUPDATES);
   nxsem_reset(&session->queuesem, 0);
 
   session->fb      = fb;
   session->display = display;
   session->state   = VNCSERVER_INITIALIZED;
-  session->nwhupd  = 0;
   session->change  = true;
 
+#ifdef CONFIG_VNCSERVER_TILEHASH
+  /* Nothing has been sent to the next client yet */
+
+  vnc_tiles_reset(session);
+#endif
+
+#ifdef CONFIG_VNCSERVER_ZRLE
+  /* Each connection has its own zlib stream */
+
+  session->deflate.started = false;
+#endif
+
   /* Careful not to disturb the keyboard/mouse callouts set by
    * vnc_fbinitialize().  Client related data left in garbage state.
    */
@@ -291,7 +294,6 @@ int vnc_server(int argc, FAR char *argv[])
     }
 
   g_vnc_sessions[display] = session;
-  nxsem_init(&session->freesem, 0, CONFIG_VNCSERVER_NUPDATES);
   nxsem_init(&session->queuesem, 0, 0);
 
   /* Inform any waiter that we have started */
@@ -45,7 +45,6 @@
 #include <stdint.h>
 #include <semaphore.h>
 #include <pthread.h>
-#include <queue.h>
 
 #include <tinyara/video/fb.h>
 #include <tinyara/video/rfb.h>
@@ -160,6 +159,48 @@
 #define VNCSERVER_UPDATE_BUFSIZE \
   (CONFIG_VNCSERVER_UPDATE_BUFSIZE + SIZEOF_RFB_FRAMEBUFFERUPDATE_S(0))
 
+/* Change detection:  The framebuffer is divided into square tiles and the
+ * hash of each tile as it was last sent is kept.  Only tiles whose hash
+ * differs are sent again.
+ */
+
+#ifndef CONFIG_VNCSERVER_TILE_SIZE
+#  define CONFIG_VNCSERVER_TILE_SIZE 16
+#endif
+
+#define VNCSERVER_TILES_X \
+  ((CONFIG_VNCSERVER_SCREENWIDTH + CONFIG_VNCSERVER_TILE_SIZE - 1) / \
+   CONFIG_VNCSERVER_TILE_SIZE)
+#define VNCSERVER_TILES_Y \
+  ((CONFIG_VNCSERVER_SCREENHEIGHT + CONFIG_VNCSERVER_TILE_SIZE - 1) / \
+   CONFIG_VNCSERVER_TILE_SIZE)
+#define VNCSERVER_NTILES    (VNCSERVER_TILES_X * VNCSERVER_TILES_Y)
+
+/* ZRLE:  Each ZRLE rectangle is at most 64 pixels wide and
+ * CONFIG_VNCSERVER_ZRLE_ROWS rows high so that it is a single ZRLE tile.
+ * The input buffer holds the uncompressed tile (worst case: a subencoding
+ * byte and raw 32-bit pixels) and the output buffer the message headers,
+ * the length of the compressed data and the compressed data.  Fixed
+ * Huffman codes spend at most nine bits per input byte.
+ */
+
+#ifndef CONFIG_VNCSERVER_ZRLE_ROWS
+#  define CONFIG_VNCSERVER_ZRLE_ROWS 16
+#endif
+
+#define VNCSERVER_ZRLE_TILEWIDTH 64
+#define VNCSERVER_ZRLE_INSIZE \
+  (1 + VNCSERVER_ZRLE_TILEWIDTH * CONFIG_VNCSERVER_ZRLE_ROWS * sizeof(uint32_t))
+#define VNCSERVER_ZRLE_HDRSIZE \
+  (SIZEOF_RFB_FRAMEBUFFERUPDATE_S(SIZEOF_RFB_RECTANGE_S(0)) + sizeof(uint32_t))
+#define VNCSERVER_ZRLE_OUTSIZE \
+  (VNCSERVER_ZRLE_HDRSIZE + VNCSERVER_ZRLE_INSIZE + \
+   (VNCSERVER_ZRLE_INSIZE >> 3) + 16)
+
+/* Size of the hash table of the deflater (must be a power of two) */
+
+#define VNC_DEFLATE_HASHSIZE 1024
+
 /* Local framebuffer characteristics in bytes */
 
 #define RFB_BYTESPERPIXEL   ((RFB_BITSPERPIXEL + 7) >> 3)
@@ -223,15 +264,29 @@ enum vnc_server_e
   VNCSERVER_STOPPED            /* The updater has stopped */
 };
 
-/* This structure is used to queue FrameBufferUpdate event.  It includes a
- * pointer to support singly linked list.
+/* Counters of the damage accumulated for the updater */
+
+struct vnc_update_stats_s
+{
+  uint32_t added;              /* Rectangles added to the damage */
+  uint32_t covered;            /* Added rectangles that were already damaged */
+  uint32_t merged;             /* Rectangles merged into a bounding box */
+  uint32_t split;              /* Damaged rectangles split around a new one */
+  uint32_t snapshots;          /* Times the updater took the damage */
+  uint32_t sent;               /* Rectangles handed to the encoders */
+  uint16_t depth;              /* Rectangles waiting for the updater */
+  uint16_t maxdepth;           /* Most rectangles ever waiting */
+};
+
+/* State of the zlib stream of a ZRLE session.  The stream is never
+ * finished:  every rectangle ends with a sync flush so that the client can
+ * inflate it completely.
  */
 
-struct vnc_fbupdate_s
+struct vnc_deflate_s
 {
-  FAR struct vnc_fbupdate_s *flink;
-  bool whupd;                  /* True: whole screen update */
-  struct nxgl_rect_s rect;     /* The enqueued update rectangle */
+  bool started;                /* True: The zlib header has been sent */
+  uint16_t head[VNC_DEFLATE_HASHSIZE]; /* Last position + 1 of each hash */
 };
 
 struct vnc_session_s
@@ -241,7 +296,6 @@ struct vnc_session_s
   struct socket listen;        /* Listen socket */
   struct socket connect;       /* Connected socket */
   volatile uint8_t state;      /* See enum vnc_server_e */
-  volatile uint8_t nwhupd;     /* Number of whole screen updates queued */
   volatile bool change;        /* True: Frambebuffer data change since last whole screen update */
 
   /* Display geometry and color characteristics */
@@ -251,6 +305,12 @@ struct vnc_session_s
   volatile uint8_t bpp;        /* Remote bits per pixel */
   volatile bool bigendian;     /* True: Remote expect data in big-endian format */
   volatile bool rre;           /* True: Remote supports RRE encoding */
+#ifdef CONFIG_VNCSERVER_HEXTILE
+  volatile bool hextile;       /* True: Remote supports Hextile encoding */
+#endif
+#ifdef CONFIG_VNCSERVER_ZRLE
+  volatile bool zrle;          /* True: Remote supports ZRLE encoding */
+#endif
   FAR uint8_t *fb;             /* Allocated local frame buffer */
 
   /* VNC client input support */
@@ -263,18 +323,34 @@ struct vnc_session_s
 
   pthread_t updater;           /* Updater thread ID */
 
-  /* Update list information */
+  /* Damage waiting for the updater.  The rectangles never overlap, so a
+   * pixel is encoded at most once for each snapshot that the updater takes.
+   */
 
-  struct vnc_fbupdate_s updpool[CONFIG_VNCSERVER_NUPDATES];
-  sq_queue_t updfree;
-  sq_queue_t updqueue;
-  sem_t freesem;
-  sem_t queuesem;
+  struct nxgl_rect_s damage[CONFIG_VNCSERVER_NUPDATES];
+  struct nxgl_rect_s snapshot[CONFIG_VNCSERVER_NUPDATES];
+  uint16_t ndamage;            /* Number of rectangles in damage[] */
+  sem_t queuesem;              /* Posted when damage[] becomes non-empty */
+  struct vnc_update_stats_s stats;
 
   /* I/O buffers for misc network send/receive */
 
   uint8_t inbuf[CONFIG_VNCSERVER_INBUFFER_SIZE];
   uint8_t outbuf[VNCSERVER_UPDATE_BUFSIZE];
+
+#ifdef CONFIG_VNCSERVER_TILEHASH
+  /* Hash of each tile as last sent to the client (zero: not sent) */
+
+  uint32_t tilehash[VNCSERVER_NTILES];
+#endif
+
+#ifdef CONFIG_VNCSERVER_ZRLE
+  /* ZRLE compression state and buffers */
+
+  struct vnc_deflate_s deflate;
+  uint8_t zrlein[VNCSERVER_ZRLE_INSIZE];
+  uint8_t zrleout[VNCSERVER_ZRLE_OUTSIZE];
+#endif
 };
 
 /* This structure is used to communicate start-up status between the server
@@ -459,6 +535,24 @@ int vnc_update_rectangle(FAR struct vnc_session_s *session,
                          FAR const struct nxgl_rect_s *rect,
                          bool change);
 
+/****************************************************************************
+ * Name: vnc_update_getstats
+ *
+ * Description:
+ *  Return the damage counters of a session.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   stats   - The location to return the counters.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void vnc_update_getstats(FAR struct vnc_session_s *session,
+                         FAR struct vnc_update_stats_s *stats);
+
 /****************************************************************************
  * Name: vnc_receiver
  *
@@ -518,6 +612,153 @@ int vnc_rre(FAR struct vnc_session_s *session, FAR struct nxgl_rect_s *rect);
 
 int vnc_raw(FAR struct vnc_session_s *session, FAR struct nxgl_rect_s *rect);
 
+/****************************************************************************
+ * Name: vnc_hextile
+ *
+ * Description:
+ *  Send the framebuffer update using the Hextile encoding.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   rect  - Describes the rectangle in the local framebuffer.
+ *
+ * Returned Value:
+ *   Zero is returned if Hextile coding was not performed (but no error was
+ *   encountered).  Otherwise, the number of bytes sent is returned on
+ *   success or a negated errno value is returned on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_VNCSERVER_HEXTILE
+int vnc_hextile(FAR struct vnc_session_s *session,
+                FAR struct nxgl_rect_s *rect);
+#endif
+
+/****************************************************************************
+ * Name: vnc_zrle
+ *
+ * Description:
+ *  Send the framebuffer update using the ZRLE encoding.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   rect  - Describes the rectangle in the local framebuffer.
+ *
+ * Returned Value:
+ *   Zero is returned if ZRLE coding was not performed (but no error was
+ *   encountered).  Otherwise, the number of bytes sent is returned on
+ *   success or a negated errno value is returned on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_VNCSERVER_ZRLE
+int vnc_zrle(FAR struct vnc_session_s *session, FAR struct nxgl_rect_s *rect);
+#endif
+
+/****************************************************************************
+ * Name: vnc_deflate
+ *
+ * Description:
+ *  Compress 'inlen' bytes as the next part of the zlib stream of a session.
+ *  The output is a single block with fixed Huffman codes followed by a sync
+ *  flush, preceded by the zlib header on the first call.
+ *
+ * Input Parameters:
+ *   zs    - The zlib stream state.
+ *   in    - The data to compress (at most 64KiB).
+ *   inlen - The number of bytes to compress.
+ *   out   - The output buffer.  It must hold at least
+ *           inlen + inlen / 8 + 16 bytes.
+ *
+ * Returned Value:
+ *   The number of bytes written to 'out'.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_VNCSERVER_ZRLE
+size_t vnc_deflate(FAR struct vnc_deflate_s *zs, FAR const uint8_t *in,
+                   size_t inlen, FAR uint8_t *out);
+#endif
+
+/****************************************************************************
+ * Name: vnc_encode
+ *
+ * Description:
+ *  Send one rectangle of the local framebuffer using the best encoding
+ *  supported by the client.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   rect  - Describes the rectangle in the local framebuffer.
+ *
+ * Returned Value:
+ *   A non-negative value on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int vnc_encode(FAR struct vnc_session_s *session, FAR struct nxgl_rect_s *rect);
+
+/****************************************************************************
+ * Name: vnc_tiles_reset
+ *
+ * Description:
+ *  Forget the contents of all tiles so that the next updates send them.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_VNCSERVER_TILEHASH
+void vnc_tiles_reset(FAR struct vnc_session_s *session);
+#endif
+
+/****************************************************************************
+ * Name: vnc_tiles_invalidate
+ *
+ * Description:
+ *  Forget the contents of the tiles that overlap a rectangle, so that the
+ *  next update of the rectangle sends them even if they did not change.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   rect  - Describes the rectangle in the local framebuffer.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_VNCSERVER_TILEHASH
+void vnc_tiles_invalidate(FAR struct vnc_session_s *session,
+                          FAR const struct nxgl_rect_s *rect);
+#endif
+
+/****************************************************************************
+ * Name: vnc_tiles_update
+ *
+ * Description:
+ *  Send the tiles overlapping a rectangle whose contents changed since
+ *  they were last sent.  Adjacent changed tiles of a tile row are sent as
+ *  one rectangle.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   rect  - Describes the rectangle in the local framebuffer.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_VNCSERVER_TILEHASH
+int vnc_tiles_update(FAR struct vnc_session_s *session,
+                     FAR const struct nxgl_rect_s *rect);
+#endif
+
 /****************************************************************************
  * Name: vnc_key_map
  *
@@ -590,6 +831,27 @@ uint32_t vnc_convert_rgb32_888(lfb_color_t rgb);
 int vnc_colors(FAR struct vnc_session_s *session, FAR struct nxgl_rect_s *rect,
                unsigned int maxcolors, FAR lfb_color_t *colors);
 
+/****************************************************************************
+ * Name: vnc_putpixel
+ *
+ * Description:
+ *  Convert one pixel to the remote framebuffer color format and store it
+ *  with the byte order of the remote.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   dest    - The location to store the pixel.
+ *   rgb     - The color in the local framebuffer format.
+ *
+ * Returned Value:
+ *   The number of bytes stored or zero if the remote color format is not
+ *   supported.
+ *
+ ****************************************************************************/
+
+size_t vnc_putpixel(FAR struct vnc_session_s *session, FAR uint8_t *dest,
+                    lfb_color_t rgb);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
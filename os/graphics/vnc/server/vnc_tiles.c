@@ -0,0 +1,263 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * graphics/vnc/server/vnc_tiles.c
+ *
+ * Change detection for framebuffer updates.  The local framebuffer is
+ * divided into tiles of CONFIG_VNCSERVER_TILE_SIZE pixels square and the
+ * hash of every tile is remembered when it is sent.  An update then sends
+ * only the tiles whose contents hash differently, so redrawing unchanged
+ * pixels and whole screen update requests cost little bandwidth.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#if defined(CONFIG_VNCSERVER_DEBUG) && !defined(CONFIG_DEBUG_GRAPHICS)
+#  undef  CONFIG_DEBUG_FEATURES
+#  undef  CONFIG_DEBUG_ERROR
+#  undef  CONFIG_DEBUG_WARN
+#  undef  CONFIG_DEBUG_INFO
+#  define CONFIG_DEBUG_FEATURES 1
+#  define CONFIG_DEBUG_ERROR    1
+#  define CONFIG_DEBUG_WARN     1
+#  define CONFIG_DEBUG_INFO     1
+#  define CONFIG_DEBUG_GRAPHICS 1
+#endif
+#include <debug.h>
+
+#include "vnc_server.h"
+
+#ifdef CONFIG_VNCSERVER_TILEHASH
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* FNV-1a parameters */
+
+#define TILE_HASH_BASIS  2166136261u
+#define TILE_HASH_PRIME  16777619u
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vnc_tile_hash
+ *
+ * Description:
+ *   Hash the contents of one tile.  Zero is never returned because it marks
+ *   tiles that have not been sent.
+ *
+ ****************************************************************************/
+
+static uint32_t vnc_tile_hash(FAR struct vnc_session_s *session,
+                              FAR const struct nxgl_rect_s *tile)
+{
+  FAR const lfb_color_t *src;
+  uint32_t hash = TILE_HASH_BASIS;
+  nxgl_coord_t x;
+  nxgl_coord_t y;
+
+  for (y = tile->pt1.y; y <= tile->pt2.y; y++)
+    {
+      src = (FAR const lfb_color_t *)
+        (session->fb + RFB_STRIDE * y + RFB_BYTESPERPIXEL * tile->pt1.x);
+
+      for (x = tile->pt1.x; x <= tile->pt2.x; x++)
+        {
+          hash = (hash ^ *src++) * TILE_HASH_PRIME;
+        }
+    }
+
+  return hash != 0 ? hash : 1;
+}
+
+/****************************************************************************
+ * Name: vnc_tile_rect
+ *
+ * Description:
+ *   Get the framebuffer rectangle of tiles tx1..tx2 of tile row ty.
+ *
+ ****************************************************************************/
+
+static void vnc_tile_rect(FAR struct nxgl_rect_s *rect, int tx1, int tx2,
+                          int ty)
+{
+  rect->pt1.x = tx1 * CONFIG_VNCSERVER_TILE_SIZE;
+  rect->pt1.y = ty * CONFIG_VNCSERVER_TILE_SIZE;
+  rect->pt2.x = MIN((tx2 + 1) * CONFIG_VNCSERVER_TILE_SIZE,
+                    CONFIG_VNCSERVER_SCREENWIDTH) - 1;
+  rect->pt2.y = MIN((ty + 1) * CONFIG_VNCSERVER_TILE_SIZE,
+                    CONFIG_VNCSERVER_SCREENHEIGHT) - 1;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vnc_tiles_reset
+ *
+ * Description:
+ *  Forget the contents of all tiles so that the next updates send them.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void vnc_tiles_reset(FAR struct vnc_session_s *session)
+{
+  memset(session->tilehash, 0, sizeof(session->tilehash));
+}
+
+/****************************************************************************
+ * Name: vnc_tiles_invalidate
+ *
+ * Description:
+ *  Forget the contents of the tiles that overlap a rectangle, so that the
+ *  next update of the rectangle sends them even if they did not change.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   rect  - Describes the rectangle in the local framebuffer.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void vnc_tiles_invalidate(FAR struct vnc_session_s *session,
+                          FAR const struct nxgl_rect_s *rect)
+{
+  int tx;
+  int ty;
+  int tx2;
+  int ty2;
+
+  tx2 = MIN(rect->pt2.x / CONFIG_VNCSERVER_TILE_SIZE, VNCSERVER_TILES_X - 1);
+  ty2 = MIN(rect->pt2.y / CONFIG_VNCSERVER_TILE_SIZE, VNCSERVER_TILES_Y - 1);
+
+  for (ty = rect->pt1.y / CONFIG_VNCSERVER_TILE_SIZE; ty <= ty2; ty++)
+    {
+      for (tx = rect->pt1.x / CONFIG_VNCSERVER_TILE_SIZE; tx <= tx2; tx++)
+        {
+          session->tilehash[ty * VNCSERVER_TILES_X + tx] = 0;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: vnc_tiles_update
+ *
+ * Description:
+ *  Send the tiles overlapping a rectangle whose contents changed since
+ *  they were last sent.  Adjacent changed tiles of a tile row are sent as
+ *  one rectangle.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   rect  - Describes the rectangle in the local framebuffer.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int vnc_tiles_update(FAR struct vnc_session_s *session,
+                     FAR const struct nxgl_rect_s *rect)
+{
+  struct nxgl_rect_s tile;
+  FAR uint32_t *slot;
+  uint32_t hash;
+  int first;
+  int tx;
+  int ty;
+  int tx1;
+  int tx2;
+  int ty2;
+  int ret;
+
+  DEBUGASSERT(rect->pt1.x >= 0 && rect->pt1.y >= 0);
+
+  tx1 = rect->pt1.x / CONFIG_VNCSERVER_TILE_SIZE;
+  tx2 = rect->pt2.x / CONFIG_VNCSERVER_TILE_SIZE;
+  ty2 = rect->pt2.y / CONFIG_VNCSERVER_TILE_SIZE;
+
+  for (ty = rect->pt1.y / CONFIG_VNCSERVER_TILE_SIZE; ty <= ty2; ty++)
+    {
+      /* 'first' is the first changed tile of the run being collected */
+
+      first = -1;
+
+      for (tx = tx1; tx <= tx2 + 1; tx++)
+        {
+          if (tx <= tx2)
+            {
+              vnc_tile_rect(&tile, tx, tx, ty);
+              hash = vnc_tile_hash(session, &tile);
+              slot = &session->tilehash[ty * VNCSERVER_TILES_X + tx];
+
+              if (*slot != hash)
+                {
+                  *slot = hash;
+                  if (first < 0)
+                    {
+                      first = tx;
+                    }
+
+                  continue;
+                }
+            }
+
+          /* An unchanged tile or the end of the row ends the run */
+
+          if (first >= 0)
+            {
+              vnc_tile_rect(&tile, first, tx - 1, ty);
+              updinfo("Changed {(%d, %d),(%d, %d)}\n",
+                      tile.pt1.x, tile.pt1.y, tile.pt2.x, tile.pt2.y);
+
+              ret = vnc_encode(session, &tile);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+
+              first = -1;
+            }
+        }
+    }
+
+  return OK;
+}
+
+#endif /* CONFIG_VNCSERVER_TILEHASH */
@@ -39,11 +39,12 @@
 
 #include <tinyara/config.h>
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <semaphore.h>
 #include <sched.h>
 #include <pthread.h>
-#include <queue.h>
 #include <assert.h>
 #include <errno.h>
 
@@ -64,21 +65,10 @@
 
 #include "vnc_server.h"
 
-/****************************************************************************
- * Pre-processor Definitions
- ****************************************************************************/
-
-#undef VNCSERVER_SEM_DEBUG          /* Define to dump queue/semaphore state */
-#undef VNCSERVER_SEM_DEBUG_SILENT   /* Define to dump only suspicious conditions */
-
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
-#ifdef VNCSERVER_SEM_DEBUG
-static sem_t g_errsem = SEM_INITIALIZER(1);
-#endif
-
 /* A rectangle represent the entire local framebuffer */
 
 static const struct nxgl_rect_s g_wholescreen =
@@ -98,214 +88,185 @@ static const struct nxgl_rect_s g_wholescreen =
  ****************************************************************************/
 
 /****************************************************************************
- * Name: vnc_sem_debug
+ * Name: vnc_damage_remove
  *
  * Description:
- *   Dump information about the freesem to verify that it is sync.
- *
- * Input Parameters:
- *   session - A reference to the VNC session structure.
- *
- * Returned Value:
- *   A non-NULL structure pointer should always be returned.  This function
- *   will wait if no structure is available.
+ *   Remove one rectangle from the damage.  The order of the rectangles is
+ *   not preserved.
  *
  ****************************************************************************/
 
-#ifdef VNCSERVER_SEM_DEBUG
-static void vnc_sem_debug(FAR struct vnc_session_s *session,
-                          FAR const char *msg, unsigned int unattached)
+static void vnc_damage_remove(FAR struct vnc_session_s *session, int index)
 {
-  FAR struct vnc_fbupdate_s *update;
-  int nqueued;
-  int nfree;
-  int freesem;
-  int queuesem;
-  int freecount;
-  int queuecount;
-  int freewaiting;
-  int queuewaiting;
-  int ret;
-
-  do
-    {
-      /* Take the semaphore (perhaps waiting) */
-
-      ret = nxsem_wait(&g_errsem);
-
-      /* The only case that an error should occur here is if the wait was
-       * awakened by a signal.
-       */
-
-      DEBUGASSERT(ret == OK || ret == -EINTR);
-    }
-  while (ret == -EINTR);
-
-  /* Count structures in the list */
-
-  nqueued      = sq_count(&session->updqueue);
-  nfree        = sq_count(&session->updfree);
-
-  freesem      = session->freesem.semcount;
-  queuesem     = session->queuesem.semcount;
-
-  freecount    = freesem  > 0 ? freesem   : 0;
-  queuecount   = queuesem > 0 ? queuesem  : 0;
-
-  freewaiting  = freesem  < 0 ? -freesem  : 0;
-  queuewaiting = queuesem < 0 ? -queuesem : 0;
-
-#ifdef VNCSERVER_SEM_DEBUG_SILENT
-  /* This dumps most false alarms in the case where:
-   *
-   * - Updater was waiting on a semaphore (count is -1)
-   * - New update added to the queue (queue count is 1)
-   * - queuesem posted.  Wakes up Updater and the count is 0.
-   */
-
-  if ((nqueued + nfree) != (freecount + queuecount))
-#endif
-    {
-      syslog(LOG_INFO, "FREESEM DEBUG:    %s\n", msg);
-      syslog(LOG_INFO, "  Free list:\n");
-      syslog(LOG_INFO, "    semcount:     %d\n", freecount);
-      syslog(LOG_INFO, "    queued nodes: %u\n", nfree);
-      syslog(LOG_INFO, "    waiting:      %u\n", freewaiting);
-      syslog(LOG_INFO, "  Qeued Updates:\n");
-      syslog(LOG_INFO, "    semcount:     %d\n", queuecount);
-      syslog(LOG_INFO, "    queued nodes: %u\n", nqueued);
-      syslog(LOG_INFO, "    waiting:      %u\n", queuewaiting);
-      syslog(LOG_INFO, "  Unqueued:       %u\n", unattached);
-    }
-
-  nxsem_post(&g_errsem);
+  session->damage[index] = session->damage[--session->ndamage];
 }
-#else
-#  define vnc_sem_debug(s,m,u)
-#endif
 
 /****************************************************************************
- * Name: vnc_alloc_update
+ * Name: vnc_add_damage
  *
  * Description:
- *   Allocate one update structure by taking it from the freelist.
+ *   Add a rectangle to the damage of a session, keeping the damaged
+ *   rectangles disjoint.  The new rectangle is merged into the bounding box
+ *   of each damaged rectangle that nxgl_rectmerge() finds worth sending as
+ *   one box.  Damaged rectangles that it overlaps otherwise are split into
+ *   the parts outside of it.  When there is no room for the pieces, the
+ *   cheapest bounding box is taken instead.
+ *
+ *   The caller must hold the scheduler lock.
  *
  * Input Parameters:
  *   session - A reference to the VNC session structure.
+ *   rect    - The clipped rectangle to add.
  *
  * Returned Value:
- *   A non-NULL structure pointer should always be returned.  This function
- *   will wait if no structure is available.
+ *   True if the rectangle added damage; false if it was already damaged.
  *
  ****************************************************************************/
 
-static FAR struct vnc_fbupdate_s *
-vnc_alloc_update(FAR struct vnc_session_s *session)
+static bool vnc_add_damage(FAR struct vnc_session_s *session,
+                           FAR const struct nxgl_rect_s *rect)
 {
-  FAR struct vnc_fbupdate_s *update;
-  int ret;
-
-  /* Reserve one element from the free list.  Lock the scheduler to assure
-   * that the sq_remfirst() and the successful return from nxsem_wait are
-   * atomic.  Of course, the scheduler will be unlocked while we wait.
+  FAR struct vnc_update_stats_s *stats = &session->stats;
+  struct nxgl_rect_s pieces[4];
+  struct nxgl_rect_s update;
+  struct nxgl_rect_s overlap;
+  int npieces;
+  int best;
+  int i;
+  int j;
+
+  stats->added++;
+
+  /* Nothing to do if one damaged rectangle already covers the update.
+   * This is always the case while a whole screen update is waiting.
    */
 
-  sched_lock();
-  vnc_sem_debug(session, "Before alloc", 0);
-
-  do
+  for (i = 0; i < session->ndamage; i++)
     {
-      /* Take the semaphore (perhaps waiting) */
+      nxgl_rectintersect(&overlap, rect, &session->damage[i]);
+      if (memcmp(&overlap, rect, sizeof(struct nxgl_rect_s)) == 0)
+        {
+          stats->covered++;
+          return false;
+        }
+    }
 
-      ret = nxsem_wait(&session->freesem);
+  nxgl_rectcopy(&update, rect);
 
-      /* The only case that an error should occur here is if the wait was
-       * awakened by a signal.
-       */
+again:
 
-      DEBUGASSERT(ret == OK || ret == -EINTR);
+  for (i = 0; i < session->ndamage; i++)
+    {
+      if (nxgl_rectmerge(&update, &update, &session->damage[i]))
+        {
+          /* Take the damaged rectangle out and start over with the box,
+           * which may now cover or touch others.
+           */
+
+          vnc_damage_remove(session, i);
+          stats->merged++;
+          goto again;
+        }
     }
-  while (ret == -EINTR);
 
-  /* It is reserved.. go get it */
+  /* Cut the update out of the damaged rectangles that it still overlaps */
 
-  update = (FAR struct vnc_fbupdate_s *)sq_remfirst(&session->updfree);
+  for (i = 0; i < session->ndamage; )
+    {
+      if (!nxgl_rectoverlap(&update, &session->damage[i]))
+        {
+          i++;
+          continue;
+        }
 
-  vnc_sem_debug(session, "After alloc", 1);
-  sched_unlock();
+      nxgl_nonintersecting(pieces, &session->damage[i], &update);
 
-  DEBUGASSERT(update != NULL);
-  return update;
-}
+      for (npieces = 0, j = 0; j < 4; j++)
+        {
+          if (!nxgl_nullrect(&pieces[j]))
+            {
+              pieces[npieces++] = pieces[j];
+            }
+        }
 
-/****************************************************************************
- * Name: vnc_free_update
- *
- * Description:
- *  Free one update structure by returning it from the freelist.
- *
- * Input Parameters:
- *   session - A reference to the VNC session structure.
- *
- * Returned Value:
- *   None
- *
- ****************************************************************************/
+      if (session->ndamage + npieces > CONFIG_VNCSERVER_NUPDATES)
+        {
+          /* No room for the pieces and the update itself */
 
-static void vnc_free_update(FAR struct vnc_session_s *session,
-                            FAR struct vnc_fbupdate_s *update)
-{
-  /* Reserve one element from the free list.  Lock the scheduler to assure
-   * that the sq_addlast() and the nxsem_post() are atomic.
-   */
+          nxgl_rectunion(&update, &update, &session->damage[i]);
+          vnc_damage_remove(session, i);
+          stats->merged++;
+          goto again;
+        }
 
-  sched_lock();
-  vnc_sem_debug(session, "Before free", 1);
+      if (npieces == 0)
+        {
+          vnc_damage_remove(session, i);
+          continue;
+        }
+
+      /* The pieces do not overlap the update, so they need no further
+       * checks.
+       */
+
+      session->damage[i] = pieces[0];
+      for (j = 1; j < npieces; j++)
+        {
+          session->damage[session->ndamage++] = pieces[j];
+        }
 
-  /* Put the entry into the free list */
+      stats->split++;
+      i++;
+    }
 
-  sq_addlast((FAR sq_entry_t *)update, &session->updfree);
+  if (session->ndamage >= CONFIG_VNCSERVER_NUPDATES)
+    {
+      /* No room.  Merge with the rectangle that wastes the fewest pixels. */
 
-  /* Post the semaphore to indicate the availability of one more update */
+      best = nxgl_rectcheapest(&update, session->damage, session->ndamage);
+      nxgl_rectunion(&update, &update, &session->damage[best]);
+      vnc_damage_remove(session, best);
+      stats->merged++;
+      goto again;
+    }
 
-  nxsem_post(&session->freesem);
+  nxgl_rectcopy(&session->damage[session->ndamage++], &update);
 
-  vnc_sem_debug(session, "After free", 0);
-  DEBUGASSERT(session->freesem.semcount <= CONFIG_VNCSERVER_NUPDATES);
+  stats->depth = session->ndamage;
+  if (stats->depth > stats->maxdepth)
+    {
+      stats->maxdepth = stats->depth;
+    }
 
-  sched_unlock();
+  return true;
 }
 
 /****************************************************************************
- * Name: vnc_remove_queue
+ * Name: vnc_take_damage
  *
  * Description:
- *  Remove one entry from the list of queued rectangles, waiting if
- *  necessary if the queue is empty.
+ *  Move all of the damage of a session into its snapshot, waiting if there
+ *  is no damage.
  *
  * Input Parameters:
  *   session - A reference to the VNC session structure.
  *
  * Returned Value:
- *   A non-NULL structure pointer should always be returned.  This function
- *   will wait if no structure is available.
+ *   The number of rectangles in the snapshot.
  *
  ****************************************************************************/
 
-static FAR struct vnc_fbupdate_s *
-vnc_remove_queue(FAR struct vnc_session_s *session)
+static int vnc_take_damage(FAR struct vnc_session_s *session)
 {
-  FAR struct vnc_fbupdate_s *rect;
+  int nrects;
   int ret;
 
-  /* Reserve one element from the list of queued rectangle.  Lock the
-   * scheduler to assure that the sq_remfirst() and the successful return
-   * from nxsem_wait are atomic.  Of course, the scheduler will be unlocked
-   * while we wait.
+  /* Lock the scheduler to assure that the successful return from
+   * nxsem_wait and the copy are atomic.  Of course, the scheduler will be
+   * unlocked while we wait.
    */
 
   sched_lock();
-  vnc_sem_debug(session, "Before remove", 0);
 
   do
     {
@@ -321,64 +282,17 @@ vnc_remove_queue(FAR struct vnc_session_s *session)
     }
   while (ret == -EINTR);
 
-  /* It is reserved.. go get it */
-
-  rect = (FAR struct vnc_fbupdate_s *)sq_remfirst(&session->updqueue);
-
-  vnc_sem_debug(session, "After remove", 0);
-  DEBUGASSERT(rect != NULL);
+  nrects = session->ndamage;
+  memcpy(session->snapshot, session->damage,
+         nrects * sizeof(struct nxgl_rect_s));
 
-  /* Check if we just removed the whole screen update from the queue */
-
-  if (session->nwhupd > 0 && rect->whupd)
-    {
-      session->nwhupd--;
-      updinfo("Whole screen update: nwhupd=%d\n", session->nwhupd);
-    }
-
-  sched_unlock();
-  return rect;
-}
-
-/****************************************************************************
- * Name: vnc_add_queue
- *
- * Description:
- *   Add one rectangle entry to the list of queued rectangles to be updated.
- *
- * Input Parameters:
- *   session - A reference to the VNC session structure.
- *   rect    - The rectangle to be added to the queue.
- *
- * Returned Value:
- *   None
- *
- ****************************************************************************/
-
-static void vnc_add_queue(FAR struct vnc_session_s *session,
-                          FAR struct vnc_fbupdate_s *rect)
-{
-  /* Lock the scheduler to assure that the sq_addlast() and the nxsem_post()
-   * are atomic.
-   */
-
-  sched_lock();
-  vnc_sem_debug(session, "Before add", 1);
-
-  /* Put the entry into the list of queued rectangles. */
-
-  sq_addlast((FAR sq_entry_t *)rect, &session->updqueue);
-
-  /* Post the semaphore to indicate the availability of one more rectangle
-   * in the queue.  This may wakeup the updater.
-   */
-
-  nxsem_post(&session->queuesem);
-
-  vnc_sem_debug(session, "After add", 0);
-  DEBUGASSERT(session->queuesem.semcount <= CONFIG_VNCSERVER_NUPDATES);
+  session->ndamage     = 0;
+  session->stats.depth = 0;
+  session->stats.snapshots++;
+  session->stats.sent += nrects;
 
   sched_unlock();
+  return nrects;
 }
 
 /****************************************************************************
@@ -399,44 +313,45 @@ static void vnc_add_queue(FAR struct vnc_session_s *session,
 static FAR void *vnc_updater(FAR void *arg)
 {
   FAR struct vnc_session_s *session = (FAR struct vnc_session_s *)arg;
-  FAR struct vnc_fbupdate_s *srcrect;
-  int ret;
+  FAR struct nxgl_rect_s *srcrect;
+  int nrects;
+  int ret = OK;
+  int i;
 
   DEBUGASSERT(session != NULL);
   ginfo("Updater running for Display %d\n", session->display);
 
   /* Loop, processing updates until we are asked to stop.
    * REVISIT: Probably need some kind of signal mechanism to wake up
-   * vnc_remove_queue() in order to stop.  Or perhaps a special STOP
+   * vnc_take_damage() in order to stop.  Or perhaps a special STOP
    * message in the queue?
    */
 
   while (session->state == VNCSERVER_RUNNING)
     {
-      /* Get the next queued rectangle update.  This call will block until an
-       * upate is available for the case where the update queue is empty.
+      /* Take all of the damage accumulated so far.  This call will block
+       * until there is damage.  New damage accumulates while the snapshot
+       * is being sent.
        */
 
-      srcrect = vnc_remove_queue(session);
-      DEBUGASSERT(srcrect != NULL);
-
-      updinfo("Dequeued {(%d, %d),(%d, %d)}\n",
-              srcrect->rect.pt1.x, srcrect->rect.pt1.y,
-              srcrect->rect.pt2.x, srcrect->rect.pt2.y);
+      nrects = vnc_take_damage(session);
 
-      /* Attempt to use RRE encoding */
-
-      ret = vnc_rre(session, &srcrect->rect);
-      if (ret == 0)
+      for (i = 0; i < nrects && ret >= 0; i++)
         {
-          /* Perform the framebuffer update using the default RAW encoding */
+          srcrect = &session->snapshot[i];
 
-          ret = vnc_raw(session, &srcrect->rect);
-        }
+          updinfo("Dequeued {(%d, %d),(%d, %d)}\n",
+                  srcrect->pt1.x, srcrect->pt1.y,
+                  srcrect->pt2.x, srcrect->pt2.y);
 
-      /* Release the update structure */
+#ifdef CONFIG_VNCSERVER_TILEHASH
+          /* Send only the tiles that changed since they were last sent */
 
-      vnc_free_update(session, srcrect);
+          ret = vnc_tiles_update(session, srcrect);
+#else
+          ret = vnc_encode(session, srcrect);
+#endif
+        }
 
       /* Break out and terminate the server if the encoding failed */
 
@@ -455,6 +370,54 @@ static FAR void *vnc_updater(FAR void *arg)
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: vnc_encode
+ *
+ * Description:
+ *  Send one rectangle of the local framebuffer using the best encoding
+ *  supported by the client.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   rect  - Describes the rectangle in the local framebuffer.
+ *
+ * Returned Value:
+ *   A non-negative value on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int vnc_encode(FAR struct vnc_session_s *session, FAR struct nxgl_rect_s *rect)
+{
+  int ret;
+
+  /* Attempt to use RRE encoding for single color rectangles */
+
+  ret = vnc_rre(session, rect);
+
+#ifdef CONFIG_VNCSERVER_ZRLE
+  if (ret == 0)
+    {
+      ret = vnc_zrle(session, rect);
+    }
+#endif
+
+#ifdef CONFIG_VNCSERVER_HEXTILE
+  if (ret == 0)
+    {
+      ret = vnc_hextile(session, rect);
+    }
+#endif
+
+  if (ret == 0)
+    {
+      /* Perform the framebuffer update using the default RAW encoding */
+
+      ret = vnc_raw(session, rect);
+    }
+
+  return ret;
+}
+
 /****************************************************************************
  * Name: vnc_start_updater
  *
@@ -544,6 +507,29 @@ int vnc_stop_updater(FAR struct vnc_session_s *session)
   return OK;
 }
 
+/****************************************************************************
+ * Name: vnc_update_getstats
+ *
+ * Description:
+ *  Return the damage counters of a session.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   stats   - The location to return the counters.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void vnc_update_getstats(FAR struct vnc_session_s *session,
+                         FAR struct vnc_update_stats_s *stats)
+{
+  sched_lock();
+  memcpy(stats, &session->stats, sizeof(struct vnc_update_stats_s));
+  sched_unlock();
+}
+
 /****************************************************************************
  * Name: vnc_update_rectangle
  *
@@ -564,9 +550,9 @@ int vnc_stop_updater(FAR struct vnc_session_s *session)
 int vnc_update_rectangle(FAR struct vnc_session_s *session,
                          FAR const struct nxgl_rect_s *rect, bool change)
 {
-  FAR struct vnc_fbupdate_s *update;
   struct nxgl_rect_s intersection;
   bool whupd;
+  bool empty;
 
   /* Clip rectangle to the screen dimensions */
 
@@ -596,72 +582,44 @@ int vnc_update_rectangle(FAR struct vnc_session_s *session,
           return OK;
         }
 
-      /* Ignore all updates if there is a queued whole screen update */
+      /* Add the rectangle to the damage, waking up the updater if there
+       * was none.  Nothing changes if the rectangle is already damaged, as
+       * it always is while a whole screen update is waiting.
+       */
 
-      if (session->nwhupd == 0)
+      empty = (session->ndamage == 0);
+      if (vnc_add_damage(session, &intersection))
         {
-          /* No whole screen updates in the queue.  Is this a new whole
-           * screen update?
+          /* There have been no frame buffer data changes since a whole
+           * screen update was queued.  Otherwise, remember if this update
+           * (OR a preceding update) was due to a data change.
            */
 
           if (whupd)
             {
-              /* Yes.. Discard all of the previously queued updates */
-
-              FAR struct vnc_fbupdate_s *curr;
-              FAR struct vnc_fbupdate_s *next;
-
               updinfo("New whole screen update...\n");
-
-              curr = (FAR struct vnc_fbupdate_s *)session->updqueue.head;
-              sq_init(&session->updqueue);
-              nxsem_reset(&session->queuesem, 0);
-
-              for (; curr != NULL; curr = next)
-                {
-                  next = curr->flink;
-                  vnc_free_update(session, curr);
-                }
-
-              /* One whole screen update will be queued.  There have been
-               * no frame buffer data changes since this update was queued.
-               */
-
-              session->nwhupd = 1;
               session->change = false;
             }
           else
             {
-              /* We are not updating the whole screen.  Remember if this
-               * update (OR a preceding update) was due to a data change.
-               */
-
               session->change |= change;
             }
 
-          /* Allocate an update structure... waiting if necessary */
-
-          update = vnc_alloc_update(session);
-          DEBUGASSERT(update != NULL);
-
-          /* Copy the clipped rectangle into the update structure */
-
-          update->whupd = whupd;
-          nxgl_rectcopy(&update->rect, &intersection);
-
-          /* Add the upate to the end of the update queue. */
-
-          vnc_add_queue(session, update);
+          if (empty)
+            {
+              nxsem_post(&session->queuesem);
+            }
 
-          updinfo("Queued {(%d, %d),(%d, %d)}\n",
+          updinfo("Queued {(%d, %d),(%d, %d)} ndamage=%d\n",
                   intersection.pt1.x, intersection.pt1.y,
-                  intersection.pt2.x, intersection.pt2.y);
+                  intersection.pt2.x, intersection.pt2.y,
+                  session->ndamage);
         }
 
       sched_unlock();
     }
 
-  /* Since we ignore bad rectangles and wait for updata structures, there is
+  /* Since we ignore bad rectangles and never wait for room, there is
    * really no way a failure can occur.
    */
 
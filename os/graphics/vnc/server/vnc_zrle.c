@@ -0,0 +1,538 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * graphics/vnc/server/vnc_zrle.c
+ *
+ * ZRLE encoding.  The update rectangle is sent as rectangles of at most
+ * 64 x CONFIG_VNCSERVER_ZRLE_ROWS pixels, each of which is a single ZRLE
+ * tile.  Every tile is coded as solid, packed palette, plain RLE, palette
+ * RLE or raw, whichever is smallest, and then compressed into the zlib
+ * stream of the session.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#if defined(CONFIG_VNCSERVER_DEBUG) && !defined(CONFIG_DEBUG_GRAPHICS)
+#  undef  CONFIG_DEBUG_FEATURES
+#  undef  CONFIG_DEBUG_ERROR
+#  undef  CONFIG_DEBUG_WARN
+#  undef  CONFIG_DEBUG_INFO
+#  define CONFIG_DEBUG_FEATURES 1
+#  define CONFIG_DEBUG_ERROR    1
+#  define CONFIG_DEBUG_WARN     1
+#  define CONFIG_DEBUG_INFO     1
+#  define CONFIG_DEBUG_GRAPHICS 1
+#endif
+#include <debug.h>
+
+#include "vnc_server.h"
+
+#ifdef CONFIG_VNCSERVER_ZRLE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* ZRLE tile subencodings */
+
+#define ZRLE_RAW          0
+#define ZRLE_SOLID        1
+#define ZRLE_PLAINRLE     128
+
+/* Largest palette that is searched for */
+
+#define ZRLE_MAXPALETTE   16
+
+/* Bytes needed to code the length of a run */
+
+#define ZRLE_RUNBYTES(n)  (((n) - 1) / 255 + 1)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* What is known about a tile after one pass over its pixels */
+
+struct zrle_tile_s
+{
+  FAR const uint8_t *src;      /* First pixel of the tile */
+  nxgl_coord_t width;          /* Size of the tile */
+  nxgl_coord_t height;
+  unsigned int cpsize;         /* Size of a compressed pixel (CPIXEL) */
+  unsigned int npalette;       /* Number of colors, if <= ZRLE_MAXPALETTE */
+  size_t plainrle;             /* Sizes of the run-length codings, */
+  size_t palrle;               /* excluding palette */
+  lfb_color_t palette[ZRLE_MAXPALETTE];
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vnc_zrle_cpixel
+ *
+ * Description:
+ *   Store one pixel as a CPIXEL:  32-bit pixels with a color depth of 24
+ *   bits are sent without their unused byte.
+ *
+ ****************************************************************************/
+
+static size_t vnc_zrle_cpixel(FAR struct vnc_session_s *session,
+                              FAR uint8_t *dest, lfb_color_t rgb,
+                              unsigned int cpsize)
+{
+  uint8_t pixel[sizeof(uint32_t)];
+  size_t size;
+
+  size = vnc_putpixel(session, pixel, rgb);
+  if (size > cpsize && session->bigendian)
+    {
+      memcpy(dest, &pixel[size - cpsize], cpsize);
+    }
+  else
+    {
+      memcpy(dest, pixel, cpsize);
+    }
+
+  return cpsize;
+}
+
+/****************************************************************************
+ * Name: vnc_zrle_putrun
+ *
+ * Description:
+ *   Store the length of a run.
+ *
+ ****************************************************************************/
+
+static FAR uint8_t *vnc_zrle_putrun(FAR uint8_t *dest, unsigned int length)
+{
+  length--;
+  while (length >= 255)
+    {
+      *dest++ = 255;
+      length -= 255;
+    }
+
+  *dest++ = (uint8_t)length;
+  return dest;
+}
+
+/****************************************************************************
+ * Name: vnc_zrle_index
+ *
+ * Description:
+ *   Return the palette index of a color.
+ *
+ ****************************************************************************/
+
+static unsigned int vnc_zrle_index(FAR const struct zrle_tile_s *tile,
+                                   lfb_color_t rgb)
+{
+  unsigned int i;
+
+  for (i = 0; i < tile->npalette - 1 && tile->palette[i] != rgb; i++);
+  return i;
+}
+
+/****************************************************************************
+ * Name: vnc_zrle_analyze
+ *
+ * Description:
+ *   Collect the palette of a tile and the sizes of its run-length codings.
+ *   npalette is set to ZRLE_MAXPALETTE + 1 if the tile has more colors.
+ *
+ ****************************************************************************/
+
+static void vnc_zrle_analyze(FAR struct zrle_tile_s *tile)
+{
+  FAR const lfb_color_t *src;
+  lfb_color_t prev = 0;
+  unsigned int runlen = 0;
+  unsigned int i;
+  nxgl_coord_t x;
+  nxgl_coord_t y;
+
+  tile->npalette = 0;
+  tile->plainrle = 0;
+  tile->palrle   = 0;
+
+  for (y = 0; y < tile->height; y++)
+    {
+      src = (FAR const lfb_color_t *)(tile->src + y * RFB_STRIDE);
+      for (x = 0; x < tile->width; x++, src++)
+        {
+          /* Runs continue from one row to the next */
+
+          if (runlen > 0 && *src == prev)
+            {
+              runlen++;
+              continue;
+            }
+
+          if (runlen > 0)
+            {
+              tile->plainrle += tile->cpsize + ZRLE_RUNBYTES(runlen);
+              tile->palrle   += runlen == 1 ? 1 : 1 + ZRLE_RUNBYTES(runlen);
+            }
+
+          prev   = *src;
+          runlen = 1;
+
+          /* A new run may have a new color */
+
+          if (tile->npalette <= ZRLE_MAXPALETTE)
+            {
+              for (i = 0; i < tile->npalette && tile->palette[i] != prev; i++);
+
+              if (i == tile->npalette)
+                {
+                  if (i < ZRLE_MAXPALETTE)
+                    {
+                      tile->palette[i] = prev;
+                    }
+
+                  tile->npalette++;
+                }
+            }
+        }
+    }
+
+  tile->plainrle += tile->cpsize + ZRLE_RUNBYTES(runlen);
+  tile->palrle   += runlen == 1 ? 1 : 1 + ZRLE_RUNBYTES(runlen);
+}
+
+/****************************************************************************
+ * Name: vnc_zrle_tile
+ *
+ * Description:
+ *   Code one tile in the smallest way into the ZRLE input buffer of the
+ *   session.
+ *
+ * Returned Value:
+ *   The number of bytes coded.
+ *
+ ****************************************************************************/
+
+static size_t vnc_zrle_tile(FAR struct vnc_session_s *session,
+                            FAR struct zrle_tile_s *tile)
+{
+  FAR const lfb_color_t *src;
+  FAR uint8_t *dest = session->zrlein;
+  lfb_color_t prev;
+  unsigned int runlen;
+  unsigned int bits = 0;
+  unsigned int acc;
+  unsigned int nacc;
+  unsigned int i;
+  size_t npixels;
+  size_t rawsize;
+  size_t packsize = SIZE_MAX;
+  size_t palsize = SIZE_MAX;
+  size_t plainsize;
+  nxgl_coord_t x;
+  nxgl_coord_t y;
+  bool palrle = false;
+
+  vnc_zrle_analyze(tile);
+
+  npixels   = (size_t)tile->width * tile->height;
+  rawsize   = npixels * tile->cpsize;
+  plainsize = tile->plainrle;
+
+  /* A solid tile is just its color */
+
+  if (tile->npalette == 1)
+    {
+      *dest++ = ZRLE_SOLID;
+      dest   += vnc_zrle_cpixel(session, dest, tile->palette[0],
+                                tile->cpsize);
+      return dest - session->zrlein;
+    }
+
+  if (tile->npalette <= ZRLE_MAXPALETTE)
+    {
+      bits     = tile->npalette == 2 ? 1 : tile->npalette <= 4 ? 2 : 4;
+      packsize = tile->npalette * tile->cpsize +
+                 tile->height * ((tile->width * bits + 7) >> 3);
+      palsize  = tile->npalette * tile->cpsize + tile->palrle;
+    }
+
+  if (palsize < packsize && palsize < plainsize && palsize < rawsize)
+    {
+      /* Palette RLE:  runs of palette indices */
+
+      *dest++ = ZRLE_PLAINRLE + tile->npalette;
+      palrle  = true;
+    }
+  else if (packsize < plainsize && packsize < rawsize)
+    {
+      /* Packed palette:  each row is packed to 'bits' bits per pixel */
+
+      *dest++ = tile->npalette;
+      for (i = 0; i < tile->npalette; i++)
+        {
+          dest += vnc_zrle_cpixel(session, dest, tile->palette[i],
+                                  tile->cpsize);
+        }
+
+      for (y = 0; y < tile->height; y++)
+        {
+          src  = (FAR const lfb_color_t *)(tile->src + y * RFB_STRIDE);
+          acc  = 0;
+          nacc = 0;
+
+          for (x = 0; x < tile->width; x++)
+            {
+              acc   = (acc << bits) | vnc_zrle_index(tile, *src++);
+              nacc += bits;
+              if (nacc == 8)
+                {
+                  *dest++ = (uint8_t)acc;
+                  acc     = 0;
+                  nacc    = 0;
+                }
+            }
+
+          if (nacc > 0)
+            {
+              *dest++ = (uint8_t)(acc << (8 - nacc));
+            }
+        }
+
+      return dest - session->zrlein;
+    }
+  else if (plainsize < rawsize)
+    {
+      /* Plain RLE:  runs of colors */
+
+      *dest++ = ZRLE_PLAINRLE;
+    }
+  else
+    {
+      /* Raw pixels */
+
+      *dest++ = ZRLE_RAW;
+      for (y = 0; y < tile->height; y++)
+        {
+          src = (FAR const lfb_color_t *)(tile->src + y * RFB_STRIDE);
+          for (x = 0; x < tile->width; x++)
+            {
+              dest += vnc_zrle_cpixel(session, dest, *src++, tile->cpsize);
+            }
+        }
+
+      return dest - session->zrlein;
+    }
+
+  /* Both run-length codings walk the runs of the tile */
+
+  if (palrle)
+    {
+      for (i = 0; i < tile->npalette; i++)
+        {
+          dest += vnc_zrle_cpixel(session, dest, tile->palette[i],
+                                  tile->cpsize);
+        }
+    }
+
+  src    = (FAR const lfb_color_t *)tile->src;
+  prev   = *src;
+  runlen = 0;
+
+  for (y = 0; y < tile->height; y++)
+    {
+      src = (FAR const lfb_color_t *)(tile->src + y * RFB_STRIDE);
+      for (x = 0; x < tile->width; x++, src++)
+        {
+          if (*src == prev)
+            {
+              runlen++;
+              continue;
+            }
+
+          if (palrle)
+            {
+              i = vnc_zrle_index(tile, prev);
+              *dest++ = runlen == 1 ? i : i | 0x80;
+            }
+          else
+            {
+              dest += vnc_zrle_cpixel(session, dest, prev, tile->cpsize);
+            }
+
+          if (!palrle || runlen > 1)
+            {
+              dest = vnc_zrle_putrun(dest, runlen);
+            }
+
+          prev   = *src;
+          runlen = 1;
+        }
+    }
+
+  if (palrle)
+    {
+      i = vnc_zrle_index(tile, prev);
+      *dest++ = runlen == 1 ? i : i | 0x80;
+    }
+  else
+    {
+      dest += vnc_zrle_cpixel(session, dest, prev, tile->cpsize);
+    }
+
+  if (!palrle || runlen > 1)
+    {
+      dest = vnc_zrle_putrun(dest, runlen);
+    }
+
+  return dest - session->zrlein;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: vnc_zrle
+ *
+ * Description:
+ *  Send the framebuffer update using the ZRLE encoding.
+ *
+ * Input Parameters:
+ *   session - An instance of the session structure.
+ *   rect  - Describes the rectangle in the local framebuffer.
+ *
+ * Returned Value:
+ *   Zero is returned if ZRLE coding was not performed (but no error was
+ *   encountered).  Otherwise, the number of bytes sent is returned on
+ *   success or a negated errno value is returned on failure.
+ *
+ ****************************************************************************/
+
+int vnc_zrle(FAR struct vnc_session_s *session, FAR struct nxgl_rect_s *rect)
+{
+  FAR struct rfb_framebufferupdate_s *update;
+  FAR const uint8_t *src;
+  struct zrle_tile_s tile;
+  nxgl_coord_t x;
+  nxgl_coord_t y;
+  uint8_t colorfmt;
+  size_t inlen;
+  size_t size;
+  ssize_t nsent;
+  int total = 0;
+
+  /* Check if the client supports the ZRLE encoding */
+
+  if (!session->zrle)
+    {
+      return 0;
+    }
+
+  /* CPIXELs drop the unused byte of 32-bit pixels */
+
+  colorfmt    = session->colorfmt;
+  tile.cpsize = colorfmt == FB_FMT_RGB32 ? 3 : (session->bpp + 7) >> 3;
+
+  /* Send one message for each tile.  NOTE that the loop also terminates if
+   * the color format changes asynchronously.
+   */
+
+  for (y = rect->pt1.y; y <= rect->pt2.y && colorfmt == session->colorfmt;
+       y += tile.height)
+    {
+      tile.height = MIN(rect->pt2.y - y + 1, CONFIG_VNCSERVER_ZRLE_ROWS);
+
+      for (x = rect->pt1.x;
+           x <= rect->pt2.x && colorfmt == session->colorfmt;
+           x += tile.width)
+        {
+          tile.width = MIN(rect->pt2.x - x + 1, VNCSERVER_ZRLE_TILEWIDTH);
+          tile.src   = session->fb + RFB_STRIDE * y + RFB_BYTESPERPIXEL * x;
+
+          /* Code and compress the tile after the headers */
+
+          inlen = vnc_zrle_tile(session, &tile);
+          DEBUGASSERT(inlen <= VNCSERVER_ZRLE_INSIZE);
+
+          size  = vnc_deflate(&session->deflate, session->zrlein, inlen,
+                              &session->zrleout[VNCSERVER_ZRLE_HDRSIZE]);
+          rfb_putbe32(&session->zrleout[VNCSERVER_ZRLE_HDRSIZE -
+                                        sizeof(uint32_t)], size);
+
+          /* Format the FramebufferUpdate message */
+
+          update          = (FAR struct rfb_framebufferupdate_s *)session->zrleout;
+          update->msgtype = RFB_FBUPDATE_MSG;
+          update->padding = 0;
+          rfb_putbe16(update->nrect, 1);
+
+          rfb_putbe16(update->rect[0].xpos, x);
+          rfb_putbe16(update->rect[0].ypos, y);
+          rfb_putbe16(update->rect[0].width, tile.width);
+          rfb_putbe16(update->rect[0].height, tile.height);
+          rfb_putbe32(update->rect[0].encoding, RFB_ENCODING_ZRLE);
+
+          size += VNCSERVER_ZRLE_HDRSIZE;
+          DEBUGASSERT(size <= VNCSERVER_ZRLE_OUTSIZE);
+
+          /* The compressed data is part of the zlib stream now, so it must
+           * be sent even if the color format changed.  Send until all of
+           * the bytes are out.
+           */
+
+          src    = session->zrleout;
+          total += size;
+
+          do
+            {
+              nsent = psock_send(&session->connect, src, size, 0);
+              if (nsent < 0)
+                {
+                  gerr("ERROR: Send ZRLE FrameBufferUpdate failed: %d\n",
+                       (int)nsent);
+                  return (int)nsent;
+                }
+
+              DEBUGASSERT(nsent <= size);
+              src  += nsent;
+              size -= nsent;
+            }
+          while (size > 0);
+
+          updinfo("Sent {(%d, %d),(%d, %d)}\n",
+                  x, y, x + tile.width - 1, y + tile.height - 1);
+        }
+    }
+
+  return total;
+}
+
+#endif /* CONFIG_VNCSERVER_ZRLE */
@@ -1654,6 +1654,26 @@ char up_romgetc(FAR const char *ptr);
 void up_mdelay(unsigned int milliseconds);
 void up_udelay(useconds_t microseconds);
 
+/****************************************************************************
+ * Name: up_perf_init, up_perf_gettime and up_perf_getfreq
+ *
+ * Description:
+ *   Architectures that select CONFIG_ARCH_HAVE_PERF_EVENTS provide a
+ *   free-running 32-bit cycle counter for timing code paths that are much
+ *   shorter than a system tick.  up_perf_init() starts the counter and is
+ *   called from up_initialize().  up_perf_gettime() returns the current
+ *   count; the difference of two counts is valid as long as the counter
+ *   did not wrap more than once.  up_perf_getfreq() returns the counting
+ *   rate in Hz.
+ *
+ ***************************************************************************/
+
+#ifdef CONFIG_ARCH_HAVE_PERF_EVENTS
+void up_perf_init(void);
+uint32_t up_perf_gettime(void);
+uint32_t up_perf_getfreq(void);
+#endif
+
 /****************************************************************************
  * Name: up_cxxinitialize
  *
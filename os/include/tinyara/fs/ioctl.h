@@ -93,6 +93,7 @@
 #define _RTCBASE        (0x1800)	/* RTC ioctl commands */
 #define _FOTABASE       (0x1900)	/* FOTA ioctl commands */
 #define _GPIOBASE       (0x2000)	/* GPIO ioctl commands */
+#define _LCDIOCBASE     (0x2100)	/* LCD driver ioctl commands */
 
 /* boardctl() commands share the same number space */
 #define _BOARDBASE      (0xff00)	/* boardctl commands */
@@ -229,6 +230,11 @@
 										 *      the block with specific debug
 										 *      command and data.
 										 * OUT: None.  */
+#define BIOC_FLUSH      _BIOC(0x000C)	/* Write any state the block driver
+										 * keeps in RAM to the media.
+										 * IN:  None
+										 * OUT: None (ioctl return value provides
+										 *      success/failure indication). */
 
 /* TinyAra MTD driver ioctl definitions ***************************************/
 
@@ -340,6 +346,11 @@
 #define _GPIOIOCVALID(c)   (_IOC_TYPE(c) == _GPIOBASE)
 #define _GPIOIOC(nr)       _IOC(_GPIOBASE, nr)
 
+/* LCD driver ioctl definitions *********************************************/
+/* (see include/tinyara/lcd/lcd.h and the individual LCD driver headers) */
+#define _LCDIOCVALID(c)    (_IOC_TYPE(c) == _LCDIOCBASE)
+#define _LCDIOC(nr)        _IOC(_LCDIOCBASE, nr)
+
 /* boardctl() command definitions *******************************************/
 #define _BOARDIOCVALID(c)  (_IOC_TYPE(c) == _BOARDBASE)
 #define _BOARDIOC(nr)      _IOC(_BOARDBASE, nr)
@@ -190,6 +190,31 @@ extern "C" {
 
 size_t procfs_memcpy(FAR const char *src, size_t srclen, FAR char *dest, size_t destlen, off_t *offset);
 
+/****************************************************************************
+ * Name: procfs_latency
+ *
+ * Description:
+ *   Format scheduling latency statistics, as returned by sched_latency(),
+ *   into the user's receive buffer, one line at a time like procfs_memcpy().
+ *
+ * Input Parameters:
+ *   latency - The statistics to show
+ *   line    - An intermediate buffer for one line
+ *   linelen - The size of 'line'; at least 32 bytes
+ *   dest    - The address of the user's receive buffer.
+ *   destlen - The size (in bytes) of the user's receive buffer.
+ *   offset  - The number of bytes to skip, see procfs_memcpy().
+ *
+ * Returned Value:
+ *   The number of bytes actually transferred into the user's receive buffer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_LATENCY
+struct sched_latency_s;
+size_t procfs_latency(FAR const struct sched_latency_s *latency, FAR char *line, size_t linelen, FAR char *dest, size_t destlen, off_t *offset);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
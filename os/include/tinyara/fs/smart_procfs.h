@@ -111,6 +111,12 @@ struct mtd_smart_procfs_data_s {
 #ifdef CONFIG_MTD_SMART_WEAR_LEVEL
 	uint32_t uneven_wearcount;	/* Number of uneven block erases */
 #endif
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+	uint32_t cachehits;			/* Sector cache lookups that hit */
+	uint32_t cachemisses;		/* Sector cache lookups that scanned the device */
+	uint32_t cachescanreads;	/* Sector headers read by those scans */
+	uint32_t cacheprefetches;	/* Entries cached by those scans */
+#endif
 };
 
 /* The following defines debug command data passed from the procfs layer to
@@ -60,6 +60,10 @@
 
 #include <tinyara/config.h>
 
+#include <stdint.h>
+
+#include <tinyara/fs/ioctl.h>
+
 /**************************************************************************************
  * Pre-processor Definitions
  **************************************************************************************/
@@ -219,10 +223,37 @@
 #define ILI9341_INTERFACE_CONTROL_RCM(n)       ((n) << ILI9341_INTERFACE_CONTROL_RCM_SHIFT)
 #define ILI9341_INTERFACE_CONTROL_BPASS        (1 << 7)
 
+/* ILI9341 driver ioctl commands *****************************************************/
+/* These are passed to the ioctl method of the lcd_dev_s returned by
+ * ili9341_initialize().
+ *
+ * ILI9341IOC_GETSTATS
+ *   Description: Get the bus transfer counters of the display.
+ *   Argument:    A reference to a struct ili9341_stats_s
+ *
+ * ILI9341IOC_RESETSTATS
+ *   Description: Clear the bus transfer counters of the display.
+ *   Argument:    Ignored
+ */
+
+#define ILI9341IOC_GETSTATS                    _LCDIOC(0x0001)
+#define ILI9341IOC_RESETSTATS                  _LCDIOC(0x0002)
+
 /**************************************************************************************
  * Public Types
  **************************************************************************************/
 
+/* Bus transfer counters of one display, see ILI9341IOC_GETSTATS */
+
+struct ili9341_stats_s {
+	uint32_t windows;			/* Address windows set for writes */
+	uint32_t streamed;			/* Runs written into an already open window */
+	uint32_t transfers;			/* Calls to sendgram() and recvgram() */
+	uint32_t cmdbytes;			/* Command and parameter bytes of the data path */
+	uint64_t txbytes;			/* Pixel bytes written */
+	uint64_t rxbytes;			/* Pixel bytes read */
+};
+
 struct ili9341_lcd_s {
 	/* Interface to control the ILI9341 lcd driver
 	 *
@@ -293,6 +324,26 @@ extern "C" {
 
 FAR struct lcd_dev_s *ili9341_initialize(FAR struct ili9341_lcd_s *lcd, int devno);
 
+/**************************************************************************************
+ * Name:  ili9341_getdev
+ *
+ * Description:
+ *   Return the LCD driver object of a display that has been initialized by
+ *   ili9341_initialize(), e.g. to read its counters with ILI9341IOC_GETSTATS.
+ *
+ * Input Parameters:
+ *
+ *   devno - A value in the range of 0 through CONFIG_ILI9341_NINTERFACES-1.
+ *
+ * Returned Value:
+ *
+ *   A reference to the LCD driver object, or NULL if the display has not been
+ *   initialized.
+ *
+ **************************************************************************************/
+
+FAR struct lcd_dev_s *ili9341_getdev(int devno);
+
 /**************************************************************************************
  * Name:  ili9341_clear
  *
@@ -94,6 +94,38 @@ struct lcd_planeinfo_s
   int (*getrun)(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer,
                 size_t npixels);
 
+  /* Optional: fill a partial raster line with a single color.  This lets
+   * the driver repeat the color itself instead of receiving the same pixel
+   * npixels times.  May be NULL, in which case the caller fills the run
+   * buffer and uses putrun():
+   *
+   *  row     - Starting row to write to (range: 0 <= row < yres)
+   *  col     - Starting column to write to (range: 0 <= col <= xres-npixels)
+   *  color   - The pixel value, in the format of this plane
+   *  npixels - The number of pixels to write to the LCD
+   *            (range: 0 < npixels <= xres-col)
+   */
+
+  int (*fillrun)(fb_coord_t row, fb_coord_t col, uint32_t color,
+                 size_t npixels);
+
+  /* Optional: write a partial raster line given as one bit per pixel.  The
+   * bits are packed most significant bit first; set bits are drawn in the
+   * foreground color and clear bits in the background color.  May be NULL,
+   * in which case the caller expands the pixels and uses putrun():
+   *
+   *  row     - Starting row to write to (range: 0 <= row < yres)
+   *  col     - Starting column to write to (range: 0 <= col <= xres-npixels)
+   *  bits    - The packed bits, (npixels + 7) / 8 bytes
+   *  fg      - The pixel value for set bits, in the format of this plane
+   *  bg      - The pixel value for clear bits, in the format of this plane
+   *  npixels - The number of pixels to write to the LCD
+   *            (range: 0 < npixels <= xres-col)
+   */
+
+  int (*putrun1bpp)(fb_coord_t row, fb_coord_t col, FAR const uint8_t *bits,
+                    uint32_t fg, uint32_t bg, size_t npixels);
+
   /* Plane color characteristics ********************************************/
 
   /* This is working memory allocated by the LCD driver for each LCD device
@@ -176,6 +208,12 @@ struct lcd_dev_s
   /* Set LCD panel contrast (0-CONFIG_LCD_MAXCONTRAST) */
 
   int (*setcontrast)(struct lcd_dev_s *dev, unsigned int contrast);
+
+  /* Optional: driver specific controls.  The commands are defined with
+   * _LCDIOC() by each driver.  May be NULL if the driver has none.
+   */
+
+  int (*ioctl)(FAR struct lcd_dev_s *dev, int cmd, unsigned long arg);
 };
 
 /****************************************************************************
@@ -45,6 +45,11 @@
 
 #include <tinyara/config.h>
 
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <tinyara/fs/ioctl.h>
+
 #ifdef CONFIG_LCD_RA8875
 
 /**************************************************************************************
@@ -65,6 +70,19 @@
  *   support.  Default is this 320x240 "landscape" orientation
  */
 
+/* RA8875 driver ioctl commands ******************************************************/
+/* These are passed to the ioctl method of the lcd_dev_s returned by
+ * ra8875_lcdinitialize().
+ *
+ * RA8875IOC_FLIP
+ *   Description: Show the frame drawn since the last flip, see ra8875_flip().
+ *                Fails with -ENOSYS without CONFIG_LCD_RA8875_PAGEFLIP or where
+ *                two layers do not fit in display memory.
+ *   Argument:    Ignored
+ */
+
+#define RA8875IOC_FLIP                         _LCDIOC(0x0003)
+
 /**************************************************************************************
  * Public Types
  **************************************************************************************/
@@ -78,6 +96,14 @@ struct ra8875_lcd_s
   void (*write_reg)(FAR struct ra8875_lcd_s *dev, uint8_t regnum, uint8_t data);
   void (*write_reg16)(FAR struct ra8875_lcd_s *dev, uint8_t regnum, uint16_t data);
 
+  /* Optional: write a burst of registers, given as nregs (register, value) byte
+   * pairs.  May be NULL, in which case the driver falls back to one write_reg() call
+   * per register.
+   */
+
+  void (*write_regs)(FAR struct ra8875_lcd_s *dev, FAR const uint8_t *regs,
+                     size_t nregs);
+
   uint8_t (*read_reg)(FAR struct ra8875_lcd_s *dev, uint8_t regnum);
   uint8_t (*read_status)(FAR struct ra8875_lcd_s *dev);
 
@@ -86,6 +112,20 @@ struct ra8875_lcd_s
   void (*pwrite_prepare)(FAR struct ra8875_lcd_s *dev, uint8_t regnum);
   void (*pwrite_data8)(FAR struct ra8875_lcd_s *dev, uint8_t data);
   void (*pwrite_data16)(FAR struct ra8875_lcd_s *dev, uint16_t data);
+
+  /* Optional: stream a whole run of 16-bit pixels in a single transfer.  May be NULL,
+   * in which case the driver falls back to one pwrite_data16() call per pixel.
+   */
+
+  void (*pwrite_run)(FAR struct ra8875_lcd_s *dev, FAR const void *pixels,
+                     size_t npixels);
+
+  /* Optional: send a block of raw bytes in a single transfer.  May be NULL, in
+   * which case the driver falls back to one pwrite_data8() call per byte.
+   */
+
+  void (*pwrite_block)(FAR struct ra8875_lcd_s *dev, FAR const uint8_t *data,
+                       size_t nbytes);
   void (*pwrite_finish)(FAR struct ra8875_lcd_s *dev);
 
   void (*pread_prepare)(FAR struct ra8875_lcd_s *dev, uint8_t regnum);
@@ -169,6 +209,69 @@ void ra8875_drawrectangle(FAR struct lcd_dev_s *dev, uint16_t x, uint16_t y,
 void ra8875_drawline(FAR struct lcd_dev_s *dev, uint16_t x1, uint16_t y1, uint16_t x2,
                      uint16_t y2, uint16_t color);
 
+/**************************************************************************************
+ * Name:  ra8875_moverectangle
+ *
+ * Description:
+ *   This is a non-standard function to move a rectangular region of the LCD using
+ *   the RA8875 Block Transfer Engine.  No pixel data is transferred over the bus.
+ *   This function is used by nxglib to accelerate window moves and scrolling.
+ *
+ *   NOTE: This non-standard function is not available to applications in the
+ *   protected or kernel build modes.
+ *
+ **************************************************************************************/
+
+void ra8875_moverectangle(FAR struct lcd_dev_s *dev, uint16_t sx, uint16_t sy,
+                          uint16_t width, uint16_t height, uint16_t dx, uint16_t dy);
+
+/**************************************************************************************
+ * Name:  ra8875_expandbitmap
+ *
+ * Description:
+ *   This is a non-standard function to draw a 1bpp bitmap using the RA8875 Block
+ *   Transfer Engine color expansion.  Set bits are drawn in the foreground color and
+ *   clear bits in the background color.  Each row of the bitmap starts on a byte
+ *   boundary and is packed most significant bit first.  This function is used by
+ *   nxglib to send two-color images, such as rendered font glyphs, at one bit per
+ *   pixel.
+ *
+ *   NOTE: This non-standard function is not available to applications in the
+ *   protected or kernel build modes.
+ *
+ **************************************************************************************/
+
+#ifdef CONFIG_LCD_RA8875_COLOREXPAND
+void ra8875_expandbitmap(FAR struct lcd_dev_s *dev, uint16_t x, uint16_t y,
+                         uint16_t width, uint16_t height, FAR const uint8_t *bits,
+                         uint16_t fg, uint16_t bg);
+#endif
+
+/**************************************************************************************
+ * Name:  ra8875_flip
+ *
+ * Description:
+ *   This is a non-standard function to show the frame drawn since the last flip.  With
+ *   CONFIG_LCD_RA8875_PAGEFLIP, all drawing goes to the hidden one of the two RA8875
+ *   layers and becomes visible only when this function is called, so partly drawn
+ *   frames are never shown.  Drawing still waits for its SPI transfers; only the copy
+ *   of the frame into the new hidden layer is left to the low priority work queue.
+ *   Clients of an NX server must see that the server has drawn the frame, e.g. with
+ *   nx_fencewait(), before they flip.  The same is available to any holder of the
+ *   lcd_dev_s as RA8875IOC_FLIP.
+ *
+ *   Returns -ENOSYS where two layers do not fit in display memory, as at 800x480 with
+ *   65K colors.
+ *
+ *   NOTE: This non-standard function is not available to applications in the
+ *   protected or kernel build modes.
+ *
+ **************************************************************************************/
+
+#ifdef CONFIG_LCD_RA8875_PAGEFLIP
+int ra8875_flip(FAR struct lcd_dev_s *dev);
+#endif
+
 /**************************************************************************************
  * Name:  ra8875_drawtriangle
  *
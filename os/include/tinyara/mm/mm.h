@@ -59,6 +59,7 @@
 #include <tinyara/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <semaphore.h>
 
@@ -207,8 +208,8 @@
 typedef uint16_t mmsize_t;
 #define MMSIZE_MAX 0xffff
 #else
-typedef size_t mmsize_t;
-#define MMSIZE_MAX SIZE_MAX
+typedef uint32_t mmsize_t;
+#define MMSIZE_MAX UINT32_MAX
 #endif
 
 /* typedef is used for defining size of address space */
@@ -292,6 +293,54 @@ struct mm_freenode_s {
 #define CHECK_FREENODE_SIZE \
 	DEBUGASSERT(sizeof(struct mm_freenode_s) == SIZEOF_MM_FREENODE)
 
+#ifdef CONFIG_MM_SLAB
+/* Small allocations are served from fixed size objects in slab pages.
+ * The pages are carved from one arena that is allocated from the heap
+ * itself when the heap is initialized.
+ */
+
+#define MM_SLAB_NCLASSES  8			/* Number of object sizes */
+#define MM_SLAB_MAXSIZE   256		/* Largest object size */
+#define MM_SLAB_PAGESIZE  1024		/* Size of one slab page */
+
+/* This describes one slab page */
+
+struct mm_slabpage_s {
+	FAR struct mm_slabpage_s *flink;	/* Supports a doubly linked list */
+	FAR struct mm_slabpage_s *blink;
+	FAR void *freelist;				/* Free objects in this page */
+	uint16_t inuse;					/* Number of allocated objects */
+	uint8_t sclass;					/* Size class of the objects */
+};
+
+/* This describes the slab arena of one heap */
+
+struct mm_slab_s {
+	FAR uint8_t *base;				/* First slab page */
+	FAR uint8_t *end;				/* End of the last slab page */
+	FAR struct mm_slabpage_s *pages;	/* One descriptor per slab page */
+	FAR struct mm_slabpage_s *freepages;	/* Pages not used by any class */
+	FAR struct mm_slabpage_s *partial[MM_SLAB_NCLASSES];	/* Pages with free objects */
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+	size_t maglimit;				/* Most bytes all magazines may cache */
+	size_t magbytes;				/* Bytes cached in all magazines */
+#endif
+};
+
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+/* Each thread keeps a magazine of free slab objects in its TCB, so that
+ * most small allocations and releases do not take the heap semaphore.
+ * The magazine is bound to the first heap that the thread uses.
+ */
+
+struct mm_magazine_s {
+	FAR struct mm_heap_s *heap;		/* Heap that owns the cached objects */
+	uint8_t count[MM_SLAB_NCLASSES];	/* Number of cached objects per class */
+	FAR void *rounds[MM_SLAB_NCLASSES][CONFIG_MM_SLAB_MAGAZINE_SIZE];
+};
+#endif
+#endif
+
 /* This describes one heap (possibly with multiple regions) */
 
 struct mm_heap_s {
@@ -326,6 +375,12 @@ struct mm_heap_s {
 	 */
 
 	struct mm_freenode_s mm_nodelist[MM_NNODES];
+
+#ifdef CONFIG_MM_SLAB
+	/* Small allocations are served from here */
+
+	struct mm_slab_s mm_slab;
+#endif
 };
 
 /****************************************************************************
@@ -425,6 +480,20 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size, mmaddress_t caller_
 FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size);
 #endif
 
+/* Functions contained in mm_slab.c *****************************************/
+
+#ifdef CONFIG_MM_SLAB
+void mm_slab_initialize(FAR struct mm_heap_s *heap);
+FAR void *mm_slab_alloc(FAR struct mm_heap_s *heap, size_t size);
+bool mm_slab_free(FAR struct mm_heap_s *heap, FAR void *mem);
+size_t mm_slab_size(FAR struct mm_heap_s *heap, FAR void *mem);
+size_t mm_slab_classsize(int sclass);
+#endif
+
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+void mm_magazine_flush(FAR struct mm_magazine_s *mag, CODE void (*release)(FAR void *mem));
+#endif
+
 /* Functions contained in kmm_malloc.c **************************************/
 
 #ifdef CONFIG_MM_KERNEL_HEAP
@@ -828,6 +828,64 @@ int nx_bitmap(NXWINDOW hwnd, FAR const struct nxgl_rect_s *dest,
               FAR const void *src[CONFIG_NX_NPLANES],
               FAR const struct nxgl_point_s *origin, unsigned int stride);
 
+#ifdef CONFIG_NX_CMDRING
+/****************************************************************************
+ * Name: nx_batch
+ *
+ * Description:
+ *   Start or stop batching the drawing commands of a connection.  While
+ *   batching, commands are only queued in the command ring of the
+ *   connection and nx_bitmap() does not wait for the server, so the source
+ *   image must be kept until a fence that follows it is reached.
+ *
+ * Input Parameters:
+ *   handle - The handle returned by nx_connect
+ *   enable - True to start batching, false to stop
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nx_batch(NXHANDLE handle, bool enable);
+
+/****************************************************************************
+ * Name: nx_fence
+ *
+ * Description:
+ *   Return a fence for the drawing commands queued so far on a connection
+ *   and ask the server to execute them.
+ *
+ * Input Parameters:
+ *   handle - The handle returned by nx_connect
+ *   fence  - Location to return the fence value
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nx_fence(NXHANDLE handle, FAR uint32_t *fence);
+
+/****************************************************************************
+ * Name: nx_fencewait
+ *
+ * Description:
+ *   Wait until all of the commands before a fence returned by nx_fence()
+ *   have been executed by the server.
+ *
+ * Input Parameters:
+ *   handle - The handle returned by nx_connect
+ *   fence  - The fence value to wait for
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nx_fencewait(NXHANDLE handle, uint32_t fence);
+#endif
+
 /****************************************************************************
  * Name: nx_notify_rectangle
  *
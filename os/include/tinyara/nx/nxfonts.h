@@ -464,7 +464,7 @@ typedef FAR void *FCACHE;
 
 struct nxfonts_glyph_s
 {
-  FAR struct nxfonts_glyph_s *flink;   /* Implements a singly linked list */
+  FAR struct nxfonts_glyph_s *flink;   /* Not used by the cache, kept for the layout */
   uint8_t code;                        /* Character code */
   uint8_t height;                      /* Height of this glyph (in rows) */
   uint8_t width;                       /* Width of this glyph (in pixels) */
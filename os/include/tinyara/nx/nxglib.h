@@ -518,6 +518,28 @@ void nxgl_rectunion(FAR struct nxgl_rect_s *dest,
                     FAR const struct nxgl_rect_s *src1,
                     FAR const struct nxgl_rect_s *src2);
 
+/****************************************************************************
+ * Name: nxgl_rectwaste, nxgl_rectmerge and nxgl_rectcheapest
+ *
+ * Description:
+ *   Decide when two damaged rectangles are better sent as their bounding
+ *   box.  nxgl_rectwaste() returns the box and the number of pixels in it
+ *   that neither rectangle covers.  nxgl_rectmerge() returns true and the
+ *   box if the two overlap or touch and the box wastes no more pixels than
+ *   the smaller rectangle covers.  nxgl_rectcheapest() returns the index
+ *   of the rectangle in list that wastes the fewest pixels with rect.
+ *
+ ****************************************************************************/
+
+int32_t nxgl_rectwaste(FAR struct nxgl_rect_s *dest,
+                       FAR const struct nxgl_rect_s *rect1,
+                       FAR const struct nxgl_rect_s *rect2);
+bool nxgl_rectmerge(FAR struct nxgl_rect_s *dest,
+                    FAR const struct nxgl_rect_s *rect1,
+                    FAR const struct nxgl_rect_s *rect2);
+int nxgl_rectcheapest(FAR const struct nxgl_rect_s *rect,
+                      FAR const struct nxgl_rect_s *list, int nrects);
+
 /****************************************************************************
  * Name: nxgl_nonintersecting
  *
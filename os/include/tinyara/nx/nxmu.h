@@ -68,6 +68,10 @@
 #  define CONFIG_NX_MXCLIENTMSGS 16 /* Number of pending messages in each client MQ */
 #endif
 
+#if defined(CONFIG_NX_CMDRING) && !defined(CONFIG_NX_CMDRING_NSLOTS)
+#  define CONFIG_NX_CMDRING_NSLOTS 32 /* Number of commands in each client ring */
+#endif
+
 /* Used to create unique client MQ name */
 
 #define NX_CLIENT_MQNAMEFMT  "nxc%d"
@@ -116,6 +120,9 @@ struct nxfe_conn_s
 
   mqd_t crdmq;            /* MQ to read from the server (may be non-blocking) */
   mqd_t cwrmq;            /* MQ to write to the server (blocking) */
+#ifdef CONFIG_NX_CMDRING
+  FAR struct nxmu_ring_s *ring; /* Window commands queued for the server */
+#endif
 
   /* These are only usable on the server side of the connection */
 
@@ -159,7 +166,8 @@ enum nxmsg_e
   NX_SVRMSG_SETBGCOLOR,       /* Set the color of the background */
   NX_SVRMSG_MOUSEIN,          /* New mouse report from mouse client */
   NX_SVRMSG_KBDIN,            /* New keyboard report from keyboard client */
-  NX_SVRMSG_REDRAWREQ         /* Request re-drawing of rectangular region */
+  NX_SVRMSG_REDRAWREQ,        /* Request re-drawing of rectangular region */
+  NX_SVRMSG_DRAIN             /* Execute the commands in a client's ring */
 };
 
 /* Server-to-Client Message Structures **************************************/
@@ -456,6 +464,36 @@ struct nxsvrmsg_redrawreq_s
   struct nxgl_rect_s rect;         /* Describes the rectangular region to be redrawn */
 };
 
+/* Client command ring ****************************************************/
+
+/* Window commands of a client are queued in this ring
+ * instead of the server message queue.  The client writes each command
+ * into the next free slot and advances head; the server executes the
+ * commands in place and advances tail.  Both counters run freely, so the
+ * number of commands executed is also the fence value that the client
+ * waits for.
+ */
+
+#ifdef CONFIG_NX_CMDRING
+union nxmu_ringslot_u
+{
+  struct nxsvrmsg_s hdr;          /* Every command begins with this form */
+  uint8_t buffer[NX_MXSVRMSGLEN]; /* Largest command */
+};
+
+struct nxmu_ring_s
+{
+  volatile uint32_t head;         /* Number of commands queued by the client */
+  volatile uint32_t tail;         /* Number of commands executed by the server */
+  volatile uint32_t nwaiters;     /* Client threads about to wait on fencesem */
+  volatile bool kicked;           /* An NX_SVRMSG_DRAIN message is pending */
+  bool batch;                     /* Queue commands without waking the server */
+  sem_t exclsem;                  /* Serializes client threads queueing commands */
+  sem_t fencesem;                 /* Posted once per waiter when tail advances */
+  union nxmu_ringslot_u slot[CONFIG_NX_CMDRING_NSLOTS];
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -561,6 +599,68 @@ int nxmu_sendserver(FAR struct nxfe_conn_s *conn,
 int nxmu_sendwindow(FAR struct nxbe_window_s *wnd, FAR const void *msg,
                     size_t msglen);
 
+/****************************************************************************
+ * Name: nxmu_ringsend
+ *
+ * Description:
+ *  Queue a window command in the command ring of the connection, waiting
+ *  for a free slot if the ring is full.  Unless the client is batching
+ *  commands, the server is asked to drain the ring.
+ *
+ * Input Parameters:
+ *   conn   - A pointer to the server connection structure
+ *   msg    - A pointer to the message to queue
+ *   msglen - The length of the message in bytes.
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_CMDRING
+int nxmu_ringsend(FAR struct nxfe_conn_s *conn, FAR const void *msg,
+                  size_t msglen);
+
+/****************************************************************************
+ * Name: nxmu_ringkick
+ *
+ * Description:
+ *  Ask the server to drain the command ring of the connection if it holds
+ *  commands and no request is pending yet.  This is done before any
+ *  message is sent through the server message queue, so that it is
+ *  executed after the commands queued before it.
+ *
+ * Input Parameters:
+ *   conn   - A pointer to the server connection structure
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nxmu_ringkick(FAR struct nxfe_conn_s *conn);
+
+/****************************************************************************
+ * Name: nxmu_ringwait
+ *
+ * Description:
+ *  Wait until the server has executed the commands in the command ring of
+ *  the connection up to the fence value 'fence'.  Passing the current
+ *  head of the ring waits for every command queued so far.  Several
+ *  threads may wait on the same connection at the same time.
+ *
+ * Input Parameters:
+ *   conn   - A pointer to the server connection structure
+ *   fence  - The number of executed commands to wait for
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nxmu_ringwait(FAR struct nxfe_conn_s *conn, uint32_t fence);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -73,6 +73,9 @@
 #include <tinyara/mm/shm.h>
 #include <tinyara/fs/fs.h>
 #include <tinyara/net/net.h>
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+#include <tinyara/mm/mm.h>
+#endif
 
 #include <arch/arch.h>
 
@@ -458,6 +461,32 @@ struct task_group_s {
 };
 #endif
 
+#ifdef CONFIG_SCHED_LATENCY
+/* struct sched_latency_s ********************************************************/
+/** @brief Scheduling latency statistics of one thread, or of all threads since
+ * boot.  Times are in microseconds.  Bucket 0 of a histogram counts times below
+ * 2 usec, bucket n times from 2^n up to 2^(n+1) usec and the last bucket also
+ * everything longer.
+ */
+struct sched_latency_s {
+	uint32_t switches;			/* Number of times switched in         */
+	uint32_t preemptions;		/* Times switched out while ready      */
+	uint32_t maxwake;			/* Longest wake-to-run latency         */
+	uint64_t semwait;			/* Time blocked on semaphores          */
+	uint64_t mqwait;			/* Time blocked on message queues      */
+	uint64_t otherwait;			/* Time blocked otherwise              */
+	uint32_t wake[CONFIG_SCHED_LATENCY_NBUCKETS];	/* Wake-to-run latencies */
+	uint32_t slice[CONFIG_SCHED_LATENCY_NBUCKETS];	/* Run slice lengths */
+};
+
+/* This is the time of a scheduling event as cycle and tick counts */
+
+struct sched_latstamp_s {
+	uint32_t cycles;			/* up_perf_gettime(), if available     */
+	uint32_t ticks;				/* clock_systimer()                    */
+};
+#endif
+
 /* struct tcb_s ******************************************************************/
 
 FAR struct wdog_s;				/* Forward reference                   */
@@ -573,6 +602,16 @@ struct tcb_s {
 	int peak_alloc_size;
 	int num_alloc_free;
 #endif
+
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+	struct mm_magazine_s magazine;	/* Free slab objects cached by the thread */
+#endif
+
+#ifdef CONFIG_SCHED_LATENCY
+	struct sched_latstamp_s latstamp;	/* Time of the last state change  */
+	uint8_t latstate;			/* State seen by latency statistics    */
+	struct sched_latency_s latency;	/* Scheduling latency statistics       */
+#endif
 };
 
 /* struct task_tcb_s *************************************************************/
@@ -744,6 +783,33 @@ FAR struct streamlist *sched_getstreams(void);
 FAR struct socketlist *sched_getsockets(void);
 #endif							/* CONFIG_NSOCKET_DESCRIPTORS */
 
+/********************************************************************************
+ * Name: sched_latency
+ *
+ * Description:
+ *   Return the scheduling latency statistics of a thread.
+ *
+ * Inputs:
+ *   pid - The task ID of the thread of interest, or -1 for the totals of all
+ *         threads since boot.
+ *   latency - The location to return the statistics
+ *
+ * Return:
+ *   OK (0) on success; -ESRCH if 'pid' does not refer to a valid thread.
+ *
+ ********************************************************************************/
+
+#ifdef CONFIG_SCHED_LATENCY
+/**
+ * @cond
+ * @internal
+ */
+int sched_latency(pid_t pid, FAR struct sched_latency_s *latency);
+/**
+ * @endcond
+ */
+#endif
+
 /********************************************************************************
  * Name: task_starthook
  *
@@ -54,12 +54,15 @@
 #define TTRACE_BUFFER              'b'
 #define TTRACE_DUMP                'd'
 #define TTRACE_PRINT               'p'
+#define TTRACE_SAVE                'o'
 
 #define TTRACE_CODE_VARIABLE        0
 #define TTRACE_CODE_UNIQUE         (1 << 7)
 
 #define TTRACE_EVENT_TYPE_BEGIN    'b'
 #define TTRACE_EVENT_TYPE_END      'e'
+#define TTRACE_EVENT_TYPE_SCHED    's'
+#define TTRACE_EVENT_TYPE_LOST     'l'
 
 #define TTRACE_MSG_BYTES            32
 #define TTRACE_COMM_BYTES           12
@@ -121,6 +124,39 @@ struct trace_packet {        // total 44 byte(message), 12byte(uid)
 	union trace_message msg;   // 32B
 };
 
+#ifdef CONFIG_TTRACE_RING
+/* With CONFIG_TTRACE_RING, trace points store records in a ring in the
+ * driver instead of writing packets to it.  Reading the driver returns a
+ * ttrace_ringhdr_s followed by the records in the order they were stored.
+ * A record of type TTRACE_EVENT_TYPE_LOST counts, in msg.message, the
+ * records that were overwritten before they were read.
+ */
+
+#define TTRACE_RING_MAGIC          0x42525454	/* "TTRB" */
+#define TTRACE_RING_VERSION        1
+
+struct ttrace_ringhdr_s {    // total 16B
+	uint32_t magic;            // 4B, TTRACE_RING_MAGIC
+	uint16_t version;          // 2B, TTRACE_RING_VERSION
+	uint16_t recsize;          // 2B, sizeof(struct ttrace_record_s)
+	uint32_t freq;             // 4B, cycles per second, 0 without cycle counter
+	uint32_t usec_per_tick;    // 4B, length of a system tick
+};
+
+struct ttrace_record_s {     // total 48B
+	uint32_t seq;              // 4B, index in the ring + 1, written last
+	uint32_t cycles;           // 4B, cycle counter
+	uint32_t ticks;            // 4B, system timer
+	pid_t pid;                 // 2B, int16_t(16b)
+	char event_type;           // 1B, char(8b)
+	int8_t codelen;            // 1B, same as trace_packet
+	union trace_message msg;   // 32B
+};
+
+int ttrace_ring_enabled(int tag);
+void ttrace_ring_put(FAR const struct ttrace_record_s *rec);
+#endif
+
 static int show_packet(struct trace_packet *packet)
 {
 	int uid = (packet->codelen & TTRACE_CODE_UNIQUE) >> 7;
@@ -273,4 +273,23 @@ void weak_function sched_process_cpuload(void);
 bool sched_verifytcb(FAR struct tcb_s *tcb);
 int sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype);
 
+#ifdef CONFIG_SCHED_RTRINDEX
+FAR struct tcb_s *sched_rtrindex_prev(uint8_t sched_priority);
+void sched_rtrindex_add(FAR struct tcb_s *tcb);
+void sched_rtrindex_remove(FAR struct tcb_s *tcb);
+#else
+#define sched_rtrindex_add(tcb)
+#define sched_rtrindex_remove(tcb)
+#endif
+
+#ifdef CONFIG_SCHED_LATENCY
+void sched_latency_switch(FAR struct tcb_s *from, FAR struct tcb_s *to);
+void sched_latency_block(FAR struct tcb_s *tcb, tstate_t task_state);
+void sched_latency_unblock(FAR struct tcb_s *tcb);
+#else
+#define sched_latency_switch(from, to)
+#define sched_latency_block(tcb, task_state)
+#define sched_latency_unblock(tcb)
+#endif
+
 #endif							/* __SCHED_SCHED_SCHED_H */
@@ -129,4 +129,5 @@ void sched_addblocked(FAR struct tcb_s *btcb, tstate_t task_state)
 	/* Make sure the TCB's state corresponds to the list */
 
 	btcb->task_state = task_state;
+	sched_latency_block(btcb, task_state);
 }
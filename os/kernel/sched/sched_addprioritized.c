@@ -123,6 +123,23 @@ bool sched_addprioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
 
 	ASSERT(sched_priority >= SCHED_PRIORITY_MIN);
 
+#ifdef CONFIG_SCHED_RTRINDEX
+	/* The ready-to-run list has an index of where each priority ends */
+
+	if (list == (FAR dq_queue_t *)&g_readytorun) {
+		prev = sched_rtrindex_prev(sched_priority);
+		if (prev) {
+			dq_addafter((FAR dq_entry_t *)prev, (FAR dq_entry_t *)tcb, list);
+		} else {
+			dq_addfirst((FAR dq_entry_t *)tcb, list);
+			ret = true;
+		}
+
+		sched_rtrindex_add(tcb);
+		return ret;
+	}
+#endif
+
 	/* Search the list to find the location to insert the new Tcb.
 	 * Each is list is maintained in ascending sched_priority order.
 	 */
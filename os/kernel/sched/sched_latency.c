@@ -0,0 +1,351 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/************************************************************************
+ * kernel/sched/sched_latency.c
+ *
+ * Scheduling latency statistics.  Every thread remembers the time of its
+ * last state change: switched in, switched out, blocked or unblocked.
+ * The next state change turns the time since then into a run slice, a
+ * wake-to-run latency or time blocked, and counts it in fixed size log2
+ * histograms of the thread and of the whole system.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Included Files
+ ************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <tinyara/arch.h>
+#include <tinyara/clock.h>
+#include <arch/irq.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_LATENCY
+
+/************************************************************************
+ * Pre-processor Definitions
+ ************************************************************************/
+
+/* Values of the latstate field of the TCB */
+
+#define LATSTATE_NONE     0		/* Not seen or not activated yet */
+#define LATSTATE_RUNNING  1		/* Switched in */
+#define LATSTATE_READY    2		/* Switched out while ready to run */
+#define LATSTATE_WOKEN    3		/* Unblocked, not switched in yet */
+#define LATSTATE_SEM      4		/* Blocked on a semaphore */
+#define LATSTATE_MQ       5		/* Blocked on a message queue */
+#define LATSTATE_BLOCKED  6		/* Blocked otherwise */
+
+/************************************************************************
+ * Private Variables
+ ************************************************************************/
+
+/* The statistics of all threads since boot */
+
+static struct sched_latency_s g_latency;
+
+#ifdef CONFIG_ARCH_HAVE_PERF_EVENTS
+/* The cycle counter wraps every few seconds.  Differences of cycle counts
+ * are used for times shorter than g_cycleticks and tick counts otherwise.
+ */
+
+static uint32_t g_cyclesperusec;
+static uint32_t g_cycleticks;
+#endif
+
+/************************************************************************
+ * Private Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name: sched_latency_now
+ ************************************************************************/
+
+static inline void sched_latency_now(FAR struct sched_latstamp_s *now)
+{
+#ifdef CONFIG_ARCH_HAVE_PERF_EVENTS
+	now->cycles = up_perf_gettime();
+#else
+	now->cycles = 0;
+#endif
+	now->ticks = (uint32_t)clock_systimer();
+}
+
+/************************************************************************
+ * Name: sched_latency_elapsed
+ *
+ * Description:
+ *   Return the microseconds between two events.
+ *
+ ************************************************************************/
+
+static uint32_t sched_latency_elapsed(FAR const struct sched_latstamp_s *then, FAR const struct sched_latstamp_s *now)
+{
+	uint32_t ticks = now->ticks - then->ticks;
+
+#ifdef CONFIG_ARCH_HAVE_PERF_EVENTS
+	if (g_cyclesperusec == 0) {
+		/* The cycle counter is not calibrated before up_initialize() */
+
+		g_cyclesperusec = up_perf_getfreq() / USEC_PER_SEC;
+		if (g_cyclesperusec > 0) {
+			g_cycleticks = UINT32_MAX / g_cyclesperusec / 2 / USEC_PER_TICK;
+		}
+	}
+
+	if (ticks < g_cycleticks) {
+		return (now->cycles - then->cycles) / g_cyclesperusec;
+	}
+#endif
+
+	if (ticks >= UINT32_MAX / USEC_PER_TICK) {
+		return UINT32_MAX;
+	}
+
+	return ticks * USEC_PER_TICK;
+}
+
+/************************************************************************
+ * Name: sched_latency_count
+ *
+ * Description:
+ *   Count a time in a histogram, see struct sched_latency_s.
+ *
+ ************************************************************************/
+
+static inline void sched_latency_count(FAR uint32_t *hist, uint32_t usec)
+{
+	int bucket = 0;
+
+	if (usec > 1) {
+		bucket = 31 - __builtin_clz(usec);
+		if (bucket >= CONFIG_SCHED_LATENCY_NBUCKETS) {
+			bucket = CONFIG_SCHED_LATENCY_NBUCKETS - 1;
+		}
+	}
+
+	hist[bucket]++;
+}
+
+/************************************************************************
+ * Public Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name: sched_latency_switch
+ *
+ * Description:
+ *   Account a context switch.  This is called wherever
+ *   sched_note_switch() is.
+ *
+ * Inputs:
+ *   from - The TCB of the thread switched out
+ *   to - The TCB of the thread switched in
+ *
+ * Assumptions:
+ *   Called in a critical section.
+ *
+ ************************************************************************/
+
+void sched_latency_switch(FAR struct tcb_s *from, FAR struct tcb_s *to)
+{
+	struct sched_latstamp_s now;
+	uint32_t usec;
+
+	if (from == to) {
+		return;
+	}
+
+	sched_latency_now(&now);
+
+	/* The thread switched out may still be ready to run.  If it blocks,
+	 * sched_latency_block() follows.
+	 */
+
+	if (from->latstate == LATSTATE_RUNNING) {
+		usec = sched_latency_elapsed(&from->latstamp, &now);
+		sched_latency_count(from->latency.slice, usec);
+		sched_latency_count(g_latency.slice, usec);
+	}
+
+	from->latstamp = now;
+	from->latstate = LATSTATE_READY;
+
+	if (to->latstate == LATSTATE_WOKEN) {
+		usec = sched_latency_elapsed(&to->latstamp, &now);
+		sched_latency_count(to->latency.wake, usec);
+		sched_latency_count(g_latency.wake, usec);
+
+		if (usec > to->latency.maxwake) {
+			to->latency.maxwake = usec;
+		}
+
+		if (usec > g_latency.maxwake) {
+			g_latency.maxwake = usec;
+		}
+	} else if (to->latstate == LATSTATE_READY) {
+		to->latency.preemptions++;
+		g_latency.preemptions++;
+	}
+
+	to->latstamp = now;
+	to->latstate = LATSTATE_RUNNING;
+	to->latency.switches++;
+	g_latency.switches++;
+}
+
+/************************************************************************
+ * Name: sched_latency_block
+ *
+ * Description:
+ *   Note that a thread was added to a blocked task list.
+ *
+ * Inputs:
+ *   tcb - The TCB of the blocked thread
+ *   task_state - The blocked state
+ *
+ * Assumptions:
+ *   Called in a critical section.
+ *
+ ************************************************************************/
+
+void sched_latency_block(FAR struct tcb_s *tcb, tstate_t task_state)
+{
+	sched_latency_now(&tcb->latstamp);
+
+	switch (task_state) {
+	case TSTATE_TASK_INACTIVE:
+		tcb->latstate = LATSTATE_NONE;
+		break;
+
+	case TSTATE_WAIT_SEM:
+		tcb->latstate = LATSTATE_SEM;
+		break;
+
+#ifndef CONFIG_DISABLE_MQUEUE
+	case TSTATE_WAIT_MQNOTEMPTY:
+	case TSTATE_WAIT_MQNOTFULL:
+		tcb->latstate = LATSTATE_MQ;
+		break;
+#endif
+
+	default:
+		tcb->latstate = LATSTATE_BLOCKED;
+		break;
+	}
+}
+
+/************************************************************************
+ * Name: sched_latency_unblock
+ *
+ * Description:
+ *   Account the time a thread was blocked when it is removed from a
+ *   blocked task list.  Its wake-to-run latency starts now.
+ *
+ * Inputs:
+ *   tcb - The TCB of the unblocked thread
+ *
+ * Assumptions:
+ *   Called in a critical section.
+ *
+ ************************************************************************/
+
+void sched_latency_unblock(FAR struct tcb_s *tcb)
+{
+	struct sched_latstamp_s now;
+	uint32_t usec;
+
+	sched_latency_now(&now);
+	usec = sched_latency_elapsed(&tcb->latstamp, &now);
+
+	switch (tcb->latstate) {
+	case LATSTATE_SEM:
+		tcb->latency.semwait += usec;
+		g_latency.semwait += usec;
+		break;
+
+	case LATSTATE_MQ:
+		tcb->latency.mqwait += usec;
+		g_latency.mqwait += usec;
+		break;
+
+	case LATSTATE_BLOCKED:
+		tcb->latency.otherwait += usec;
+		g_latency.otherwait += usec;
+		break;
+
+	default:
+		break;
+	}
+
+	tcb->latstamp = now;
+	tcb->latstate = LATSTATE_WOKEN;
+}
+
+/************************************************************************
+ * Name: sched_latency
+ *
+ * Description:
+ *   Return the scheduling latency statistics of a thread.
+ *
+ * Inputs:
+ *   pid - The task ID of the thread of interest, or -1 for the totals of
+ *         all threads since boot.
+ *   latency - The location to return the statistics
+ *
+ * Return Value:
+ *   OK (0) on success; -ESRCH if 'pid' does not refer to a valid thread.
+ *
+ ************************************************************************/
+
+int sched_latency(pid_t pid, FAR struct sched_latency_s *latency)
+{
+	FAR struct tcb_s *tcb;
+	irqstate_t flags;
+	int ret = OK;
+
+	DEBUGASSERT(latency);
+
+	/* Keep the thread valid and the counts consistent while copying */
+
+	flags = irqsave();
+
+	if (pid < 0) {
+		memcpy(latency, &g_latency, sizeof(struct sched_latency_s));
+	} else {
+		tcb = sched_gettcb(pid);
+		if (tcb) {
+			memcpy(latency, &tcb->latency, sizeof(struct sched_latency_s));
+		} else {
+			ret = -ESRCH;
+		}
+	}
+
+	irqrestore(flags);
+	return ret;
+}
+
+#endif							/* CONFIG_SCHED_LATENCY */
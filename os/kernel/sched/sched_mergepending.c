@@ -133,7 +133,12 @@ bool sched_mergepending(void)
 		 * order.
 		 */
 
+#ifdef CONFIG_SCHED_RTRINDEX
+		rtrprev = sched_rtrindex_prev(pndtcb->sched_priority);
+		rtrtcb = rtrprev ? rtrprev->flink : (FAR struct tcb_s *)g_readytorun.head;
+#else
 		for (; (rtrtcb && pndtcb->sched_priority <= rtrtcb->sched_priority); rtrtcb = rtrtcb->flink) ;
+#endif
 
 		/* Add the pndtcb to the spot found in the list.  Check if the
 		 * pndtcb goes at the ends of the g_readytorun list. This would be
@@ -151,6 +156,7 @@ bool sched_mergepending(void)
 			/* Inform the instrumentation layer that we are switching tasks */
 
 			sched_note_switch(rtrtcb, pndtcb);
+			sched_latency_switch(rtrtcb, pndtcb);
 
 			/* Then insert at the head of the list */
 
@@ -174,6 +180,8 @@ bool sched_mergepending(void)
 			pndtcb->task_state = TSTATE_TASK_READYTORUN;
 		}
 
+		sched_rtrindex_add(pndtcb);
+
 		/* Set up for the next time through */
 
 		rtrtcb = pndtcb;
@@ -163,6 +163,15 @@ int sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype)
 			sched_releasepid(tcb->pid);
 		}
 
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+		/* Return the slab objects cached by the thread.  Interrupts are
+		 * disabled here, so sched_ufree() frees them only if the heap is
+		 * free and defers them otherwise.
+		 */
+
+		mm_magazine_flush(&tcb->magazine, sched_ufree);
+#endif
+
 		/* Delete the thread's stack if one has been allocated */
 
 		if (tcb->stack_alloc_ptr) {
@@ -123,4 +123,5 @@ void sched_removeblocked(FAR struct tcb_s *btcb)
 	 */
 
 	btcb->task_state = TSTATE_TASK_INVALID;
+	sched_latency_unblock(btcb);
 }
@@ -0,0 +1,164 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/************************************************************************
+ * kernel/sched/sched_rtrindex.c
+ *
+ * Priority index of the g_readytorun list.  The list itself is unchanged:
+ * it is still ordered by priority, FIFO within a priority, and its head is
+ * the running task.  The TCBs of one priority form a run of the list, and
+ * the index remembers the last TCB of every run plus a bitmap of the
+ * priorities that have one.  A new TCB then goes right after the last TCB
+ * of the lowest priority at or above its own, which is found with a few
+ * bitmap word tests instead of a walk of the list.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Included Files
+ ************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <assert.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_RTRINDEX
+
+/************************************************************************
+ * Pre-processor Definitions
+ ************************************************************************/
+
+#define RTRINDEX_NWORDS ((SCHED_PRIORITY_MAX + 32) / 32)
+
+/************************************************************************
+ * Private Variables
+ ************************************************************************/
+
+/* Bit n is set if there is a ready-to-run TCB of priority n */
+
+static uint32_t g_rtrbitmap[RTRINDEX_NWORDS];
+
+/* The last ready-to-run TCB of each priority */
+
+static FAR struct tcb_s *g_rtrlast[SCHED_PRIORITY_MAX + 1];
+
+/************************************************************************
+ * Public Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name: sched_rtrindex_prev
+ *
+ * Description:
+ *   Find where a TCB of a priority goes in the g_readytorun list.
+ *
+ * Inputs:
+ *   sched_priority - The priority of the TCB
+ *
+ * Return Value:
+ *   The TCB after which the new TCB goes, or NULL if it goes at the
+ *   head of the list.
+ *
+ * Assumptions:
+ *   Called in a critical section.
+ *
+ ************************************************************************/
+
+FAR struct tcb_s *sched_rtrindex_prev(uint8_t sched_priority)
+{
+	int index = sched_priority >> 5;
+	uint32_t bits;
+
+	/* Ignore the priorities below sched_priority in its word */
+
+	bits = g_rtrbitmap[index] & (UINT32_MAX << (sched_priority & 31));
+
+	while (bits == 0) {
+		if (++index >= RTRINDEX_NWORDS) {
+			return NULL;
+		}
+
+		bits = g_rtrbitmap[index];
+	}
+
+	/* The lowest set bit is the lowest priority at or above sched_priority.
+	 * On ARMv7 __builtin_ctz() is an RBIT and a CLZ instruction.
+	 */
+
+	return g_rtrlast[(index << 5) + __builtin_ctz(bits)];
+}
+
+/************************************************************************
+ * Name: sched_rtrindex_add
+ *
+ * Description:
+ *   Index a TCB that was just added to the g_readytorun list.  The TCB
+ *   must be the last one of its priority in the list.
+ *
+ * Inputs:
+ *   tcb - The TCB added
+ *
+ * Assumptions:
+ *   Called in a critical section.
+ *
+ ************************************************************************/
+
+void sched_rtrindex_add(FAR struct tcb_s *tcb)
+{
+	uint8_t sched_priority = tcb->sched_priority;
+
+	DEBUGASSERT(tcb->flink == NULL || tcb->flink->sched_priority < sched_priority);
+
+	g_rtrlast[sched_priority] = tcb;
+	g_rtrbitmap[sched_priority >> 5] |= (uint32_t)1 << (sched_priority & 31);
+}
+
+/************************************************************************
+ * Name: sched_rtrindex_remove
+ *
+ * Description:
+ *   Drop a TCB from the index before it is removed from the g_readytorun
+ *   list or before its priority is changed in place.
+ *
+ * Inputs:
+ *   tcb - The TCB to be removed
+ *
+ * Assumptions:
+ *   Called in a critical section.
+ *
+ ************************************************************************/
+
+void sched_rtrindex_remove(FAR struct tcb_s *tcb)
+{
+	uint8_t sched_priority = tcb->sched_priority;
+	FAR struct tcb_s *prev;
+
+	if (g_rtrlast[sched_priority] == tcb) {
+		prev = tcb->blink;
+		if (prev && prev->sched_priority == sched_priority) {
+			g_rtrlast[sched_priority] = prev;
+		} else {
+			g_rtrlast[sched_priority] = NULL;
+			g_rtrbitmap[sched_priority >> 5] &= ~((uint32_t)1 << (sched_priority & 31));
+		}
+	}
+}
+
+#endif							/* CONFIG_SCHED_RTRINDEX */
@@ -163,10 +163,14 @@ int sched_setpriority(FAR struct tcb_s *tcb, int sched_priority)
 		/* Otherwise, we can just change priority since it has no effect */
 
 		else {
-			/* Change the task priority */
+			/* Change the task priority.  It stays at the head of the
+			 * ready-to-run list.
+			 */
 
 			OS_TRACE_TASK_PRIORITY(tcb, tcb->sched_priority, sched_priority);
+			sched_rtrindex_remove(tcb);
 			tcb->sched_priority = (uint8_t)sched_priority;
+			sched_rtrindex_add(tcb);
 		}
 		break;
 
@@ -127,10 +127,12 @@ int sched_yield(void)
 
 		/* A context switch will occur. */
 		sched_note_switch(rtcb, ntcb);
+		sched_latency_switch(rtcb, ntcb);
 		ntcb->task_state = TSTATE_TASK_RUNNING;
 		switch_needed = true;
 
 		/* Remove the TCB from the ready-to-run list */
+		sched_rtrindex_remove(rtcb);
 		dq_rem((FAR dq_entry_t *)rtcb, (FAR dq_queue_t *)&g_readytorun);
 
 		/* Since the current TCB is not in any list, it is now invalid */
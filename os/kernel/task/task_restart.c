@@ -180,6 +180,10 @@ int task_restart(pid_t pid)
 		 */
 
 		state = irqsave();
+		if (tcb->cmn.task_state == TSTATE_TASK_READYTORUN) {
+			sched_rtrindex_remove(&tcb->cmn);
+		}
+
 		dq_rem((FAR dq_entry_t *)tcb, (dq_queue_t *)g_tasklisttable[tcb->cmn.task_state].list);
 		tcb->cmn.task_state = TSTATE_TASK_INVALID;
 		irqrestore(state);
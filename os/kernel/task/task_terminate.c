@@ -185,6 +185,10 @@ int task_terminate(pid_t pid, bool nonblocking)
 	/* Remove the task from the OS's tasks lists. */
 
 	saved_state = irqsave();
+	if (dtcb->task_state == TSTATE_TASK_READYTORUN) {
+		sched_rtrindex_remove(dtcb);
+	}
+
 	dq_rem((FAR dq_entry_t *)dtcb, (dq_queue_t *)g_tasklisttable[dtcb->task_state].list);
 	dtcb->task_state = TSTATE_TASK_INVALID;
 	irqrestore(saved_state);
@@ -50,6 +50,16 @@
 
 #include "nxcontext.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Access to the CLOCK reference bit of the glyph of a character code */
+
+#define nxf_referenced(p,c)   ((p)->refbits[(c) >> 3] & (1 << ((c) & 7)))
+#define nxf_reference(p,c)    ((p)->refbits[(c) >> 3] |= (1 << ((c) & 7)))
+#define nxf_unreference(p,c)  ((p)->refbits[(c) >> 3] &= ~(1 << ((c) & 7)))
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -70,8 +80,8 @@ struct nxfonts_fcache_s
   sem_t fsem;                          /* Serializes access to the font cache */
   uint16_t fontid;                     /* ID of font in this cache */
   int16_t fclients;                    /* Number of connected clients */
-  uint8_t maxglyphs;                   /* Maximum size of glyph[] array */
-  uint8_t nglyphs;                     /* Current size of glyph[] array */
+  uint8_t maxglyphs;                   /* Maximum number of cached glyphs */
+  uint8_t nglyphs;                     /* Current number of cached glyphs */
   uint8_t bpp;                         /* Bits per pixel */
   nxgl_mxpixel_t fgcolor;              /* Foreground color */
   nxgl_mxpixel_t bgcolor;              /* Background color */
@@ -79,8 +89,9 @@ struct nxfonts_fcache_s
 
   /* Glyph cache data storage */
 
-  FAR struct nxfonts_glyph_s *head;    /* Head of the list of glyphs */
-  FAR struct nxfonts_glyph_s *tail;    /* Tail of the list of glyphs */
+  uint8_t hand;                        /* CLOCK hand, an index into index[] */
+  uint8_t refbits[32];                 /* CLOCK reference bits by character code */
+  FAR struct nxfonts_glyph_s *index[256]; /* Cached glyphs by character code */
 };
 
 /****************************************************************************
@@ -178,67 +189,57 @@ static void nxf_cache_lock(FAR struct nxfonts_fcache_s *priv)
 #define nxf_cache_unlock(p) (_SEM_POST(&priv->fsem))
 
 /****************************************************************************
- * Name: nxf_removeglyph
+ * Name: nxf_evictglyph
  *
  * Description:
- *   Removes the entry 'glyph' from the font cache.
+ *   Free one glyph to make room for a new one.  The glyph is chosen with the
+ *   CLOCK algorithm:  the hand sweeps around the index, giving a second
+ *   chance to each glyph that was used since the hand last passed it, and
+ *   frees the first glyph that was not.
+ *
+ * Assumptions:
+ *   The caller has exclusive access to the font cache and the cache holds
+ *   at least one glyph.
  *
  ****************************************************************************/
 
-static inline void nxf_removeglyph(FAR struct nxfonts_fcache_s *priv,
-                                   FAR struct nxfonts_glyph_s *glyph,
-                                   FAR struct nxfonts_glyph_s *prev)
+static void nxf_evictglyph(FAR struct nxfonts_fcache_s *priv)
 {
-  ginfo("fcache=%p glyph=%p\n", priv, glyph);
-
-  /* Remove the glyph for the list.  First check for removal from the head
-   * (which, I think, never actually happens).
-   */
-
-  if (prev == NULL)
-    {
-      /* Replace the head with the node following glyph */
-
-      priv->head = glyph->flink;
-
-      /* If there is no node following glyph, then the list is empty */
+  FAR struct nxfonts_glyph_s *glyph;
 
-      if (priv->head == NULL)
-        {
-          priv->tail = NULL;
-        }
-    }
+  DEBUGASSERT(priv->nglyphs > 0);
 
-  /* Check for removal from the tail (we know that the list cannot become
-   * empty in either of the next two cases).
+  /* At most two turns are needed:  the first one clears every reference
+   * bit, so the second one must find a victim.
    */
 
-  else if (glyph->flink == NULL)
+  for (; ; )
     {
-      priv->tail = prev;
-      prev->flink = NULL;
-    }
-
-  /* No.. Remove from mid-list */
+      glyph = priv->index[priv->hand++];
+      if (glyph != NULL)
+        {
+          if (nxf_referenced(priv, glyph->code))
+            {
+              nxf_unreference(priv, glyph->code);
+            }
+          else
+            {
+              ginfo("fcache=%p glyph=%p\n", priv, glyph);
 
-  else
-    {
-      prev->flink = glyph->flink;
+              priv->index[glyph->code] = NULL;
+              priv->nglyphs--;
+              lib_free(glyph);
+              return;
+            }
+        }
     }
-
-  glyph->flink = NULL;
-
-  /* Decrement the count of glyphs in the font cache */
-
-  DEBUGASSERT(priv->nglyphs > 0);
-  priv->nglyphs--;
 }
 
 /****************************************************************************
  * Name: nxf_addglyph
  *
  * Description:
- *   Add the entry 'glyph' to the head font cache list.
+ *   Add the entry 'glyph' to the font cache index.
  *
  ****************************************************************************/
 
@@ -247,20 +248,11 @@ static inline void nxf_addglyph(FAR struct nxfonts_fcache_s *priv,
 {
   ginfo("fcache=%p glyph=%p\n", priv, glyph);
 
-  /* Add the glyph to the head of the list */
-
-  glyph->flink = priv->head;
-
-  if (priv->head == NULL)
-    {
-      priv->tail = glyph;
-    }
-
-  priv->head = glyph;
-
-  /* Increment the count of glyphs in the font cache. */
-
+  DEBUGASSERT(priv->index[glyph->code] == NULL);
   DEBUGASSERT(priv->nglyphs < priv->maxglyphs);
+
+  nxf_reference(priv, glyph->code);
+  priv->index[glyph->code] = glyph;
   priv->nglyphs++;
 }
 
@@ -268,18 +260,17 @@ static inline void nxf_addglyph(FAR struct nxfonts_fcache_s *priv,
  * Name: nxf_findglyph
  *
  * Description:
- *   Find the glyph for the specific character 'ch' in the list of pre-
- *   rendered fonts in the font cache.
+ *   Find the glyph for the specific character 'ch' in the font cache.
  *
  *   This is logically a part of nxf_cache_getglyph().  nxf_cache_getglyph()
  *   will attempt to find the cached glyph before rendering a new one.  So
  *   this function has two unexpected side-effects:  (1) If the font cache
- *   is full and the font is not found, then the least-recently-used glyph
- *   is deleted to make space for the new glyph that will be allocated.
+ *   is full and the font is not found, then a glyph that has not been used
+ *   recently is deleted to make space for the new glyph that will be
+ *   allocated.
  *
- *   (2) If the glyph is found, then it is moved to the head of the list of
- *   glyphs since it is now the most recently used (leaving the least
- *   recently used glyph at the tail of the list).
+ *   (2) If the glyph is found, then it is marked as referenced so that the
+ *   next eviction sweep will pass over it.
  *
  * Assumptions:
  *   The caller has exclusive access to the font cache.
@@ -290,50 +281,26 @@ static FAR struct nxfonts_glyph_s *
 nxf_findglyph(FAR struct nxfonts_fcache_s *priv, uint8_t ch)
 {
   FAR struct nxfonts_glyph_s *glyph;
-  FAR struct nxfonts_glyph_s *prev;
 
   ginfo("fcache=%p ch=%c (%02x)\n",
         priv, (ch >= 32 && ch < 128) ? ch : '.', ch);
 
-  /* Try to find the glyph in the list of pre-rendered glyphs */
+  /* The glyphs are indexed by character code */
 
-   for (prev = NULL, glyph = priv->head;
-        glyph != NULL;
-        prev = glyph, glyph = glyph->flink)
+  glyph = priv->index[ch];
+  if (glyph != NULL)
     {
-      /* Check if we found the glyph for this character */
-
-      if (glyph->code == ch)
-        {
-          /* This is now the most recently used glyph.  Move it to the head
-           * of the list (if it is not already at the head of the list).
-           */
-
-          if (prev != NULL)
-            {
-              nxf_removeglyph(priv, glyph, prev);
-              nxf_addglyph(priv, glyph);
-            }
-
-          /* And return the glyph that we found */
-
-          return glyph;
-        }
-
-      /* Is this the last glyph in the list?  Has the cache reached its
-       * limit for the number of cached fonts?
-       */
+      nxf_reference(priv, ch);
+      return glyph;
+    }
 
-      if (glyph->flink == NULL && priv->nglyphs >= priv->maxglyphs)
-        {
-          /* Yes.. then remove it from the list and free the glyph memory.
-           * We do this because we have all of the information in hand now
-           * and we will surely need to have this space later.
-           */
+  /* Not cached.  Has the cache reached its limit for the number of cached
+   * glyphs?  If so, free one now since we will surely need the space.
+   */
 
-          nxf_removeglyph(priv, glyph, prev);
-          return NULL;
-        }
+  if (priv->nglyphs > 0 && priv->nglyphs >= priv->maxglyphs)
+    {
+      nxf_evictglyph(priv);
     }
 
   return NULL;
@@ -547,6 +514,7 @@ nxf_renderglyph(FAR struct nxfonts_fcache_s *priv,
     {
       /* Save the character code, dimensions, and physcial width of the glyph */
 
+      glyph->flink  = NULL;
       glyph->code   = ch;
       glyph->width  = width;
       glyph->height = height;
@@ -808,8 +776,7 @@ void nxf_cache_disconnect(FCACHE fhandle)
   FAR struct nxfonts_fcache_s *priv = (FAR struct nxfonts_fcache_s *)fhandle;
   FAR struct nxfonts_fcache_s *fcache;
   FAR struct nxfonts_fcache_s *prev;
-  FAR struct nxfonts_glyph_s *glyph;
-  FAR struct nxfonts_glyph_s *next;
+  int i;
 
   ginfo("fhandle=%p\n", fhandle);
 
@@ -841,10 +808,12 @@ void nxf_cache_disconnect(FCACHE fhandle)
 
       /* Free all allocated glyph memory */
 
-      for (glyph = priv->head; glyph != NULL; glyph = next)
+      for (i = 0; i < 256; i++)
         {
-          next = glyph->flink;
-          lib_free(glyph);
+          if (priv->index[i] != NULL)
+            {
+              lib_free(priv->index[i]);
+            }
         }
 
       /* Destroy the serializing semaphore... while we are holding it? */
@@ -0,0 +1,148 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * libnx/nxglib/nxglib_rectmerge.c
+ *
+ * The rule that decides when two damaged rectangles are sent as their
+ * bounding box, shared by the NX shadow framebuffer and the VNC updater.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <tinyara/nx/nxglib.h>
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxgl_rectarea
+ ****************************************************************************/
+
+static int32_t nxgl_rectarea(FAR const struct nxgl_rect_s *rect)
+{
+  return (int32_t)(rect->pt2.x - rect->pt1.x + 1) *
+         (int32_t)(rect->pt2.y - rect->pt1.y + 1);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxgl_rectwaste
+ *
+ * Description:
+ *   Return the bounding box of two rectangles in dest, and the number of
+ *   pixels in it that neither of the two covers.
+ *
+ ****************************************************************************/
+
+int32_t nxgl_rectwaste(FAR struct nxgl_rect_s *dest,
+                       FAR const struct nxgl_rect_s *rect1,
+                       FAR const struct nxgl_rect_s *rect2)
+{
+  struct nxgl_rect_s overlap;
+  int32_t waste;
+
+  nxgl_rectintersect(&overlap, rect1, rect2);
+
+  waste = -nxgl_rectarea(rect1) - nxgl_rectarea(rect2);
+  if (!nxgl_nullrect(&overlap))
+    {
+      waste += nxgl_rectarea(&overlap);
+    }
+
+  nxgl_rectunion(dest, rect1, rect2);
+  return waste + nxgl_rectarea(dest);
+}
+
+/****************************************************************************
+ * Name: nxgl_rectmerge
+ *
+ * Description:
+ *   Return true and the bounding box of two rectangles in dest if they
+ *   overlap or touch, and the box adds no more uncovered pixels than the
+ *   smaller of the two covers.  dest may be one of the two rectangles.
+ *
+ ****************************************************************************/
+
+bool nxgl_rectmerge(FAR struct nxgl_rect_s *dest,
+                    FAR const struct nxgl_rect_s *rect1,
+                    FAR const struct nxgl_rect_s *rect2)
+{
+  struct nxgl_rect_s merged;
+  int32_t limit;
+
+  if (rect1->pt1.x > rect2->pt2.x + 1 || rect2->pt1.x > rect1->pt2.x + 1 ||
+      rect1->pt1.y > rect2->pt2.y + 1 || rect2->pt1.y > rect1->pt2.y + 1)
+    {
+      return false;
+    }
+
+  limit = ngl_min(nxgl_rectarea(rect1), nxgl_rectarea(rect2));
+  if (nxgl_rectwaste(&merged, rect1, rect2) > limit)
+    {
+      return false;
+    }
+
+  nxgl_rectcopy(dest, &merged);
+  return true;
+}
+
+/****************************************************************************
+ * Name: nxgl_rectcheapest
+ *
+ * Description:
+ *   Return the index of the rectangle in list whose bounding box with rect
+ *   has the fewest uncovered pixels.  nrects must not be zero.
+ *
+ ****************************************************************************/
+
+int nxgl_rectcheapest(FAR const struct nxgl_rect_s *rect,
+                      FAR const struct nxgl_rect_s *list, int nrects)
+{
+  struct nxgl_rect_s merged;
+  int32_t bestwaste;
+  int32_t waste;
+  int best;
+  int i;
+
+  best      = 0;
+  bestwaste = INT32_MAX;
+
+  for (i = 0; i < nrects; i++)
+    {
+      waste = nxgl_rectwaste(&merged, rect, &list[i]);
+      if (waste < bestwaste)
+        {
+          best      = i;
+          bestwaste = waste;
+        }
+    }
+
+  return best;
+}
@@ -82,7 +82,9 @@ int nx_bitmap(NXWINDOW hwnd, FAR const struct nxgl_rect_s *dest,
   struct nxsvrmsg_bitmap_s outmsg;
   int i;
   int ret;
+#ifndef CONFIG_NX_CMDRING
   sem_t sem_done;
+#endif
 
 #ifdef CONFIG_DEBUG_FEATURES
   if (!wnd || !dest || !src || !origin)
@@ -107,7 +109,22 @@ int nx_bitmap(NXWINDOW hwnd, FAR const struct nxgl_rect_s *dest,
   outmsg.origin.y   = origin->y;
   nxgl_rectcopy(&outmsg.dest, dest);
 
+#ifdef CONFIG_NX_CMDRING
+  /* Completion is tracked with the fence of the command ring.  Unless the
+   * client is batching commands, wait until the command is completed, so
+   * that caller can release the buffer.
+   */
+
+  outmsg.sem_done = NULL;
 
+  ret = nxmu_sendwindow(wnd, &outmsg, sizeof(struct nxsvrmsg_bitmap_s));
+  if (ret == OK && wnd->conn->ring != NULL && !wnd->conn->ring->batch)
+    {
+      ret = nxmu_ringwait(wnd->conn, wnd->conn->ring->head);
+    }
+
+  return ret;
+#else
   /* Create a semaphore for tracking command completion */
 
   outmsg.sem_done = &sem_done;
@@ -141,4 +158,5 @@ int nx_bitmap(NXWINDOW hwnd, FAR const struct nxgl_rect_s *dest,
   (void)_SEM_DESTROY(&sem_done);
 
   return ret;
+#endif
 }
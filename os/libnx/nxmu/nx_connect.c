@@ -125,6 +125,24 @@ NXHANDLE nx_connectinstance(FAR const char *svrmqname)
       goto errout;
     }
 
+#ifdef CONFIG_NX_CMDRING
+  /* Allocate the command ring.  exclsem is a mutex of the client threads.
+   * fencesem is used for signaling and, hence, should not have priority
+   * inheritance enabled.
+   */
+
+  conn->ring = (FAR struct nxmu_ring_s *)lib_uzalloc(sizeof(struct nxmu_ring_s));
+  if (!conn->ring)
+    {
+      set_errno(ENOMEM);
+      goto errout_with_conn;
+    }
+
+  (void)_SEM_INIT(&conn->ring->exclsem, 0, 1);
+  (void)_SEM_INIT(&conn->ring->fencesem, 0, 0);
+  (void)_SEM_SETPROTOCOL(&conn->ring->fencesem, SEM_PRIO_NONE);
+#endif
+
   /* Create the client MQ name */
 
   nxmu_semtake(&g_nxlibsem);
@@ -202,6 +220,14 @@ errout_with_wmq:
 errout_with_rmq:
   mq_close(conn->crdmq);
 errout_with_conn:
+#ifdef CONFIG_NX_CMDRING
+  if (conn->ring)
+    {
+      (void)_SEM_DESTROY(&conn->ring->exclsem);
+      (void)_SEM_DESTROY(&conn->ring->fencesem);
+      lib_ufree(conn->ring);
+    }
+#endif
   lib_ufree(conn);
 errout:
   return NULL;
@@ -47,6 +47,7 @@
 #include <debug.h>
 
 #include <tinyara/mqueue.h>
+#include <tinyara/semaphore.h>
 #include <tinyara/nx/nx.h>
 #include <tinyara/nx/nxbe.h>
 #include <tinyara/nx/nxmu.h>
@@ -82,6 +83,14 @@ static inline void nx_disconnected(FAR struct nxfe_conn_s *conn)
   (void)mq_close(conn->cwrmq);
   (void)mq_close(conn->crdmq);
 
+#ifdef CONFIG_NX_CMDRING
+  /* Free the command ring.  The server drained it before disconnecting */
+
+  (void)_SEM_DESTROY(&conn->ring->exclsem);
+  (void)_SEM_DESTROY(&conn->ring->fencesem);
+  lib_ufree(conn->ring);
+#endif
+
   /* And free the client structure */
 
   lib_ufree(conn);
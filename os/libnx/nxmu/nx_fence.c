@@ -0,0 +1,145 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * libnx/nxmu/nx_fence.c
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/nx/nx.h>
+#include <tinyara/nx/nxmu.h>
+
+#ifdef CONFIG_NX_CMDRING
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nx_batch
+ *
+ * Description:
+ *   Start or stop batching the drawing commands of a connection.  While
+ *   batching, commands are only queued in the command ring of the
+ *   connection and the server is woken when half of the ring is used, when
+ *   a fence is requested or when any other message is sent to the server.
+ *   nx_bitmap() then returns without waiting for the server, so the caller
+ *   must keep the source image until a later fence is reached.
+ *
+ * Input Parameters:
+ *   handle - The handle returned by nx_connect
+ *   enable - True to start batching, false to stop
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nx_batch(NXHANDLE handle, bool enable)
+{
+  FAR struct nxfe_conn_s *conn = (FAR struct nxfe_conn_s *)handle;
+
+#ifdef CONFIG_DEBUG_FEATURES
+  if (!conn || !conn->ring)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+#endif
+
+  conn->ring->batch = enable;
+
+  /* Hand anything already queued to the server */
+
+  return enable ? OK : nxmu_ringkick(conn);
+}
+
+/****************************************************************************
+ * Name: nx_fence
+ *
+ * Description:
+ *   Return a fence for the drawing commands queued so far on a connection
+ *   and ask the server to execute them.  The fence is reached once all of
+ *   those commands have been executed.
+ *
+ * Input Parameters:
+ *   handle - The handle returned by nx_connect
+ *   fence  - Location to return the fence value
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nx_fence(NXHANDLE handle, FAR uint32_t *fence)
+{
+  FAR struct nxfe_conn_s *conn = (FAR struct nxfe_conn_s *)handle;
+
+#ifdef CONFIG_DEBUG_FEATURES
+  if (!conn || !conn->ring || !fence)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+#endif
+
+  *fence = conn->ring->head;
+  return nxmu_ringkick(conn);
+}
+
+/****************************************************************************
+ * Name: nx_fencewait
+ *
+ * Description:
+ *   Wait until a fence returned by nx_fence() is reached.
+ *
+ * Input Parameters:
+ *   handle - The handle returned by nx_connect
+ *   fence  - The fence value to wait for
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nx_fencewait(NXHANDLE handle, uint32_t fence)
+{
+  FAR struct nxfe_conn_s *conn = (FAR struct nxfe_conn_s *)handle;
+
+#ifdef CONFIG_DEBUG_FEATURES
+  if (!conn || !conn->ring)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+#endif
+
+  return nxmu_ringwait(conn, fence);
+}
+
+#endif /* CONFIG_NX_CMDRING */
@@ -80,7 +80,9 @@ int nx_getrectangle(NXWINDOW hwnd, FAR const struct nxgl_rect_s *rect,
   FAR struct nxbe_window_s        *wnd = (FAR struct nxbe_window_s *)hwnd;
   struct nxsvrmsg_getrectangle_s  outmsg;
   int ret;
+#ifndef CONFIG_NX_CMDRING
   sem_t sem_done;
+#endif
 
 #ifdef CONFIG_DEBUG_FEATURES
   if (!hwnd || !rect || !dest)
@@ -101,6 +103,21 @@ int nx_getrectangle(NXWINDOW hwnd, FAR const struct nxgl_rect_s *rect,
 
   nxgl_rectcopy(&outmsg.rect, rect);
 
+#ifdef CONFIG_NX_CMDRING
+  /* Completion is tracked with the fence of the command ring.  Wait until
+   * the command is completed, so that the data is in the caller's buffer.
+   */
+
+  outmsg.sem_done = NULL;
+
+  ret = nxmu_sendwindow(wnd, &outmsg, sizeof(struct nxsvrmsg_getrectangle_s));
+  if (ret == OK && wnd->conn->ring != NULL)
+    {
+      ret = nxmu_ringwait(wnd->conn, wnd->conn->ring->head);
+    }
+
+  return ret;
+#else
   /* Create a semaphore for tracking command completion */
 
   outmsg.sem_done = &sem_done;
@@ -134,4 +151,5 @@ int nx_getrectangle(NXWINDOW hwnd, FAR const struct nxgl_rect_s *rect,
   _SEM_DESTROY(&sem_done);
 
   return ret;
+#endif
 }
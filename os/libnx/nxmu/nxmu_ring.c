@@ -0,0 +1,223 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * libnx/nxmu/nxmu_ring.c
+ *
+ * Client side of the command ring.  Window commands are copied into the
+ * ring of the connection and the server is woken with a single
+ * NX_SVRMSG_DRAIN message, after which it executes every queued command in
+ * place.  Completion is reported by the count of executed commands, which
+ * the client compares against a fence value instead of creating a
+ * semaphore for each command.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <mqueue.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/mqueue.h>
+#include <tinyara/nx/nxmu.h>
+
+#ifdef CONFIG_NX_CMDRING
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxmu_ringkick
+ *
+ * Description:
+ *  Ask the server to drain the command ring of the connection if it holds
+ *  commands and no request is pending yet.
+ *
+ ****************************************************************************/
+
+int nxmu_ringkick(FAR struct nxfe_conn_s *conn)
+{
+  FAR struct nxmu_ring_s *ring = conn->ring;
+  struct nxsvrmsg_s outmsg;
+  int ret;
+
+  if (ring == NULL || ring->kicked || ring->head == ring->tail)
+    {
+      return OK;
+    }
+
+  /* Mark the request before sending it: the server may run and clear the
+   * mark before _MQ_SEND returns.
+   */
+
+  ring->kicked = true;
+
+  outmsg.msgid = NX_SVRMSG_DRAIN;
+  outmsg.conn  = conn;
+
+  ret = _MQ_SEND(conn->cwrmq, (FAR const char *)&outmsg,
+                 sizeof(struct nxsvrmsg_s), NX_SVRMSG_PRIO);
+  if (ret < 0)
+    {
+      gerr("ERROR: _MQ_SEND failed: %d\n", _MQ_GETERRNO(ret));
+      ring->kicked = false;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxmu_ringwait
+ *
+ * Description:
+ *  Wait until the server has executed the commands in the command ring of
+ *  the connection up to the fence value 'fence'.  Any number of client
+ *  threads may wait on the same connection, each for its own fence.
+ *
+ ****************************************************************************/
+
+int nxmu_ringwait(FAR struct nxfe_conn_s *conn, uint32_t fence)
+{
+  FAR struct nxmu_ring_s *ring = conn->ring;
+  uint32_t nwaiters;
+  int ret;
+
+  DEBUGASSERT(ring != NULL);
+
+  if ((int32_t)(ring->tail - fence) >= 0)
+    {
+      return OK;
+    }
+
+  /* Make sure that the server will drain the ring */
+
+  ret = nxmu_ringkick(conn);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  for (; ; )
+    {
+      /* Count this thread as a waiter before testing tail again.  The
+       * server advances tail before it takes the count, so either this
+       * test sees the new tail or the server posts fencesem for us.
+       */
+
+      __atomic_add_fetch(&ring->nwaiters, 1, __ATOMIC_SEQ_CST);
+
+      if ((int32_t)(__atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) -
+                    fence) >= 0)
+        {
+          break;
+        }
+
+      nxmu_semtake(&ring->fencesem);
+
+      if ((int32_t)(ring->tail - fence) >= 0)
+        {
+          return OK;
+        }
+    }
+
+  /* Withdraw the count again.  If the server has already taken it, the
+   * matching post must be consumed.  The counts of the waiters are
+   * interchangeable, since every waiter tests its own fence when woken.
+   */
+
+  nwaiters = __atomic_load_n(&ring->nwaiters, __ATOMIC_SEQ_CST);
+  do
+    {
+      if (nwaiters == 0)
+        {
+          nxmu_semtake(&ring->fencesem);
+          break;
+        }
+    }
+  while (!__atomic_compare_exchange_n(&ring->nwaiters, &nwaiters,
+                                      nwaiters - 1, false, __ATOMIC_SEQ_CST,
+                                      __ATOMIC_SEQ_CST));
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxmu_ringsend
+ *
+ * Description:
+ *  Queue a window command in the command ring of the connection.  Client
+ *  threads that share the connection queue their commands one at a time.
+ *
+ ****************************************************************************/
+
+int nxmu_ringsend(FAR struct nxfe_conn_s *conn, FAR const void *msg,
+                  size_t msglen)
+{
+  FAR struct nxmu_ring_s *ring = conn->ring;
+  uint32_t pending;
+  int ret = OK;
+
+  DEBUGASSERT(ring != NULL && msglen <= NX_MXSVRMSGLEN);
+
+  nxmu_semtake(&ring->exclsem);
+
+  /* If the ring is full, wait until the oldest command has been executed */
+
+  if (ring->head - ring->tail >= CONFIG_NX_CMDRING_NSLOTS)
+    {
+      ret = nxmu_ringwait(conn, ring->head - CONFIG_NX_CMDRING_NSLOTS + 1);
+      if (ret < 0)
+        {
+          goto errout_with_excl;
+        }
+    }
+
+  /* Copy the command into the next slot and only then make it visible to
+   * the server.
+   */
+
+  memcpy(ring->slot[ring->head % CONFIG_NX_CMDRING_NSLOTS].buffer, msg,
+         msglen);
+  ring->head++;
+
+  /* Wake the server for every command, or when a batching client has
+   * filled half of the ring, so that the server works while the client
+   * keeps queueing.
+   */
+
+  pending = ring->head - ring->tail;
+  if (!ring->batch || pending >= CONFIG_NX_CMDRING_NSLOTS / 2)
+    {
+      ret = nxmu_ringkick(conn);
+    }
+
+errout_with_excl:
+  nxmu_semgive(&ring->exclsem);
+  return ret;
+}
+
+#endif /* CONFIG_NX_CMDRING */
@@ -81,6 +81,18 @@ int nxmu_sendserver(FAR struct nxfe_conn_s *conn, FAR const void *msg,
     }
 #endif
 
+#ifdef CONFIG_NX_CMDRING
+  /* Have the server drain the command ring first, so that this message is
+   * executed after the window commands queued before it.
+   */
+
+  ret = nxmu_ringkick(conn);
+  if (ret < 0)
+    {
+      return ret;
+    }
+#endif
+
   /* Send the message to the server */
 
   ret = _MQ_SEND(conn->cwrmq, msg, msglen, NX_SVRMSG_PRIO);
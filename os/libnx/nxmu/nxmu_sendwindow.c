@@ -86,6 +86,15 @@ int nxmu_sendwindow(FAR struct nxbe_window_s *wnd, FAR const void *msg,
 
   if (!NXBE_ISBLOCKED(wnd))
     {
+#ifdef CONFIG_NX_CMDRING
+      /* Queue the message in the command ring of the connection */
+
+      if (wnd->conn->ring != NULL)
+        {
+          return nxmu_ringsend(wnd->conn, msg, msglen);
+        }
+#endif
+
       /* Send the message to the server */
 
       ret = nxmu_sendserver(wnd->conn, msg, msglen);
@@ -26,6 +26,9 @@
 #ifdef CONFIG_LOGM_TIMESTAMP
 #include <tinyara/clock.h>
 #endif
+#ifdef CONFIG_ARCH_HAVE_PERF_EVENTS
+#include <tinyara/arch.h>
+#endif
 #include "logm.h"
 
 int g_logm_head;
@@ -34,7 +37,11 @@ int g_logm_available;
 int g_logm_enqueued_count;
 int g_logm_dropmsg_count;
 int g_logm_overflow_offset;
+#ifdef LOGM_BENCHMARK
+uint32_t g_logm_irqoff_max;
+#endif
 
+#ifndef CONFIG_LOGM_BINARY
 static void logm_putc(FAR struct lib_outstream_s *this, int ch)
 {
 	if (this->nput < g_logm_available - 1) {
@@ -50,19 +57,39 @@ static void logm_initstream(FAR struct lib_outstream_s *outstream)
 #endif
 	outstream->nput = 0;
 }
+#endif
 
 /* logm_internal hook for syslog & printfs */
 int logm_internal(int priority, const char *fmt, va_list ap)
 {
-	irqstate_t flags;
 	int ret = 0;
+#if !defined(CONFIG_LOGM_BINARY) || defined(CONFIG_ARCH_LOWPUTC)
 	struct lib_outstream_s strm;
+#endif
+#ifndef CONFIG_LOGM_BINARY
+	irqstate_t flags;
 #ifdef CONFIG_LOGM_TIMESTAMP
 	struct timespec ts;
 #endif
+#ifdef LOGM_BENCHMARK
+	uint32_t irqoff;
+#endif
+#endif
+
+#ifdef CONFIG_LOGM_BINARY
+	/* Queue the message unformatted.  This does not disable interrupts, so
+	 * it is also done for interrupt handlers.
+	 */
 
+	if (LOGM_STATUS(LOGM_READY) && logm_binary_put(priority, fmt, ap) == OK) {
+		return 0;
+	}
+#else
 	if (LOGM_STATUS(LOGM_READY) && !LOGM_STATUS(LOGM_BUFFER_RESIZE_REQ) && !up_interrupt_context()) {
 		flags = irqsave();
+#ifdef LOGM_BENCHMARK
+		irqoff = up_perf_gettime();
+#endif
 
 		if (LOGM_STATUS(LOGM_BUFFER_OVERFLOW)) {
 			g_logm_dropmsg_count++;
@@ -95,14 +122,22 @@ int logm_internal(int priority, const char *fmt, va_list ap)
 		g_logm_available -= (ret + 1);
 		g_logm_enqueued_count++;
 
+#ifdef LOGM_BENCHMARK
+		irqoff = up_perf_gettime() - irqoff;
+		if (irqoff > g_logm_irqoff_max) {
+			g_logm_irqoff_max = irqoff;
+		}
+#endif
 		irqrestore(flags);
-	} else {
-		/* Low Output: Sytem is not yet completely ready or this is called from interrupt handler */
+		return ret;
+	}
+#endif
+
+	/* Low Output: Sytem is not yet completely ready or this is called from interrupt handler */
 #ifdef CONFIG_ARCH_LOWPUTC
-		lib_lowoutstream(&strm);
-		ret = lib_vsprintf(&strm, fmt, ap);
+	lib_lowoutstream(&strm);
+	ret = lib_vsprintf(&strm, fmt, ap);
 #endif
-	}
 
 	return ret;
 }
@@ -20,6 +20,7 @@
 
 #include <tinyara/config.h>
 #include <stdint.h>
+#include <stdarg.h>
 
 /****************************************************************************
  * Preprocessor Definitions
@@ -33,6 +34,18 @@
 #define LOGM_BUFFER_SIZE (10240)
 #endif
 
+/* Unformatted messages start at multiples of LOGM_RECORD_ALIGN bytes,
+ * so the buffer size is rounded down to a multiple of it.
+ */
+
+#define LOGM_RECORD_ALIGN 4
+
+/* Time spent with interrupts disabled is measured for the benchmark */
+
+#if defined(CONFIG_LOGM_TEST) && defined(CONFIG_ARCH_HAVE_PERF_EVENTS)
+#define LOGM_BENCHMARK
+#endif
+
 #ifdef CONFIG_LOGM_PRINT_INTERVAL
 #define LOGM_PRINT_INTERVAL        CONFIG_LOGM_PRINT_INTERVAL
 #else
@@ -76,11 +89,19 @@ EXTERN int logm_bufsize;
 EXTERN uint8_t logm_status;
 EXTERN volatile int new_logm_bufsize;
 EXTERN volatile int logm_print_interval;
+#ifdef LOGM_BENCHMARK
+EXTERN uint32_t g_logm_irqoff_max;
+#endif
 
 /************************************************************************************
  * Private Function Prototypes
  ************************************************************************************/
 int logm_task(int argc, char *argv[]);
+#ifdef CONFIG_LOGM_BINARY
+int logm_binary_put(int priority, FAR const char *fmt, va_list ap);
+void logm_binary_flush(void);
+void logm_binary_wait(void);
+#endif
 void logm_register_tashcmds(void);
 static int logm_tash(int argc, char **args);
 
@@ -0,0 +1,600 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * os/logm/logm_binary.c
+ *
+ * Unformatted messages.  A caller reserves a record in the logm buffer with
+ * a compare-and-swap of the tail offset and fills in the format string
+ * pointer, a timestamp and the raw arguments, so queuing a message takes no
+ * lock and never disables interrupts.  The size field of a record is
+ * written last and tells the logm task that the record is complete; the
+ * logm task formats the record, zeroes it and only then moves the head past
+ * it.  A record never wraps around the end of the buffer: the space up to
+ * the end is queued as a padding record instead.
+ *
+ * Only the ARMv7 exclusive load and store instructions behind the GCC
+ * __atomic builtins are needed, so this also works on a single core without
+ * any help from the scheduler.
+ *
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <unistd.h>
+#include <tinyara/clock.h>
+#include "logm.h"
+
+#ifdef CONFIG_LOGM_BINARY
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define LOGM_RECORD_SIZE(n) \
+	(((n) + LOGM_RECORD_ALIGN - 1) & ~(LOGM_RECORD_ALIGN - 1))
+
+/* Set in the size field of a padding record */
+
+#define LOGM_RECORD_PAD 0x8000
+
+/* Longest conversion specification that is queued, not counting the
+ * digits that replace '*' widths and precisions.
+ */
+
+#define LOGM_CONV_MAX 16
+#define LOGM_SPEC_MAX (LOGM_CONV_MAX + 24)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Argument types of conversions */
+
+enum logm_arg_e {
+	LOGM_ARG_END,				/* No more conversions, or one that is not supported */
+	LOGM_ARG_NONE,				/* "%%" */
+	LOGM_ARG_INT,
+	LOGM_ARG_LONG,
+	LOGM_ARG_LLONG,
+	LOGM_ARG_DOUBLE,
+	LOGM_ARG_PTR,
+	LOGM_ARG_STR
+};
+
+/* One conversion of a format string */
+
+struct logm_conv_s {
+	FAR const char *start;		/* The '%', or the end of the format string */
+	FAR const char *end;		/* Just past the conversion character */
+	uint8_t type;				/* See enum logm_arg_e */
+	uint8_t wstar;				/* The width is an argument */
+	uint8_t pstar;				/* The precision is an argument */
+};
+
+/* Header of a queued message, followed by the arguments */
+
+struct logm_record_s {
+	uint16_t size;				/* Bytes in the record, zero until it is complete */
+	uint8_t priority;			/* Priority passed to logm_internal() */
+	uint8_t nconv;				/* Number of conversions with queued arguments */
+	FAR const char *fmt;		/* The format string */
+#ifdef CONFIG_LOGM_TIMESTAMP
+	uint32_t ticks;				/* System time when the message was queued */
+#endif
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Number of callers that are between checking for a resize request and
+ * completing their record.
+ */
+
+static int g_logm_writers;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Find the next conversion of a format string */
+
+static int logm_nextconv(FAR const char *fmt, FAR struct logm_conv_s *conv)
+{
+	FAR const char *p;
+	int longs = 0;
+	bool ldouble = false;
+
+	conv->wstar = false;
+	conv->pstar = false;
+
+	p = strchr(fmt, '%');
+	if (p == NULL) {
+		conv->start = fmt + strlen(fmt);
+		conv->end = conv->start;
+		conv->type = LOGM_ARG_END;
+		return LOGM_ARG_END;
+	}
+
+	conv->start = p++;
+
+	/* Flags, width and precision */
+
+	while (*p != '\0' && strchr("-+ #0", *p) != NULL) {
+		p++;
+	}
+
+	if (*p == '*') {
+		conv->wstar = true;
+		p++;
+	} else {
+		while (*p >= '0' && *p <= '9') {
+			p++;
+		}
+	}
+
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			conv->pstar = true;
+			p++;
+		} else {
+			while (*p >= '0' && *p <= '9') {
+				p++;
+			}
+		}
+	}
+
+	/* Length modifiers.  size_t and ptrdiff_t are as wide as long. */
+
+	for (;; p++) {
+		if (*p == 'l' || *p == 'z' || *p == 't') {
+			longs++;
+		} else if (*p == 'j') {
+			longs = 2;
+		} else if (*p == 'L') {
+			ldouble = true;
+		} else if (*p != 'h') {
+			break;
+		}
+	}
+
+	switch (*p) {
+	case '%':
+		conv->type = LOGM_ARG_NONE;
+		break;
+
+	case 'd':
+	case 'i':
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+	case 'c':
+		conv->type = longs == 0 ? LOGM_ARG_INT : longs == 1 ? LOGM_ARG_LONG : LOGM_ARG_LLONG;
+		break;
+
+	case 'f':
+	case 'F':
+	case 'e':
+	case 'E':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		conv->type = ldouble ? LOGM_ARG_END : LOGM_ARG_DOUBLE;
+		break;
+
+	case 'p':
+		conv->type = LOGM_ARG_PTR;
+		break;
+
+	case 's':
+		conv->type = LOGM_ARG_STR;
+		break;
+
+	default:
+		/* %n, long double and anything unknown end the message */
+
+		conv->type = LOGM_ARG_END;
+		break;
+	}
+
+	if (conv->type == LOGM_ARG_END || p + 1 - conv->start > LOGM_CONV_MAX) {
+		conv->end = conv->start;
+		conv->type = LOGM_ARG_END;
+	} else {
+		conv->end = p + 1;
+	}
+
+	return conv->type;
+}
+
+/* Append one raw argument to the staged arguments */
+
+static bool logm_putarg(FAR uint8_t *args, FAR size_t *nbytes, FAR const void *value, size_t size)
+{
+	if (*nbytes + size > CONFIG_LOGM_BINARY_ARGSIZE) {
+		return false;
+	}
+
+	memcpy(&args[*nbytes], value, size);
+	*nbytes += size;
+	return true;
+}
+
+/* Stage the arguments of a message and return the number of conversions
+ * whose arguments all fit.
+ */
+
+static int logm_capture(FAR uint8_t *args, FAR size_t *nbytes, FAR const char *fmt, va_list ap)
+{
+	struct logm_conv_s conv;
+	FAR const char *str;
+	long long llval;
+	double dval;
+	void *pval;
+	long lval;
+	size_t len;
+	int ival;
+	int nconv;
+	bool fits;
+
+	*nbytes = 0;
+
+	for (nconv = 0; nconv < UINT8_MAX; nconv++, fmt = conv.end) {
+		if (logm_nextconv(fmt, &conv) == LOGM_ARG_END) {
+			break;
+		}
+
+		fits = true;
+
+		if (conv.wstar) {
+			ival = va_arg(ap, int);
+			fits = logm_putarg(args, nbytes, &ival, sizeof(int));
+		}
+
+		if (conv.pstar) {
+			ival = va_arg(ap, int);
+			fits = fits && logm_putarg(args, nbytes, &ival, sizeof(int));
+		}
+
+		switch (conv.type) {
+		case LOGM_ARG_INT:
+			ival = va_arg(ap, int);
+			fits = fits && logm_putarg(args, nbytes, &ival, sizeof(int));
+			break;
+
+		case LOGM_ARG_LONG:
+			lval = va_arg(ap, long);
+			fits = fits && logm_putarg(args, nbytes, &lval, sizeof(long));
+			break;
+
+		case LOGM_ARG_LLONG:
+			llval = va_arg(ap, long long);
+			fits = fits && logm_putarg(args, nbytes, &llval, sizeof(long long));
+			break;
+
+		case LOGM_ARG_DOUBLE:
+			dval = va_arg(ap, double);
+			fits = fits && logm_putarg(args, nbytes, &dval, sizeof(double));
+			break;
+
+		case LOGM_ARG_PTR:
+			pval = va_arg(ap, void *);
+			fits = fits && logm_putarg(args, nbytes, &pval, sizeof(void *));
+			break;
+
+		case LOGM_ARG_STR:
+			/* Strings are copied, truncated if need be */
+
+			str = va_arg(ap, FAR const char *);
+			if (str == NULL) {
+				str = "(null)";
+			}
+
+			len = CONFIG_LOGM_BINARY_ARGSIZE - *nbytes;
+			if (len > CONFIG_LOGM_BINARY_STRMAX + 1) {
+				len = CONFIG_LOGM_BINARY_STRMAX + 1;
+			}
+
+			if (!fits || len == 0) {
+				fits = false;
+				break;
+			}
+
+			len = strnlen(str, len - 1);
+			memcpy(&args[*nbytes], str, len);
+			args[*nbytes + len] = '\0';
+			*nbytes += len + 1;
+			break;
+
+		default:
+			break;
+		}
+
+		if (!fits) {
+			break;
+		}
+	}
+
+	return nconv;
+}
+
+/* Reserve 'size' bytes of contiguous space at the tail of the buffer */
+
+static int logm_reserve(int size, FAR int *offset)
+{
+	int tail;
+	int head;
+	int room;
+	int pad;
+	int next;
+
+	tail = __atomic_load_n(&g_logm_tail, __ATOMIC_RELAXED);
+
+	do {
+		head = __atomic_load_n(&g_logm_head, __ATOMIC_ACQUIRE);
+
+		/* One record alignment unit is kept free so that a full buffer
+		 * cannot be told apart from an empty one.
+		 */
+
+		room = (head > tail ? head - tail : logm_bufsize - tail + head) - LOGM_RECORD_ALIGN;
+		pad = tail + size > logm_bufsize ? logm_bufsize - tail : 0;
+		if (pad + size > room) {
+			return -ENOSPC;
+		}
+
+		next = (tail + pad + size) % logm_bufsize;
+	} while (!__atomic_compare_exchange_n(&g_logm_tail, &tail, next, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+	if (pad > 0) {
+		__atomic_store_n((FAR uint16_t *)&g_logm_rsvbuf[tail], pad | LOGM_RECORD_PAD, __ATOMIC_RELEASE);
+		tail = 0;
+	}
+
+	*offset = tail;
+	return OK;
+}
+
+/* Read one raw argument of a record */
+
+static FAR const uint8_t *logm_getarg(FAR const uint8_t *args, FAR void *value, size_t size)
+{
+	memcpy(value, args, size);
+	return args + size;
+}
+
+/* Format one queued message to stdout */
+
+static void logm_print(FAR const struct logm_record_s *rec)
+{
+	FAR const uint8_t *args = (FAR const uint8_t *)(rec + 1);
+	FAR const char *fmt = rec->fmt;
+	FAR const char *p;
+	struct logm_conv_s conv;
+	char spec[LOGM_SPEC_MAX];
+	long long llval;
+	double dval;
+	void *pval;
+	long lval;
+	int ival;
+	int len;
+	int i;
+
+#ifdef CONFIG_LOGM_TIMESTAMP
+	fprintf(stdout, "[%4d.%4d] ", (int)(rec->ticks / TICK_PER_SEC), (int)((rec->ticks % TICK_PER_SEC) * USEC_PER_TICK / 100));
+#endif
+
+	for (i = 0; i < rec->nconv; i++, fmt = conv.end) {
+		logm_nextconv(fmt, &conv);
+		fwrite(fmt, 1, conv.start - fmt, stdout);
+
+		/* Copy the specification with the '*' replaced by the queued
+		 * values.  A negative precision is taken as omitted.
+		 */
+
+		for (len = 0, p = conv.start; p < conv.end; p++) {
+			if (*p != '*') {
+				spec[len++] = *p;
+				continue;
+			}
+
+			args = logm_getarg(args, &ival, sizeof(int));
+			if (p[-1] == '.' && ival < 0) {
+				len--;
+			} else {
+				len += snprintf(&spec[len], LOGM_SPEC_MAX - len, "%d", ival);
+			}
+		}
+
+		spec[len] = '\0';
+
+		switch (conv.type) {
+		case LOGM_ARG_NONE:
+			fputc('%', stdout);
+			break;
+
+		case LOGM_ARG_INT:
+			args = logm_getarg(args, &ival, sizeof(int));
+			fprintf(stdout, spec, ival);
+			break;
+
+		case LOGM_ARG_LONG:
+			args = logm_getarg(args, &lval, sizeof(long));
+			fprintf(stdout, spec, lval);
+			break;
+
+		case LOGM_ARG_LLONG:
+			args = logm_getarg(args, &llval, sizeof(long long));
+			fprintf(stdout, spec, llval);
+			break;
+
+		case LOGM_ARG_DOUBLE:
+			args = logm_getarg(args, &dval, sizeof(double));
+			fprintf(stdout, spec, dval);
+			break;
+
+		case LOGM_ARG_PTR:
+			args = logm_getarg(args, &pval, sizeof(void *));
+			fprintf(stdout, spec, pval);
+			break;
+
+		case LOGM_ARG_STR:
+			fprintf(stdout, spec, (FAR const char *)args);
+			args += strlen((FAR const char *)args) + 1;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	/* The rest of the format string, which is still unformatted if the
+	 * arguments did not fit.
+	 */
+
+	fputs(fmt, stdout);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: logm_binary_put
+ *
+ * Description:
+ *   Queue a message without formatting it.  May be called from interrupt
+ *   handlers.  A message that does not fit is dropped and counted.
+ *
+ * Returned Value:
+ *   OK if the message was queued or dropped; -EBUSY if the buffer is being
+ *   resized, in which case 'ap' is left untouched.
+ *
+ ****************************************************************************/
+
+int logm_binary_put(int priority, FAR const char *fmt, va_list ap)
+{
+	uint8_t args[CONFIG_LOGM_BINARY_ARGSIZE];
+	FAR struct logm_record_s *rec;
+#ifdef CONFIG_LOGM_TIMESTAMP
+	uint32_t ticks = (uint32_t)clock_systimer();
+#endif
+	size_t nbytes;
+	int offset;
+	int nconv;
+	int size;
+
+	/* The logm task waits for all writers before it moves the buffer */
+
+	__atomic_add_fetch(&g_logm_writers, 1, __ATOMIC_SEQ_CST);
+	if (LOGM_STATUS(LOGM_BUFFER_RESIZE_REQ)) {
+		__atomic_sub_fetch(&g_logm_writers, 1, __ATOMIC_RELEASE);
+		return -EBUSY;
+	}
+
+	nconv = logm_capture(args, &nbytes, fmt, ap);
+	size = LOGM_RECORD_SIZE(sizeof(struct logm_record_s) + nbytes);
+
+	if (logm_reserve(size, &offset) < 0) {
+		__atomic_add_fetch(&g_logm_dropmsg_count, 1, __ATOMIC_RELAXED);
+	} else {
+		rec = (FAR struct logm_record_s *)&g_logm_rsvbuf[offset];
+		rec->priority = (uint8_t)priority;
+		rec->nconv = (uint8_t)nconv;
+		rec->fmt = fmt;
+#ifdef CONFIG_LOGM_TIMESTAMP
+		rec->ticks = ticks;
+#endif
+		memcpy(rec + 1, args, nbytes);
+
+		/* Complete the record */
+
+		__atomic_store_n(&rec->size, (uint16_t)size, __ATOMIC_RELEASE);
+	}
+
+	__atomic_sub_fetch(&g_logm_writers, 1, __ATOMIC_RELEASE);
+	return OK;
+}
+
+/****************************************************************************
+ * Name: logm_binary_flush
+ *
+ * Description:
+ *   Format all complete messages at the head of the buffer to stdout and
+ *   free their space.  Called by the logm task only.
+ *
+ ****************************************************************************/
+
+void logm_binary_flush(void)
+{
+	FAR struct logm_record_s *rec;
+	int dropped;
+	int size;
+
+	for (;;) {
+		rec = (FAR struct logm_record_s *)&g_logm_rsvbuf[g_logm_head];
+		size = __atomic_load_n(&rec->size, __ATOMIC_ACQUIRE);
+		if (size == 0) {
+			break;
+		}
+
+		if ((size & LOGM_RECORD_PAD) == 0) {
+			logm_print(rec);
+		}
+
+		/* Zero the whole record, so that no stale size field is found when
+		 * a later record starts inside of it.
+		 */
+
+		size &= ~LOGM_RECORD_PAD;
+		memset(rec, 0, size);
+		__atomic_store_n(&g_logm_head, (g_logm_head + size) % logm_bufsize, __ATOMIC_RELEASE);
+	}
+
+	dropped = __atomic_exchange_n(&g_logm_dropmsg_count, 0, __ATOMIC_RELAXED);
+	if (dropped > 0) {
+		fprintf(stdout, "\n[LOGM BUFFER OVERFLOW] %d messages are dropped\n", dropped);
+	}
+}
+
+/****************************************************************************
+ * Name: logm_binary_wait
+ *
+ * Description:
+ *   Wait until no caller is queuing a message.  Called by the logm task
+ *   after LOGM_BUFFER_RESIZE_REQ was set, so no new caller can start.
+ *
+ ****************************************************************************/
+
+void logm_binary_wait(void)
+{
+	while (__atomic_load_n(&g_logm_writers, __ATOMIC_ACQUIRE) > 0) {
+		usleep(USEC_PER_TICK);
+	}
+}
+
+#endif							/* CONFIG_LOGM_BINARY */
@@ -35,6 +35,13 @@ volatile int logm_print_interval = LOGM_PRINT_INTERVAL * 1000;
 
 static int logm_change_bufsize(int buflen)
 {
+#ifdef CONFIG_LOGM_BINARY
+	buflen &= ~(LOGM_RECORD_ALIGN - 1);
+	if (buflen == 0) {
+		buflen = -1;
+	}
+#endif
+
 	/* Keep using old size if a parameter is invalid */
 	if (buflen < 0) {
 		LOGM_STATUS_CLEAR(LOGM_BUFFER_RESIZE_REQ);
@@ -64,9 +71,14 @@ static int logm_change_bufsize(int buflen)
 
 int logm_task(int argc, char *argv[])
 {
+#ifndef CONFIG_LOGM_BINARY
 	int ret = 0;
+#endif
 	irqstate_t flags;
 
+#ifdef CONFIG_LOGM_BINARY
+	logm_bufsize &= ~(LOGM_RECORD_ALIGN - 1);
+#endif
 	g_logm_rsvbuf = (char *)malloc(logm_bufsize);
 	memset(g_logm_rsvbuf, 0, logm_bufsize);
 
@@ -79,6 +91,9 @@ int logm_task(int argc, char *argv[])
 #endif
 
 	while (1) {
+#ifdef CONFIG_LOGM_BINARY
+		logm_binary_flush();
+#else
 		while (g_logm_enqueued_count > 0) {
 			ret = 0;
 			while (*(g_logm_rsvbuf + (g_logm_head + ret) % logm_bufsize)) {
@@ -98,8 +113,13 @@ int logm_task(int argc, char *argv[])
 				g_logm_overflow_offset = -1;
 			}
 		}
+#endif
 
 		if (LOGM_STATUS(LOGM_BUFFER_RESIZE_REQ)) {
+#ifdef CONFIG_LOGM_BINARY
+			/* Messages may still be queued into the old buffer */
+			logm_binary_wait();
+#endif
 			flags = irqsave();
 			if (logm_change_bufsize(new_logm_bufsize) != OK) {
 				fprintf(stdout, "\n[LOGM] Failed to change buffer size\n");
@@ -16,19 +16,77 @@
  *
  ****************************************************************************/
 #include <stdio.h>
+#include <stdint.h>
 #include <unistd.h>
+#include <sched.h>
 #include <syslog.h>
+#include <tinyara/arch.h>
 #include <tinyara/kthread.h>
 #include <tinyara/logm.h>
 
 #include "logm.h"
 
+/* Number of calls timed by the benchmark.  The messages must fit in the
+ * logm buffer, since dropped messages are cheaper than queued ones.
+ */
+#define LOGMTEST_BENCH_CALLS 64
+
 /* Global Variables */
 static int g_logmtest_handle = 123;
 
+#ifdef LOGM_BENCHMARK
+/* Time logm() calls with the cycle counter and report the cost per call and
+ * the longest time logm spent with interrupts disabled.  Build with and
+ * without CONFIG_LOGM_BINARY to compare the two modes.
+ */
+static void logmtest_benchmark(void)
+{
+	uint32_t start;
+	uint32_t cycles;
+	uint32_t min = UINT32_MAX;
+	uint32_t max = 0;
+	uint64_t total = 0;
+	uint32_t mhz;
+	int i;
+
+	/* Keep the logm task from running in the middle of a call */
+	sched_lock();
+	g_logm_irqoff_max = 0;
+
+	for (i = 0; i < LOGMTEST_BENCH_CALLS; i++) {
+		start = up_perf_gettime();
+		logm(1, 0, 3, "logm bench %d %s %d\n", i, "call", g_logmtest_handle);
+		cycles = up_perf_gettime() - start;
+
+		total += cycles;
+		if (cycles < min) {
+			min = cycles;
+		}
+		if (cycles > max) {
+			max = cycles;
+		}
+	}
+
+	sched_unlock();
+
+	mhz = up_perf_getfreq() / 1000000;
+	logm(1, 0, 3, "[LOGM BENCH] %s mode: %d calls, cycles per call min %u avg %u max %u, max IRQ off %u cycles, %u MHz\n",
+#ifdef CONFIG_LOGM_BINARY
+		 "binary",
+#else
+		 "text",
+#endif
+		 LOGMTEST_BENCH_CALLS, min, (uint32_t)(total / LOGMTEST_BENCH_CALLS), max, g_logm_irqoff_max, mhz);
+}
+#endif
+
 /* LOGM test routine */
 static int logmtest_kthread(int argc, char *argv[])
 {
+#ifdef LOGM_BENCHMARK
+	logmtest_benchmark();
+#endif
+
 	while (1) {
 		logm(1, 0, 3, "lom direct call test1 %d\n", g_logmtest_handle);
 		logm(1, 0, 3, "lom direct call test2 %d\n", g_logmtest_handle);
@@ -110,6 +110,14 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 
 	OS_TRACE_MEM_FREE(mem, caller_retaddr);
 
+#ifdef CONFIG_MM_SLAB
+	/* Objects from the slab pages go back there */
+
+	if (mm_slab_free(heap, mem)) {
+		return;
+	}
+#endif
+
 	/* We need to hold the MM semaphore while we muck with the
 	 * nodelist.
 	 */
@@ -229,4 +229,10 @@ void mm_initialize(FAR struct mm_heap_s *heap, FAR void *heapstart, size_t heaps
 	/* Add the initial region of memory to the heap */
 
 	mm_addregion(heap, heapstart, heapsize);
+
+#ifdef CONFIG_MM_SLAB
+	/* Then set aside the pages for small objects */
+
+	mm_slab_initialize(heap);
+#endif
 }
@@ -120,6 +120,16 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 		return NULL;
 	}
 
+#ifdef CONFIG_MM_SLAB
+	/* Small objects come from the slab pages if there is room */
+
+	ret = mm_slab_alloc(heap, size);
+	if (ret) {
+		mvdbg("Allocated %p from slab, size %d\n", ret, size);
+		return ret;
+	}
+#endif
+
 	/* Adjust the size to account for (1) the size of the allocated node and
 	 * (2) to make sure that it is an even multiple of our granule size.
 	 */
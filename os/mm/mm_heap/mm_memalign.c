@@ -123,6 +123,14 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment, size_t size)
 	size = MM_ALIGN_UP(size);	/* Make multiples of our granule size */
 	allocsize = size + 2 * alignment;	/* Add double full alignment size */
 
+#ifdef CONFIG_MM_SLAB
+	/* The chunk is trimmed below, so it must not come from a slab page */
+
+	if (allocsize <= MM_SLAB_MAXSIZE) {
+		allocsize = MM_SLAB_MAXSIZE + 1;
+	}
+#endif
+
 	/* Then malloc that size */
 #ifdef CONFIG_DEBUG_MM_HEAPINFO
 	/*Passing Zero as caller addr to avoid adding memalloc info in malloc function,
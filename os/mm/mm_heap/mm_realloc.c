@@ -137,6 +137,27 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem, size_t size)
 		return NULL;
 	}
 
+#ifdef CONFIG_MM_SLAB
+	/* A slab object stays where it is if it is still big enough.  Otherwise
+	 * it is moved, since slab objects cannot grow.
+	 */
+
+	oldsize = mm_slab_size(heap, oldmem);
+	if (oldsize > 0) {
+		if (size <= oldsize) {
+			return oldmem;
+		}
+
+		newmem = mm_malloc(heap, size);
+		if (newmem) {
+			memcpy(newmem, oldmem, oldsize);
+			mm_free(heap, oldmem);
+		}
+
+		return newmem;
+	}
+#endif
+
 	/* Adjust the size to account for (1) the size of the allocated node and
 	 * (2) to make sure that it is an even multiple of our granule size.
 	 */
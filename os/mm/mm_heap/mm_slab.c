@@ -0,0 +1,548 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * mm/mm_heap/mm_slab.c
+ *
+ * Segregated-fit allocator for small objects.  A fixed arena is taken from
+ * the heap when it is initialized and split into pages of MM_SLAB_PAGESIZE
+ * bytes.  Each page in use holds objects of one size class, linked through
+ * their first word while they are free, so that allocation and release are
+ * a list pop and push with no per-object header.  A page whose objects are
+ * all free goes back to the arena and may be reused for any class.
+ *
+ * With CONFIG_MM_SLAB_MAGAZINE, the running thread first allocates from and
+ * releases to a magazine of free objects in its own TCB, and takes the heap
+ * semaphore only to move half a magazine of objects to or from the pages.
+ * A thread cannot empty the magazines of others, so all magazines together
+ * may cache only a part of the arena.  The rest stays on the pages for any
+ * thread to use.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <tinyara/mm/mm.h>
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+#include <tinyara/arch.h>
+#include <tinyara/sched.h>
+#endif
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Size classes are selected in steps of 16 bytes */
+
+#define MM_SLAB_SHIFT     4
+#define MM_SLAB_NSTEPS    ((MM_SLAB_MAXSIZE >> MM_SLAB_SHIFT) + 1)
+
+/* Number of objects moved by one magazine refill or drain */
+
+#define MM_MAGAZINE_BATCH (CONFIG_MM_SLAB_MAGAZINE_SIZE / 2)
+
+/* All magazines together may cache at most 1/MM_MAGAZINE_SHARE of the arena */
+
+#define MM_MAGAZINE_SHARE 4
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Object size of each class */
+
+static const uint16_t g_slabsize[MM_SLAB_NCLASSES] = {
+	16, 32, 48, 64, 96, 128, 192, 256
+};
+
+/* Size class for each 16 byte step of request size */
+
+static const uint8_t g_slabclass[MM_SLAB_NSTEPS] = {
+	0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_slab_addpage / mm_slab_rempage
+ *
+ * Description:
+ *   Add a page to the head of, or remove it from, a doubly linked list of
+ *   pages.
+ *
+ ****************************************************************************/
+
+static inline void mm_slab_addpage(FAR struct mm_slabpage_s **list, FAR struct mm_slabpage_s *page)
+{
+	page->blink = NULL;
+	page->flink = *list;
+	if (*list) {
+		(*list)->blink = page;
+	}
+
+	*list = page;
+}
+
+static inline void mm_slab_rempage(FAR struct mm_slabpage_s **list, FAR struct mm_slabpage_s *page)
+{
+	if (page->blink) {
+		page->blink->flink = page->flink;
+	} else {
+		*list = page->flink;
+	}
+
+	if (page->flink) {
+		page->flink->blink = page->blink;
+	}
+
+	page->flink = NULL;
+	page->blink = NULL;
+}
+
+/****************************************************************************
+ * Name: mm_slab_page
+ *
+ * Description:
+ *   Return the descriptor of the slab page holding 'mem', or NULL if 'mem'
+ *   is not in the slab arena.
+ *
+ ****************************************************************************/
+
+static inline FAR struct mm_slabpage_s *mm_slab_page(FAR struct mm_slab_s *slab, FAR void *mem)
+{
+	FAR uint8_t *ptr = (FAR uint8_t *)mem;
+
+	if (ptr < slab->base || ptr >= slab->end) {
+		return NULL;
+	}
+
+	return &slab->pages[(ptr - slab->base) / MM_SLAB_PAGESIZE];
+}
+
+/****************************************************************************
+ * Name: mm_slab_get
+ *
+ * Description:
+ *   Take one object of class 'sclass' from the slab pages, starting a new
+ *   page if no page of the class has a free object.  Returns NULL if the
+ *   arena is exhausted.  The caller holds the heap semaphore.
+ *
+ ****************************************************************************/
+
+static FAR void *mm_slab_get(FAR struct mm_slab_s *slab, int sclass)
+{
+	FAR struct mm_slabpage_s *page;
+	FAR uint8_t *obj;
+	uint16_t objsize;
+	int i;
+
+	/* Use a page of this class with free objects, or start a new one */
+
+	page = slab->partial[sclass];
+	if (page == NULL) {
+		page = slab->freepages;
+		if (page == NULL) {
+			return NULL;
+		}
+
+		mm_slab_rempage(&slab->freepages, page);
+
+		/* Chain all objects of the new page into its free list */
+
+		objsize = g_slabsize[sclass];
+		obj = slab->base + (page - slab->pages) * MM_SLAB_PAGESIZE;
+		page->freelist = obj;
+		for (i = MM_SLAB_PAGESIZE / objsize; i > 1; i--) {
+			*(FAR void **)obj = obj + objsize;
+			obj += objsize;
+		}
+
+		*(FAR void **)obj = NULL;
+		page->inuse = 0;
+		page->sclass = sclass;
+
+		mm_slab_addpage(&slab->partial[sclass], page);
+	}
+
+	/* Take the first free object.  A page with none left leaves the list */
+
+	obj = (FAR uint8_t *)page->freelist;
+	page->freelist = *(FAR void **)obj;
+	page->inuse++;
+
+	if (page->freelist == NULL) {
+		mm_slab_rempage(&slab->partial[sclass], page);
+	}
+
+	return obj;
+}
+
+/****************************************************************************
+ * Name: mm_slab_put
+ *
+ * Description:
+ *   Return the object 'mem' to its slab page 'page'.  The caller holds the
+ *   heap semaphore.
+ *
+ ****************************************************************************/
+
+static void mm_slab_put(FAR struct mm_slab_s *slab, FAR struct mm_slabpage_s *page, FAR void *mem)
+{
+	DEBUGASSERT(page->inuse > 0);
+
+	/* A full page becomes available to its class again */
+
+	if (page->freelist == NULL) {
+		mm_slab_addpage(&slab->partial[page->sclass], page);
+	}
+
+	*(FAR void **)mem = page->freelist;
+	page->freelist = mem;
+	page->inuse--;
+
+	/* An empty page goes back to the arena for any class to use */
+
+	if (page->inuse == 0) {
+		mm_slab_rempage(&slab->partial[page->sclass], page);
+		page->freelist = NULL;
+		mm_slab_addpage(&slab->freepages, page);
+	}
+}
+
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+/****************************************************************************
+ * Name: mm_magazine
+ *
+ * Description:
+ *   Return the magazine of the calling thread if it may be used for 'heap',
+ *   or NULL if the slab pages must be used directly.
+ *
+ *   Only the running thread touches its own magazine, and it never does so
+ *   from an interrupt handler.  While a task exits, the thread that will run
+ *   next is the head of the ready-to-run list but is marked ready-to-run,
+ *   not running, so the exit path does not use its magazine behind its
+ *   back.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_magazine_s *mm_magazine(FAR struct mm_heap_s *heap)
+{
+	FAR struct tcb_s *tcb = sched_self();
+
+	if (tcb == NULL || tcb->task_state != TSTATE_TASK_RUNNING || up_interrupt_context()) {
+		return NULL;
+	}
+
+	/* The magazine belongs to the first heap that the thread uses */
+
+	if (tcb->magazine.heap == NULL) {
+		tcb->magazine.heap = heap;
+	}
+
+	return tcb->magazine.heap == heap ? &tcb->magazine : NULL;
+}
+
+/****************************************************************************
+ * Name: mm_magazine_room
+ *
+ * Description:
+ *   Check if the magazines may cache one more object of 'objsize' bytes.
+ *   Threads may race between the check and the update, so the limit may be
+ *   exceeded by a few objects.
+ *
+ ****************************************************************************/
+
+static inline bool mm_magazine_room(FAR struct mm_slab_s *slab, uint16_t objsize)
+{
+	return __atomic_load_n(&slab->magbytes, __ATOMIC_RELAXED) + objsize <= slab->maglimit;
+}
+
+/****************************************************************************
+ * Name: mm_magazine_drain
+ *
+ * Description:
+ *   Return up to 'nobjs' objects of class 'sclass' from the magazine 'mag'
+ *   to their slab pages.  The caller holds the heap semaphore.
+ *
+ ****************************************************************************/
+
+static void mm_magazine_drain(FAR struct mm_slab_s *slab, FAR struct mm_magazine_s *mag, int sclass, int nobjs)
+{
+	FAR void *obj;
+
+	while (nobjs-- > 0 && mag->count[sclass] > 0) {
+		obj = mag->rounds[sclass][--mag->count[sclass]];
+		mm_slab_put(slab, mm_slab_page(slab, obj), obj);
+		__atomic_fetch_sub(&slab->magbytes, g_slabsize[sclass], __ATOMIC_RELAXED);
+	}
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_slab_initialize
+ *
+ * Description:
+ *   Take the slab arena from the heap.  If the heap is too small, small
+ *   allocations simply keep using the heap.
+ *
+ ****************************************************************************/
+
+void mm_slab_initialize(FAR struct mm_heap_s *heap)
+{
+	FAR struct mm_slab_s *slab = &heap->mm_slab;
+	FAR uint8_t *arena;
+	size_t npages;
+	size_t i;
+
+	memset(slab, 0, sizeof(struct mm_slab_s));
+
+	/* The page descriptors live at the start of the arena, followed by the
+	 * pages themselves.
+	 */
+
+	npages = CONFIG_MM_SLAB_SIZE / (MM_SLAB_PAGESIZE + sizeof(struct mm_slabpage_s));
+	if (npages == 0) {
+		return;
+	}
+
+	arena = (FAR uint8_t *)mm_malloc(heap, CONFIG_MM_SLAB_SIZE);
+	if (arena == NULL) {
+		mdbg("No room for a %d byte slab arena\n", CONFIG_MM_SLAB_SIZE);
+		return;
+	}
+
+	slab->pages = (FAR struct mm_slabpage_s *)arena;
+	slab->base  = arena + MM_ALIGN_UP(npages * sizeof(struct mm_slabpage_s));
+	slab->end   = slab->base + npages * MM_SLAB_PAGESIZE;
+
+	for (i = npages; i > 0; i--) {
+		mm_slab_addpage(&slab->freepages, &slab->pages[i - 1]);
+	}
+
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+	slab->maglimit = npages * MM_SLAB_PAGESIZE / MM_MAGAZINE_SHARE;
+#endif
+
+	mvdbg("Slab arena %p, %d pages\n", arena, (int)npages);
+}
+
+/****************************************************************************
+ * Name: mm_slab_alloc
+ *
+ * Description:
+ *   Allocate an object of at least 'size' bytes from the slab arena.
+ *   Returns NULL if the size is too large for a slab or if the arena is
+ *   exhausted, in which case the caller falls back to the heap.
+ *
+ ****************************************************************************/
+
+FAR void *mm_slab_alloc(FAR struct mm_heap_s *heap, size_t size)
+{
+	FAR struct mm_slab_s *slab = &heap->mm_slab;
+	FAR void *obj;
+	int sclass;
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+	FAR struct mm_magazine_s *mag;
+	FAR void *extra;
+	int i;
+#endif
+
+	if (size > MM_SLAB_MAXSIZE || slab->base == NULL) {
+		return NULL;
+	}
+
+	sclass = g_slabclass[(size + (1 << MM_SLAB_SHIFT) - 1) >> MM_SLAB_SHIFT];
+
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+	mag = mm_magazine(heap);
+	if (mag != NULL) {
+		if (mag->count[sclass] > 0) {
+			__atomic_fetch_sub(&slab->magbytes, g_slabsize[sclass], __ATOMIC_RELAXED);
+			return mag->rounds[sclass][--mag->count[sclass]];
+		}
+
+		/* Take the object and up to half a magazine more from the pages.
+		 * If the arena is exhausted, the objects that this thread caches
+		 * for the other classes may free a page.
+		 */
+
+		mm_takesemaphore(heap);
+		obj = mm_slab_get(slab, sclass);
+		if (obj == NULL) {
+			for (i = 0; i < MM_SLAB_NCLASSES; i++) {
+				mm_magazine_drain(slab, mag, i, CONFIG_MM_SLAB_MAGAZINE_SIZE);
+			}
+
+			obj = mm_slab_get(slab, sclass);
+		}
+
+		for (i = 1; obj != NULL && i < MM_MAGAZINE_BATCH && mm_magazine_room(slab, g_slabsize[sclass]); i++) {
+			extra = mm_slab_get(slab, sclass);
+			if (extra == NULL) {
+				break;
+			}
+
+			mag->rounds[sclass][mag->count[sclass]++] = extra;
+			__atomic_fetch_add(&slab->magbytes, g_slabsize[sclass], __ATOMIC_RELAXED);
+		}
+
+		mm_givesemaphore(heap);
+		return obj;
+	}
+#endif
+
+	mm_takesemaphore(heap);
+	obj = mm_slab_get(slab, sclass);
+	mm_givesemaphore(heap);
+
+	return obj;
+}
+
+/****************************************************************************
+ * Name: mm_slab_free
+ *
+ * Description:
+ *   Return 'mem' to its slab page.  Returns false if 'mem' does not belong
+ *   to the slab arena, in which case the caller frees it to the heap.
+ *
+ ****************************************************************************/
+
+bool mm_slab_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+	FAR struct mm_slab_s *slab = &heap->mm_slab;
+	FAR struct mm_slabpage_s *page;
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+	FAR struct mm_magazine_s *mag;
+	int sclass;
+#endif
+
+	page = mm_slab_page(slab, mem);
+	if (page == NULL) {
+		return false;
+	}
+
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+	mag = mm_magazine(heap);
+	if (mag != NULL) {
+		sclass = page->sclass;
+
+		/* Drain half of a full magazine back to the slab pages */
+
+		if (mag->count[sclass] >= CONFIG_MM_SLAB_MAGAZINE_SIZE) {
+			mm_takesemaphore(heap);
+			mm_magazine_drain(slab, mag, sclass, MM_MAGAZINE_BATCH);
+			mm_givesemaphore(heap);
+		}
+
+		/* Cache the object unless the magazines hold their share */
+
+		if (mm_magazine_room(slab, g_slabsize[sclass])) {
+			mag->rounds[sclass][mag->count[sclass]++] = mem;
+			__atomic_fetch_add(&slab->magbytes, g_slabsize[sclass], __ATOMIC_RELAXED);
+			return true;
+		}
+	}
+#endif
+
+	mm_takesemaphore(heap);
+	mm_slab_put(slab, page, mem);
+	mm_givesemaphore(heap);
+
+	return true;
+}
+
+/****************************************************************************
+ * Name: mm_slab_size
+ *
+ * Description:
+ *   Return the usable size of the slab object 'mem', or zero if 'mem' does
+ *   not belong to the slab arena.
+ *
+ ****************************************************************************/
+
+size_t mm_slab_size(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+	FAR struct mm_slabpage_s *page;
+
+	page = mm_slab_page(&heap->mm_slab, mem);
+	if (page == NULL) {
+		return 0;
+	}
+
+	return g_slabsize[page->sclass];
+}
+
+/****************************************************************************
+ * Name: mm_slab_classsize
+ *
+ * Description:
+ *   Return the object size of slab class 'sclass'.
+ *
+ ****************************************************************************/
+
+size_t mm_slab_classsize(int sclass)
+{
+	DEBUGASSERT(sclass >= 0 && sclass < MM_SLAB_NCLASSES);
+	return g_slabsize[sclass];
+}
+
+#ifdef CONFIG_MM_SLAB_MAGAZINE
+/****************************************************************************
+ * Name: mm_magazine_flush
+ *
+ * Description:
+ *   Pass every object cached in the magazine 'mag' to 'release' and empty
+ *   the magazine.  This is called when the owning thread exits, typically
+ *   with sched_ufree() as 'release' so that the objects are freed without
+ *   blocking, or deferred if the heap is busy.
+ *
+ ****************************************************************************/
+
+void mm_magazine_flush(FAR struct mm_magazine_s *mag, CODE void (*release)(FAR void *mem))
+{
+	int sclass;
+
+	for (sclass = 0; sclass < MM_SLAB_NCLASSES; sclass++) {
+		while (mag->count[sclass] > 0) {
+			__atomic_fetch_sub(&mag->heap->mm_slab.magbytes, g_slabsize[sclass], __ATOMIC_RELAXED);
+			release(mag->rounds[sclass][--mag->count[sclass]]);
+		}
+	}
+
+	mag->heap = NULL;
+}
+#endif
+
+#endif /* CONFIG_MM_SLAB */
@@ -0,0 +1,19 @@
+/****************************************************************************
+ * tools/logmbench/arch/irq.h
+ *
+ * Interrupts cannot be disabled on the host.  logmbench.c counts the calls
+ * instead, so that it can tell which logm mode disables interrupts.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_LOGMBENCH_ARCH_IRQ_H
+#define __TOOLS_LOGMBENCH_ARCH_IRQ_H
+
+#include <stdint.h>
+
+typedef uint32_t irqstate_t;
+
+irqstate_t irqsave(void);
+void irqrestore(irqstate_t flags);
+
+#endif							/* __TOOLS_LOGMBENCH_ARCH_IRQ_H */
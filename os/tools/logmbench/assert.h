@@ -0,0 +1,15 @@
+/****************************************************************************
+ * tools/logmbench/assert.h
+ *
+ * Assertions are compiled out in the host build of the logm and stdio
+ * sources, as in a build without CONFIG_DEBUG.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_LOGMBENCH_ASSERT_H
+#define __TOOLS_LOGMBENCH_ASSERT_H
+
+#define ASSERT(f)
+#define DEBUGASSERT(f)
+
+#endif							/* __TOOLS_LOGMBENCH_ASSERT_H */
@@ -0,0 +1,280 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/logmbench/logmbench.c
+ *
+ * Measures on the host what a logm() call costs the caller and how long it
+ * keeps interrupts disabled.  The real os/logm/logm.c is built once with
+ * the text path, which formats with lib/libc/stdio/lib_libvsprintf.c, and
+ * once with CONFIG_LOGM_BINARY, which queues os/logm/logm_binary.c records
+ * that the logm task formats later.  Before the timing, every message of a
+ * set of formats must come out of the logm buffer exactly as vsnprintf()
+ * formats it.  The maxima include the times the host itself interrupts the
+ * benchmark:
+ *
+ *   make -f Makefile.host logmbench
+ *   ./logmbench_text; ./logmbench_binary
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+
+#include <arch/irq.h>
+#include <tinyara/arch.h>
+
+/* Formatted records are written to a memory stream, which the equivalence
+ * check compares with vsnprintf().
+ */
+
+static FILE *g_bench_out;
+
+#undef stdout
+#define stdout g_bench_out
+
+#include "logm.c"
+#ifdef CONFIG_LOGM_BINARY
+#include "logm_binary.c"
+#endif
+
+#undef stdout
+#define stdout stdout
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Calls per batch.  The messages must fit in the logm buffer, since dropped
+ * messages are cheaper than queued ones.
+ */
+
+#define NCALLS         64
+#define NBATCHES       2000
+#define MSGMAX         256
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* Owned by logm_process.c, which also holds the logm task */
+
+uint8_t logm_status;
+int logm_bufsize = LOGM_BUFFER_SIZE;
+char *g_logm_rsvbuf;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int g_irqsaves;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Format all queued messages into buffer, as the logm task would print them */
+
+static void bench_drain(FAR char *buffer, size_t size)
+{
+	FAR char *text;
+	size_t len;
+	int ret;
+
+	g_bench_out = open_memstream(&text, &len);
+	if (g_bench_out == NULL) {
+		perror("open_memstream");
+		exit(EXIT_FAILURE);
+	}
+
+#ifdef CONFIG_LOGM_BINARY
+	logm_binary_flush();
+#else
+	while (g_logm_enqueued_count > 0) {
+		ret = 0;
+		while (g_logm_rsvbuf[(g_logm_head + ret) % logm_bufsize]) {
+			fputc(g_logm_rsvbuf[(g_logm_head + ret++) % logm_bufsize], g_bench_out);
+		}
+
+		g_logm_head = (g_logm_head + ret + 1) % logm_bufsize;
+		g_logm_available += ret + 1;
+		g_logm_enqueued_count--;
+	}
+#endif
+
+	fclose(g_bench_out);
+	ret = snprintf(buffer, size, "%s", text);
+	free(text);
+
+	if (ret >= size) {
+		fprintf(stderr, "ERROR: %d bytes of messages do not fit\n", ret);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/* Queue one message and compare what logm prints with vsnprintf() */
+
+static void bench_check(FAR const char *fmt, ...)
+{
+	char expect[MSGMAX];
+	char actual[MSGMAX];
+	va_list ap;
+
+	va_start(ap, fmt);
+	vsnprintf(expect, sizeof(expect), fmt, ap);
+	va_end(ap);
+
+	va_start(ap, fmt);
+	logm_internal(LOGM_DEF_PRIORITY, fmt, ap);
+	va_end(ap);
+
+	bench_drain(actual, sizeof(actual));
+	if (strcmp(expect, actual) != 0) {
+		fprintf(stderr, "ERROR: \"%s\" printed \"%s\", expected \"%s\"\n", fmt, actual, expect);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* Interrupts are only counted, see arch/irq.h */
+
+irqstate_t irqsave(void)
+{
+	g_irqsaves++;
+	return 0;
+}
+
+void irqrestore(irqstate_t flags)
+{
+}
+
+bool up_interrupt_context(void)
+{
+	return false;
+}
+
+uint32_t up_perf_gettime(void)
+{
+	return (uint32_t)bench_nsec();
+}
+
+uint32_t up_perf_getfreq(void)
+{
+	return 1000000000;
+}
+
+int main(int argc, char **argv)
+{
+	char drained[LOGM_BUFFER_SIZE];
+	uint64_t total = 0;
+	uint64_t start;
+	uint32_t elapsed;
+	uint32_t min = UINT32_MAX;
+	uint32_t max = 0;
+	int batch;
+	int i;
+
+#ifdef CONFIG_LOGM_BINARY
+	logm_bufsize &= ~(LOGM_RECORD_ALIGN - 1);
+#endif
+	g_logm_rsvbuf = calloc(1, logm_bufsize);
+	if (g_logm_rsvbuf == NULL) {
+		perror("calloc");
+		return EXIT_FAILURE;
+	}
+
+	g_logm_available = logm_bufsize;
+	g_logm_overflow_offset = -1;
+	LOGM_STATUS_SET(LOGM_READY);
+
+	/* Conversions that both formatters support.  lib_vsprintf() ignores the
+	 * precision of strings.
+	 */
+
+	bench_check("plain text\n");
+	bench_check("logm bench %d %s %d\n", 7, "call", 123);
+	bench_check("[%5d|%-5d|%05d|%+d]\n", 42, -42, 42, 42);
+	bench_check("%x %X %#x %o %u %c%%\n", 0xbeefu, 0xbeefu, 255u, 8u, 4000000000u, 'z');
+	bench_check("%ld %lu %lx\n", -1234567890L, 3000000000UL, 0xdeadbeefUL);
+	bench_check("%lld %llu\n", -1234567890123LL, 18000000000000000000ULL);
+	bench_check("%*d|%-*d|%0*d|%.*f\n", 6, 13, 4, 7, 5, -9, 3, 2.25);
+	bench_check("%8s|%-8s|%s\n", "right", "left", "");
+	bench_check("%.2f %8.3f %-8.1f|\n", 3.14159, -2.5, 100.25);
+	bench_check("%s=%d, %s=%d, %s=%d\n", "a", 1, "b", 2, "c", 3);
+
+	/* Time calls in batches that fit the buffer and drain it in between */
+
+	g_logm_irqoff_max = 0;
+	g_irqsaves = 0;
+
+	for (batch = 0; batch < NBATCHES; batch++) {
+		for (i = 0; i < NCALLS; i++) {
+			start = bench_nsec();
+			logm(1, 0, 3, "logm bench %d %s %d\n", i, "call", batch);
+			elapsed = bench_nsec() - start;
+
+			total += elapsed;
+			if (elapsed < min) {
+				min = elapsed;
+			}
+
+			if (elapsed > max) {
+				max = elapsed;
+			}
+		}
+
+		bench_drain(drained, sizeof(drained));
+	}
+
+	if (g_logm_dropmsg_count > 0) {
+		fprintf(stderr, "ERROR: %d messages were dropped\n", g_logm_dropmsg_count);
+		return EXIT_FAILURE;
+	}
+
+#ifdef CONFIG_LOGM_BINARY
+	printf("logm binary mode, %d calls\n", NCALLS * NBATCHES);
+#else
+	printf("logm text mode, %d calls\n", NCALLS * NBATCHES);
+#endif
+	printf("%-24s %8u\n", "Min ns per call", min);
+	printf("%-24s %8.1f\n", "Avg ns per call", (double)total / (NCALLS * NBATCHES));
+	printf("%-24s %8u\n", "Max ns per call", max);
+	printf("%-24s %8d\n", "Interrupts disabled", g_irqsaves);
+	printf("%-24s %8u\n", "Max ns IRQ off", g_logm_irqoff_max);
+
+	return EXIT_SUCCESS;
+}
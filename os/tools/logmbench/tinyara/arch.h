@@ -0,0 +1,19 @@
+/****************************************************************************
+ * tools/logmbench/tinyara/arch.h
+ *
+ * The performance counter that logm and the formatter use, provided by
+ * logmbench.c from the host monotonic clock in nanoseconds.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_LOGMBENCH_TINYARA_ARCH_H
+#define __TOOLS_LOGMBENCH_TINYARA_ARCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+bool up_interrupt_context(void);
+uint32_t up_perf_gettime(void);
+uint32_t up_perf_getfreq(void);
+
+#endif							/* __TOOLS_LOGMBENCH_TINYARA_ARCH_H */
@@ -0,0 +1,26 @@
+/****************************************************************************
+ * tools/logmbench/tinyara/config.h
+ *
+ * Stands in for the generated configuration when the logm sources are
+ * built on the host by logmbench.  CONFIG_LOGM_BINARY is set on the command
+ * line.  The test and performance counter options turn on the measurement
+ * of the time spent with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_LOGMBENCH_TINYARA_CONFIG_H
+#define __TOOLS_LOGMBENCH_TINYARA_CONFIG_H
+
+#define CONFIG_LOGM_TEST 1
+#define CONFIG_ARCH_HAVE_PERF_EVENTS 1
+#define CONFIG_LOGM_BUFFER_SIZE 10240
+#define CONFIG_LOGM_BINARY_ARGSIZE 64
+#define CONFIG_LOGM_BINARY_STRMAX 32
+#define CONFIG_LIBC_FLOATINGPOINT 1
+#define CONFIG_HAVE_LONG_LONG 1
+
+/* From the TinyAra sys/types.h, which the host one replaces */
+
+#define OK 0
+
+#endif							/* __TOOLS_LOGMBENCH_TINYARA_CONFIG_H */
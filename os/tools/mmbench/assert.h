@@ -0,0 +1,16 @@
+/****************************************************************************
+ * tools/mmbench/assert.h
+ *
+ * Assertions are compiled out in the host build of the heap, as in a
+ * build without CONFIG_DEBUG.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_MMBENCH_ASSERT_H
+#define __TOOLS_MMBENCH_ASSERT_H
+
+#define ASSERT(f)
+#define DEBUGASSERT(f)
+#define DEBUGVERIFY(f)         ((void)(f))
+
+#endif							/* __TOOLS_MMBENCH_ASSERT_H */
@@ -0,0 +1,22 @@
+/****************************************************************************
+ * tools/mmbench/debug.h
+ *
+ * Debug output is compiled out in the host build of the heap, as in a
+ * build without CONFIG_DEBUG.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_MMBENCH_DEBUG_H
+#define __TOOLS_MMBENCH_DEBUG_H
+
+#define OK                     0
+#define ERROR                  -1
+
+#define dbg(...)
+#define lldbg(...)
+#define mdbg(...)
+#define mvdbg(...)
+#define mlldbg(...)
+#define mllvdbg(...)
+
+#endif							/* __TOOLS_MMBENCH_DEBUG_H */
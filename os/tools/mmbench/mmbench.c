@@ -0,0 +1,244 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/mmbench/mmbench.c
+ *
+ * Measures on the host what small allocations cost and how much they
+ * fragment the heap.  The real mm/mm_heap sources manage a static arena.
+ * A fixed set of slots is churned: a random slot that holds an object is
+ * freed, an empty one gets a new object of a random size.  The workloads
+ * differ in their mix of sizes.  After each one, the free chunks of the
+ * heap are walked to find the largest allocation that would still
+ * succeed.  The first and last byte of every object are tagged with its
+ * address and checked before it is freed.  The heap is built once as it is and once
+ * with CONFIG_MM_SLAB:
+ *
+ *   make -f Makefile.host mmbench
+ *   ./mmbench_heap; ./mmbench_slab
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <debug.h>
+
+#include <tinyara/mm/mm.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define HEAPSIZE       (96 * 1024)
+#define NSLOTS         400
+#define NOPS           2000000
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_slot_s {
+	FAR uint8_t *mem;
+	size_t size;
+};
+
+struct bench_load_s {
+	FAR const char *name;
+	int small;					/* Percent of objects of 1..64 bytes */
+	int medium;					/* Percent of objects of 65..256 bytes */
+	/* The rest are 257..2048 bytes */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct bench_load_s g_loads[] = {
+	{ "Small", 100, 0 },
+	{ "Small+medium", 70, 30 },
+	{ "Mixed", 60, 25 },
+};
+
+static uint64_t g_arena[HEAPSIZE / sizeof(uint64_t)];
+static struct mm_heap_s g_heap;
+static struct bench_slot_s g_slots[NSLOTS];
+static uint32_t g_seed = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static unsigned int bench_random(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return g_seed >> 8;
+}
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static size_t bench_size(FAR const struct bench_load_s *load)
+{
+	unsigned int pick = bench_random() % 100;
+
+	if (pick < load->small) {
+		return 1 + bench_random() % 64;
+	} else if (pick < load->small + load->medium) {
+		return 65 + bench_random() % 192;
+	}
+
+	return 257 + bench_random() % 1792;
+}
+
+/* Release an object after checking that its ends were not overwritten */
+
+static void bench_free(FAR struct bench_slot_s *slot)
+{
+	uint8_t tag = (uint8_t)((uintptr_t)slot->mem >> 4);
+
+	if (slot->mem[0] != tag || slot->mem[slot->size - 1] != tag) {
+		fprintf(stderr, "ERROR: object %p of %lu bytes was overwritten\n", slot->mem, (unsigned long)slot->size);
+		exit(EXIT_FAILURE);
+	}
+
+	mm_free(&g_heap, slot->mem);
+	slot->mem = NULL;
+}
+
+/* Walk the free chunks of the heap */
+
+static void bench_freechunks(FAR size_t *total, FAR size_t *largest)
+{
+	FAR struct mm_freenode_s *node;
+
+	*total = 0;
+	*largest = 0;
+	for (node = g_heap.mm_nodelist[0].flink; node != NULL; node = node->flink) {
+		*total += node->size;
+		if (node->size > *largest) {
+			*largest = node->size;
+		}
+	}
+}
+
+static void bench_run(FAR const struct bench_load_s *load)
+{
+	FAR struct bench_slot_s *slot;
+	uint64_t elapsed;
+	uint64_t start;
+	uint32_t failed = 0;
+	size_t largest;
+	size_t live = 0;
+	size_t total;
+	size_t x;
+	int op;
+
+	g_seed = 1;
+	memset(g_slots, 0, sizeof(g_slots));
+	mm_initialize(&g_heap, g_arena, sizeof(g_arena));
+
+	start = bench_nsec();
+	for (op = 0; op < NOPS; op++) {
+		slot = &g_slots[bench_random() % NSLOTS];
+		if (slot->mem != NULL) {
+			bench_free(slot);
+			continue;
+		}
+
+		slot->size = bench_size(load);
+		slot->mem = mm_malloc(&g_heap, slot->size);
+		if (slot->mem == NULL) {
+			failed++;
+			continue;
+		}
+
+		slot->mem[0] = (uint8_t)((uintptr_t)slot->mem >> 4);
+		slot->mem[slot->size - 1] = slot->mem[0];
+	}
+
+	elapsed = bench_nsec() - start;
+
+	for (x = 0; x < NSLOTS; x++) {
+		if (g_slots[x].mem != NULL) {
+			live += g_slots[x].size;
+		}
+	}
+
+	bench_freechunks(&total, &largest);
+	printf("%-14s %10.1f %8u %10lu %10lu %10lu\n", load->name, (double)elapsed / NOPS, failed, (unsigned long)live, (unsigned long)total, (unsigned long)largest);
+
+	for (x = 0; x < NSLOTS; x++) {
+		if (g_slots[x].mem != NULL) {
+			bench_free(&g_slots[x]);
+		}
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* The benchmark is single threaded */
+
+void mm_seminitialize(FAR struct mm_heap_s *heap)
+{
+}
+
+int mm_trysemaphore(FAR struct mm_heap_s *heap)
+{
+	return OK;
+}
+
+void mm_takesemaphore(FAR struct mm_heap_s *heap)
+{
+}
+
+void mm_givesemaphore(FAR struct mm_heap_s *heap)
+{
+}
+
+int main(int argc, char **argv)
+{
+	int x;
+
+#ifdef CONFIG_MM_SLAB
+	printf("Heap of %d KiB with a %d KiB slab arena, %d slots\n", HEAPSIZE / 1024, CONFIG_MM_SLAB_SIZE / 1024, NSLOTS);
+#else
+	printf("Heap of %d KiB, %d slots\n", HEAPSIZE / 1024, NSLOTS);
+#endif
+	printf("%-14s %10s %8s %10s %10s %10s\n", "Workload", "ns/op", "Failed", "Live", "Free", "Largest");
+
+	for (x = 0; x < sizeof(g_loads) / sizeof(g_loads[0]); x++) {
+		bench_run(&g_loads[x]);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,14 @@
+/****************************************************************************
+ * tools/mmbench/os_trace_events_tizenrt.h
+ *
+ * Trace points are compiled out in the host build of mmbench.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_MMBENCH_OS_TRACE_EVENTS_TIZENRT_H
+#define __TOOLS_MMBENCH_OS_TRACE_EVENTS_TIZENRT_H
+
+#define OS_TRACE_MEM_ALLOC(mem, size, caller)
+#define OS_TRACE_MEM_FREE(mem, caller)
+
+#endif							/* __TOOLS_MMBENCH_OS_TRACE_EVENTS_TIZENRT_H */
@@ -0,0 +1,17 @@
+/****************************************************************************
+ * tools/mmbench/tinyara/config.h
+ *
+ * Stands in for the generated configuration when the heap sources are
+ * built on the host by mmbench.  CONFIG_MM_SLAB is set on the command
+ * line.  CONFIG_HAVE_LONG_LONG selects 32 byte minimum chunks, which a
+ * free node needs with the 8 byte pointers of the host.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_MMBENCH_TINYARA_CONFIG_H
+#define __TOOLS_MMBENCH_TINYARA_CONFIG_H
+
+#define CONFIG_MM_REGIONS 1
+#define CONFIG_HAVE_LONG_LONG 1
+
+#endif							/* __TOOLS_MMBENCH_TINYARA_CONFIG_H */
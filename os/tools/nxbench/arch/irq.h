@@ -0,0 +1,12 @@
+/****************************************************************************
+ * tools/nxbench/arch/irq.h
+ *
+ * The LCD drivers include the architecture interrupt definitions, but use
+ * none of them on the host.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_ARCH_IRQ_H
+#define __TOOLS_NXBENCH_ARCH_IRQ_H
+
+#endif							/* __TOOLS_NXBENCH_ARCH_IRQ_H */
@@ -0,0 +1,16 @@
+/****************************************************************************
+ * tools/nxbench/assert.h
+ *
+ * Assertions are compiled out in the host build of the graphics sources,
+ * as in a build without CONFIG_DEBUG.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_ASSERT_H
+#define __TOOLS_NXBENCH_ASSERT_H
+
+#define ASSERT(f)
+#define DEBUGASSERT(f)
+#define DEBUGVERIFY(f)         ((void)(f))
+
+#endif							/* __TOOLS_NXBENCH_ASSERT_H */
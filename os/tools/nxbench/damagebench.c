@@ -0,0 +1,340 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/nxbench/damagebench.c
+ *
+ * Measures on the host how the VNC updater coalesces damage.  The real
+ * graphics/vnc/server/vnc_updater.c is built into the benchmark with the
+ * encoders replaced by counters.  Workloads of typing, window drags,
+ * widget redraws and random updates are queued with vnc_update_rectangle()
+ * and the damage is taken every few updates, as the updater would between
+ * two sends.  The pixels and rectangles encoded are compared with those of
+ * sending every queued rectangle as it came, and with the pixels that were
+ * actually damaged.  Every snapshot is checked to cover each damaged pixel
+ * exactly once:
+ *
+ *   make -f Makefile.host damagebench
+ *   ./damagebench
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <debug.h>
+
+/* The updater is built into the benchmark, which needs its static damage
+ * functions.
+ */
+
+typedef FAR void *pthread_addr_t;
+
+static int sched_lock(void)
+{
+	return 0;
+}
+
+static int sched_unlock(void)
+{
+	return 0;
+}
+
+#include "vnc_updater.c"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define XRES           CONFIG_VNCSERVER_SCREENWIDTH
+#define YRES           CONFIG_VNCSERVER_SCREENHEIGHT
+#define MAXUPDATES     1000
+#define NPASSES        200
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_workload_s {
+	FAR const char *name;
+	int nupdates;              /* Updates queued */
+	int period;                /* Updates between two snapshots */
+	struct nxgl_rect_s rects[MAXUPDATES];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct vnc_session_s g_session;
+static struct bench_workload_s g_workload;
+static uint8_t g_dirty[YRES][XRES];
+static uint32_t g_dirtied;
+static uint32_t g_encoded;
+static uint32_t g_nencoded;
+static uint32_t g_seed = 1;
+static bool g_check;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static unsigned int bench_random(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return g_seed >> 8;
+}
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void bench_fail(FAR const char *what, int ret)
+{
+	fprintf(stderr, "ERROR: %s failed: %d\n", what, ret);
+	exit(EXIT_FAILURE);
+}
+
+static uint32_t bench_area(FAR const struct nxgl_rect_s *rect)
+{
+	return (uint32_t)(rect->pt2.x - rect->pt1.x + 1) * (uint32_t)(rect->pt2.y - rect->pt1.y + 1);
+}
+
+/* The encoders only count what they are given */
+
+int vnc_rre(FAR struct vnc_session_s *session, FAR struct nxgl_rect_s *rect)
+{
+	return 0;
+}
+
+int vnc_raw(FAR struct vnc_session_s *session, FAR struct nxgl_rect_s *rect)
+{
+	g_encoded += bench_area(rect);
+	g_nencoded++;
+	return 1;
+}
+
+static void bench_add(int x, int y, int width, int height)
+{
+	FAR struct nxgl_rect_s *rect = &g_workload.rects[g_workload.nupdates++];
+
+	rect->pt1.x = x;
+	rect->pt1.y = y;
+	rect->pt2.x = x + width - 1;
+	rect->pt2.y = y + height - 1;
+}
+
+static void bench_workload(int n)
+{
+	int x;
+	int y;
+
+	g_workload.nupdates = 0;
+
+	switch (n) {
+	case 0:
+		/* Typing:  a glyph, then the cursor after it */
+
+		g_workload.name = "Typing";
+		g_workload.period = 8;
+		for (x = 0; g_workload.nupdates < 400; x++) {
+			bench_add(16 + (x % 48) * 6, 20 + (x / 48) * 13, 6, 13);
+			bench_add(22 + (x % 48) * 6, 20 + (x / 48) * 13, 2, 13);
+		}
+		break;
+
+	case 1:
+		/* A 150x120 window dragged:  where it was and where it is */
+
+		g_workload.name = "Drag";
+		g_workload.period = 4;
+		for (x = 0; x < 100; x++) {
+			bench_add(10 + x, 10 + x / 2, 150, 120);
+			bench_add(12 + x, 11 + x / 2, 150, 120);
+		}
+		break;
+
+	case 2:
+		/* A dialog redrawn:  each button, its label and its borders */
+
+		g_workload.name = "Widgets";
+		g_workload.period = 24;
+		for (y = 0; y < 4; y++) {
+			for (x = 0; x < 4; x++) {
+				bench_add(20 + x * 70, 40 + y * 40, 60, 20);
+				bench_add(30 + x * 70, 43 + y * 40, 40, 13);
+				bench_add(20 + x * 70, 40 + y * 40, 60, 1);
+				bench_add(20 + x * 70, 59 + y * 40, 60, 1);
+				bench_add(20 + x * 70, 40 + y * 40, 1, 20);
+				bench_add(79 + x * 70, 40 + y * 40, 1, 20);
+			}
+		}
+		break;
+
+	default:
+		/* Random rectangles, taken often or by a slow client */
+
+		g_workload.name = n == 3 ? "Random" : "Slow";
+		g_workload.period = n == 3 ? 16 : 200;
+		g_seed = 1;
+		while (g_workload.nupdates < MAXUPDATES) {
+			x = bench_random() % XRES;
+			y = bench_random() % YRES;
+			bench_add(x, y, 1 + bench_random() % 80, 1 + bench_random() % 60);
+		}
+		break;
+	}
+}
+
+/* Check that the damage covers every dirty pixel exactly once */
+
+static void bench_snapshot(void)
+{
+	FAR struct nxgl_rect_s *rect;
+	int nrects;
+	int x;
+	int y;
+	int i;
+
+	nrects = vnc_take_damage(&g_session);
+
+	for (i = 0; i < nrects; i++) {
+		rect = &g_session.snapshot[i];
+		vnc_encode(&g_session, rect);
+
+		if (g_check) {
+			for (y = rect->pt1.y; y <= rect->pt2.y; y++) {
+				for (x = rect->pt1.x; x <= rect->pt2.x; x++) {
+					if (g_dirty[y][x] == 1) {
+						g_dirtied++;
+					} else if (g_dirty[y][x] == 2) {
+						fprintf(stderr, "ERROR: (%d,%d) is sent twice in %s\n", x, y, g_workload.name);
+						exit(EXIT_FAILURE);
+					}
+
+					g_dirty[y][x] = 2;
+				}
+			}
+		}
+	}
+
+	if (g_check) {
+		for (y = 0; y < YRES; y++) {
+			for (x = 0; x < XRES; x++) {
+				if (g_dirty[y][x] == 1) {
+					fprintf(stderr, "ERROR: (%d,%d) is not sent in %s\n", x, y, g_workload.name);
+					exit(EXIT_FAILURE);
+				}
+			}
+		}
+
+		memset(g_dirty, 0, sizeof(g_dirty));
+	}
+}
+
+static void bench_run(void)
+{
+	FAR struct nxgl_rect_s *rect;
+	int ret;
+	int x;
+	int y;
+	int i;
+
+	memset(&g_session, 0, sizeof(g_session));
+	g_dirtied = 0;
+	g_encoded = 0;
+	g_nencoded = 0;
+
+	for (i = 0; i < g_workload.nupdates; i++) {
+		rect = &g_workload.rects[i];
+		ret = vnc_update_rectangle(&g_session, rect, true);
+		if (ret < 0) {
+			bench_fail("vnc_update_rectangle", ret);
+		}
+
+		if (g_check) {
+			for (y = rect->pt1.y; y <= rect->pt2.y && y < YRES; y++) {
+				for (x = rect->pt1.x; x <= rect->pt2.x && x < XRES; x++) {
+					g_dirty[y][x] = 1;
+				}
+			}
+		}
+
+		if ((i + 1) % g_workload.period == 0 || i + 1 == g_workload.nupdates) {
+			bench_snapshot();
+		}
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+	struct nxgl_rect_s clipped;
+	uint32_t queued;
+	uint32_t dirtied;
+	uint64_t start;
+	uint64_t elapsed;
+	int pass;
+	int n;
+	int i;
+
+	printf("VNC damage, %d rectangles at most, %dx%d screen\n", CONFIG_VNCSERVER_NUPDATES, XRES, YRES);
+	printf("%-8s %7s %6s %10s %10s %10s %7s %6s %6s %9s\n", "Workload", "Updates", "Period", "Queued px", "Dirty px", "Sent px", "Queued", "Sent", "Depth", "ns/update");
+
+	for (n = 0; n < 5; n++) {
+		bench_workload(n);
+
+		/* What sending every update as it came would cost */
+
+		queued = 0;
+		for (i = 0; i < g_workload.nupdates; i++) {
+			nxgl_rectintersect(&clipped, &g_workload.rects[i], &g_wholescreen);
+			queued += bench_area(&clipped);
+		}
+
+		g_check = true;
+		bench_run();
+		dirtied = g_dirtied;
+
+		g_check = false;
+		start = bench_nsec();
+		for (pass = 0; pass < NPASSES; pass++) {
+			bench_run();
+		}
+
+		elapsed = bench_nsec() - start;
+
+		printf("%-8s %7d %6d %10u %10u %10u %7d %6u %6u %9.1f\n", g_workload.name, g_workload.nupdates, g_workload.period, queued, dirtied, g_encoded, g_workload.nupdates, g_nencoded, g_session.stats.maxdepth, (double)elapsed / NPASSES / g_workload.nupdates);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,45 @@
+/****************************************************************************
+ * tools/nxbench/debug.h
+ *
+ * Debug output and assertions are compiled out in the graphics benchmarks,
+ * as in a build without CONFIG_DEBUG.  This also provides the few
+ * definitions that the drivers and libraries get from other target
+ * headers.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_DEBUG_H
+#define __TOOLS_NXBENCH_DEBUG_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#define OK                     0
+#define ERROR                  -1
+#define TRUE                   1
+#define FALSE                  0
+
+#define dbg(...)
+#define vdbg(...)
+#define lldbg(...)
+#define llvdbg(...)
+#define gdbg(...)
+#define gvdbg(...)
+#define gerr(...)
+#define gwarn(...)
+#define ginfo(...)
+#define lcderr(...)
+#define lcdwarn(...)
+#define lcdinfo(...)
+#define DEBUGASSERT(f)
+#define ASSERT(f)
+#define PANIC()                abort()
+#define UNUSED(a)              ((void)(a))
+
+#define get_errno()            (errno)
+#define set_errno(e)           do { errno = (e); } while (0)
+#define get_errno_ptr()        (&errno)
+
+#define zalloc(s)              calloc(1, s)
+
+#endif							/* __TOOLS_NXBENCH_DEBUG_H */
@@ -0,0 +1,222 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/nxbench/fontbench.c
+ *
+ * Measures on the host what looking up glyphs in the NX font cache costs.
+ * The real libnx/nxfonts cache, font tables and 16bpp renderer are built
+ * with the X11 misc fixed 6x13 font.  A terminal style text of prose, C
+ * source and log lines is put through nxf_cache_getglyph() for several
+ * cache sizes, and the hit rate and the time per glyph are printed.  Every
+ * glyph returned is checked against one rendered in a cache that holds the
+ * whole font:
+ *
+ *   make -f Makefile.host fontbench
+ *   ./fontbench
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <debug.h>
+
+#include <tinyara/nx/nxfonts.h>
+
+#include "nxcontext.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define NPASSES        200
+#define FGCOLOR        0xffff
+#define BGCOLOR        0x0000
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+uint32_t g_nxbench_mallocs;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char g_text[] =
+	"The SMART MTD layer maps logical sectors to physical ones, so that a\n"
+	"sector can be rewritten without erasing its whole block first.  When\n"
+	"too few free sectors are left, the block with the most released\n"
+	"sectors is relocated and erased.\n"
+	"static int ra8875_putrun(fb_coord_t row, fb_coord_t col,\n"
+	"                         FAR const uint8_t *buffer, size_t npixels)\n"
+	"{\n"
+	"  FAR struct ra8875_dev_s *priv = &g_lcddev;\n"
+	"  int i;\n"
+	"\n"
+	"  for (i = 0; i < npixels; i++)\n"
+	"    {\n"
+	"      lcd->pwrite_data16(lcd, src[i]);\n"
+	"    }\n"
+	"}\n"
+	"[   12.345678] wlan0: associated with 00:1a:2b:3c:4d:5e (ch 6)\n"
+	"[   12.400213] dhcpc: lease 192.168.0.42/24 gw 192.168.0.1 DNS OK\n"
+	"[   13.002951] mqtt: connected to broker.example.org:1883, QoS=1\n"
+	"TASH>> ps\n"
+	"  PID | PRIO | FLAG |  TYPE   | NP |  STATUS  | NAME\n"
+	"------|------|------|---------|----|----------|----------\n"
+	"    0 |    0 | FIFO | KTHREAD |    | READY    | Idle Task\n"
+	"    1 |  224 | RR   | KTHREAD |    | WAITSIG  | hpwork\n"
+	"    3 |  100 | RR   | TASK    |    | RUNNING  | tash\n";
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void bench_fail(FAR const char *what, int ret)
+{
+	fprintf(stderr, "ERROR: %s failed: %d\n", what, ret);
+	exit(EXIT_FAILURE);
+}
+
+/* Spaces have no glyph in the font; nxterm fills them with the background */
+
+static bool bench_isglyph(char ch)
+{
+	return ch != ' ' && ch != '\n';
+}
+
+static void bench_check(FAR const struct nxfonts_glyph_s *glyph, FAR const struct nxfonts_glyph_s *ref, uint8_t ch)
+{
+	if (glyph == NULL || glyph->code != ch || glyph->width != ref->width || glyph->height != ref->height || glyph->stride != ref->stride || memcmp(glyph->bitmap, ref->bitmap, glyph->stride * glyph->height) != 0) {
+		fprintf(stderr, "ERROR: glyph of code %02x is wrong\n", ch);
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void bench_run(int maxglyphs, FAR const struct nxfonts_glyph_s **ref)
+{
+	FAR const struct nxfonts_glyph_s *glyph;
+	FCACHE fcache;
+	uint64_t elapsed;
+	uint64_t start;
+	uint32_t nglyphs = 0;
+	uint32_t misses;
+	int pass;
+	int x;
+
+	fcache = nxf_cache_connect(FONTID_X11_MISC_FIXED_6X13, FGCOLOR, BGCOLOR, 16, maxglyphs);
+	if (fcache == NULL) {
+		bench_fail("nxf_cache_connect", -errno);
+	}
+
+	/* Timed without the checks */
+
+	misses = g_nxbench_mallocs;
+	start = bench_nsec();
+	for (pass = 0; pass < NPASSES; pass++) {
+		for (x = 0; g_text[x] != '\0'; x++) {
+			if (bench_isglyph(g_text[x]) && nxf_cache_getglyph(fcache, g_text[x]) != NULL) {
+				nglyphs++;
+			}
+		}
+	}
+
+	elapsed = bench_nsec() - start;
+	misses = g_nxbench_mallocs - misses;
+
+	/* The same text again, checking every glyph */
+
+	for (x = 0; g_text[x] != '\0'; x++) {
+		if (bench_isglyph(g_text[x])) {
+			glyph = nxf_cache_getglyph(fcache, g_text[x]);
+			bench_check(glyph, ref[(uint8_t)g_text[x]], g_text[x]);
+		}
+	}
+
+	printf("%10d %10.1f%% %10u %10.1f\n", maxglyphs, 100.0 * (nglyphs - misses) / nglyphs, misses, (double)elapsed / nglyphs);
+
+	nxf_cache_disconnect(fcache);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+	static const int sizes[] = { 8, 16, 32, 48, 64, 96 };
+	FAR const struct nxfonts_glyph_s *ref[256];
+	FAR const struct nxfonts_glyph_s *glyph;
+	FAR struct nxfonts_glyph_s *copy;
+	FCACHE fcache;
+	size_t size;
+	int x;
+
+	/* Copies of reference glyphs, from a cache that never evicts */
+
+	fcache = nxf_cache_connect(FONTID_X11_MISC_FIXED_6X13, FGCOLOR, BGCOLOR, 16, 255);
+	if (fcache == NULL) {
+		bench_fail("nxf_cache_connect", -errno);
+	}
+
+	memset(ref, 0, sizeof(ref));
+	for (x = 0; g_text[x] != '\0'; x++) {
+		if (bench_isglyph(g_text[x]) && ref[(uint8_t)g_text[x]] == NULL) {
+			glyph = nxf_cache_getglyph(fcache, g_text[x]);
+			if (glyph == NULL) {
+				bench_fail("nxf_cache_getglyph", g_text[x]);
+			}
+
+			size = SIZEOF_NXFONTS_GLYPH_S(glyph->stride * glyph->height);
+			copy = malloc(size);
+			if (copy == NULL) {
+				bench_fail("malloc", -ENOMEM);
+			}
+
+			memcpy(copy, glyph, size);
+			ref[(uint8_t)g_text[x]] = copy;
+		}
+	}
+
+	nxf_cache_disconnect(fcache);
+
+	printf("NX font cache, %lu characters per pass, %d passes\n", (unsigned long)strlen(g_text), NPASSES);
+	printf("%10s %11s %10s %10s\n", "Glyphs", "Hit rate", "Renders", "ns/glyph");
+
+	for (x = 0; x < sizeof(sizes) / sizeof(sizes[0]); x++) {
+		bench_run(sizes[x], ref);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,457 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/nxbench/ili9341bench.c
+ *
+ * Measures on the host how many bus transactions pixel runs cost on the
+ * ILI9341.  The real drivers/lcd/ili9341.c runs on a mock lower half that
+ * counts commands, parameter bytes and gram transfers, and that keeps the
+ * column and page window and the gram of the controller.  Each frame is
+ * drawn once with the address window closed before every run, which sets a
+ * new window per row as before, and once with the window left open for the
+ * next row of a rectangle.  Both must leave the gram the same as the image
+ * that was drawn, and the counters of ILI9341IOC_GETSTATS must agree with
+ * the mock:
+ *
+ *   make -f Makefile.host ili9341bench
+ *   ./ili9341bench
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <debug.h>
+
+#include <tinyara/lcd/lcd.h>
+#include <tinyara/lcd/ili9341.h>
+
+/* The driver is built into the benchmark, which needs its static device
+ * structure to close the address window.
+ */
+
+#include "lcd/ili9341.c"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define XRES           320
+#define YRES           240
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The mock lower half and the state of the controller behind it */
+
+struct bench_lcd_s {
+	struct ili9341_lcd_s dev;	/* Lower half interface, must be first */
+
+	/* Controller state */
+
+	uint8_t cmd;				/* Last command */
+	uint8_t nparams;			/* Parameters received for it */
+	uint8_t params[4];			/* The first parameters */
+	bool writing;				/* Gram writes may continue */
+	uint16_t sc;				/* Column window */
+	uint16_t ec;
+	uint16_t sp;				/* Page window */
+	uint16_t ep;
+	uint16_t x;					/* Next gram position */
+	uint16_t y;
+	uint16_t gram[YRES][XRES];
+
+	/* Counters */
+
+	uint32_t selects;			/* Select/deselect cycles */
+	uint32_t cmds;				/* Command bytes */
+	uint32_t params_sent;		/* Parameter bytes */
+	uint32_t grams;				/* sendgram() calls */
+	uint32_t words;				/* Pixels sent */
+	uint32_t errors;			/* Gram writes the driver got wrong */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct bench_lcd_s g_mock;
+static uint16_t g_image[YRES][XRES];
+static uint16_t g_pixels[XRES];
+static uint32_t g_seed = 1;
+static bool g_perrow;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static unsigned int bench_random(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return g_seed >> 8;
+}
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void bench_fail(FAR const char *what, int ret)
+{
+	fprintf(stderr, "ERROR: %s failed: %d\n", what, ret);
+	exit(EXIT_FAILURE);
+}
+
+/* Mock lower half */
+
+static void mock_select(FAR struct ili9341_lcd_s *lcd)
+{
+	g_mock.selects++;
+}
+
+static void mock_deselect(FAR struct ili9341_lcd_s *lcd)
+{
+}
+
+static int mock_sendcmd(FAR struct ili9341_lcd_s *lcd, const uint8_t cmd)
+{
+	g_mock.cmds++;
+	g_mock.cmd = cmd;
+	g_mock.nparams = 0;
+
+	switch (cmd) {
+	case ILI9341_MEMORY_WRITE:
+		g_mock.x = g_mock.sc;
+		g_mock.y = g_mock.sp;
+		g_mock.writing = true;
+		break;
+
+	case ILI9341_WRITE_MEMORY_CONTINUE:
+		/* Only continues a write that no other command has broken */
+
+		if (!g_mock.writing) {
+			g_mock.errors++;
+		}
+		break;
+
+	default:
+		g_mock.writing = false;
+		break;
+	}
+
+	return OK;
+}
+
+static int mock_sendparam(FAR struct ili9341_lcd_s *lcd, const uint8_t param)
+{
+	g_mock.params_sent++;
+	if (g_mock.nparams < 4) {
+		g_mock.params[g_mock.nparams] = param;
+	}
+
+	if (++g_mock.nparams == 4) {
+		if (g_mock.cmd == ILI9341_COLUMN_ADDRESS_SET) {
+			g_mock.sc = g_mock.params[0] << 8 | g_mock.params[1];
+			g_mock.ec = g_mock.params[2] << 8 | g_mock.params[3];
+		} else if (g_mock.cmd == ILI9341_PAGE_ADDRESS_SET) {
+			g_mock.sp = g_mock.params[0] << 8 | g_mock.params[1];
+			g_mock.ep = g_mock.params[2] << 8 | g_mock.params[3];
+		}
+	}
+
+	return OK;
+}
+
+static int mock_recvparam(FAR struct ili9341_lcd_s *lcd, uint8_t *param)
+{
+	*param = 0;
+	return OK;
+}
+
+static int mock_recvgram(FAR struct ili9341_lcd_s *lcd, uint16_t *wd, uint32_t nwords)
+{
+	memset(wd, 0, nwords * sizeof(uint16_t));
+	return OK;
+}
+
+static int mock_sendgram(FAR struct ili9341_lcd_s *lcd, const uint16_t *wd, uint32_t nwords)
+{
+	uint32_t i;
+
+	g_mock.grams++;
+	g_mock.words += nwords;
+
+	if (!g_mock.writing) {
+		g_mock.errors++;
+		return OK;
+	}
+
+	/* The controller fills the window column by column, then page by page */
+
+	for (i = 0; i < nwords; i++) {
+		if (g_mock.x >= XRES || g_mock.y >= YRES) {
+			g_mock.errors++;
+		} else {
+			g_mock.gram[g_mock.y][g_mock.x] = wd[i];
+		}
+
+		if (++g_mock.x > g_mock.ec) {
+			g_mock.x = g_mock.sc;
+			if (++g_mock.y > g_mock.ep) {
+				g_mock.y = g_mock.sp;
+			}
+		}
+	}
+
+	return OK;
+}
+
+static int mock_backlight(FAR struct ili9341_lcd_s *lcd, int level)
+{
+	return OK;
+}
+
+/* Runs, as NX draws them, also drawn into the reference image */
+
+static void bench_closewindow(void)
+{
+	if (g_perrow) {
+		ili9341_closewindow(&g_lcddev[0]);
+	}
+}
+
+static void bench_putrun(FAR struct lcd_planeinfo_s *pinfo, int row, int col, int npixels)
+{
+	int ret;
+	int x;
+
+	for (x = 0; x < npixels; x++) {
+		g_pixels[x] = bench_random();
+	}
+
+	memcpy(&g_image[row][col], g_pixels, npixels * sizeof(uint16_t));
+
+	bench_closewindow();
+	ret = pinfo->putrun(row, col, (FAR const uint8_t *)g_pixels, npixels);
+	if (ret < 0) {
+		bench_fail("putrun", ret);
+	}
+}
+
+static void bench_fillrun(FAR struct lcd_planeinfo_s *pinfo, int row, int col, uint16_t color, int npixels)
+{
+	int ret;
+	int x;
+
+	for (x = 0; x < npixels; x++) {
+		g_image[row][col + x] = color;
+	}
+
+	bench_closewindow();
+	ret = pinfo->fillrun(row, col, color, npixels);
+	if (ret < 0) {
+		bench_fail("fillrun", ret);
+	}
+}
+
+static void bench_frame(FAR struct lcd_planeinfo_s *pinfo, int frame)
+{
+	uint16_t color;
+	int row;
+	int x;
+	int y;
+	int n;
+
+	switch (frame) {
+	case 0:
+		/* A full screen redraw */
+
+		for (row = 0; row < YRES; row++) {
+			bench_putrun(pinfo, row, 0, XRES);
+		}
+		break;
+
+	case 1:
+		/* 32 widgets of 96x32 pixels */
+
+		for (n = 0; n < 32; n++) {
+			x = bench_random() % (XRES - 96);
+			y = bench_random() % (YRES - 32);
+			for (row = y; row < y + 32; row++) {
+				bench_putrun(pinfo, row, x, 96);
+			}
+		}
+		break;
+
+	case 2:
+		/* 32 filled rectangles of 64x48 pixels */
+
+		for (n = 0; n < 32; n++) {
+			x = bench_random() % (XRES - 64);
+			y = bench_random() % (YRES - 48);
+			color = bench_random();
+			for (row = y; row < y + 48; row++) {
+				bench_fillrun(pinfo, row, x, color, 64);
+			}
+		}
+		break;
+
+	case 3:
+		/* 1000 glyphs of 6x13 pixels */
+
+		for (n = 0; n < 1000; n++) {
+			x = bench_random() % (XRES - 6);
+			y = bench_random() % (YRES - 13);
+			for (row = y; row < y + 13; row++) {
+				bench_putrun(pinfo, row, x, 6);
+			}
+		}
+		break;
+
+	case 4:
+		/* 2000 runs of 16 pixels at random places, nothing to stream */
+
+		for (n = 0; n < 2000; n++) {
+			x = bench_random() % (XRES - 16);
+			y = bench_random() % YRES;
+			bench_putrun(pinfo, y, x, 16);
+		}
+		break;
+	}
+}
+
+static void bench_run(FAR struct lcd_dev_s *dev, FAR struct lcd_planeinfo_s *pinfo, int frame, FAR const char *name, FAR const char *how)
+{
+	struct ili9341_stats_s stats;
+	uint32_t cmdbytes;
+	uint64_t start;
+	uint64_t elapsed;
+	int ret;
+
+	/* Both ways start from a cleared display and a closed window */
+
+	ret = ili9341_clear(dev, 0);
+	if (ret < 0) {
+		bench_fail("ili9341_clear", ret);
+	}
+
+	memset(g_image, 0, sizeof(g_image));
+	ili9341_closewindow(&g_lcddev[0]);
+
+	ret = dev->ioctl(dev, ILI9341IOC_RESETSTATS, 0);
+	if (ret < 0) {
+		bench_fail("ILI9341IOC_RESETSTATS", ret);
+	}
+
+	g_seed = frame + 1;
+	g_mock.selects = 0;
+	g_mock.cmds = 0;
+	g_mock.params_sent = 0;
+	g_mock.grams = 0;
+	g_mock.words = 0;
+
+	start = bench_nsec();
+	bench_frame(pinfo, frame);
+	elapsed = bench_nsec() - start;
+
+	ret = dev->ioctl(dev, ILI9341IOC_GETSTATS, (unsigned long)((uintptr_t)&stats));
+	if (ret < 0) {
+		bench_fail("ILI9341IOC_GETSTATS", ret);
+	}
+
+	cmdbytes = g_mock.cmds + g_mock.params_sent;
+	printf("%-10s %-9s %8u %8u %9u %9u %9u %10u %8.1f\n", name, how, stats.windows, stats.streamed, cmdbytes, g_mock.grams, g_mock.selects, cmdbytes + 2 * g_mock.words, elapsed / 1000.0);
+
+	/* The gram must hold what was drawn, and the driver must count what it
+	 * put on the bus.
+	 */
+
+	if (g_mock.errors != 0 || memcmp(g_mock.gram, g_image, sizeof(g_image)) != 0) {
+		fprintf(stderr, "ERROR: %s frame drew the wrong pixels\n", name);
+		exit(EXIT_FAILURE);
+	}
+
+	if (stats.cmdbytes != cmdbytes || stats.transfers != g_mock.grams || stats.txbytes != 2 * g_mock.words) {
+		fprintf(stderr, "ERROR: %s frame counters are wrong\n", name);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+	static const char *names[] = { "Screen", "Widgets", "Fills", "Glyphs", "Scattered" };
+	struct lcd_planeinfo_s pinfo;
+	FAR struct lcd_dev_s *dev;
+	int ret;
+	int x;
+
+	g_mock.dev.select = mock_select;
+	g_mock.dev.deselect = mock_deselect;
+	g_mock.dev.sendcmd = mock_sendcmd;
+	g_mock.dev.sendparam = mock_sendparam;
+	g_mock.dev.recvparam = mock_recvparam;
+	g_mock.dev.recvgram = mock_recvgram;
+	g_mock.dev.sendgram = mock_sendgram;
+	g_mock.dev.backlight = mock_backlight;
+
+	dev = ili9341_initialize(&g_mock.dev, 0);
+	if (dev == NULL || ili9341_getdev(0) != dev) {
+		bench_fail("ili9341_initialize", -errno);
+	}
+
+	ret = dev->getplaneinfo(dev, 0, &pinfo);
+	if (ret < 0) {
+		bench_fail("getplaneinfo", ret);
+	}
+
+	/* Runs below the last row must be refused */
+
+	if (pinfo.putrun(YRES, 0, (FAR const uint8_t *)g_pixels, 1) != -EINVAL || pinfo.fillrun(YRES, 0, 0, 1) != -EINVAL) {
+		fprintf(stderr, "ERROR: a run below the display was accepted\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("ILI9341 pixel runs, %dx%d RGB565\n", XRES, YRES);
+	printf("%-10s %-9s %8s %8s %9s %9s %9s %10s %8s\n", "Frame", "Window", "Windows", "Streamed", "Cmd bytes", "Transfers", "Selects", "Bus bytes", "Host us");
+
+	for (x = 0; x < sizeof(names) / sizeof(names[0]); x++) {
+		g_perrow = true;
+		bench_run(dev, &pinfo, x, names[x], "per row");
+
+		g_perrow = false;
+		bench_run(dev, &pinfo, x, names[x], "streamed");
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,28 @@
+/****************************************************************************
+ * tools/nxbench/nxcontext.h
+ *
+ * Replaces libnx/nxcontext.h in the graphics benchmarks.  Allocations of
+ * the NX libraries go to the host heap through nxbench_malloc(), which
+ * counts them, so that fontbench can tell how many glyphs were rendered.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_NXCONTEXT_H
+#define __TOOLS_NXBENCH_NXCONTEXT_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+extern uint32_t g_nxbench_mallocs;
+
+static inline FAR void *nxbench_malloc(size_t size)
+{
+	g_nxbench_mallocs++;
+	return malloc(size);
+}
+
+#define lib_malloc(s)          nxbench_malloc(s)
+#define lib_zalloc(s)          calloc(1, s)
+#define lib_free(p)            free(p)
+
+#endif							/* __TOOLS_NXBENCH_NXCONTEXT_H */
@@ -0,0 +1,12 @@
+/****************************************************************************
+ * tools/nxbench/nxfonts_16bpp.c
+ *
+ * The 16bpp glyph renderer, which the target build generates from
+ * nxfonts_convert.c with NXFONTS_BITSPERPIXEL=16.
+ *
+ ****************************************************************************/
+
+#define NXFONTS_BITSPERPIXEL   16
+#define NXFONTS_SUFFIX         _16bpp
+
+#include "nxfonts/nxfonts_convert.c"
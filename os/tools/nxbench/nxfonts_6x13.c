@@ -0,0 +1,12 @@
+/****************************************************************************
+ * tools/nxbench/nxfonts_6x13.c
+ *
+ * The font tables of the X11 misc fixed 6x13 font, which the target build
+ * generates from nxfonts_bitmaps.c with NXFONTS_FONTID=27.
+ *
+ ****************************************************************************/
+
+#define NXFONTS_FONTID         27
+#define NXFONTS_PREFIX         g_x11_misc_fixed_6x13_
+
+#include "nxfonts/nxfonts_bitmaps.c"
@@ -0,0 +1,12 @@
+/****************************************************************************
+ * tools/nxbench/nxglib_copyrectangle_16bpp.c
+ *
+ * The 16bpp image copy to an LCD, which the target build generates from
+ * nxglib/lcd/nxglib_copyrectangle.c with NXGLIB_BITSPERPIXEL=16.
+ *
+ ****************************************************************************/
+
+#define NXGLIB_BITSPERPIXEL    16
+#define NXGLIB_SUFFIX          _16bpp
+
+#include "lcd/nxglib_copyrectangle.c"
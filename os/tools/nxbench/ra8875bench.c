@@ -0,0 +1,223 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/nxbench/ra8875bench.c
+ *
+ * Measures on the host what drawing pixel runs on the RA8875 costs on the
+ * SPI bus.  The real drivers/lcd/ra8875.c and ra8875_spi.c run on the mock
+ * SPI device of spimock.c, which counts transfers, chip select cycles and
+ * bytes.  Each frame is drawn once through the pwrite_run() method of the
+ * SPI lower half and once with that method removed, which sends one SPI
+ * block per pixel as before.  Both must put the same bytes on the bus:
+ *
+ *   make -f Makefile.host ra8875bench
+ *   ./ra8875bench
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <debug.h>
+
+#include <tinyara/lcd/lcd.h>
+#include <tinyara/spi/spi.h>
+
+/* The SPI lower half is built into the benchmark, which needs its static
+ * method table to take pwrite_run() out.
+ */
+
+#include "lcd/ra8875_spi.c"
+
+#include "spimock.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define XRES           800
+#define YRES           480
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint16_t g_pixels[XRES];
+static uint32_t g_seed = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static unsigned int bench_random(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return g_seed >> 8;
+}
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void bench_fail(FAR const char *what, int ret)
+{
+	fprintf(stderr, "ERROR: %s failed: %d\n", what, ret);
+	exit(EXIT_FAILURE);
+}
+
+static void bench_putrun(FAR struct lcd_planeinfo_s *pinfo, int row, int col, int npixels)
+{
+	int ret;
+	int x;
+
+	for (x = 0; x < npixels; x++) {
+		g_pixels[x] = bench_random();
+	}
+
+	ret = pinfo->putrun(row, col, (FAR const uint8_t *)g_pixels, npixels);
+	if (ret < 0) {
+		bench_fail("putrun", ret);
+	}
+}
+
+/* The frames, as NX would draw them through putrun */
+
+static void bench_frame(FAR struct lcd_planeinfo_s *pinfo, int frame)
+{
+	int row;
+	int x;
+	int y;
+	int n;
+
+	switch (frame) {
+	case 0:
+		/* A full screen redraw */
+
+		for (row = 0; row < YRES; row++) {
+			bench_putrun(pinfo, row, 0, XRES);
+		}
+		break;
+
+	case 1:
+		/* 64 widgets of 96x32 pixels */
+
+		for (n = 0; n < 64; n++) {
+			x = bench_random() % (XRES - 96);
+			y = bench_random() % (YRES - 32);
+			for (row = y; row < y + 32; row++) {
+				bench_putrun(pinfo, row, x, 96);
+			}
+		}
+		break;
+
+	case 2:
+		/* 2000 glyphs of 6x13 pixels */
+
+		for (n = 0; n < 2000; n++) {
+			x = bench_random() % (XRES - 6);
+			y = bench_random() % (YRES - 13);
+			for (row = y; row < y + 13; row++) {
+				bench_putrun(pinfo, row, x, 6);
+			}
+		}
+		break;
+	}
+}
+
+static uint32_t bench_run(FAR struct lcd_planeinfo_s *pinfo, int frame, FAR const char *name, FAR const char *how)
+{
+	uint64_t start;
+	uint64_t elapsed;
+
+	/* Put the register shadows of the driver in the same state for both
+	 * ways of sending runs before counting.
+	 */
+
+	bench_putrun(pinfo, 0, 0, 1);
+
+	g_seed = frame + 1;
+	spimock_reset();
+
+	start = bench_nsec();
+	bench_frame(pinfo, frame);
+	elapsed = bench_nsec() - start;
+
+	printf("%-12s %-10s %10u %10u %10u %10.1f\n", name, how, g_spimock.transfers, g_spimock.cycles, g_spimock.bytes, elapsed / 1000.0);
+	return g_spimock.hash;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+	static const char *names[] = { "Full screen", "Widgets", "Glyphs" };
+	struct lcd_planeinfo_s pinfo;
+	FAR struct lcd_dev_s *dev;
+	uint32_t hash;
+	int ret;
+	int x;
+
+	ret = board_lcd_initialize();
+	if (ret < 0) {
+		bench_fail("board_lcd_initialize", ret);
+	}
+
+	dev = board_lcd_getdev(0);
+	ret = dev->getplaneinfo(dev, 0, &pinfo);
+	if (ret < 0) {
+		bench_fail("getplaneinfo", ret);
+	}
+
+	/* Two layers do not fit at 800x480 with 65K colors, so there is nothing to flip */
+
+	if (dev->ioctl == NULL || dev->ioctl(dev, RA8875IOC_FLIP, 0) != -ENOSYS || dev->ioctl(dev, 0, 0) != -ENOTTY) {
+		fprintf(stderr, "ERROR: unexpected ioctl results\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("RA8875 SPI pixel runs, %d byte staging buffer\n", RUNBUFSIZE);
+	printf("%-12s %-10s %10s %10s %10s %10s\n", "Frame", "Runs", "Transfers", "CS cycles", "Bytes", "Host us");
+
+	for (x = 0; x < sizeof(names) / sizeof(names[0]); x++) {
+		ra8875_spi.pwrite_run = NULL;
+		hash = bench_run(&pinfo, x, names[x], "per pixel");
+
+		ra8875_spi.pwrite_run = spi_pwrite_run;
+		if (bench_run(&pinfo, x, names[x], "block") != hash) {
+			fprintf(stderr, "ERROR: %s frame sent different bytes\n", names[x]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
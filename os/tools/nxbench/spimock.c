@@ -0,0 +1,138 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/nxbench/spimock.c
+ *
+ * The mock SPI device of the LCD benchmarks.  Reads return zeros, which
+ * the drivers take as an idle controller.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdbool.h>
+#include <string.h>
+#include <debug.h>
+
+#include <tinyara/spi/spi.h>
+
+#include "spimock.h"
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int spimock_lock(FAR struct spi_dev_s *dev, bool lock);
+static void spimock_select(FAR struct spi_dev_s *dev, enum spi_dev_e devid, bool selected);
+static uint32_t spimock_setfrequency(FAR struct spi_dev_s *dev, uint32_t frequency);
+static void spimock_setmode(FAR struct spi_dev_s *dev, enum spi_mode_e mode);
+static void spimock_setbits(FAR struct spi_dev_s *dev, int nbits);
+static void spimock_exchange(FAR struct spi_dev_s *dev, FAR const void *txbuffer, FAR void *rxbuffer, size_t nwords);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct spi_ops_s g_spimockops = {
+	.lock = spimock_lock,
+	.select = spimock_select,
+	.setfrequency = spimock_setfrequency,
+	.setmode = spimock_setmode,
+	.setbits = spimock_setbits,
+	.exchange = spimock_exchange,
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+struct spimock_s g_spimock = {
+	.spi = { &g_spimockops },
+	.frequency = 1000000,
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int spimock_lock(FAR struct spi_dev_s *dev, bool lock)
+{
+	return OK;
+}
+
+static void spimock_select(FAR struct spi_dev_s *dev, enum spi_dev_e devid, bool selected)
+{
+	if (selected) {
+		g_spimock.cycles++;
+	}
+}
+
+static uint32_t spimock_setfrequency(FAR struct spi_dev_s *dev, uint32_t frequency)
+{
+	g_spimock.frequency = frequency;
+	return frequency;
+}
+
+static void spimock_setmode(FAR struct spi_dev_s *dev, enum spi_mode_e mode)
+{
+}
+
+static void spimock_setbits(FAR struct spi_dev_s *dev, int nbits)
+{
+}
+
+static void spimock_exchange(FAR struct spi_dev_s *dev, FAR const void *txbuffer, FAR void *rxbuffer, size_t nwords)
+{
+	FAR const uint8_t *tx = txbuffer;
+	size_t x;
+
+	g_spimock.transfers++;
+	g_spimock.bytes += nwords;
+	g_spimock.bussecs += 8.0 * nwords / g_spimock.frequency;
+	if (tx != NULL) {
+		for (x = 0; x < nwords; x++) {
+			g_spimock.hash = (g_spimock.hash ^ tx[x]) * 16777619;
+		}
+	}
+
+	if (rxbuffer != NULL) {
+		memset(rxbuffer, 0, nwords);
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+FAR struct spi_dev_s *up_spiinitialize(int port)
+{
+	return &g_spimock.spi;
+}
+
+void spimock_reset(void)
+{
+	g_spimock.transfers = 0;
+	g_spimock.cycles = 0;
+	g_spimock.bytes = 0;
+	g_spimock.hash = 2166136261;
+	g_spimock.bussecs = 0.0;
+}
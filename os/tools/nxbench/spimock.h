@@ -0,0 +1,31 @@
+/****************************************************************************
+ * tools/nxbench/spimock.h
+ *
+ * A mock SPI device for the LCD benchmarks.  up_spiinitialize() returns it
+ * for every port.  It counts what the driver sends and how long that would
+ * take at the frequency the driver selected.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_SPIMOCK_H
+#define __TOOLS_NXBENCH_SPIMOCK_H
+
+#include <stdint.h>
+
+#include <tinyara/spi/spi.h>
+
+struct spimock_s {
+	struct spi_dev_s spi;
+	uint32_t frequency;			/* Frequency selected by the driver */
+	uint32_t transfers;			/* exchange() calls */
+	uint32_t cycles;			/* Chip select cycles */
+	uint32_t bytes;				/* Bytes on the bus */
+	uint32_t hash;				/* FNV-1a of the bytes sent */
+	double bussecs;				/* Time the bytes take on the bus */
+};
+
+extern struct spimock_s g_spimock;
+
+void spimock_reset(void);
+
+#endif							/* __TOOLS_NXBENCH_SPIMOCK_H */
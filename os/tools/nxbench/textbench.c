@@ -0,0 +1,227 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/nxbench/textbench.c
+ *
+ * Measures on the host what drawing text on the RA8875 costs on the SPI
+ * bus.  A screen of terminal text in the X11 misc fixed 6x13 font is
+ * rendered through the real NX font cache and nxgl_copyrectangle_16bpp()
+ * into drivers/lcd/ra8875.c, which runs on the mock SPI device of
+ * spimock.c.  textbench_runs sends each glyph as pixel runs;
+ * textbench_expand is built with CONFIG_LCD_RA8875_COLOREXPAND and lets
+ * the Block Transfer Engine expand the glyphs from one bit per pixel.  The
+ * characters per second are those the bus allows at the SPI frequencies
+ * the driver selects:
+ *
+ *   make -f Makefile.host textbench
+ *   ./textbench_runs
+ *   ./textbench_expand
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <debug.h>
+
+#include <tinyara/board.h>
+#include <tinyara/lcd/lcd.h>
+#include <tinyara/nx/nxglib.h>
+#include <tinyara/nx/nxfonts.h>
+
+#include "spimock.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define XRES           800
+#define YRES           480
+#define NSCREENS       10
+#define FGCOLOR        0xffff
+#define BGCOLOR        0x001f
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+uint32_t g_nxbench_mallocs;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char g_text[] =
+	"[   12.345678] wlan0: associated with 00:1a:2b:3c:4d:5e (ch 6)\n"
+	"[   12.400213] dhcpc: lease 192.168.0.42/24 gw 192.168.0.1 DNS OK\n"
+	"[   13.002951] mqtt: connected to broker.example.org:1883, QoS=1\n"
+	"TASH>> ps\n"
+	"  PID | PRIO | FLAG |  TYPE   | NP |  STATUS  | NAME\n"
+	"------|------|------|---------|----|----------|----------\n"
+	"    0 |    0 | FIFO | KTHREAD |    | READY    | Idle Task\n"
+	"    1 |  224 | RR   | KTHREAD |    | WAITSIG  | hpwork\n"
+	"    3 |  100 | RR   | TASK    |    | RUNNING  | tash\n"
+	"The SMART MTD layer maps logical sectors to physical ones, so that a "
+	"sector can be rewritten without erasing its whole block first.  When "
+	"too few free sectors are left, the block with the most released "
+	"sectors is relocated and erased.\n";
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void bench_fail(FAR const char *what, int ret)
+{
+	fprintf(stderr, "ERROR: %s failed: %d\n", what, ret);
+	exit(EXIT_FAILURE);
+}
+
+/* Draw one screen of text, wrapping long lines as a terminal does.  Spaces
+ * have no glyph; nxterm fills them with the background separately.
+ */
+
+static uint32_t bench_screen(FAR struct lcd_planeinfo_s *pinfo, FCACHE fcache, FAR const struct nx_font_s *metrics, int *index)
+{
+	FAR const struct nxfonts_glyph_s *glyph;
+	struct nxgl_point_s origin;
+	struct nxgl_rect_s dest;
+	uint32_t nchars = 0;
+	int row = 0;
+	int col = 0;
+	char ch;
+
+	while (row + metrics->mxheight <= YRES) {
+		ch = g_text[*index];
+		if (++(*index) >= sizeof(g_text) - 1) {
+			*index = 0;
+		}
+
+		if (ch == '\n' || col + metrics->mxwidth > XRES) {
+			row += metrics->mxheight;
+			col = 0;
+			if (ch == '\n') {
+				continue;
+			}
+		}
+
+		if (ch != ' ') {
+			glyph = nxf_cache_getglyph(fcache, ch);
+			if (glyph == NULL) {
+				bench_fail("nxf_cache_getglyph", ch);
+			}
+
+			origin.x = col;
+			origin.y = row;
+			dest.pt1 = origin;
+			dest.pt2.x = col + glyph->width - 1;
+			dest.pt2.y = row + glyph->height - 1;
+			if (dest.pt2.y < YRES) {
+				nxgl_copyrectangle_16bpp(pinfo, &dest, glyph->bitmap, &origin, glyph->stride);
+				nchars++;
+			}
+		}
+
+		col += metrics->mxwidth;
+	}
+
+	return nchars;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+	FAR const struct nx_font_s *metrics;
+	struct lcd_planeinfo_s pinfo;
+	FAR struct lcd_dev_s *dev;
+	NXHANDLE hfont;
+	FCACHE fcache;
+	uint64_t elapsed;
+	uint64_t start;
+	uint32_t nchars = 0;
+	int index = 0;
+	int ret;
+	int x;
+
+	ret = board_lcd_initialize();
+	if (ret < 0) {
+		bench_fail("board_lcd_initialize", ret);
+	}
+
+	dev = board_lcd_getdev(0);
+	ret = dev->getplaneinfo(dev, 0, &pinfo);
+	if (ret < 0) {
+		bench_fail("getplaneinfo", ret);
+	}
+
+	fcache = nxf_cache_connect(FONTID_X11_MISC_FIXED_6X13, FGCOLOR, BGCOLOR, 16, 96);
+	if (fcache == NULL) {
+		bench_fail("nxf_cache_connect", -errno);
+	}
+
+	hfont = nxf_cache_getfonthandle(fcache);
+	metrics = nxf_getfontset(hfont);
+
+	/* Render every glyph once, so that only drawing is counted */
+
+	for (x = 0; x < NSCREENS; x++) {
+		(void)bench_screen(&pinfo, fcache, metrics, &index);
+	}
+
+	index = 0;
+	spimock_reset();
+	start = bench_nsec();
+	for (x = 0; x < NSCREENS; x++) {
+		nchars += bench_screen(&pinfo, fcache, metrics, &index);
+	}
+
+	elapsed = bench_nsec() - start;
+
+#ifdef CONFIG_LCD_RA8875_COLOREXPAND
+	printf("RA8875 text, glyphs expanded by the BTE\n");
+#else
+	printf("RA8875 text, glyphs sent as pixel runs\n");
+#endif
+	printf("%-22s %10u\n", "Characters", nchars);
+	printf("%-22s %10.1f\n", "Transfers/char", (double)g_spimock.transfers / nchars);
+	printf("%-22s %10.1f\n", "CS cycles/char", (double)g_spimock.cycles / nchars);
+	printf("%-22s %10.1f\n", "Bytes/char", (double)g_spimock.bytes / nchars);
+	printf("%-22s %10.0f\n", "Bus chars/s", nchars / g_spimock.bussecs);
+	printf("%-22s %10.1f\n", "Host ns/char", (double)elapsed / nchars);
+
+	nxf_cache_disconnect(fcache);
+	return EXIT_SUCCESS;
+}
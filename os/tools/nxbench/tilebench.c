@@ -0,0 +1,283 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/nxbench/tilebench.c
+ *
+ * Measures on the host how tile-parallel rasterization scales with the
+ * number of tile workers.  The real nxbe fill, trapezoid and bitmap
+ * operations draw through graphics/nxbe/nxbe_tile.c and the 16bpp
+ * framebuffer rasterizers into a RAM framebuffer.  The tile workers are
+ * host threads.  Each operation is timed with 0, 1, 2 and 4 workers
+ * besides the drawing thread, and every result must be the same image as
+ * the one drawn without workers:
+ *
+ *   make -f Makefile.host tilebench
+ *   ./tilebench
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <debug.h>
+
+#include <tinyara/kthread.h>
+#include <tinyara/nx/nxglib.h>
+#include <tinyara/video/fb.h>
+
+/* The tile pool is built into the benchmark, which changes the number of
+ * workers that it wakes.  The host has no priority inheritance to turn off.
+ */
+
+#define SEM_PRIO_NONE          0
+#define sem_setprotocol(s,p)   ((void)(s))
+
+#include "nxbe_tile.c"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define XRES           800
+#define YRES           480
+#define NPASSES        100
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_thread_s {
+	main_t entry;
+	FAR char *argv[3];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct nxbe_state_s g_be;
+static uint16_t g_fb[YRES][XRES];
+static uint16_t g_image[YRES + 8][XRES];
+static uint16_t g_ref[YRES][XRES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void bench_fail(FAR const char *what, int ret)
+{
+	fprintf(stderr, "ERROR: %s failed: %d\n", what, ret);
+	exit(EXIT_FAILURE);
+}
+
+static FAR void *bench_thread(FAR void *arg)
+{
+	FAR struct bench_thread_s *thread = (FAR struct bench_thread_s *)arg;
+
+	thread->entry(2, thread->argv);
+	return NULL;
+}
+
+/* Kernel threads of the tile pool, started as host threads */
+
+int kernel_thread(FAR const char *name, int priority, int stack_size, main_t entry, FAR char *const argv[])
+{
+	FAR struct bench_thread_s *thread;
+	pthread_t tid;
+
+	thread = malloc(sizeof(struct bench_thread_s));
+	if (thread == NULL) {
+		errno = ENOMEM;
+		return ERROR;
+	}
+
+	thread->entry = entry;
+	thread->argv[0] = (FAR char *)name;
+	thread->argv[1] = strdup(argv[0]);
+	thread->argv[2] = NULL;
+
+	if (pthread_create(&tid, NULL, bench_thread, thread) != 0) {
+		errno = EAGAIN;
+		return ERROR;
+	}
+
+	pthread_detach(tid);
+	return 1;
+}
+
+/* One pass of an operation over the whole screen */
+
+static void bench_draw(int op, int pass)
+{
+	static const struct nxgl_point_s origin = { 0, 0 };
+	struct nxgl_trapezoid_s trap;
+	struct nxgl_rect_s rect;
+	nxgl_mxpixel_t color[CONFIG_NX_NPLANES];
+	FAR const void *src[CONFIG_NX_NPLANES];
+
+	rect.pt1.x = 0;
+	rect.pt1.y = 0;
+	rect.pt2.x = XRES - 1;
+	rect.pt2.y = YRES - 1;
+	color[0] = pass * 0x0841 + 0x1234;
+
+	switch (op) {
+	case 0:
+		nxbe_fill(&g_be.bkgd, &rect, color);
+		break;
+
+	case 1:
+		/* A triangle pointing down, then one pointing up beside it */
+
+		trap.top.x1 = itob16(0);
+		trap.top.x2 = itob16(XRES - 1);
+		trap.top.y = 0;
+		trap.bot.x1 = itob16(XRES / 2 - pass);
+		trap.bot.x2 = itob16(XRES / 2 + pass);
+		trap.bot.y = YRES - 1;
+		nxbe_filltrapezoid(&g_be.bkgd, &rect, &trap, color);
+
+		trap.top.x1 = itob16(pass);
+		trap.top.x2 = itob16(pass);
+		trap.bot.x1 = itob16(0);
+		trap.bot.x2 = itob16(XRES / 3);
+		color[0] = ~color[0];
+		nxbe_filltrapezoid(&g_be.bkgd, &rect, &trap, color);
+		break;
+
+	case 2:
+		src[0] = &g_image[pass & 7][0];
+		nxbe_bitmap(&g_be.bkgd, &rect, src, &origin, XRES * sizeof(uint16_t));
+		break;
+	}
+}
+
+static double bench_run(int op, int nworkers)
+{
+	uint64_t start;
+	uint64_t elapsed;
+	int pass;
+
+	g_be.tiles.nworkers = nworkers;
+	memset(g_fb, 0, sizeof(g_fb));
+
+	start = bench_nsec();
+	for (pass = 0; pass < NPASSES; pass++) {
+		bench_draw(op, pass);
+	}
+
+	elapsed = bench_nsec() - start;
+
+	/* The image drawn without workers is the reference */
+
+	if (nworkers == 0) {
+		memcpy(g_ref, g_fb, sizeof(g_fb));
+	} else if (memcmp(g_ref, g_fb, sizeof(g_fb)) != 0) {
+		fprintf(stderr, "ERROR: %d workers drew a different image\n", nworkers);
+		exit(EXIT_FAILURE);
+	}
+
+	return (double)XRES * YRES * NPASSES * 1000.0 / elapsed;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+	static const char *names[] = { "Fill", "Trapezoids", "Bitmap" };
+	static const int nworkers[] = { 0, 1, 2, 4 };
+	FAR struct nxbe_plane_s *plane = &g_be.plane[0];
+	double base;
+	double mpps;
+	uint32_t seed = 1;
+	int ret;
+	int x;
+	int y;
+
+	/* A RAM framebuffer with the 16bpp rasterizers */
+
+	g_be.vinfo.fmt = FB_FMT_RGB16_565;
+	g_be.vinfo.xres = XRES;
+	g_be.vinfo.yres = YRES;
+	g_be.vinfo.nplanes = 1;
+
+	plane->pinfo.fbmem = g_fb;
+	plane->pinfo.fblen = sizeof(g_fb);
+	plane->pinfo.stride = XRES * sizeof(uint16_t);
+	plane->pinfo.bpp = 16;
+	/* The 16bpp rasterizers take the color as uint16_t, which
+	 * nxbe_configure() ignores when it selects them.
+	 */
+
+	plane->fillrectangle = (FAR void *)nxgl_fillrectangle_16bpp;
+	plane->filltrapezoid = (FAR void *)nxgl_filltrapezoid_16bpp;
+	plane->copyrectangle = nxgl_copyrectangle_16bpp;
+
+	g_be.bkgd.be = &g_be;
+	g_be.bkgd.bounds.pt2.x = XRES - 1;
+	g_be.bkgd.bounds.pt2.y = YRES - 1;
+	g_be.topwnd = &g_be.bkgd;
+
+	for (y = 0; y < YRES + 8; y++) {
+		for (x = 0; x < XRES; x++) {
+			seed = seed * 1103515245 + 12345;
+			g_image[y][x] = seed >> 16;
+		}
+	}
+
+	ret = nxbe_tile_initialize(&g_be);
+	if (ret < 0 || g_be.tiles.nworkers != CONFIG_NX_TILES_NWORKERS) {
+		bench_fail("nxbe_tile_initialize", ret);
+	}
+
+	printf("NX tiles, %dx%d 16bpp, %d rows per tile, %ld host CPUs\n", XRES, YRES, CONFIG_NX_TILES_ROWS, sysconf(_SC_NPROCESSORS_ONLN));
+	printf("%-12s %8s %12s %8s\n", "Operation", "Workers", "Mpixels/s", "Speedup");
+
+	for (x = 0; x < sizeof(names) / sizeof(names[0]); x++) {
+		base = 0.0;
+		for (y = 0; y < sizeof(nworkers) / sizeof(nworkers[0]); y++) {
+			mpps = bench_run(x, nworkers[y]);
+			if (y == 0) {
+				base = mpps;
+			}
+
+			printf("%-12s %8d %12.1f %7.2fx\n", names[x], nworkers[y], mpps, mpps / base);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,15 @@
+/****************************************************************************
+ * tools/nxbench/tinyara/arch.h
+ *
+ * The LCD drivers only need the busy-wait delays from the architecture
+ * interface.  The mock bus of the benchmarks never needs to wait.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_TINYARA_ARCH_H
+#define __TOOLS_NXBENCH_TINYARA_ARCH_H
+
+#define up_udelay(us)
+#define up_mdelay(ms)
+
+#endif							/* __TOOLS_NXBENCH_TINYARA_ARCH_H */
@@ -0,0 +1,23 @@
+/****************************************************************************
+ * tools/nxbench/tinyara/config.h
+ *
+ * Stands in for the generated configuration when graphics sources are
+ * built on the host by the nxbench tools.  The options they compare are
+ * set on the command line.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_TINYARA_CONFIG_H
+#define __TOOLS_NXBENCH_TINYARA_CONFIG_H
+
+#define CONFIG_NX 1
+#define CONFIG_NXFONTS 1
+#define CONFIG_NXFONT_X11_MISC_FIXED_6X13 1
+#define CONFIG_NXFONTS_DISABLE_1BPP 1
+#define CONFIG_NXFONTS_DISABLE_2BPP 1
+#define CONFIG_NXFONTS_DISABLE_4BPP 1
+#define CONFIG_NXFONTS_DISABLE_8BPP 1
+#define CONFIG_NXFONTS_DISABLE_24BPP 1
+#define CONFIG_NXFONTS_DISABLE_32BPP 1
+
+#endif							/* __TOOLS_NXBENCH_TINYARA_CONFIG_H */
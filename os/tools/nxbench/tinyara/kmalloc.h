@@ -0,0 +1,18 @@
+/****************************************************************************
+ * tools/nxbench/tinyara/kmalloc.h
+ *
+ * The kernel heap of the graphics benchmarks is the host heap.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_TINYARA_KMALLOC_H
+#define __TOOLS_NXBENCH_TINYARA_KMALLOC_H
+
+#include <stdlib.h>
+
+#define kmm_malloc(s)          malloc(s)
+#define kmm_zalloc(s)          calloc(1, s)
+#define kmm_realloc(p,s)       realloc(p, s)
+#define kmm_free(p)            free(p)
+
+#endif							/* __TOOLS_NXBENCH_TINYARA_KMALLOC_H */
@@ -0,0 +1,16 @@
+/****************************************************************************
+ * tools/nxbench/tinyara/kthread.h
+ *
+ * Kernel threads are started as host threads by the benchmark that needs
+ * them.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_TINYARA_KTHREAD_H
+#define __TOOLS_NXBENCH_TINYARA_KTHREAD_H
+
+typedef int (*main_t)(int argc, char *argv[]);
+
+int kernel_thread(FAR const char *name, int priority, int stack_size, main_t entry, FAR char *const argv[]);
+
+#endif							/* __TOOLS_NXBENCH_TINYARA_KTHREAD_H */
@@ -0,0 +1,19 @@
+/****************************************************************************
+ * tools/nxbench/tinyara/net/net.h
+ *
+ * The VNC benchmark sends into a capture buffer instead of a socket.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_TINYARA_NET_NET_H
+#define __TOOLS_NXBENCH_TINYARA_NET_NET_H
+
+#include <sys/types.h>
+
+struct socket {
+	int s_crefs;
+};
+
+ssize_t psock_send(FAR struct socket *psock, FAR const void *buf, size_t len, int flags);
+
+#endif							/* __TOOLS_NXBENCH_TINYARA_NET_NET_H */
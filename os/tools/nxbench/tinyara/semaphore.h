@@ -0,0 +1,30 @@
+/****************************************************************************
+ * tools/nxbench/tinyara/semaphore.h
+ *
+ * The graphics benchmarks are single threaded, so the semaphores that
+ * serialize access to shared state never need to wait.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_TINYARA_SEMAPHORE_H
+#define __TOOLS_NXBENCH_TINYARA_SEMAPHORE_H
+
+#include <semaphore.h>
+#include <errno.h>
+
+#define SEM_INITIALIZER(c)     { { 0 } }
+
+static inline int nxbench_sem(FAR sem_t *sem)
+{
+	return 0;
+}
+
+#define nxsem_init(s,p,c)      nxbench_sem(s)
+#define nxsem_wait(s)          nxbench_sem(s)
+#define nxsem_post(s)          nxbench_sem(s)
+#define _SEM_WAIT(s)           nxbench_sem(s)
+#define _SEM_POST(s)           nxbench_sem(s)
+#define _SEM_DESTROY(s)        nxbench_sem(s)
+#define _SEM_ERRNO(r)          errno
+
+#endif							/* __TOOLS_NXBENCH_TINYARA_SEMAPHORE_H */
@@ -0,0 +1,74 @@
+/****************************************************************************
+ * tools/nxbench/tinyara/video/rfb.h
+ *
+ * The part of the RFB protocol definitions that the VNC encoders use, for
+ * the VNC benchmark.  Values and layouts are those of RFC 6143.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_TINYARA_VIDEO_RFB_H
+#define __TOOLS_NXBENCH_TINYARA_VIDEO_RFB_H
+
+#include <stdint.h>
+
+#define RFB_FBUPDATE_MSG       0
+
+#define RFB_ENCODING_RAW       0
+#define RFB_ENCODING_RRE       2
+#define RFB_ENCODING_HEXTILE   5
+#define RFB_ENCODING_ZRLE      16
+
+struct rfb_rectangle_s {
+	uint8_t xpos[2];
+	uint8_t ypos[2];
+	uint8_t width[2];
+	uint8_t height[2];
+	uint8_t encoding[4];
+	uint8_t data[1];
+};
+
+#define SIZEOF_RFB_RECTANGE_S(d) \
+	(sizeof(struct rfb_rectangle_s) + (d) - 1)
+
+struct rfb_framebufferupdate_s {
+	uint8_t msgtype;
+	uint8_t padding;
+	uint8_t nrect[2];
+	struct rfb_rectangle_s rect[1];
+};
+
+#define SIZEOF_RFB_FRAMEBUFFERUPDATE_S(r) \
+	(sizeof(struct rfb_framebufferupdate_s) + (r) - sizeof(struct rfb_rectangle_s))
+
+struct rfb_pixelfmt_s;
+struct rfb_setencodings_s;
+
+#define rfb_putbe16(d, v) \
+	do { \
+		(d)[0] = (uint8_t)((v) >> 8); \
+		(d)[1] = (uint8_t)(v); \
+	} while (0)
+
+#define rfb_putbe32(d, v) \
+	do { \
+		(d)[0] = (uint8_t)((v) >> 24); \
+		(d)[1] = (uint8_t)((v) >> 16); \
+		(d)[2] = (uint8_t)((v) >> 8); \
+		(d)[3] = (uint8_t)(v); \
+	} while (0)
+
+#define rfb_putle16(d, v) \
+	do { \
+		(d)[0] = (uint8_t)(v); \
+		(d)[1] = (uint8_t)((v) >> 8); \
+	} while (0)
+
+#define rfb_putle32(d, v) \
+	do { \
+		(d)[0] = (uint8_t)(v); \
+		(d)[1] = (uint8_t)((v) >> 8); \
+		(d)[2] = (uint8_t)((v) >> 16); \
+		(d)[3] = (uint8_t)((v) >> 24); \
+	} while (0)
+
+#endif							/* __TOOLS_NXBENCH_TINYARA_VIDEO_RFB_H */
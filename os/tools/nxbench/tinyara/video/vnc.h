@@ -0,0 +1,22 @@
+/****************************************************************************
+ * tools/nxbench/tinyara/video/vnc.h
+ *
+ * The input callouts of a VNC session, for the VNC benchmark.  The remote
+ * RGB8 2:2:2 format of the VNC server is not among the formats of
+ * tinyara/video/fb.h, so it gets a value of its own here.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_NXBENCH_TINYARA_VIDEO_VNC_H
+#define __TOOLS_NXBENCH_TINYARA_VIDEO_VNC_H
+
+#include <stdint.h>
+
+#ifndef FB_FMT_RGB8_222
+#define FB_FMT_RGB8_222        0xfe
+#endif
+
+typedef void (*vnc_mouseout_t)(FAR void *arg, int16_t x, int16_t y, uint8_t buttons);
+typedef void (*vnc_kbdout_t)(FAR void *arg, uint8_t nch, FAR const uint8_t *ch);
+
+#endif							/* __TOOLS_NXBENCH_TINYARA_VIDEO_VNC_H */
@@ -0,0 +1,914 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/nxbench/vncbench.c
+ *
+ * Checks and measures the Hextile and ZRLE encoders of the VNC server on
+ * the host.  The real vnc_hextile.c, vnc_zrle.c, vnc_deflate.c and
+ * vnc_color.c send into a capture buffer, a few bytes at a time, and the
+ * captured messages are decoded again with decoders written from the RFB
+ * specification and with zlib's inflate():
+ *
+ * - vnc_deflate() is fed random, repetitive and empty buffers of up to
+ *   64KiB as one zlib stream, and every call must inflate to its input.
+ * - Screens of noise, glyphs, few colors, many colors, runs and solid
+ *   color are encoded in every remote pixel format and byte order, for
+ *   the whole screen, single pixels and rectangles of odd sizes, and must
+ *   decode to the pixels that vnc_putpixel() gives.
+ *
+ * A replay of typical updates is then encoded over and over to compare the
+ * bytes sent and the time spent with those of raw pixels:
+ *
+ *   make -f Makefile.host vncbench
+ *   ./vncbench_rgb16
+ *   ./vncbench_rgb32
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <zlib.h>
+#include <debug.h>
+
+#include "vnc_server.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define XRES           CONFIG_VNCSERVER_SCREENWIDTH
+#define YRES           CONFIG_VNCSERVER_SCREENHEIGHT
+#define NPASSES        50
+#define NRECTS         24
+#define MAXRECTS       64
+#define CAPTURESIZE    (2 * XRES * YRES * sizeof(uint32_t) + 65536)
+
+#define HEXTILE_RAW               (1 << 0)
+#define HEXTILE_BACKGROUND        (1 << 1)
+#define HEXTILE_FOREGROUND        (1 << 2)
+#define HEXTILE_ANYSUBRECTS       (1 << 3)
+#define HEXTILE_SUBRECTSCOLOURED  (1 << 4)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* A remote pixel format */
+
+struct bench_format_s {
+	FAR const char *name;
+	uint8_t colorfmt;
+	uint8_t bpp;
+};
+
+/* A scene of the replay:  what is drawn and the damage it causes */
+
+struct bench_scene_s {
+	FAR const char *name;
+	int nrects;
+	struct nxgl_rect_s rects[MAXRECTS];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct bench_format_s g_formats[] = {
+	{ "RGB8 2:2:2", FB_FMT_RGB8_222, 8 },
+	{ "RGB8 3:3:2", FB_FMT_RGB8_332, 8 },
+	{ "RGB16 5:5:5", FB_FMT_RGB16_555, 16 },
+	{ "RGB16 5:6:5", FB_FMT_RGB16_565, 16 },
+	{ "RGB32 8:8:8", FB_FMT_RGB32, 32 },
+};
+
+static FAR const char *g_patterns[] = {
+	"noise", "glyphs", "4 colors", "17 colors", "runs", "solid"
+};
+
+static struct vnc_session_s g_session;
+static uint8_t g_fb[RFB_SIZE];
+static uint8_t g_remote[XRES * YRES * sizeof(uint32_t)];
+static uint8_t g_capture[CAPTURESIZE];
+static uint8_t g_zrledata[VNCSERVER_ZRLE_INSIZE];
+static size_t g_ncaptured;
+static size_t g_sendmax;
+static z_stream g_zstream;
+static uint32_t g_seed = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static unsigned int bench_random(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return g_seed >> 8;
+}
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void bench_fail(FAR const char *what, int ret)
+{
+	fprintf(stderr, "ERROR: %s failed: %d\n", what, ret);
+	exit(EXIT_FAILURE);
+}
+
+static unsigned int bench_getbe16(FAR const uint8_t *src)
+{
+	return ((unsigned int)src[0] << 8) | src[1];
+}
+
+static uint32_t bench_getbe32(FAR const uint8_t *src)
+{
+	return ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8) | src[3];
+}
+
+/* A local color, with the unused byte of 32-bit pixels clear */
+
+static lfb_color_t bench_color(unsigned int value)
+{
+	return (lfb_color_t)(((((value >> 16) & RFB_RMAX) << RFB_RSHIFT) | (((value >> 8) & RFB_GMAX) << RFB_GSHIFT) | ((value & RFB_BMAX) << RFB_BSHIFT)));
+}
+
+static void bench_putfb(int x, int y, lfb_color_t color)
+{
+	((FAR lfb_color_t *)(g_fb + y * RFB_STRIDE))[x] = color;
+}
+
+static void bench_fillfb(int x, int y, int width, int height, lfb_color_t color)
+{
+	int i;
+	int j;
+
+	for (j = y; j < y + height && j < YRES; j++) {
+		for (i = x; i < x + width && i < XRES; i++) {
+			bench_putfb(i, j, color);
+		}
+	}
+}
+
+/* A glyph of random bits, as text of a 6x13 font would look */
+
+static void bench_glyph(int x, int y, lfb_color_t fg, lfb_color_t bg)
+{
+	int i;
+	int j;
+
+	for (j = 0; j < 13; j++) {
+		for (i = 0; i < 6; i++) {
+			bench_putfb(x + i, y + j, j > 1 && j < 11 && i < 5 && (bench_random() & 3) == 0 ? fg : bg);
+		}
+	}
+}
+
+static void bench_pattern(int pattern)
+{
+	lfb_color_t palette[17];
+	int x;
+	int y;
+
+	for (x = 0; x < 17; x++) {
+		palette[x] = bench_color(bench_random());
+	}
+
+	for (y = 0; y < YRES; y++) {
+		for (x = 0; x < XRES; x++) {
+			switch (pattern) {
+			case 0:
+				bench_putfb(x, y, bench_color(bench_random()));
+				break;
+			case 2:
+				bench_putfb(x, y, palette[bench_random() % 4]);
+				break;
+			case 3:
+				bench_putfb(x, y, palette[bench_random() % 17]);
+				break;
+			case 4:
+				bench_putfb(x, y, palette[(x / (1 + y % 37)) % 17]);
+				break;
+			default:
+				bench_putfb(x, y, palette[0]);
+				break;
+			}
+		}
+	}
+
+	if (pattern == 1) {
+		for (y = 0; y + 13 <= YRES; y += 13) {
+			for (x = 0; x + 6 <= XRES; x += 6) {
+				bench_glyph(x, y, palette[1], palette[0]);
+			}
+		}
+	}
+}
+
+/* The socket:  at most g_sendmax bytes are taken at a time */
+
+ssize_t psock_send(FAR struct socket *psock, FAR const void *buf, size_t len, int flags)
+{
+	if (len > g_sendmax) {
+		len = g_sendmax;
+	}
+
+	if (g_ncaptured + len > CAPTURESIZE) {
+		bench_fail("psock_send", -ENOBUFS);
+	}
+
+	memcpy(&g_capture[g_ncaptured], buf, len);
+	g_ncaptured += len;
+	return len;
+}
+
+/* Decoders, after RFC 6143 */
+
+static void bench_putremote(int x, int y, FAR const uint8_t *pixel, unsigned int bpp)
+{
+	memcpy(&g_remote[(y * XRES + x) * bpp], pixel, bpp);
+}
+
+static FAR const uint8_t *bench_unhextile(FAR const uint8_t *src, FAR const uint8_t *end, int x0, int y0, int width, int height, unsigned int bpp)
+{
+	uint8_t bg[4];
+	uint8_t fg[4];
+	FAR const uint8_t *color;
+	bool bgvalid = false;
+	bool fgvalid = false;
+	unsigned int nsubrects;
+	unsigned int mask;
+	int tx;
+	int ty;
+	int tw;
+	int th;
+	int sx;
+	int sy;
+	int sw;
+	int sh;
+	int x;
+	int y;
+
+	for (ty = y0; ty < y0 + height; ty += 16) {
+		th = MIN(16, y0 + height - ty);
+		for (tx = x0; tx < x0 + width; tx += 16) {
+			tw = MIN(16, x0 + width - tx);
+			if (src >= end) {
+				return NULL;
+			}
+
+			mask = *src++;
+			if ((mask & HEXTILE_RAW) != 0) {
+				if (src + tw * th * bpp > end) {
+					return NULL;
+				}
+
+				for (y = ty; y < ty + th; y++) {
+					for (x = tx; x < tx + tw; x++, src += bpp) {
+						bench_putremote(x, y, src, bpp);
+					}
+				}
+
+				bgvalid = false;
+				fgvalid = false;
+				continue;
+			}
+
+			if ((mask & HEXTILE_BACKGROUND) != 0) {
+				memcpy(bg, src, bpp);
+				src += bpp;
+				bgvalid = true;
+			}
+
+			if ((mask & HEXTILE_FOREGROUND) != 0) {
+				memcpy(fg, src, bpp);
+				src += bpp;
+				fgvalid = true;
+			}
+
+			if (!bgvalid) {
+				return NULL;
+			}
+
+			for (y = ty; y < ty + th; y++) {
+				for (x = tx; x < tx + tw; x++) {
+					bench_putremote(x, y, bg, bpp);
+				}
+			}
+
+			if ((mask & HEXTILE_ANYSUBRECTS) == 0) {
+				continue;
+			}
+
+			for (nsubrects = *src++; nsubrects > 0; nsubrects--) {
+				if ((mask & HEXTILE_SUBRECTSCOLOURED) != 0) {
+					color = src;
+					src += bpp;
+				} else if (fgvalid) {
+					color = fg;
+				} else {
+					return NULL;
+				}
+
+				sx = src[0] >> 4;
+				sy = src[0] & 15;
+				sw = (src[1] >> 4) + 1;
+				sh = (src[1] & 15) + 1;
+				src += 2;
+
+				if (src > end || sx + sw > tw || sy + sh > th) {
+					return NULL;
+				}
+
+				for (y = ty + sy; y < ty + sy + sh; y++) {
+					for (x = tx + sx; x < tx + sx + sw; x++) {
+						bench_putremote(x, y, color, bpp);
+					}
+				}
+			}
+
+			if ((mask & HEXTILE_SUBRECTSCOLOURED) != 0) {
+				fgvalid = false;
+			}
+		}
+	}
+
+	return src;
+}
+
+static FAR const uint8_t *bench_cpixel(FAR const uint8_t *src, FAR uint8_t *pixel, unsigned int bpp, unsigned int cpsize)
+{
+	if (cpsize == bpp) {
+		memcpy(pixel, src, bpp);
+	} else if (g_session.bigendian) {
+		pixel[0] = 0;
+		memcpy(&pixel[1], src, cpsize);
+	} else {
+		memcpy(pixel, src, cpsize);
+		pixel[3] = 0;
+	}
+
+	return src + cpsize;
+}
+
+static FAR const uint8_t *bench_runlength(FAR const uint8_t *src, FAR const uint8_t *end, FAR unsigned int *length)
+{
+	*length = 1;
+	while (src < end && *src == 255) {
+		*length += *src++;
+	}
+
+	if (src >= end) {
+		return NULL;
+	}
+
+	*length += *src++;
+	return src;
+}
+
+static bool bench_unzrletile(FAR const uint8_t *src, FAR const uint8_t *end, int x0, int y0, int width, int height, unsigned int bpp, unsigned int cpsize)
+{
+	uint8_t palette[128][4];
+	uint8_t pixel[4];
+	unsigned int subenc;
+	unsigned int npalette = 0;
+	unsigned int length;
+	unsigned int index;
+	unsigned int bits;
+	unsigned int i;
+	int npixels = width * height;
+	int n = 0;
+	int x;
+	int y;
+
+	subenc = *src++;
+	if (subenc == 1 || (subenc >= 2 && subenc <= 16) || subenc >= 130) {
+		npalette = subenc >= 130 ? subenc - 128 : subenc;
+		for (i = 0; i < npalette; i++) {
+			src = bench_cpixel(src, palette[i], bpp, cpsize);
+		}
+	}
+
+	if (subenc == 0) {
+		for (y = y0; y < y0 + height; y++) {
+			for (x = x0; x < x0 + width; x++) {
+				src = bench_cpixel(src, pixel, bpp, cpsize);
+				bench_putremote(x, y, pixel, bpp);
+			}
+		}
+	} else if (subenc == 1) {
+		for (y = y0; y < y0 + height; y++) {
+			for (x = x0; x < x0 + width; x++) {
+				bench_putremote(x, y, palette[0], bpp);
+			}
+		}
+	} else if (subenc <= 16) {
+		bits = subenc == 2 ? 1 : subenc <= 4 ? 2 : 4;
+		for (y = y0; y < y0 + height; y++) {
+			for (x = 0; x < width; x++) {
+				index = (src[(x * bits) >> 3] >> (8 - bits - ((x * bits) & 7))) & ((1 << bits) - 1);
+				if (index >= npalette) {
+					return false;
+				}
+
+				bench_putremote(x0 + x, y, palette[index], bpp);
+			}
+
+			src += (width * bits + 7) >> 3;
+		}
+	} else if (subenc == 128 || subenc >= 130) {
+		while (n < npixels) {
+			if (subenc == 128) {
+				src = bench_cpixel(src, pixel, bpp, cpsize);
+				src = bench_runlength(src, end, &length);
+			} else {
+				index = *src++;
+				if ((index & 0x80) != 0) {
+					src = bench_runlength(src, end, &length);
+				} else {
+					length = 1;
+				}
+
+				index &= 0x7f;
+				if (index >= npalette) {
+					return false;
+				}
+
+				memcpy(pixel, palette[index], bpp);
+			}
+
+			if (src == NULL || n + (int)length > npixels) {
+				return false;
+			}
+
+			for (; length > 0; length--, n++) {
+				bench_putremote(x0 + n % width, y0 + n / width, pixel, bpp);
+			}
+		}
+	} else {
+		return false;
+	}
+
+	return src == end;
+}
+
+static FAR const uint8_t *bench_unzrle(FAR const uint8_t *src, FAR const uint8_t *end, int x0, int y0, int width, int height, unsigned int bpp)
+{
+	unsigned int cpsize;
+	uint32_t length;
+	int ret;
+
+	/* The coder sends every tile as a rectangle of its own */
+
+	if (width > VNCSERVER_ZRLE_TILEWIDTH || height > 64 || src + 4 > end) {
+		return NULL;
+	}
+
+	length = bench_getbe32(src);
+	src += 4;
+	if (src + length > end) {
+		return NULL;
+	}
+
+	g_zstream.next_in = (FAR uint8_t *)src;
+	g_zstream.avail_in = length;
+	g_zstream.next_out = g_zrledata;
+	g_zstream.avail_out = sizeof(g_zrledata);
+
+	ret = inflate(&g_zstream, Z_SYNC_FLUSH);
+	if (ret != Z_OK || g_zstream.avail_in != 0) {
+		fprintf(stderr, "ERROR: inflate: %d, %u bytes left\n", ret, g_zstream.avail_in);
+		return NULL;
+	}
+
+	cpsize = g_session.colorfmt == FB_FMT_RGB32 ? 3 : bpp;
+	if (!bench_unzrletile(g_zrledata, g_zstream.next_out, x0, y0, width, height, bpp, cpsize)) {
+		return NULL;
+	}
+
+	return src + length;
+}
+
+/* Decode everything captured into g_remote */
+
+static bool bench_decode(void)
+{
+	FAR const uint8_t *src = g_capture;
+	FAR const uint8_t *end = &g_capture[g_ncaptured];
+	unsigned int bpp = g_session.bpp >> 3;
+	int x;
+	int y;
+	int width;
+	int height;
+
+	while (src < end) {
+		if (src + 16 > end || src[0] != RFB_FBUPDATE_MSG || bench_getbe16(&src[2]) != 1) {
+			return false;
+		}
+
+		x = bench_getbe16(&src[4]);
+		y = bench_getbe16(&src[6]);
+		width = bench_getbe16(&src[8]);
+		height = bench_getbe16(&src[10]);
+		if (x + width > XRES || y + height > YRES) {
+			return false;
+		}
+
+		switch (bench_getbe32(&src[12])) {
+		case RFB_ENCODING_HEXTILE:
+			src = bench_unhextile(src + 16, end, x, y, width, height, bpp);
+			break;
+		case RFB_ENCODING_ZRLE:
+			src = bench_unzrle(src + 16, end, x, y, width, height, bpp);
+			break;
+		default:
+			return false;
+		}
+
+		if (src == NULL) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Compare a rectangle of g_remote with the converted local framebuffer */
+
+static bool bench_compare(FAR const struct nxgl_rect_s *rect)
+{
+	unsigned int bpp = g_session.bpp >> 3;
+	uint8_t pixel[4];
+	int x;
+	int y;
+
+	for (y = rect->pt1.y; y <= rect->pt2.y; y++) {
+		for (x = rect->pt1.x; x <= rect->pt2.x; x++) {
+			vnc_putpixel(&g_session, pixel, ((FAR lfb_color_t *)(g_fb + y * RFB_STRIDE))[x]);
+			if (memcmp(pixel, &g_remote[(y * XRES + x) * bpp], bpp) != 0) {
+				fprintf(stderr, "ERROR: pixel (%d,%d) differs\n", x, y);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/* Start a new connection:  a new zlib stream on both ends */
+
+static void bench_connect(FAR const struct bench_format_s *format, bool bigendian)
+{
+	g_session.colorfmt = format->colorfmt;
+	g_session.bpp = format->bpp;
+	g_session.bigendian = bigendian;
+	g_session.fb = g_fb;
+	g_session.deflate.started = false;
+
+	inflateEnd(&g_zstream);
+	memset(&g_zstream, 0, sizeof(g_zstream));
+	if (inflateInit(&g_zstream) != Z_OK) {
+		bench_fail("inflateInit", -ENOMEM);
+	}
+}
+
+static int bench_encode(FAR struct nxgl_rect_s *rect, bool zrle)
+{
+	g_session.hextile = !zrle;
+	g_session.zrle = zrle;
+	return zrle ? vnc_zrle(&g_session, rect) : vnc_hextile(&g_session, rect);
+}
+
+/* vnc_deflate() against zlib's inflate(), as one stream */
+
+static unsigned long bench_deflatecheck(void)
+{
+	static const size_t sizes[] = { 0, 1, 2, 3, 4, 100, 258, 259, 1000, 4097, VNCSERVER_ZRLE_INSIZE, 40000, 65535 };
+	static uint8_t in[65535];
+	static uint8_t out[65535 + 65535 / 8 + 16];
+	static uint8_t back[65535];
+	struct vnc_deflate_s zs;
+	unsigned long ncalls = 0;
+	size_t outlen;
+	size_t i;
+	size_t j;
+	int kind;
+	int ret;
+
+	memset(&zs, 0, sizeof(zs));
+	inflateEnd(&g_zstream);
+	memset(&g_zstream, 0, sizeof(g_zstream));
+	if (inflateInit(&g_zstream) != Z_OK) {
+		bench_fail("inflateInit", -ENOMEM);
+	}
+
+	for (kind = 0; kind < 4; kind++) {
+		for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+			for (j = 0; j < sizes[i]; j++) {
+				switch (kind) {
+				case 0:
+					in[j] = bench_random();
+					break;
+				case 1:
+					in[j] = 0;
+					break;
+				case 2:
+					in[j] = "abcdefg"[j % 7];
+					break;
+				default:
+					in[j] = (bench_random() & 7) == 0 ? bench_random() : (j >> 6);
+					break;
+				}
+			}
+
+			outlen = vnc_deflate(&zs, in, sizes[i], out);
+			if (outlen > sizes[i] + sizes[i] / 8 + 16) {
+				fprintf(stderr, "ERROR: %lu bytes deflated to %lu\n", (unsigned long)sizes[i], (unsigned long)outlen);
+				exit(EXIT_FAILURE);
+			}
+
+			g_zstream.next_in = out;
+			g_zstream.avail_in = outlen;
+			g_zstream.next_out = back;
+			g_zstream.avail_out = sizeof(back);
+
+			ret = inflate(&g_zstream, Z_SYNC_FLUSH);
+			if ((ret != Z_OK && !(ret == Z_BUF_ERROR && sizes[i] == 0)) || g_zstream.avail_in != 0 || sizeof(back) - g_zstream.avail_out != sizes[i] || memcmp(in, back, sizes[i]) != 0) {
+				fprintf(stderr, "ERROR: %lu bytes of kind %d do not inflate back: %d\n", (unsigned long)sizes[i], kind, ret);
+				exit(EXIT_FAILURE);
+			}
+
+			ncalls++;
+		}
+	}
+
+	return ncalls;
+}
+
+/* Every pattern and some rectangles in one remote format */
+
+static unsigned long bench_check(FAR const struct bench_format_s *format, bool bigendian)
+{
+	struct nxgl_rect_s rect;
+	unsigned long ncases = 0;
+	int pattern;
+	int zrle;
+	int n;
+
+	bench_connect(format, bigendian);
+
+	for (pattern = 0; pattern < sizeof(g_patterns) / sizeof(g_patterns[0]); pattern++) {
+		bench_pattern(pattern);
+
+		for (n = 0; n < NRECTS; n++) {
+			if (n == 0) {
+				rect.pt1.x = 0;
+				rect.pt1.y = 0;
+				rect.pt2.x = XRES - 1;
+				rect.pt2.y = YRES - 1;
+			} else if (n == 1) {
+				rect.pt1.x = XRES - 1;
+				rect.pt1.y = YRES - 1;
+				rect.pt2 = rect.pt1;
+			} else {
+				rect.pt1.x = bench_random() % XRES;
+				rect.pt1.y = bench_random() % YRES;
+				rect.pt2.x = rect.pt1.x + bench_random() % MIN(XRES - rect.pt1.x, 150);
+				rect.pt2.y = rect.pt1.y + bench_random() % MIN(YRES - rect.pt1.y, 100);
+			}
+
+			for (zrle = 0; zrle < 2; zrle++) {
+				memset(g_remote, 0x5a, sizeof(g_remote));
+				g_ncaptured = 0;
+				g_sendmax = 1 + bench_random() % 2000;
+
+				if (bench_encode(&rect, zrle) <= 0 || !bench_decode() || !bench_compare(&rect)) {
+					fprintf(stderr, "ERROR: %s of %s in %s %s, {(%d,%d),(%d,%d)}\n", zrle ? "ZRLE" : "Hextile", g_patterns[pattern], format->name, bigendian ? "big-endian" : "little-endian", rect.pt1.x, rect.pt1.y, rect.pt2.x, rect.pt2.y);
+					exit(EXIT_FAILURE);
+				}
+
+				ncases++;
+			}
+		}
+	}
+
+	return ncases;
+}
+
+/* The replay */
+
+static void bench_addrect(FAR struct bench_scene_s *scene, int x, int y, int width, int height)
+{
+	FAR struct nxgl_rect_s *rect = &scene->rects[scene->nrects++];
+
+	rect->pt1.x = x;
+	rect->pt1.y = y;
+	rect->pt2.x = MIN(x + width, XRES) - 1;
+	rect->pt2.y = MIN(y + height, YRES) - 1;
+}
+
+static void bench_scene(FAR struct bench_scene_s *scene, int n)
+{
+	lfb_color_t white = bench_color(0xffffff);
+	lfb_color_t black = bench_color(0);
+	lfb_color_t grey = bench_color(0xc0c0c0);
+	lfb_color_t blue = bench_color(0x2040a0);
+	int x;
+	int y;
+
+	scene->nrects = 0;
+
+	switch (n) {
+	case 0:
+		/* A desktop with two windows of text, drawn as a whole */
+
+		scene->name = "Desktop";
+		bench_fillfb(0, 0, XRES, YRES, bench_color(0x308080));
+		for (x = 0; x < 2; x++) {
+			bench_fillfb(10 + x * 150, 10 + x * 60, 150, 120, grey);
+			bench_fillfb(10 + x * 150, 10 + x * 60, 150, 14, blue);
+			bench_fillfb(14 + x * 150, 28 + x * 60, 142, 98, white);
+			for (y = 30 + x * 60; y + 13 < 126 + x * 60; y += 13) {
+				int col;
+
+				for (col = 16 + x * 150; col + 6 < 156 + x * 150; col += 6) {
+					bench_glyph(col, y, black, white);
+				}
+			}
+		}
+
+		bench_addrect(scene, 0, 0, XRES, YRES);
+		break;
+
+	case 1:
+		/* Typing:  one glyph after the other */
+
+		scene->name = "Typing";
+		for (x = 0; x < MAXRECTS; x++) {
+			bench_glyph(16 + (x % 40) * 6, 40 + (x / 40) * 13, black, white);
+			bench_addrect(scene, 16 + (x % 40) * 6, 40 + (x / 40) * 13, 6, 13);
+		}
+		break;
+
+	case 2:
+		/* Scrolling:  a window of text redrawn */
+
+		scene->name = "Scroll";
+		bench_fillfb(14, 28, 288, 195, white);
+		for (y = 30; y + 13 < 220; y += 13) {
+			for (x = 16; x + 6 < 300; x += 6) {
+				bench_glyph(x, y, black, white);
+			}
+		}
+
+		bench_addrect(scene, 14, 28, 288, 195);
+		break;
+
+	case 3:
+		/* Widgets:  buttons and a progress bar redrawn */
+
+		scene->name = "Widgets";
+		for (x = 0; x < 8; x++) {
+			bench_fillfb(20 + x * 36, 200, 32, 20, x & 1 ? grey : blue);
+			bench_fillfb(21 + x * 36, 201, 30, 1, white);
+			bench_addrect(scene, 20 + x * 36, 200, 32, 20);
+		}
+
+		bench_fillfb(20, 180, 200, 8, blue);
+		bench_fillfb(220, 180, 80, 8, grey);
+		bench_addrect(scene, 20, 180, 280, 8);
+		break;
+
+	default:
+		/* A photo:  smooth colors with noise */
+
+		scene->name = "Photo";
+		for (y = 0; y < 120; y++) {
+			for (x = 0; x < 160; x++) {
+				bench_putfb(80 + x, 60 + y, bench_color(((x + (bench_random() & 7)) << 17) | ((y + (bench_random() & 7)) << 9) | ((x + y) & 0xff)));
+			}
+		}
+
+		bench_addrect(scene, 80, 60, 160, 120);
+		break;
+	}
+}
+
+static void bench_replay(FAR const struct bench_format_s *format)
+{
+	struct bench_scene_s scene;
+	unsigned long raw;
+	unsigned long sent[2];
+	uint64_t elapsed[2];
+	uint64_t start;
+	int zrle;
+	int pass;
+	int n;
+	int i;
+
+	printf("Replay in %s, %d passes\n", format->name, NPASSES);
+	printf("%-10s %10s %10s %10s %10s %10s\n", "Scene", "Raw bytes", "Hextile", "ZRLE", "Hextile us", "ZRLE us");
+
+	for (n = 0; n < 5; n++) {
+		bench_scene(&scene, n);
+		raw = 0;
+		for (i = 0; i < scene.nrects; i++) {
+			raw += 16 + (scene.rects[i].pt2.x - scene.rects[i].pt1.x + 1) * (scene.rects[i].pt2.y - scene.rects[i].pt1.y + 1) * (format->bpp >> 3);
+		}
+
+		for (zrle = 0; zrle < 2; zrle++) {
+			/* The first pass is decoded and checked */
+
+			bench_connect(format, false);
+			memset(g_remote, 0x5a, sizeof(g_remote));
+			g_ncaptured = 0;
+			g_sendmax = 1460;
+
+			for (i = 0; i < scene.nrects; i++) {
+				if (bench_encode(&scene.rects[i], zrle) <= 0) {
+					bench_fail("encode", 0);
+				}
+			}
+
+			sent[zrle] = g_ncaptured;
+			if (!bench_decode()) {
+				bench_fail("decode", zrle);
+			}
+
+			for (i = 0; i < scene.nrects; i++) {
+				if (!bench_compare(&scene.rects[i])) {
+					bench_fail("compare", zrle);
+				}
+			}
+
+			start = bench_nsec();
+			for (pass = 0; pass < NPASSES; pass++) {
+				for (i = 0; i < scene.nrects; i++) {
+					g_ncaptured = 0;
+					bench_encode(&scene.rects[i], zrle);
+				}
+			}
+
+			elapsed[zrle] = bench_nsec() - start;
+		}
+
+		printf("%-10s %10lu %10lu %10lu %10.1f %10.1f\n", scene.name, raw, sent[0], sent[1], elapsed[0] / 1000.0 / NPASSES, elapsed[1] / 1000.0 / NPASSES);
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+	unsigned long ncases = 0;
+	int i;
+
+	printf("%lu vnc_deflate() calls inflate back\n", bench_deflatecheck());
+
+	for (i = 0; i < sizeof(g_formats) / sizeof(g_formats[0]); i++) {
+		ncases += bench_check(&g_formats[i], false);
+		if (g_formats[i].bpp > 8) {
+			ncases += bench_check(&g_formats[i], true);
+		}
+	}
+
+	printf("%lu Hextile and ZRLE updates decode to the screen, %d bpp local\n", ncases, RFB_BITSPERPIXEL);
+
+	for (i = 0; i < sizeof(g_formats) / sizeof(g_formats[0]); i++) {
+		if (g_formats[i].colorfmt == RFB_COLORFMT) {
+			bench_replay(&g_formats[i]);
+		}
+	}
+
+	inflateEnd(&g_zstream);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,279 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/nxbench/wordtest.c
+ *
+ * Checks the word-wide run kernels of graphics/nxglib/nxglib_wordrun.h
+ * against a byte-wise reference on the host and measures both.  Runs of
+ * 16 and 32 bpp pixels, the two depths that the kernels serve, are filled,
+ * copied and moved to a lower address within the same row, for every
+ * width up to 67 pixels and a few screen widths, and for every start of
+ * the source and destination on and off a word boundary.  The bytes
+ * around each run must be left alone.  The time of an 800 pixel run is
+ * then compared with the per-pixel loops used without CONFIG_NX_WORDRUNS:
+ *
+ *   make -f Makefile.host wordtest
+ *   ./wordtest
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "nxglib_wordrun.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MAXWIDTH       1024
+#define BUFSIZE        (4 * MAXWIDTH + 64)
+#define GUARD          16
+#define NPASSES        20000
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+enum test_op_e {
+	OP_FILL = 0,
+	OP_COPY,
+	OP_MOVE
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char *g_opnames[] = { "fill", "copy", "move" };
+static const size_t g_widths[] = { 320, 480, 640, 799, 800 };
+
+static uint32_t g_test[BUFSIZE / 4];
+static uint32_t g_ref[BUFSIZE / 4];
+static uint32_t g_src[BUFSIZE / 4];
+static uint32_t g_seed = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static unsigned int test_random(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return g_seed >> 8;
+}
+
+static uint64_t test_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void test_randomize(FAR uint32_t *buffer)
+{
+	FAR uint8_t *bytes = (FAR uint8_t *)buffer;
+	size_t x;
+
+	for (x = 0; x < BUFSIZE; x++) {
+		bytes[x] = test_random();
+	}
+}
+
+/* The reference: one byte at a time, front to back */
+
+static void test_reference(enum test_op_e op, FAR uint8_t *dest, FAR const uint8_t *src, FAR const uint8_t *color, int bpp, size_t npixels)
+{
+	size_t bytes = npixels * (bpp / 8);
+	size_t x;
+
+	for (x = 0; x < bytes; x++) {
+		dest[x] = op == OP_FILL ? color[x % (bpp / 8)] : src[x];
+	}
+}
+
+/* The per-pixel loops that NXGL_MEMSET and NXGL_MEMCPY are without words */
+
+static void test_pixels(enum test_op_e op, FAR uint8_t *dest, FAR const uint8_t *src, FAR const uint8_t *color, int bpp, size_t npixels)
+{
+	size_t x;
+
+	if (bpp == 16) {
+		FAR uint16_t *dest16 = (FAR uint16_t *)dest;
+		FAR const uint16_t *src16 = (FAR const uint16_t *)src;
+
+		for (x = 0; x < npixels; x++) {
+			dest16[x] = op == OP_FILL ? *(FAR const uint16_t *)color : src16[x];
+		}
+	} else {
+		FAR uint32_t *dest32 = (FAR uint32_t *)dest;
+		FAR const uint32_t *src32 = (FAR const uint32_t *)src;
+
+		for (x = 0; x < npixels; x++) {
+			dest32[x] = op == OP_FILL ? *(FAR const uint32_t *)color : src32[x];
+		}
+	}
+}
+
+static void test_kernel(enum test_op_e op, FAR uint8_t *dest, FAR const uint8_t *src, FAR const uint8_t *color, int bpp, size_t npixels)
+{
+	if (bpp == 16) {
+		if (op == OP_FILL) {
+			nxgl_fillwords_16bpp((FAR uint16_t *)dest, *(FAR const uint16_t *)color, npixels);
+		} else {
+			nxgl_copywords_16bpp((FAR uint16_t *)dest, (FAR const uint16_t *)src, npixels);
+		}
+	} else {
+		if (op == OP_FILL) {
+			nxgl_fillwords_32bpp((FAR uint32_t *)dest, *(FAR const uint32_t *)color, npixels);
+		} else {
+			nxgl_copywords_32bpp((FAR uint32_t *)dest, (FAR const uint32_t *)src, npixels);
+		}
+	}
+}
+
+/* Run one case through the kernel and the reference, on identical buffers */
+
+static void test_case(enum test_op_e op, int bpp, size_t npixels, size_t doffset, size_t soffset)
+{
+	FAR const uint8_t *tsrc;
+	FAR const uint8_t *rsrc;
+	FAR uint8_t *tdest;
+	FAR uint8_t *rdest;
+	uint32_t color;
+
+	test_randomize(g_test);
+	test_randomize(g_src);
+	memcpy(g_ref, g_test, BUFSIZE);
+	color = test_random() ^ (test_random() << 16);
+
+	tdest = (FAR uint8_t *)g_test + GUARD + doffset;
+	rdest = (FAR uint8_t *)g_ref + GUARD + doffset;
+
+	if (op == OP_MOVE) {
+		/* Move the run to the left within the same buffer */
+
+		tsrc = tdest + soffset;
+		rsrc = rdest + soffset;
+	} else {
+		tsrc = (FAR uint8_t *)g_src + GUARD + soffset;
+		rsrc = tsrc;
+	}
+
+	test_kernel(op, tdest, tsrc, (FAR const uint8_t *)&color, bpp, npixels);
+	test_reference(op, rdest, rsrc, (FAR const uint8_t *)&color, bpp, npixels);
+
+	if (memcmp(g_test, g_ref, BUFSIZE) != 0) {
+		fprintf(stderr, "ERROR: %d bpp %s of %lu pixels, dest offset %lu, source offset %lu differs\n", bpp, g_opnames[op], (unsigned long)npixels, (unsigned long)doffset, (unsigned long)soffset);
+		exit(EXIT_FAILURE);
+	}
+}
+
+static unsigned long test_check(int bpp)
+{
+	unsigned long ncases = 0;
+	size_t pixsize = bpp / 8;
+	size_t npixels;
+	size_t doffset;
+	size_t soffset;
+	size_t x;
+
+	for (npixels = 0; npixels < 68 + sizeof(g_widths) / sizeof(g_widths[0]); npixels++) {
+		size_t width = npixels < 68 ? npixels : g_widths[npixels - 68];
+
+		/* Pixels must be aligned to their own size, words need not be */
+
+		for (doffset = 0; doffset < 4; doffset += pixsize) {
+			for (soffset = 0; soffset < 4; soffset += pixsize) {
+				test_case(OP_FILL, bpp, width, doffset, 0);
+				test_case(OP_COPY, bpp, width, doffset, soffset);
+				ncases += 2;
+			}
+
+			/* Same-row moves to the left by one to five pixels */
+
+			for (x = 1; x <= 5; x++) {
+				test_case(OP_MOVE, bpp, width, doffset, x * pixsize);
+				ncases++;
+			}
+		}
+	}
+
+	return ncases;
+}
+
+static void test_measure(int bpp, enum test_op_e op, size_t npixels)
+{
+	FAR uint8_t *dest = (FAR uint8_t *)g_test + GUARD;
+	FAR const uint8_t *src = (FAR const uint8_t *)g_src + GUARD;
+	uint32_t color = 0x12345678;
+	uint64_t kernel;
+	uint64_t pixels;
+	uint64_t start;
+	int pass;
+
+	start = test_nsec();
+	for (pass = 0; pass < NPASSES; pass++) {
+		test_kernel(op, dest, src, (FAR const uint8_t *)&color, bpp, npixels);
+		__asm__ __volatile__("" : : "r"(dest) : "memory");
+	}
+
+	kernel = test_nsec() - start;
+
+	start = test_nsec();
+	for (pass = 0; pass < NPASSES; pass++) {
+		test_pixels(op, dest, src, (FAR const uint8_t *)&color, bpp, npixels);
+		__asm__ __volatile__("" : : "r"(dest) : "memory");
+	}
+
+	pixels = test_nsec() - start;
+
+	printf("%4d %-6s %8lu %12.1f %12.1f\n", bpp, g_opnames[op], (unsigned long)npixels, (double)pixels / NPASSES, (double)kernel / NPASSES);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+	unsigned long ncases;
+	int op;
+
+	ncases = test_check(16);
+	ncases += test_check(32);
+	printf("%lu runs match the byte-wise reference\n", ncases);
+
+	printf("%4s %-6s %8s %12s %12s\n", "bpp", "Run", "Pixels", "Pixels ns", "Words ns");
+	for (op = OP_FILL; op <= OP_COPY; op++) {
+		test_measure(16, op, 800);
+		test_measure(32, op, 800);
+	}
+
+	return EXIT_SUCCESS;
+}
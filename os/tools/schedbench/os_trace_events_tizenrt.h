@@ -0,0 +1,14 @@
+/****************************************************************************
+ * tools/schedbench/os_trace_events_tizenrt.h
+ *
+ * Trace points are compiled out in the host build of schedbench.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_SCHEDBENCH_OS_TRACE_EVENTS_TIZENRT_H
+#define __TOOLS_SCHEDBENCH_OS_TRACE_EVENTS_TIZENRT_H
+
+#define OS_TRACE_TASK_SUSPENDED(tcb)
+#define OS_TRACE_TASK_READY(tcb)
+
+#endif							/* __TOOLS_SCHEDBENCH_OS_TRACE_EVENTS_TIZENRT_H */
@@ -0,0 +1,54 @@
+/****************************************************************************
+ * tools/schedbench/sched/sched.h
+ *
+ * The part of kernel/sched/sched.h and of the TCB that the ready-to-run
+ * list code uses, so that schedbench can build that code on the host.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_SCHEDBENCH_SCHED_SCHED_H
+#define __TOOLS_SCHEDBENCH_SCHED_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <queue.h>
+
+#define SCHED_PRIORITY_MIN     1
+#define SCHED_PRIORITY_MAX     255
+
+#define ASSERT(f)              assert(f)
+#define DEBUGASSERT(f)         assert(f)
+
+#define sched_note_switch(t1, t2)
+#define sched_latency_switch(from, to)
+
+enum tstate_e {
+	TSTATE_TASK_INVALID = 0,
+	TSTATE_TASK_PENDING,
+	TSTATE_TASK_READYTORUN,
+	TSTATE_TASK_RUNNING
+};
+
+struct tcb_s {
+	FAR struct tcb_s *flink;
+	FAR struct tcb_s *blink;
+	uint8_t sched_priority;
+	uint8_t task_state;
+};
+
+extern volatile dq_queue_t g_readytorun;
+
+bool sched_addprioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list);
+bool sched_removereadytorun(FAR struct tcb_s *rtcb);
+
+#ifdef CONFIG_SCHED_RTRINDEX
+FAR struct tcb_s *sched_rtrindex_prev(uint8_t sched_priority);
+void sched_rtrindex_add(FAR struct tcb_s *tcb);
+void sched_rtrindex_remove(FAR struct tcb_s *tcb);
+#else
+#define sched_rtrindex_add(tcb)
+#define sched_rtrindex_remove(tcb)
+#endif
+
+#endif							/* __TOOLS_SCHEDBENCH_SCHED_SCHED_H */
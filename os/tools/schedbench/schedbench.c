@@ -0,0 +1,207 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/schedbench/schedbench.c
+ *
+ * Measures on the host what adding a TCB to and removing a TCB from the
+ * ready-to-run list costs for growing numbers of ready tasks.  The real
+ * kernel/sched/sched_addprioritized.c and sched_removereadytorun.c are
+ * built against a minimal TCB, once as they are and once with
+ * CONFIG_SCHED_RTRINDEX:
+ *
+ *   make -f Makefile.host schedbench
+ *   ./schedbench_list; ./schedbench_index
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sched/sched.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MAX_TASKS      256
+#define NITERATIONS    20000
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+volatile dq_queue_t g_readytorun;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct tcb_s g_idle;
+static struct tcb_s g_tcbs[MAX_TASKS];
+static uint32_t g_seed = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static unsigned int bench_random(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return g_seed >> 8;
+}
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint8_t bench_priority(void)
+{
+	return SCHED_PRIORITY_MIN + bench_random() % (SCHED_PRIORITY_MAX - SCHED_PRIORITY_MIN);
+}
+
+static void bench_add(FAR struct tcb_s *tcb)
+{
+	sched_addprioritized(tcb, (FAR dq_queue_t *)&g_readytorun);
+	tcb->task_state = TSTATE_TASK_READYTORUN;
+}
+
+/* Verify that the list is ordered by priority and ends with the IDLE task */
+
+static void bench_check(int ntasks)
+{
+	FAR struct tcb_s *tcb;
+	FAR struct tcb_s *prev = NULL;
+	int count = 0;
+
+	for (tcb = (FAR struct tcb_s *)g_readytorun.head; tcb; tcb = tcb->flink) {
+		if (tcb->blink != prev || (prev && prev->sched_priority < tcb->sched_priority)) {
+			fprintf(stderr, "ERROR: ready-to-run list out of order\n");
+			exit(EXIT_FAILURE);
+		}
+
+		prev = tcb;
+		count++;
+	}
+
+	if (prev != &g_idle || (FAR struct tcb_s *)g_readytorun.tail != &g_idle || count != ntasks + 1) {
+		fprintf(stderr, "ERROR: ready-to-run list has %d TCBs, expected %d\n", count, ntasks + 1);
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void bench_run(int ntasks)
+{
+	uint64_t addtime = 0;
+	uint64_t remtime = 0;
+	uint64_t start;
+	int batch = ntasks > 1 ? ntasks / 2 : 1;
+	int first;
+	int iter;
+	int i;
+
+	for (i = 0; i < ntasks; i++) {
+		g_tcbs[i].sched_priority = bench_priority();
+		bench_add(&g_tcbs[i]);
+	}
+
+	bench_check(ntasks);
+
+	/* Take a batch of tasks out and put them back with new priorities, as
+	 * tasks that block and wake up.
+	 */
+
+	for (iter = 0; iter < NITERATIONS; iter++) {
+		first = bench_random() % (ntasks - batch + 1);
+
+		start = bench_nsec();
+		for (i = first; i < first + batch; i++) {
+			sched_removereadytorun(&g_tcbs[i]);
+		}
+
+		remtime += bench_nsec() - start;
+
+		for (i = first; i < first + batch; i++) {
+			g_tcbs[i].sched_priority = bench_priority();
+		}
+
+		start = bench_nsec();
+		for (i = first; i < first + batch; i++) {
+			bench_add(&g_tcbs[i]);
+		}
+
+		addtime += bench_nsec() - start;
+	}
+
+	bench_check(ntasks);
+
+	printf("%6d %12.1f %12.1f %12.1f\n", ntasks, (double)addtime / ((uint64_t)NITERATIONS * batch), (double)remtime / ((uint64_t)NITERATIONS * batch), (double)(addtime + remtime) / ((uint64_t)NITERATIONS * batch));
+
+	for (i = 0; i < ntasks; i++) {
+		sched_removereadytorun(&g_tcbs[i]);
+	}
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+	int maxtasks = 128;
+	int ntasks;
+
+	if (argc > 1) {
+		maxtasks = atoi(argv[1]);
+		if (maxtasks < 1 || maxtasks > MAX_TASKS) {
+			fprintf(stderr, "USAGE: %s [1..%d]\n", argv[0], MAX_TASKS);
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* The IDLE task is always at the end of the list */
+
+	dq_init(&g_readytorun);
+	g_idle.task_state = TSTATE_TASK_RUNNING;
+	dq_addfirst((FAR dq_entry_t *)&g_idle, (FAR dq_queue_t *)&g_readytorun);
+	sched_rtrindex_add(&g_idle);
+
+#ifdef CONFIG_SCHED_RTRINDEX
+	printf("Ready-to-run list with priority index\n");
+#else
+	printf("Ready-to-run list\n");
+#endif
+	printf("%6s %12s %12s %12s\n", "Tasks", "Add ns", "Remove ns", "Total ns");
+
+	/* Finer steps from 8 tasks on, where the two ways cross over */
+
+	for (ntasks = 1; ntasks <= maxtasks; ntasks += ntasks < 8 ? ntasks : ntasks / 4) {
+		bench_run(ntasks);
+	}
+
+	return EXIT_SUCCESS;
+}
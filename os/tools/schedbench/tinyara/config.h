@@ -0,0 +1,13 @@
+/****************************************************************************
+ * tools/schedbench/tinyara/config.h
+ *
+ * Stands in for the generated configuration when scheduler sources are
+ * built on the host by schedbench.  CONFIG_SCHED_RTRINDEX is set on the
+ * command line.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_SCHEDBENCH_TINYARA_CONFIG_H
+#define __TOOLS_SCHEDBENCH_TINYARA_CONFIG_H
+
+#endif							/* __TOOLS_SCHEDBENCH_TINYARA_CONFIG_H */
@@ -0,0 +1,31 @@
+/****************************************************************************
+ * tools/smartbench/debug.h
+ *
+ * Debug output and assertions are compiled out in smartbench, as in a
+ * build without CONFIG_DEBUG.  This also provides the few definitions
+ * that the driver gets from other target headers.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_SMARTBENCH_DEBUG_H
+#define __TOOLS_SMARTBENCH_DEBUG_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#define OK                     0
+#define ERROR                  -1
+#define TRUE                   1
+#define FALSE                  0
+
+#define dbg(...)
+#define fdbg(...)
+#define fvdbg(...)
+#define DEBUGASSERT(f)
+#define ASSERT(f)
+
+#define get_errno_ptr()        (&errno)
+
+#define zalloc(s)              calloc(1, s)
+
+#endif							/* __TOOLS_SMARTBENCH_DEBUG_H */
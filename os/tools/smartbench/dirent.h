@@ -0,0 +1,16 @@
+/****************************************************************************
+ * tools/smartbench/dirent.h
+ *
+ * The host dirent.h plus the TinyAra entry types.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_SMARTBENCH_DIRENT_H
+#define __TOOLS_SMARTBENCH_DIRENT_H
+
+#include_next <dirent.h>
+
+#define DTYPE_FILE             0x01
+#define DTYPE_DIRECTORY        0x08
+
+#endif							/* __TOOLS_SMARTBENCH_DIRENT_H */
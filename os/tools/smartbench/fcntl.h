@@ -0,0 +1,16 @@
+/****************************************************************************
+ * tools/smartbench/fcntl.h
+ *
+ * The host fcntl.h plus the TinyAra O_WROK, which is set for O_WRONLY and
+ * O_RDWR opens alike.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_SMARTBENCH_FCNTL_H
+#define __TOOLS_SMARTBENCH_FCNTL_H
+
+#include_next <fcntl.h>
+
+#define O_WROK                 (O_WRONLY | O_RDWR)
+
+#endif							/* __TOOLS_SMARTBENCH_FCNTL_H */
@@ -0,0 +1,372 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/smartbench/smartbench.c
+ *
+ * Measures on the host what mounting a SMART device costs for growing
+ * flash sizes.  The real fs/driver/mtd/smart.c runs on a RAM MTD device
+ * whose reads are counted.  The device is formatted and mostly filled,
+ * then mounted again after a clean close, after changes that were synced
+ * and after changes that were not.  Every mount checks all the sectors
+ * read back as written.  The driver is built once as it is and once with
+ * CONFIG_MTD_SMART_MAP_CHECKPOINT:
+ *
+ *   make -f Makefile.host smartbench
+ *   ./smartbench_scan; ./smartbench_ckpt
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/ioctl.h>
+#include <tinyara/fs/mtd.h>
+#include <tinyara/fs/smart.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MAX_SECTORS    65536
+
+/* SMART_FIRST_ALLOC_SECTOR, the sectors below are reserved */
+
+#define FIRST_SECTOR   12
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Counts the reads of the RAM MTD device it wraps */
+
+struct bench_mtd_s {
+	struct mtd_dev_s mtd;
+	FAR struct mtd_dev_s *ram;
+	uint32_t reads;
+	uint32_t readbytes;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct bench_mtd_s g_mtd;
+static FAR const struct block_operations *g_bops;
+static struct inode g_inode;
+
+/* The sequence number written to each logical sector, 0 if not allocated */
+
+static uint16_t g_contents[MAX_SECTORS];
+static uint8_t g_buffer[CONFIG_MTD_SMART_SECTOR_SIZE];
+static uint32_t g_seed = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static unsigned int bench_random(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return g_seed >> 8;
+}
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void bench_fail(FAR const char *what, int ret)
+{
+	fprintf(stderr, "ERROR: %s failed: %d\n", what, ret);
+	exit(EXIT_FAILURE);
+}
+
+static int bench_erase(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks)
+{
+	return g_mtd.ram->erase(g_mtd.ram, startblock, nblocks);
+}
+
+static ssize_t bench_bread(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks, FAR uint8_t *buffer)
+{
+	ssize_t ret = g_mtd.ram->bread(g_mtd.ram, startblock, nblocks, buffer);
+
+	g_mtd.reads++;
+	if (ret > 0) {
+		g_mtd.readbytes += ret * CONFIG_RAMMTD_BLOCKSIZE;
+	}
+
+	return ret;
+}
+
+static ssize_t bench_bwrite(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks, FAR const uint8_t *buffer)
+{
+	return g_mtd.ram->bwrite(g_mtd.ram, startblock, nblocks, buffer);
+}
+
+static ssize_t bench_read(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes, FAR uint8_t *buffer)
+{
+	ssize_t ret = g_mtd.ram->read(g_mtd.ram, offset, nbytes, buffer);
+
+	g_mtd.reads++;
+	if (ret > 0) {
+		g_mtd.readbytes += ret;
+	}
+
+	return ret;
+}
+
+static int bench_ioctl(FAR struct mtd_dev_s *dev, int cmd, unsigned long arg)
+{
+	return g_mtd.ram->ioctl(g_mtd.ram, cmd, arg);
+}
+
+static int bench_blkioctl(int cmd, unsigned long arg)
+{
+	return g_bops->ioctl(&g_inode, cmd, arg);
+}
+
+static void bench_write(uint16_t logsector, uint16_t seq)
+{
+	struct smart_read_write_s req;
+	int ret;
+
+	memset(g_buffer, seq & 0xff, sizeof(g_buffer));
+	g_buffer[0] = seq >> 8;
+
+	req.logsector = logsector;
+	req.offset = 0;
+	req.count = sizeof(g_buffer) - 16;
+	req.buffer = g_buffer;
+	ret = bench_blkioctl(BIOC_WRITESECT, (unsigned long)&req);
+	if (ret < 0) {
+		bench_fail("BIOC_WRITESECT", ret);
+	}
+
+	g_contents[logsector] = seq;
+}
+
+/* Allocate, rewrite and free sectors as a file system would */
+
+static void bench_churn(int nops, int nsectors)
+{
+	static uint16_t seq;
+	int ret;
+	int op;
+	int x;
+
+	for (op = 0; op < nops; op++) {
+		x = FIRST_SECTOR + bench_random() % (nsectors - FIRST_SECTOR);
+
+		/* Rewritten sectors are freed and allocated again, which lets the
+		 * allocation collect garbage.
+		 */
+
+		if (g_contents[x] != 0) {
+			ret = bench_blkioctl(BIOC_FREESECT, x);
+			if (ret < 0) {
+				bench_fail("BIOC_FREESECT", ret);
+			}
+
+			g_contents[x] = 0;
+			if (bench_random() % 4 == 0) {
+				continue;
+			}
+		}
+
+		ret = bench_blkioctl(BIOC_ALLOCSECT, x);
+		if (ret != x) {
+			bench_fail("BIOC_ALLOCSECT", ret);
+		}
+
+		bench_write(x, ++seq ? seq : ++seq);
+	}
+}
+
+static void bench_verify(int nsectors)
+{
+	struct smart_read_write_s req;
+	int ret;
+	int x;
+
+	for (x = FIRST_SECTOR; x < nsectors; x++) {
+		if (g_contents[x] == 0) {
+			continue;
+		}
+
+		req.logsector = x;
+		req.offset = 0;
+		req.count = sizeof(g_buffer) - 16;
+		req.buffer = g_buffer;
+		ret = bench_blkioctl(BIOC_READSECT, (unsigned long)&req);
+		if (ret < 0 || g_buffer[0] != g_contents[x] >> 8 || g_buffer[1] != (g_contents[x] & 0xff)) {
+			fprintf(stderr, "ERROR: logical sector %d does not read back\n", x);
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+/* Mount the device in RAM as after a reset and check its contents */
+
+static void bench_mount(FAR const char *how, int nsectors)
+{
+	struct smart_format_s fmt;
+	uint64_t start;
+	uint64_t elapsed;
+	int ret;
+
+	g_mtd.reads = 0;
+	g_mtd.readbytes = 0;
+
+	start = bench_nsec();
+	ret = smart_initialize(0, &g_mtd.mtd, NULL);
+	if (ret < 0) {
+		bench_fail("smart_initialize", ret);
+	}
+
+	ret = bench_blkioctl(BIOC_GETFORMAT, (unsigned long)&fmt);
+	elapsed = bench_nsec() - start;
+	if (ret < 0 || (fmt.flags & SMART_FMT_ISFORMATTED) == 0) {
+		bench_fail("BIOC_GETFORMAT", ret);
+	}
+
+	printf("%8d %-10s %10.1f %10u %12u\n", nsectors, how, elapsed / 1000.0, g_mtd.reads, g_mtd.readbytes);
+
+	bench_verify(nsectors);
+}
+
+static void bench_run(size_t size)
+{
+	struct smart_format_s fmt;
+	FAR uint8_t *flash;
+	int nsectors;
+	int ret;
+
+	flash = malloc(size);
+	if (flash == NULL) {
+		bench_fail("malloc", -ENOMEM);
+	}
+
+	memset(g_contents, 0, sizeof(g_contents));
+	g_mtd.ram = rammtd_initialize(flash, size);
+	if (g_mtd.ram == NULL) {
+		bench_fail("rammtd_initialize", -ENOMEM);
+	}
+
+	ret = smart_initialize(0, &g_mtd.mtd, NULL);
+	if (ret < 0) {
+		bench_fail("smart_initialize", ret);
+	}
+
+	ret = bench_blkioctl(BIOC_LLFORMAT, 0);
+	if (ret < 0) {
+		bench_fail("BIOC_LLFORMAT", ret);
+	}
+
+	ret = bench_blkioctl(BIOC_GETFORMAT, (unsigned long)&fmt);
+	if (ret < 0) {
+		bench_fail("BIOC_GETFORMAT", ret);
+	}
+
+	/* Use about half of the sectors */
+
+	nsectors = fmt.nsectors / 2;
+	bench_churn(nsectors * 4, nsectors);
+	g_bops->close(&g_inode);
+	bench_mount("clean", nsectors);
+
+	/* Changes made since, then synced */
+
+	bench_churn(nsectors / 16 + 1, nsectors);
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+	ret = bench_blkioctl(BIOC_FLUSH, 0);
+	if (ret < 0) {
+		bench_fail("BIOC_FLUSH", ret);
+	}
+#endif
+	bench_mount("synced", nsectors);
+
+	/* Changes that were not */
+
+	bench_churn(nsectors / 16 + 1, nsectors);
+	bench_mount("unsynced", nsectors);
+
+	free(g_mtd.ram);
+	free(flash);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* smart_initialize() registers a block driver for each mount.  Only the
+ * last one is used.
+ */
+
+int register_blockdriver(FAR const char *path, FAR const struct block_operations *bops, mode_t mode, FAR void *priv)
+{
+	g_bops = bops;
+	g_inode.i_private = priv;
+	return OK;
+}
+
+int main(int argc, char **argv)
+{
+	size_t maxsize = 16;
+	size_t size;
+
+	if (argc > 1) {
+		maxsize = atoi(argv[1]);
+		if (maxsize < 1 || maxsize > 32) {
+			fprintf(stderr, "USAGE: %s [1..32 MiB]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	g_mtd.mtd.erase = bench_erase;
+	g_mtd.mtd.bread = bench_bread;
+	g_mtd.mtd.bwrite = bench_bwrite;
+	g_mtd.mtd.read = bench_read;
+	g_mtd.mtd.ioctl = bench_ioctl;
+
+#ifdef CONFIG_MTD_SMART_MAP_CHECKPOINT
+	printf("SMART mount with sector map checkpoint\n");
+#else
+	printf("SMART mount\n");
+#endif
+	printf("%8s %-10s %10s %10s %12s\n", "Sectors", "After", "Mount us", "Reads", "Bytes read");
+
+	for (size = 256 * 1024; size <= maxsize * 1024 * 1024; size *= 2) {
+		bench_run(size);
+	}
+
+	return EXIT_SUCCESS;
+}
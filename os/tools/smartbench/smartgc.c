@@ -0,0 +1,453 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/smartbench/smartgc.c
+ *
+ * Replays a write workload against the real fs/driver/mtd/smart.c on a RAM
+ * MTD device and reports the latency of the writes.  The device is filled
+ * to a given level, then sectors are rewritten in bursts separated by idle
+ * time, most of them from a small hot set, with files created and deleted
+ * now and then.  The RAM device takes no time, so the time of every read,
+ * program and erase is simulated with typical SPI NOR flash figures, and
+ * the queued background work runs in the idle time.  At the end all the
+ * sectors are checked, also after mounting the device again.  The driver
+ * is built as it is, with CONFIG_MTD_SMART_GC_COSTBENEFIT, and with that
+ * and CONFIG_MTD_SMART_GC_BACKGROUND:
+ *
+ *   make -f Makefile.host smartgc
+ *   ./smartgc_greedy; ./smartgc_costbenefit; ./smartgc_background
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/clock.h>
+#include <tinyara/wqueue.h>
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/ioctl.h>
+#include <tinyara/fs/mtd.h>
+#include <tinyara/fs/smart.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define DEVICE_SIZE    (2 * 1024 * 1024)
+#define MAX_SECTORS    65536
+#define MAX_WRITES     1000000
+
+/* SMART_FIRST_ALLOC_SECTOR, the sectors below are reserved */
+
+#define FIRST_SECTOR   12
+
+/* Simulated flash timing in microseconds */
+
+#define READ_USEC      40		/* Per MTD block read */
+#define PROGRAM_USEC   800		/* Per MTD block programmed */
+#define ERASE_USEC     (45000 * (CONFIG_RAMMTD_ERASESIZE / 4096))
+
+/* The workload */
+
+#define BURST_WRITES   16		/* Writes back to back */
+#define IDLE_MSEC      250		/* Idle time between bursts */
+#define HOT_PERCENT    10		/* Share of the sectors that are hot */
+#define HOT_WRITES     90		/* Share of the writes to hot sectors */
+#define CREATE_PERMIL  20		/* Writes that delete and create a file */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Counts the operations of the RAM MTD device it wraps */
+
+struct bench_mtd_s {
+	struct mtd_dev_s mtd;
+	FAR struct mtd_dev_s *ram;
+	uint32_t programs;
+	uint32_t erases;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct bench_mtd_s g_mtd;
+static FAR const struct block_operations *g_bops;
+static struct inode g_inode;
+
+/* The simulated time in microseconds */
+
+static uint64_t g_now;
+
+/* The only work queued by the driver, and when it is due */
+
+static FAR struct work_s *g_work;
+static uint64_t g_workdue;
+
+/* The sequence number written to each logical sector, 0 if not allocated */
+
+static uint16_t g_contents[MAX_SECTORS];
+static uint16_t g_seq;
+static uint32_t g_latency[MAX_WRITES];
+static int g_nwrites;
+static uint8_t g_buffer[CONFIG_MTD_SMART_SECTOR_SIZE];
+static uint32_t g_seed = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static unsigned int bench_random(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return g_seed >> 8;
+}
+
+static void bench_fail(FAR const char *what, int ret)
+{
+	fprintf(stderr, "ERROR: %s failed: %d\n", what, ret);
+	exit(EXIT_FAILURE);
+}
+
+static int bench_erase(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks)
+{
+	g_mtd.erases += nblocks;
+	g_now += (uint64_t)nblocks * ERASE_USEC;
+	return g_mtd.ram->erase(g_mtd.ram, startblock, nblocks);
+}
+
+static ssize_t bench_bread(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks, FAR uint8_t *buffer)
+{
+	g_now += (uint64_t)nblocks * READ_USEC;
+	return g_mtd.ram->bread(g_mtd.ram, startblock, nblocks, buffer);
+}
+
+static ssize_t bench_bwrite(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks, FAR const uint8_t *buffer)
+{
+	g_mtd.programs += nblocks;
+	g_now += (uint64_t)nblocks * PROGRAM_USEC;
+	return g_mtd.ram->bwrite(g_mtd.ram, startblock, nblocks, buffer);
+}
+
+static ssize_t bench_read(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes, FAR uint8_t *buffer)
+{
+	g_now += (nbytes + CONFIG_RAMMTD_BLOCKSIZE - 1) / CONFIG_RAMMTD_BLOCKSIZE * READ_USEC;
+	return g_mtd.ram->read(g_mtd.ram, offset, nbytes, buffer);
+}
+
+static int bench_ioctl(FAR struct mtd_dev_s *dev, int cmd, unsigned long arg)
+{
+	return g_mtd.ram->ioctl(g_mtd.ram, cmd, arg);
+}
+
+static int bench_blkioctl(int cmd, unsigned long arg)
+{
+	return g_bops->ioctl(&g_inode, cmd, arg);
+}
+
+static void bench_writesect(uint16_t logsector)
+{
+	struct smart_read_write_s req;
+	int ret;
+
+	g_seq = g_seq + 1 ? g_seq + 1 : 1;
+	memset(g_buffer, g_seq & 0xff, sizeof(g_buffer));
+	g_buffer[0] = g_seq >> 8;
+
+	req.logsector = logsector;
+	req.offset = 0;
+	req.count = sizeof(g_buffer) - 16;
+	req.buffer = g_buffer;
+	ret = bench_blkioctl(BIOC_WRITESECT, (unsigned long)&req);
+	if (ret < 0) {
+		bench_fail("BIOC_WRITESECT", ret);
+	}
+
+	g_contents[logsector] = g_seq;
+}
+
+static void bench_create(uint16_t logsector)
+{
+	int ret;
+
+	ret = bench_blkioctl(BIOC_ALLOCSECT, logsector);
+	if (ret != logsector) {
+		bench_fail("BIOC_ALLOCSECT", ret);
+	}
+
+	bench_writesect(logsector);
+}
+
+static void bench_delete(uint16_t logsector)
+{
+	int ret;
+
+	ret = bench_blkioctl(BIOC_FREESECT, logsector);
+	if (ret < 0) {
+		bench_fail("BIOC_FREESECT", ret);
+	}
+
+	g_contents[logsector] = 0;
+}
+
+/* Run the background work that is due before the given time */
+
+static void bench_idle(uint64_t until)
+{
+	FAR struct work_s *work;
+	worker_t worker;
+
+	while (g_work != NULL && g_work->worker != NULL) {
+		work = g_work;
+		if (g_workdue > g_now) {
+			if (g_workdue >= until) {
+				break;
+			}
+
+			g_now = g_workdue;
+		} else if (g_now >= until) {
+			break;
+		}
+
+		worker = work->worker;
+		work->worker = NULL;
+		worker(work->arg);
+	}
+
+	if (g_now < until) {
+		g_now = until;
+	}
+}
+
+/* One write of the workload */
+
+static void bench_op(int nsectors, int nhot)
+{
+	uint16_t x;
+
+	if (bench_random() % 1000 < CREATE_PERMIL) {
+		/* Replace a cold sector, as a file deleted and another created */
+
+		x = FIRST_SECTOR + nhot + bench_random() % (nsectors - FIRST_SECTOR - nhot);
+		bench_delete(x);
+		bench_create(x);
+	} else if (bench_random() % 100 < HOT_WRITES) {
+		x = FIRST_SECTOR + bench_random() % nhot;
+		bench_writesect(x);
+	} else {
+		x = FIRST_SECTOR + nhot + bench_random() % (nsectors - FIRST_SECTOR - nhot);
+		bench_writesect(x);
+	}
+}
+
+static void bench_verify(int nsectors)
+{
+	struct smart_read_write_s req;
+	int ret;
+	int x;
+
+	for (x = FIRST_SECTOR; x < nsectors; x++) {
+		if (g_contents[x] == 0) {
+			continue;
+		}
+
+		req.logsector = x;
+		req.offset = 0;
+		req.count = sizeof(g_buffer) - 16;
+		req.buffer = g_buffer;
+		ret = bench_blkioctl(BIOC_READSECT, (unsigned long)&req);
+		if (ret < 0 || g_buffer[0] != g_contents[x] >> 8 || g_buffer[1] != (g_contents[x] & 0xff)) {
+			fprintf(stderr, "ERROR: logical sector %d does not read back\n", x);
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+static int bench_compare(FAR const void *a, FAR const void *b)
+{
+	uint32_t x = *(FAR const uint32_t *)a;
+	uint32_t y = *(FAR const uint32_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static void bench_run(int fill, int nwrites)
+{
+	struct smart_format_s fmt;
+	FAR uint8_t *flash;
+	uint64_t arrival;
+	uint32_t programs;
+	uint32_t erases;
+	int nsectors;
+	int nhot;
+	int ret;
+	int x;
+
+	flash = malloc(DEVICE_SIZE);
+	if (flash == NULL) {
+		bench_fail("malloc", -ENOMEM);
+	}
+
+	memset(g_contents, 0, sizeof(g_contents));
+	g_mtd.ram = rammtd_initialize(flash, DEVICE_SIZE);
+	if (g_mtd.ram == NULL) {
+		bench_fail("rammtd_initialize", -ENOMEM);
+	}
+
+	ret = smart_initialize(0, &g_mtd.mtd, NULL);
+	if (ret < 0) {
+		bench_fail("smart_initialize", ret);
+	}
+
+	ret = bench_blkioctl(BIOC_LLFORMAT, 0);
+	if (ret < 0) {
+		bench_fail("BIOC_LLFORMAT", ret);
+	}
+
+	ret = bench_blkioctl(BIOC_GETFORMAT, (unsigned long)&fmt);
+	if (ret < 0) {
+		bench_fail("BIOC_GETFORMAT", ret);
+	}
+
+	/* Fill the device to the given percentage */
+
+	nsectors = fmt.nsectors * fill / 100;
+	nhot = (nsectors - FIRST_SECTOR) * HOT_PERCENT / 100;
+	for (x = FIRST_SECTOR; x < nsectors; x++) {
+		bench_create(x);
+	}
+
+	/* Replay the writes in bursts and measure them */
+
+	g_nwrites = 0;
+	programs = g_mtd.programs;
+	erases = g_mtd.erases;
+
+	while (g_nwrites < nwrites) {
+		bench_idle(g_now + IDLE_MSEC * 1000);
+
+		for (x = 0; x < BURST_WRITES && g_nwrites < nwrites; x++) {
+			arrival = g_now;
+			bench_op(nsectors, nhot);
+			g_latency[g_nwrites++] = g_now - arrival;
+		}
+	}
+
+	programs = g_mtd.programs - programs;
+	erases = g_mtd.erases - erases;
+
+	qsort(g_latency, g_nwrites, sizeof(uint32_t), bench_compare);
+	printf("%4d%% %8d %10.2f %10.2f %10.2f %10.2f %8u %10.2f\n", fill, g_nwrites, g_latency[g_nwrites / 2] / 1000.0, g_latency[g_nwrites * 99 / 100] / 1000.0, g_latency[g_nwrites * 999 / 1000] / 1000.0, g_latency[g_nwrites - 1] / 1000.0, erases, (double)programs / g_nwrites);
+
+	/* Check the contents, also as found by a scan */
+
+	bench_verify(nsectors);
+	g_work = NULL;
+	ret = smart_initialize(0, &g_mtd.mtd, NULL);
+	if (ret < 0) {
+		bench_fail("smart_initialize", ret);
+	}
+
+	bench_verify(nsectors);
+
+	free(g_mtd.ram);
+	free(flash);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* smart_initialize() registers a block driver for each mount.  Only the
+ * last one is used.
+ */
+
+int register_blockdriver(FAR const char *path, FAR const struct block_operations *bops, mode_t mode, FAR void *priv)
+{
+	g_bops = bops;
+	g_inode.i_private = priv;
+	return OK;
+}
+
+uint32_t clock_systimer(void)
+{
+	return (uint32_t)(g_now / 1000);
+}
+
+int work_queue(int qid, FAR struct work_s *work, worker_t worker, FAR void *arg, uint32_t delay)
+{
+	work->worker = worker;
+	work->arg = arg;
+	work->qtime = clock_systimer();
+	work->delay = delay;
+
+	g_work = work;
+	g_workdue = g_now + (uint64_t)delay * 1000;
+	return OK;
+}
+
+int work_cancel(int qid, FAR struct work_s *work)
+{
+	work->worker = NULL;
+	return OK;
+}
+
+int main(int argc, char **argv)
+{
+	int nwrites = 20000;
+	int fill;
+
+	if (argc > 1) {
+		nwrites = atoi(argv[1]);
+		if (nwrites < 1 || nwrites > MAX_WRITES) {
+			fprintf(stderr, "USAGE: %s [1..%d writes]\n", argv[0], MAX_WRITES);
+			return EXIT_FAILURE;
+		}
+	}
+
+	g_mtd.mtd.erase = bench_erase;
+	g_mtd.mtd.bread = bench_bread;
+	g_mtd.mtd.bwrite = bench_bwrite;
+	g_mtd.mtd.read = bench_read;
+	g_mtd.mtd.ioctl = bench_ioctl;
+
+#if defined(CONFIG_MTD_SMART_GC_BACKGROUND)
+	printf("SMART writes, cost-benefit and background garbage collection\n");
+#elif defined(CONFIG_MTD_SMART_GC_COSTBENEFIT)
+	printf("SMART writes, cost-benefit garbage collection\n");
+#else
+	printf("SMART writes\n");
+#endif
+	printf("%5s %8s %10s %10s %10s %10s %8s %10s\n", "Full", "Writes", "p50 ms", "p99 ms", "p99.9 ms", "Max ms", "Erases", "Blks/write");
+
+	for (fill = 50; fill <= 80; fill += 15) {
+		bench_run(fill, nwrites);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,450 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/smartbench/smartpath.c
+ *
+ * Measures on the host what looking up a path costs in SmartFS for
+ * growing directory sizes.  The real fs/smartfs and fs/driver/mtd/smart.c
+ * run on a RAM MTD device whose reads are counted.  A tree of directories
+ * and files is created, then the files are stat()ed, mostly a few of
+ * them over and over, as an application reading its configuration would.
+ * Files are deleted and created again and renamed back and forth among
+ * the lookups, and every stat() is checked against what the tree should
+ * hold.  SmartFS is built once as it is and once with CONFIG_SMARTFS_DCACHE:
+ *
+ *   make -f Makefile.host smartpath
+ *   ./smartpath_read; ./smartpath_dcache
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <debug.h>
+#include <sys/stat.h>
+
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/ioctl.h>
+#include <tinyara/fs/mtd.h>
+#include <tinyara/fs/smart.h>
+
+#include "smartfs/smartfs.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define FLASH_SIZE     (4 * 1024 * 1024)
+#define MAX_FANOUT     64
+#define NFILES(f)      (4 * (f))
+#define NHOT           8
+#define NLOOKUPS       20000
+#define CHURN_PERIOD   100
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Counts the reads of the RAM MTD device it wraps */
+
+struct bench_mtd_s {
+	struct mtd_dev_s mtd;
+	FAR struct mtd_dev_s *ram;
+	uint32_t reads;
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+extern const struct mountpt_operations smartfs_operations;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct bench_mtd_s g_mtd;
+static struct inode g_blkinode;
+static struct inode g_mntinode;
+static uint32_t g_seed = 1;
+
+/* Whether each file exists under its own name, and whether it has been
+ * renamed to its other name.
+ */
+
+static uint8_t g_exists[NFILES(MAX_FANOUT)];
+static uint8_t g_renamed[NFILES(MAX_FANOUT)];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static unsigned int bench_random(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return g_seed >> 8;
+}
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void bench_fail(FAR const char *what, int ret)
+{
+	fprintf(stderr, "ERROR: %s failed: %d\n", what, ret);
+	exit(EXIT_FAILURE);
+}
+
+static int bench_erase(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks)
+{
+	return g_mtd.ram->erase(g_mtd.ram, startblock, nblocks);
+}
+
+static ssize_t bench_bread(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks, FAR uint8_t *buffer)
+{
+	g_mtd.reads++;
+	return g_mtd.ram->bread(g_mtd.ram, startblock, nblocks, buffer);
+}
+
+static ssize_t bench_bwrite(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks, FAR const uint8_t *buffer)
+{
+	return g_mtd.ram->bwrite(g_mtd.ram, startblock, nblocks, buffer);
+}
+
+static ssize_t bench_read(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes, FAR uint8_t *buffer)
+{
+	g_mtd.reads++;
+	return g_mtd.ram->read(g_mtd.ram, offset, nbytes, buffer);
+}
+
+static int bench_ioctl(FAR struct mtd_dev_s *dev, int cmd, unsigned long arg)
+{
+	return g_mtd.ram->ioctl(g_mtd.ram, cmd, arg);
+}
+
+static int bench_blkioctl(int cmd, unsigned long arg)
+{
+	return g_blkinode.u.i_bops->ioctl(&g_blkinode, cmd, arg);
+}
+
+/* Low-level format the device and write an empty root directory, as
+ * mksmartfs() does.
+ */
+
+static void bench_format(void)
+{
+	struct smart_read_write_s req;
+	uint8_t type = SMARTFS_SECTOR_TYPE_DIR;
+	int ret;
+
+	ret = bench_blkioctl(BIOC_LLFORMAT, 0);
+	if (ret < 0) {
+		bench_fail("BIOC_LLFORMAT", ret);
+	}
+
+	ret = bench_blkioctl(BIOC_ALLOCSECT, SMARTFS_ROOT_DIR_SECTOR);
+	if (ret != SMARTFS_ROOT_DIR_SECTOR) {
+		bench_fail("BIOC_ALLOCSECT", ret);
+	}
+
+	req.logsector = SMARTFS_ROOT_DIR_SECTOR;
+	req.offset = 0;
+	req.count = 1;
+	req.buffer = &type;
+	ret = bench_blkioctl(BIOC_WRITESECT, (unsigned long)&req);
+	if (ret < 0) {
+		bench_fail("BIOC_WRITESECT", ret);
+	}
+}
+
+/* File n is in one of the directories dir0/sub0, dir0/sub1, dir1/sub0
+ * and dir1/sub1, each of which has fanout files.  The other name of a
+ * file is in the next of these directories.
+ */
+
+static void bench_path(FAR char *path, int n, int fanout, bool renamed)
+{
+	int dir = (n / fanout + (renamed ? 1 : 0)) % 4;
+
+	sprintf(path, "dir%d/sub%d/%s%d.cfg", dir / 2, dir % 2, renamed ? "moved" : "file", n);
+}
+
+/* Each file holds as many bytes as its number plus one */
+
+static void bench_create(int n, int fanout)
+{
+	struct file file;
+	char path[64];
+	char data[NFILES(MAX_FANOUT) + 1];
+	ssize_t nwritten;
+	int ret;
+
+	bench_path(path, n, fanout, false);
+	memset(&file, 0, sizeof(file));
+	file.f_inode = &g_mntinode;
+	ret = smartfs_operations.open(&file, path, O_CREAT | O_WRONLY, 0666);
+	if (ret < 0) {
+		bench_fail("open", ret);
+	}
+
+	memset(data, 'x', n + 1);
+	nwritten = smartfs_operations.write(&file, data, n + 1);
+	if (nwritten != n + 1) {
+		bench_fail("write", nwritten);
+	}
+
+	smartfs_operations.close(&file);
+	g_exists[n] = TRUE;
+	g_renamed[n] = FALSE;
+}
+
+static void bench_mkdir(FAR const char *fmt, int a, int b)
+{
+	char path[64];
+	int ret;
+
+	sprintf(path, fmt, a, b);
+	ret = smartfs_operations.mkdir(&g_mntinode, path, 0777);
+	if (ret < 0) {
+		bench_fail("mkdir", ret);
+	}
+}
+
+/* stat() a file by one of its names and check the result, returning the
+ * MTD reads it took.
+ */
+
+static uint32_t bench_stat(int n, int fanout, bool renamed, uint64_t *elapsed)
+{
+	struct stat buf;
+	char path[64];
+	uint64_t start;
+	uint32_t reads;
+	int ret;
+
+	bench_path(path, n, fanout, renamed);
+	reads = g_mtd.reads;
+	start = bench_nsec();
+	ret = smartfs_operations.stat(&g_mntinode, path, &buf);
+	*elapsed += bench_nsec() - start;
+	reads = g_mtd.reads - reads;
+
+	if (g_exists[n] && g_renamed[n] == renamed) {
+		if (ret != OK || !S_ISREG(buf.st_mode) || buf.st_size != n + 1) {
+			fprintf(stderr, "ERROR: %s not found or wrong: %d\n", path, ret);
+			exit(EXIT_FAILURE);
+		}
+	} else if (ret != -ENOENT) {
+		fprintf(stderr, "ERROR: %s found after it was removed: %d\n", path, ret);
+		exit(EXIT_FAILURE);
+	}
+
+	return reads;
+}
+
+/* Delete and create again, or rename a file.  Both names are looked up
+ * before and after to bring them into the cache.
+ */
+
+static void bench_churn(int fanout)
+{
+	uint64_t elapsed = 0;
+	char oldpath[64];
+	char newpath[64];
+	int n = bench_random() % NFILES(fanout);
+	int ret;
+
+	bench_stat(n, fanout, false, &elapsed);
+	bench_stat(n, fanout, true, &elapsed);
+
+	if (!g_exists[n]) {
+		bench_create(n, fanout);
+	} else if (bench_random() % 2 == 0 && !g_renamed[n]) {
+		bench_path(oldpath, n, fanout, false);
+		ret = smartfs_operations.unlink(&g_mntinode, oldpath);
+		if (ret < 0) {
+			bench_fail("unlink", ret);
+		}
+
+		g_exists[n] = FALSE;
+	} else {
+		bench_path(oldpath, n, fanout, g_renamed[n]);
+		bench_path(newpath, n, fanout, !g_renamed[n]);
+		ret = smartfs_operations.rename(&g_mntinode, oldpath, newpath);
+		if (ret < 0) {
+			bench_fail("rename", ret);
+		}
+
+		g_renamed[n] = !g_renamed[n];
+	}
+
+	bench_stat(n, fanout, false, &elapsed);
+	bench_stat(n, fanout, true, &elapsed);
+}
+
+static void bench_run(int fanout)
+{
+#ifdef CONFIG_SMARTFS_DCACHE
+	FAR struct smartfs_mountpt_s *fs;
+#endif
+	FAR void *handle;
+	FAR uint8_t *flash;
+	uint64_t elapsed = 0;
+	uint32_t reads = 0;
+	int hot[NHOT];
+	int ret;
+	int n;
+	int x;
+
+	flash = malloc(FLASH_SIZE);
+	if (flash == NULL) {
+		bench_fail("malloc", -ENOMEM);
+	}
+
+	g_mtd.ram = rammtd_initialize(flash, FLASH_SIZE);
+	if (g_mtd.ram == NULL) {
+		bench_fail("rammtd_initialize", -ENOMEM);
+	}
+
+	ret = smart_initialize(0, &g_mtd.mtd, NULL);
+	if (ret < 0) {
+		bench_fail("smart_initialize", ret);
+	}
+
+	bench_format();
+
+	ret = smartfs_operations.bind(&g_blkinode, NULL, &handle);
+	if (ret < 0) {
+		bench_fail("bind", ret);
+	}
+
+	g_mntinode.u.i_mops = &smartfs_operations;
+	g_mntinode.i_private = handle;
+
+	/* fanout directories in the root and in dir0 and dir1, and fanout files
+	 * in each of their first two subdirectories.
+	 */
+
+	for (x = 0; x < fanout; x++) {
+		bench_mkdir("dir%d", x, 0);
+	}
+
+	for (x = 0; x < 2 * fanout; x++) {
+		bench_mkdir("dir%d/sub%d", x / fanout, x % fanout);
+	}
+
+	for (n = 0; n < NFILES(fanout); n++) {
+		bench_create(n, fanout);
+	}
+
+	/* The hot files are spread over the four directories */
+
+	for (x = 0; x < NHOT; x++) {
+		hot[x] = (x % 4) * fanout + bench_random() % fanout;
+	}
+
+#ifdef CONFIG_SMARTFS_DCACHE
+	fs = handle;
+	fs->fs_dcachehits = 0;
+	fs->fs_dcachemisses = 0;
+#endif
+
+	for (x = 0; x < NLOOKUPS; x++) {
+		if (x % CHURN_PERIOD == CHURN_PERIOD - 1) {
+			bench_churn(fanout);
+		}
+
+		if (bench_random() % 10 < 8) {
+			n = hot[bench_random() % NHOT];
+		} else {
+			n = bench_random() % NFILES(fanout);
+		}
+
+		reads += bench_stat(n, fanout, g_renamed[n], &elapsed);
+	}
+
+	printf("%8d %10.1f %10.2f", fanout, (double)reads / NLOOKUPS, elapsed / 1000.0 / NLOOKUPS);
+#ifdef CONFIG_SMARTFS_DCACHE
+	printf(" %9.1f%%", 100.0 * fs->fs_dcachehits / (fs->fs_dcachehits + fs->fs_dcachemisses));
+#endif
+	printf("\n");
+
+	smartfs_operations.unbind(handle, NULL);
+	free(g_mtd.ram);
+	free(flash);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* smart_initialize() registers the block driver of the device */
+
+int register_blockdriver(FAR const char *path, FAR const struct block_operations *bops, mode_t mode, FAR void *priv)
+{
+	g_blkinode.u.i_bops = bops;
+	g_blkinode.i_private = priv;
+	return OK;
+}
+
+int main(int argc, char **argv)
+{
+	int maxfanout = MAX_FANOUT;
+	int fanout;
+
+	if (argc > 1) {
+		maxfanout = atoi(argv[1]);
+		if (maxfanout < 4 || maxfanout > MAX_FANOUT) {
+			fprintf(stderr, "USAGE: %s [4..%d]\n", argv[0], MAX_FANOUT);
+			return EXIT_FAILURE;
+		}
+	}
+
+	g_mtd.mtd.erase = bench_erase;
+	g_mtd.mtd.bread = bench_bread;
+	g_mtd.mtd.bwrite = bench_bwrite;
+	g_mtd.mtd.read = bench_read;
+	g_mtd.mtd.ioctl = bench_ioctl;
+
+#ifdef CONFIG_SMARTFS_DCACHE
+	printf("SmartFS path lookup with a %d entry directory entry cache\n", CONFIG_SMARTFS_DCACHE_SIZE);
+	printf("%8s %10s %10s %10s\n", "Entries", "Reads", "Stat us", "Hits");
+#else
+	printf("SmartFS path lookup\n");
+	printf("%8s %10s %10s\n", "Entries", "Reads", "Stat us");
+#endif
+
+	for (fanout = 4; fanout <= maxfanout; fanout *= 2) {
+		bench_run(fanout);
+	}
+
+	return EXIT_SUCCESS;
+}
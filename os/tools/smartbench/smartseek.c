@@ -0,0 +1,384 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Kim Sparrow All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/smartbench/smartseek.c
+ *
+ * Measures on the host what seeking in a SmartFS file costs for growing
+ * file sizes.  The real fs/smartfs and fs/driver/mtd/smart.c run on a RAM
+ * MTD device whose reads are counted.  A log file is written and kept
+ * open, then read back at random positions, and then grown by records
+ * appended at its end between reads at random positions, as a log that
+ * is also being looked at.  Every read is checked.  SmartFS is built once
+ * as it is and once with CONFIG_SMARTFS_SEEK_INDEX:
+ *
+ *   make -f Makefile.host smartseek
+ *   ./smartseek_walk; ./smartseek_index
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <tinyara/fs/fs.h>
+#include <tinyara/fs/ioctl.h>
+#include <tinyara/fs/mtd.h>
+#include <tinyara/fs/smart.h>
+
+#include "smartfs/smartfs.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define FLASH_SIZE     (4 * 1024 * 1024)
+#define RECORD_SIZE    64
+#define NREADS         2000
+#define NAPPENDS       500
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Counts the reads of the RAM MTD device it wraps */
+
+struct bench_mtd_s {
+	struct mtd_dev_s mtd;
+	FAR struct mtd_dev_s *ram;
+	uint32_t reads;
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+extern const struct mountpt_operations smartfs_operations;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct bench_mtd_s g_mtd;
+static struct inode g_blkinode;
+static struct inode g_mntinode;
+static uint32_t g_seed = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static unsigned int bench_random(void)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return g_seed >> 8;
+}
+
+static uint64_t bench_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void bench_fail(FAR const char *what, int ret)
+{
+	fprintf(stderr, "ERROR: %s failed: %d\n", what, ret);
+	exit(EXIT_FAILURE);
+}
+
+static int bench_erase(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks)
+{
+	return g_mtd.ram->erase(g_mtd.ram, startblock, nblocks);
+}
+
+static ssize_t bench_bread(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks, FAR uint8_t *buffer)
+{
+	g_mtd.reads++;
+	return g_mtd.ram->bread(g_mtd.ram, startblock, nblocks, buffer);
+}
+
+static ssize_t bench_bwrite(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks, FAR const uint8_t *buffer)
+{
+	return g_mtd.ram->bwrite(g_mtd.ram, startblock, nblocks, buffer);
+}
+
+static ssize_t bench_read(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes, FAR uint8_t *buffer)
+{
+	g_mtd.reads++;
+	return g_mtd.ram->read(g_mtd.ram, offset, nbytes, buffer);
+}
+
+static int bench_ioctl(FAR struct mtd_dev_s *dev, int cmd, unsigned long arg)
+{
+	return g_mtd.ram->ioctl(g_mtd.ram, cmd, arg);
+}
+
+static int bench_blkioctl(int cmd, unsigned long arg)
+{
+	return g_blkinode.u.i_bops->ioctl(&g_blkinode, cmd, arg);
+}
+
+/* The byte at each file position */
+
+static uint8_t bench_byte(size_t pos)
+{
+	return (uint8_t)(pos * 7 + (pos >> 8));
+}
+
+/* Low-level format the device and write an empty root directory, as
+ * mksmartfs() does.
+ */
+
+static void bench_format(void)
+{
+	struct smart_read_write_s req;
+	uint8_t type = SMARTFS_SECTOR_TYPE_DIR;
+	int ret;
+
+	ret = bench_blkioctl(BIOC_LLFORMAT, 0);
+	if (ret < 0) {
+		bench_fail("BIOC_LLFORMAT", ret);
+	}
+
+	ret = bench_blkioctl(BIOC_ALLOCSECT, SMARTFS_ROOT_DIR_SECTOR);
+	if (ret != SMARTFS_ROOT_DIR_SECTOR) {
+		bench_fail("BIOC_ALLOCSECT", ret);
+	}
+
+	req.logsector = SMARTFS_ROOT_DIR_SECTOR;
+	req.offset = 0;
+	req.count = 1;
+	req.buffer = &type;
+	ret = bench_blkioctl(BIOC_WRITESECT, (unsigned long)&req);
+	if (ret < 0) {
+		bench_fail("BIOC_WRITESECT", ret);
+	}
+}
+
+static void bench_append(FAR struct file *filep, size_t *filelen, size_t len)
+{
+	uint8_t buffer[RECORD_SIZE];
+	ssize_t nwritten;
+	size_t x;
+
+	for (x = 0; x < len; x++) {
+		buffer[x] = bench_byte(*filelen + x);
+	}
+
+	nwritten = smartfs_operations.write(filep, (FAR const char *)buffer, len);
+	if (nwritten != len) {
+		bench_fail("write", nwritten);
+	}
+
+	*filelen += len;
+}
+
+/* Seek and read a record back, returning the MTD reads the seek took */
+
+static uint32_t bench_seekread(FAR struct file *filep, size_t filelen, uint64_t *elapsed)
+{
+	uint8_t buffer[RECORD_SIZE];
+	uint64_t start;
+	uint32_t reads;
+	size_t pos = bench_random() % (filelen - RECORD_SIZE);
+	ssize_t nread;
+	off_t ret;
+	int x;
+
+	reads = g_mtd.reads;
+	start = bench_nsec();
+	ret = smartfs_operations.seek(filep, pos, SEEK_SET);
+	*elapsed += bench_nsec() - start;
+	reads = g_mtd.reads - reads;
+	if (ret != pos) {
+		bench_fail("seek", ret);
+	}
+
+	nread = smartfs_operations.read(filep, (FAR char *)buffer, RECORD_SIZE);
+	if (nread != RECORD_SIZE) {
+		bench_fail("read", nread);
+	}
+
+	for (x = 0; x < RECORD_SIZE; x++) {
+		if (buffer[x] != bench_byte(pos + x)) {
+			fprintf(stderr, "ERROR: file position %lu does not read back\n", (unsigned long)(pos + x));
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	return reads;
+}
+
+static void bench_report(size_t filelen, FAR const char *what, uint32_t reads, uint32_t maxreads, uint64_t elapsed, int nops)
+{
+	printf("%8lu %-8s %10.1f %10u %10.2f\n", (unsigned long)filelen / 1024, what, (double)reads / nops, maxreads, elapsed / 1000.0 / nops);
+}
+
+static void bench_run(size_t size)
+{
+	struct file file;
+	FAR void *handle;
+	FAR uint8_t *flash;
+	uint64_t elapsed;
+	uint32_t reads;
+	uint32_t maxreads;
+	uint32_t n;
+	size_t filelen = 0;
+	off_t pos;
+	int ret;
+	int x;
+
+	flash = malloc(FLASH_SIZE);
+	if (flash == NULL) {
+		bench_fail("malloc", -ENOMEM);
+	}
+
+	g_mtd.ram = rammtd_initialize(flash, FLASH_SIZE);
+	if (g_mtd.ram == NULL) {
+		bench_fail("rammtd_initialize", -ENOMEM);
+	}
+
+	ret = smart_initialize(0, &g_mtd.mtd, NULL);
+	if (ret < 0) {
+		bench_fail("smart_initialize", ret);
+	}
+
+	bench_format();
+
+	ret = smartfs_operations.bind(&g_blkinode, NULL, &handle);
+	if (ret < 0) {
+		bench_fail("bind", ret);
+	}
+
+	g_mntinode.u.i_mops = &smartfs_operations;
+	g_mntinode.i_private = handle;
+
+	memset(&file, 0, sizeof(file));
+	file.f_inode = &g_mntinode;
+	ret = smartfs_operations.open(&file, "log", O_CREAT | O_RDWR, 0666);
+	if (ret < 0) {
+		bench_fail("open", ret);
+	}
+
+	while (filelen < size) {
+		bench_append(&file, &filelen, RECORD_SIZE);
+	}
+
+	/* Reads at random positions */
+
+	elapsed = 0;
+	reads = 0;
+	maxreads = 0;
+	for (x = 0; x < NREADS; x++) {
+		n = bench_seekread(&file, filelen, &elapsed);
+		reads += n;
+		if (n > maxreads) {
+			maxreads = n;
+		}
+	}
+
+	bench_report(filelen, "random", reads, maxreads, elapsed, NREADS);
+
+	/* Records appended at the end between them */
+
+	elapsed = 0;
+	reads = 0;
+	maxreads = 0;
+	for (x = 0; x < NAPPENDS; x++) {
+		uint64_t start = bench_nsec();
+
+		n = g_mtd.reads;
+		pos = smartfs_operations.seek(&file, 0, SEEK_END);
+		elapsed += bench_nsec() - start;
+		n = g_mtd.reads - n;
+		if (pos != filelen) {
+			bench_fail("seek", pos);
+		}
+
+		bench_append(&file, &filelen, RECORD_SIZE);
+		n += bench_seekread(&file, filelen, &elapsed);
+		reads += n;
+		if (n > maxreads) {
+			maxreads = n;
+		}
+	}
+
+	bench_report(filelen, "append", reads, maxreads, elapsed, NAPPENDS);
+
+	smartfs_operations.close(&file);
+	smartfs_operations.unbind(handle, NULL);
+	free(g_mtd.ram);
+	free(flash);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* smart_initialize() registers the block driver of the device */
+
+int register_blockdriver(FAR const char *path, FAR const struct block_operations *bops, mode_t mode, FAR void *priv)
+{
+	g_blkinode.u.i_bops = bops;
+	g_blkinode.i_private = priv;
+	return OK;
+}
+
+int main(int argc, char **argv)
+{
+	size_t maxsize = 1024;
+	size_t size;
+
+	if (argc > 1) {
+		maxsize = atoi(argv[1]);
+		if (maxsize < 16 || maxsize > 2048) {
+			fprintf(stderr, "USAGE: %s [16..2048 KiB]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	g_mtd.mtd.erase = bench_erase;
+	g_mtd.mtd.bread = bench_bread;
+	g_mtd.mtd.bwrite = bench_bwrite;
+	g_mtd.mtd.read = bench_read;
+	g_mtd.mtd.ioctl = bench_ioctl;
+
+#ifdef CONFIG_SMARTFS_SEEK_INDEX
+	printf("SmartFS seek with chain index every %d sectors, %d entries\n", CONFIG_SMARTFS_SEEK_INDEX_INTERVAL, CONFIG_SMARTFS_SEEK_INDEX_SIZE);
+#else
+	printf("SmartFS seek\n");
+#endif
+	printf("%8s %-8s %10s %10s %10s\n", "KiB", "Seeks", "Reads", "Max reads", "Seek us");
+
+	for (size = 16 * 1024; size <= maxsize * 1024; size *= 2) {
+		bench_run(size);
+	}
+
+	return EXIT_SUCCESS;
+}
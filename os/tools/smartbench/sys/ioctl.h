@@ -0,0 +1,12 @@
+/****************************************************************************
+ * tools/smartbench/sys/ioctl.h
+ *
+ * Hides the host <sys/ioctl.h>, whose definitions clash with those of
+ * <tinyara/fs/ioctl.h>.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_SMARTBENCH_SYS_IOCTL_H
+#define __TOOLS_SMARTBENCH_SYS_IOCTL_H
+
+#endif							/* __TOOLS_SMARTBENCH_SYS_IOCTL_H */
@@ -0,0 +1,15 @@
+/****************************************************************************
+ * tools/smartbench/sys/statfs.h
+ *
+ * The host sys/statfs.h plus the SmartFS magic number.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_SMARTBENCH_SYS_STATFS_H
+#define __TOOLS_SMARTBENCH_SYS_STATFS_H
+
+#include_next <sys/statfs.h>
+
+#define SMARTFS_MAGIC          0x54524D53
+
+#endif							/* __TOOLS_SMARTBENCH_SYS_STATFS_H */
@@ -0,0 +1,17 @@
+/****************************************************************************
+ * tools/smartbench/tinyara/clock.h
+ *
+ * smartgc keeps a simulated system time with one tick per millisecond.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_SMARTBENCH_TINYARA_CLOCK_H
+#define __TOOLS_SMARTBENCH_TINYARA_CLOCK_H
+
+#include <stdint.h>
+
+#define MSEC2TICK(msec)        (msec)
+
+uint32_t clock_systimer(void);
+
+#endif							/* __TOOLS_SMARTBENCH_TINYARA_CLOCK_H */
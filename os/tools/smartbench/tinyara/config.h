@@ -0,0 +1,24 @@
+/****************************************************************************
+ * tools/smartbench/tinyara/config.h
+ *
+ * Stands in for the generated configuration when the SMART MTD driver is
+ * built on the host by smartbench and smartgc.  The options they compare,
+ * and the erase size of smartgc, are set on the command line.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_SMARTBENCH_TINYARA_CONFIG_H
+#define __TOOLS_SMARTBENCH_TINYARA_CONFIG_H
+
+#define CONFIG_MTD_SMART 1
+#define CONFIG_FS_WRITABLE 1
+#define CONFIG_MTD_SMART_SECTOR_SIZE 512
+#define CONFIG_MTD_SMART_WEAR_LEVEL 1
+#define CONFIG_SMARTFS_ERASEDSTATE 0xff
+#define CONFIG_SMARTFS_MAXNAMLEN 32
+#define CONFIG_RAMMTD_BLOCKSIZE 512
+#ifndef CONFIG_RAMMTD_ERASESIZE
+#define CONFIG_RAMMTD_ERASESIZE 65536
+#endif
+
+#endif							/* __TOOLS_SMARTBENCH_TINYARA_CONFIG_H */
@@ -0,0 +1,17 @@
+/****************************************************************************
+ * tools/smartbench/tinyara/kmalloc.h
+ *
+ * The kernel heap is the host heap in smartbench.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_SMARTBENCH_TINYARA_KMALLOC_H
+#define __TOOLS_SMARTBENCH_TINYARA_KMALLOC_H
+
+#include <stdlib.h>
+
+#define kmm_malloc(s)          malloc(s)
+#define kmm_zalloc(s)          calloc(1, s)
+#define kmm_free(p)            free(p)
+
+#endif							/* __TOOLS_SMARTBENCH_TINYARA_KMALLOC_H */
@@ -0,0 +1,30 @@
+/****************************************************************************
+ * tools/smartbench/tinyara/wqueue.h
+ *
+ * smartgc runs the queued work itself when the simulated device is idle.
+ *
+ ****************************************************************************/
+
+#ifndef __TOOLS_SMARTBENCH_TINYARA_WQUEUE_H
+#define __TOOLS_SMARTBENCH_TINYARA_WQUEUE_H
+
+#include <stdint.h>
+
+#define HPWORK                 0
+#define LPWORK                 1
+
+typedef void (*worker_t)(FAR void *arg);
+
+struct work_s {
+	worker_t worker;			/* Work callback */
+	FAR void *arg;				/* Callback argument */
+	uint32_t qtime;				/* Time work queued */
+	uint32_t delay;				/* Delay until work performed */
+};
+
+#define work_available(work)   ((work)->worker == NULL)
+
+int work_queue(int qid, FAR struct work_s *work, worker_t worker, FAR void *arg, uint32_t delay);
+int work_cancel(int qid, FAR struct work_s *work);
+
+#endif							/* __TOOLS_SMARTBENCH_TINYARA_WQUEUE_H */
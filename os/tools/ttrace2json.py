@@ -0,0 +1,198 @@
+#!/usr/bin/env python
+###########################################################################
+#
+# Copyright 2017 Kim Sparrow All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+# either express or implied. See the License for the specific
+# language governing permissions and limitations under the License.
+#
+###########################################################################
+#
+# Converts a T-trace ring dump into Chrome trace event JSON, which can be
+# opened with chrome://tracing or https://ui.perfetto.dev.
+#
+# A dump is what reading the T-trace driver returns with CONFIG_TTRACE_RING,
+# for example saved on the target with 'ttrace -o /mnt/trace.bin'.  Its
+# layout is struct ttrace_ringhdr_s followed by struct ttrace_record_s
+# records, see os/include/tinyara/ttrace_internal.h.
+#
+# Spans of trace_begin()/trace_end() are shown per task.  Context switches
+# are shown as slices of the task running on the CPU.
+#
+# Example: ttrace2json.py -f trace.bin -o trace.json
+
+from __future__ import print_function
+
+import sys
+import json
+import struct
+from optparse import OptionParser
+
+RING_MAGIC = 0x42525454
+RING_VERSION = 1
+
+HDR_FORMAT = '<IHHII'
+RECORD_FORMAT = '<IIIhcB32s'
+SCHED_FORMAT = '<hBB12shBb12s'
+
+CODE_UNIQUE = 0x80
+
+# Chrome trace 'pid's of the two groups of tracks
+CPU_PID = 0
+TASK_PID = 1
+
+
+def cstring(raw):
+	return raw.split(b'\0', 1)[0].decode('ascii', 'replace').strip()
+
+
+class Clock(object):
+	"""Turns the cycle and tick counts of records into microseconds.
+
+	The cycle counter wraps after a few seconds, so differences of cycle
+	counts are used only between records that are close in ticks.
+	"""
+
+	def __init__(self, freq, usec_per_tick):
+		self.freq = freq
+		self.usec_per_tick = usec_per_tick
+		self.last = None
+
+	def time(self, cycles, ticks):
+		if self.last is None:
+			self.last = (cycles, ticks, float(ticks * self.usec_per_tick))
+			return self.last[2]
+
+		lcycles, lticks, lusec = self.last
+		dticks = (ticks - lticks) & 0xffffffff
+		if dticks >= 0x80000000:
+			dticks -= 0x100000000
+		tick_usec = dticks * self.usec_per_tick
+
+		usec = lusec + tick_usec
+		if self.freq > 0:
+			wrap_usec = 0x100000000 * 1e6 / self.freq
+			if abs(tick_usec) < wrap_usec / 4:
+				dcycles = (cycles - lcycles) & 0xffffffff
+				if dcycles >= 0x80000000:
+					dcycles -= 0x100000000
+				usec = lusec + dcycles * 1e6 / self.freq
+
+		self.last = (cycles, ticks, usec)
+		return usec
+
+
+def read_dump(data):
+	hdrsize = struct.calcsize(HDR_FORMAT)
+	if len(data) < hdrsize:
+		raise ValueError('dump is too short')
+
+	magic, version, recsize, freq, usec_per_tick = struct.unpack_from(HDR_FORMAT, data)
+	if magic != RING_MAGIC or version != RING_VERSION:
+		raise ValueError('not a T-trace ring dump')
+	if recsize != struct.calcsize(RECORD_FORMAT):
+		raise ValueError('unexpected record size %d' % recsize)
+
+	records = []
+	for offset in range(hdrsize, len(data) - recsize + 1, recsize):
+		records.append(struct.unpack_from(RECORD_FORMAT, data, offset))
+
+	return freq, usec_per_tick, records
+
+
+def lost_event(lost, ts):
+	return {'ph': 'i', 'name': '%d records lost' % lost, 'pid': CPU_PID, 'tid': 0, 'ts': ts, 's': 'g'}
+
+
+def convert(freq, usec_per_tick, records):
+	clock = Clock(freq, usec_per_tick)
+	events = [
+		{'ph': 'M', 'name': 'process_name', 'pid': CPU_PID, 'args': {'name': 'CPU'}},
+		{'ph': 'M', 'name': 'process_name', 'pid': TASK_PID, 'args': {'name': 'Tasks'}},
+	]
+	names = {}
+	running = None
+	lost = 0
+	ts = 0
+
+	for seq, cycles, ticks, pid, event_type, codelen, msg in records:
+		event_type = event_type.decode('ascii', 'replace')
+
+		# Lost records carry no time; mark them at the record that follows
+		if event_type == 'l':
+			lost += struct.unpack_from('<I', msg)[0]
+			continue
+
+		ts = clock.time(cycles, ticks)
+		if lost > 0:
+			events.append(lost_event(lost, ts))
+			lost = 0
+
+		if event_type == 's':
+			fields = struct.unpack(SCHED_FORMAT, msg)
+			next_pid, next_prio, next_comm = fields[4], fields[5], cstring(fields[7])
+
+			if running is not None:
+				start, rpid, rcomm = running
+				events.append({'ph': 'X', 'name': rcomm, 'pid': CPU_PID, 'tid': 0,
+							   'ts': start, 'dur': max(ts - start, 0), 'args': {'pid': rpid}})
+			running = (ts, next_pid, next_comm)
+
+			if names.get(next_pid) != next_comm:
+				names[next_pid] = next_comm
+				events.append({'ph': 'M', 'name': 'thread_name', 'pid': TASK_PID, 'tid': next_pid,
+							   'args': {'name': '%s (%d)' % (next_comm, next_pid)}})
+		elif event_type == 'b':
+			if codelen & CODE_UNIQUE:
+				name = 'uid %d' % (codelen & ~CODE_UNIQUE)
+			else:
+				name = cstring(msg)
+			events.append({'ph': 'B', 'name': name, 'pid': TASK_PID, 'tid': pid, 'ts': ts})
+		elif event_type == 'e':
+			events.append({'ph': 'E', 'pid': TASK_PID, 'tid': pid, 'ts': ts})
+
+	if lost > 0:
+		events.append(lost_event(lost, ts))
+
+	# Records of concurrent trace points can be stored slightly out of order
+	events.sort(key=lambda e: e.get('ts', -1))
+	return {'traceEvents': events, 'displayTimeUnit': 'ns'}
+
+
+def main():
+	parser = OptionParser()
+	parser.add_option("-f", "--file", dest="infilename", help="T-trace ring dump", metavar="INPUT_FILE")
+	parser.add_option("-o", "--output", dest="output", help="Output written to this file. Default is stdout.", metavar="OUTPUT_FILE")
+	(options, args) = parser.parse_args()
+
+	if not options.infilename:
+		parser.print_help()
+		sys.exit(1)
+
+	with open(options.infilename, 'rb') as infile:
+		data = infile.read()
+
+	try:
+		trace = convert(*read_dump(data))
+	except ValueError as e:
+		print('%s: %s' % (options.infilename, e), file=sys.stderr)
+		sys.exit(1)
+
+	if options.output:
+		with open(options.output, 'w') as outfile:
+			json.dump(trace, outfile)
+	else:
+		json.dump(trace, sys.stdout)
+
+
+if __name__ == '__main__':
+	main()